@@ -30,6 +30,10 @@
 #define _EXPAND_STRUCT_NAME(type) _array_##type
 #define _EXPAND_METHOD_NAME(type, method) _array_##type##_##method
 
+// arrays created with Create() whose values fit within this many bytes (including the terminator)
+// store them inline after the header so they only cost a single allocation
+#define ARRAY_INLINE_SIZE 64
+
 #define _ARRAY_DEFINE_STRUCT(type) struct _EXPAND_STRUCT_NAME(type)\
 {\
 	/* The pointer to the backing array */\
@@ -48,12 +52,16 @@
 	ulong TypeId;\
 	/* Whether or not this object was constructed on the stack */\
 	bool StackObject;\
-	/* Whether or not the array needs to recalculate the hash */\
+	/* Whether or not the array needs to recalculate the hash, */\
+	/* hashes are only calculated lazily by Hash() or Equals() */\
 	bool Dirty;\
-	/* The Hash of this array */\
+	/* The Hash of this array, only valid when Dirty is false */\
 	ulong Hash;\
-	/* Whether or not this array is auto hashed, default is true */\
+	/* Whether or not Equals() should calculate and compare hashes, default is true */\
 	bool AutoHash;\
+	/* Whether or not Values is stored in the same block as this header, */\
+	/* inline values are moved to the heap the first time the array grows */\
+	bool InlineValues;\
 }; \
 typedef struct _array_##type partial_##type##_##array;\
 typedef struct _array_##type* type##_array;
@@ -98,6 +106,10 @@ typedef struct _array_##type* type##_array;
 #define _dynamic_array(type, initialCount) _EXPAND_METHOD_NAME(type,Create)(initialCount) 
 #define dynamic_array(type, initialCount) _dynamic_array(type, initialCount)
 
+#define _inline_array(type, inlineCount) _EXPAND_METHOD_NAME(type,CreateInline)(inlineCount) 
+// Creates a heap array that stores up to inlineCount elements inside of its header allocation
+#define inline_array(type, inlineCount) _inline_array(type, inlineCount)
+
 // checks the corresponding attribute against the provided value
 // throws if the value is out of bounds, otherwise returns value
 #define guard_array_attribute(arr,attribute,value) ((value) > (arr)->attribute ? throw_in_expression(IndexOutOfRangeException) : (value))
@@ -224,7 +236,11 @@ DEFINE_TYPE_ID(Array);
 
 struct _arrayMethods
 {
+	// Creates an array, arrays smaller than ARRAY_INLINE_SIZE bytes store their values inline
 	Array(*Create)(ulong elementSize, ulong count, ulong typeId);
+	// Creates an array that stores up to inlineCount elements in the same allocation as the header
+	// and only allocates a separate block for its values once it grows past that
+	Array(*CreateInline)(ulong elementSize, ulong inlineCount, ulong typeId);
 	void (*AutoResize)(Array);
 	void (*Resize)(Array, ulong newCount);
 	// Appends the given item to the end of the array
@@ -236,20 +252,61 @@ struct _arrayMethods
 	void (*Swap)(Array, ulong firstIndex, ulong secondIndex);
 	// Insertion sorts given the provided comparator Func
 	void (*InsertionSort)(Array, bool(comparator)(void* leftMemoryBlock, void* rightMemoryBlock));
+	// O(n log n) unstable introsort, the comparator returns true when left belongs after right
+	void (*Sort)(Array, bool(comparator)(void* leftMemoryBlock, void* rightMemoryBlock));
+	// O(n log n) stable merge sort, equal elements keep their order, allocates a copy of the array
+	void (*StableSort)(Array, bool(comparator)(void* leftMemoryBlock, void* rightMemoryBlock));
+	// Stable LSD radix sort in ascending order of the keys returned by the selector
+	// use the RadixKeyFrom* helpers to create keys from signed or floating point values
+	void (*RadixSort)(Array, ulong(*keySelector)(void* item));
 	// Gets a pointer to the value contained at index
 	void* (*At)(Array, ulong index);
 	// Appends the given value array to the end of the given array
 	Array(*AppendArray)(Array array, Array appendedValue);
+	// Appends count elements from the given c array to the end of the given array with a single copy
+	Array(*AppendCArray)(Array array, const void* values, ulong count);
+	// Ensures the array can hold at least count elements without resizing
+	void (*Reserve)(Array array, ulong count);
 	Array(*InsertArray)(Array dest, Array src, ulong index);
 	void (*Clear)(Array array);
 	bool (*Equals)(Array left, Array right);
 	void (*Foreach)(Array, void(*method)(void*));
 	void (*ForeachWithContext)(Array, void* context, void(*method)(void* context, void* item));
 	void (*Dispose)(Array);
+	// Runs the long running array benchmarks, these are not ran on start
+	void (*RunBenchmarks)(void);
 };
 
 extern const struct _arrayMethods Arrays;
 
+// Converts values into keys whose unsigned order matches the order of the value, for use with RadixSort
+private ulong RadixKeyFromInt(int value)
+{
+	return (ulong)((unsigned int)value ^ 0x80000000u);
+}
+
+private ulong RadixKeyFromLong(long long value)
+{
+	return (ulong)value ^ 0x8000000000000000ull;
+}
+
+private ulong RadixKeyFromFloat(float value)
+{
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	// negative floats sort backwards so flip every bit, positive floats only need the sign flipped
+	return (ulong)((bits & 0x80000000u) ? ~bits : bits | 0x80000000u);
+}
+
+private ulong RadixKeyFromDouble(double value)
+{
+	ulong bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	return (bits & 0x8000000000000000ull) ? ~bits : bits | 0x8000000000000000ull;
+}
+
 // TEMPLATE FOR METHODS
 #define _EXPAND_DEFINE_ARRAY(type) _ARRAY_DEFINE_STRUCT(type)\
 DEFINE_TYPE_ID(type##_array); \
@@ -258,6 +315,11 @@ private array(type) _EXPAND_METHOD_NAME(type,Create)(ulong count)\
 REGISTER_TYPE(type##_array); \
 return (array(type))Arrays.Create(sizeof(type), count, type##_arrayTypeId); \
 }\
+private array(type) _EXPAND_METHOD_NAME(type,CreateInline)(ulong inlineCount)\
+{\
+REGISTER_TYPE(type##_array); \
+return (array(type))Arrays.CreateInline(sizeof(type), inlineCount, type##_arrayTypeId); \
+}\
 private void _EXPAND_METHOD_NAME(type,AutoResize)(array(type) array)\
 {\
 Arrays.AutoResize((Array)array); \
@@ -307,6 +369,18 @@ private void _EXPAND_METHOD_NAME(type, InsertionSort)(array(type) array, bool(co
 {\
 Arrays.InsertionSort((Array)array, comparator); \
 }\
+private void _EXPAND_METHOD_NAME(type, Sort)(array(type) array, bool(comparator)(type* leftMemoryBlock, type* rightMemoryBlock))\
+{\
+Arrays.Sort((Array)array, comparator); \
+}\
+private void _EXPAND_METHOD_NAME(type, StableSort)(array(type) array, bool(comparator)(type* leftMemoryBlock, type* rightMemoryBlock))\
+{\
+Arrays.StableSort((Array)array, comparator); \
+}\
+private void _EXPAND_METHOD_NAME(type, RadixSort)(array(type) array, ulong(*keySelector)(type* item))\
+{\
+Arrays.RadixSort((Array)array, keySelector); \
+}\
 private type* _EXPAND_METHOD_NAME(type, At)(array(type) array, ulong index)\
 {\
 return (type*)Arrays.At((Array)array, index); \
@@ -325,12 +399,11 @@ private array(type) _EXPAND_METHOD_NAME(type, InsertArray)(array(type) destinati
 }\
 private void _EXPAND_METHOD_NAME(type, AppendCArray)(array(type) array, const type* carray, const ulong arraySize)\
 {\
-for (ulong cIndex = 0; cIndex < arraySize; ++cIndex)\
-{\
-type value = carray[cIndex]; \
-\
-_EXPAND_METHOD_NAME(type, Append)(array, value); \
+Arrays.AppendCArray((Array)array, carray, arraySize); \
 }\
+private void _EXPAND_METHOD_NAME(type, Reserve)(array(type) array, ulong count)\
+{\
+Arrays.Reserve((Array)array, count); \
 }\
 private void _EXPAND_METHOD_NAME(type, Clear)(array(type)array)\
 {\
@@ -347,7 +420,7 @@ Arrays.ForeachWithContext((Array)array, context, method); \
 private array(type) _EXPAND_METHOD_NAME(type, Clone)(array(type) array)\
 {\
 array(type) result = _EXPAND_METHOD_NAME(type, Create)(array->Capacity); \
-_EXPAND_METHOD_NAME(type, AppendArray)(result, array); \
+Arrays.AppendCArray((Array)result, array->Values, array->Count); \
 return result; \
 }\
 private void _EXPAND_METHOD_NAME(type, Dispose)(array(type)array)\
@@ -435,6 +508,7 @@ private array(type) _EXPAND_METHOD_NAME(type, Any)(array(type) arr, void* state,
 const static struct _array_##type##_methods\
 {\
 	array(type) (*Create)(ulong count); \
+	array(type) (*CreateInline)(ulong inlineCount); \
 	void (*AutoResize)(array(type)); \
 	void (*Resize)(array(type), ulong newCount); \
 	void (*Append)(array(type), type); \
@@ -443,11 +517,15 @@ const static struct _array_##type##_methods\
 	bool (*Empty)(array(type)); \
 	void (*Swap)(array(type), ulong firstIndex, ulong secondIndex); \
 	void (*InsertionSort)(array(type), bool(comparator)(type* left, type* right)); \
+	void (*Sort)(array(type), bool(comparator)(type* left, type* right)); \
+	void (*StableSort)(array(type), bool(comparator)(type* left, type* right)); \
+	void (*RadixSort)(array(type), ulong(*keySelector)(type* item)); \
 	type* (*At)(array(type), ulong index); \
 	type(*ValueAt)(array(type), ulong index); \
 	array(type) (*AppendArray)(array(type), const array(type) appendedValue); \
 	array(type) (*InsertArray)(array(type) destination, array(type) values, ulong index); \
 	void (*AppendCArray)(array(type), const type* carray, const ulong count); \
+	void (*Reserve)(array(type), ulong count); \
 	bool (*Equals)(array(type), array(type)); \
 	bool (*BeginsWith)(array(type), array(type)); \
 	void (*Clear)(array(type)); \
@@ -465,6 +543,7 @@ const static struct _array_##type##_methods\
 } type##_array##Arrays = \
 {\
 	.Create = _EXPAND_METHOD_NAME(type, Create), \
+	.CreateInline = _EXPAND_METHOD_NAME(type, CreateInline), \
 	.AutoResize = _EXPAND_METHOD_NAME(type, AutoResize), \
 	.Resize = _EXPAND_METHOD_NAME(type, Resize), \
 	.Append = _EXPAND_METHOD_NAME(type, Append), \
@@ -473,11 +552,15 @@ const static struct _array_##type##_methods\
 	.Empty = _EXPAND_METHOD_NAME(type, Empty), \
 	.Swap = _EXPAND_METHOD_NAME(type, Swap), \
 	.InsertionSort = _EXPAND_METHOD_NAME(type, InsertionSort), \
+	.Sort = _EXPAND_METHOD_NAME(type, Sort), \
+	.StableSort = _EXPAND_METHOD_NAME(type, StableSort), \
+	.RadixSort = _EXPAND_METHOD_NAME(type, RadixSort), \
 	.At = _EXPAND_METHOD_NAME(type, At), \
 	.ValueAt = _EXPAND_METHOD_NAME(type, ValueAt), \
 	.AppendArray = _EXPAND_METHOD_NAME(type, AppendArray), \
 	.InsertArray = _EXPAND_METHOD_NAME(type, InsertArray), \
 	.AppendCArray = _EXPAND_METHOD_NAME(type, AppendCArray), \
+	.Reserve = _EXPAND_METHOD_NAME(type, Reserve), \
 	.Equals = _EXPAND_METHOD_NAME(type, Equals), \
 	.Clear = _EXPAND_METHOD_NAME(type, Clear), \
 	.Foreach = _EXPAND_METHOD_NAME(type, Foreach), \
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "core/csharp.h"
+
+// Interlocked operations on 64-bit (ulong, long long) and 32-bit (long) values
+// all operations are full memory barriers and return the ORIGINAL value unless noted otherwise
+
+#ifdef _WIN32
+
+// increments the value and returns the NEW value
+#define AtomicIncrement(value) ((ulong)_InterlockedIncrement64((volatile long long*)&(value)))
+// decrements the value and returns the NEW value
+#define AtomicDecrement(value) ((ulong)_InterlockedDecrement64((volatile long long*)&(value)))
+#define AtomicAdd(value, amount) ((ulong)_InterlockedExchangeAdd64((volatile long long*)&(value), (long long)(amount)))
+#define AtomicExchange(value, newValue) ((ulong)_InterlockedExchange64((volatile long long*)&(value), (long long)(newValue)))
+#define AtomicCompareExchange(value, newValue, comparand) ((ulong)_InterlockedCompareExchange64((volatile long long*)&(value), (long long)(newValue), (long long)(comparand)))
+
+#define AtomicExchange32(value, newValue) _InterlockedExchange((volatile long*)&(value), (long)(newValue))
+#define AtomicCompareExchange32(value, newValue, comparand) _InterlockedCompareExchange((volatile long*)&(value), (long)(newValue), (long)(comparand))
+
+// hints to the processor that we are spinning on a value
+#define SpinWait() _mm_pause()
+
+#else
+
+#define AtomicIncrement(value) ((ulong)__atomic_add_fetch((volatile long long*)&(value), 1, __ATOMIC_SEQ_CST))
+#define AtomicDecrement(value) ((ulong)__atomic_sub_fetch((volatile long long*)&(value), 1, __ATOMIC_SEQ_CST))
+#define AtomicAdd(value, amount) ((ulong)__atomic_fetch_add((volatile long long*)&(value), (long long)(amount), __ATOMIC_SEQ_CST))
+#define AtomicExchange(value, newValue) ((ulong)__atomic_exchange_n((volatile long long*)&(value), (long long)(newValue), __ATOMIC_SEQ_CST))
+#define AtomicCompareExchange(value, newValue, comparand) ((ulong)__sync_val_compare_and_swap((volatile long long*)&(value), (long long)(comparand), (long long)(newValue)))
+
+#define AtomicExchange32(value, newValue) __atomic_exchange_n((volatile long*)&(value), (long)(newValue), __ATOMIC_SEQ_CST)
+#define AtomicCompareExchange32(value, newValue, comparand) __sync_val_compare_and_swap((volatile long*)&(value), (long)(comparand), (long)(newValue))
+
+#define SpinWait() __builtin_ia32_pause()
+
+#endif
@@ -68,6 +68,28 @@ struct _fileMethods {
 	// (if you want to add to the buffer count manually)
 	bool (*TryReadLine)(File file, string buffer, ulong offset, ulong* out_lineLength);
 
+	// maps the file at the provided path into memory and returns a READ ONLY view of its contents
+	// nothing is copied, pages are read from the OS page cache as they are touched
+	// the view is not guaranteed to be null terminated, use its Count
+	// the view must be released with Files.Unmap, not strings.Dispose
+	string(*Map)(const string path);
+
+	// maps the file at the provided path into memory and sets the out value to a READ ONLY
+	// view of its contents, returns false if the file could not be opened or mapped
+	bool (*TryMap)(const string path, string* out_view);
+
+	// releases a view returned by Map or TryMap, any partial strings taken from it become invalid
+	void (*Unmap)(string view);
+
+	// gets the size in bytes and the last time the file at the provided path was written to without opening it,
+	// the time is only meaningful when compared with another time from this method
+	bool (*TryGetInfo)(const string path, ulong* out_size, ulong* out_lastModified);
+
+	// gets the next line in the view starting at cursor without copying it and advances
+	// the cursor past the line ending, the line does not contain its trailing \n or \r\n
+	// returns false once the end of the view is reached
+	bool (*TryGetNextLine)(const string view, ulong* cursor, partial_string* out_line);
+
 	/// <summary>
 	/// Attempts to look forwards into the file and count the number of times targetSequence is encountered, counting is stopped when end of file is reached
 	/// or when the abortsequence is encountered
@@ -83,6 +105,8 @@ struct _fileMethods {
 	/// Determines if all files that were opened were closed appropriately
 	/// </summary>
 	bool (*TryVerifyCleanup)(void);
+
+	void (*RunUnitTests)(void);
 };
 
 extern const struct _fileMethods Files;
@@ -23,6 +23,9 @@ struct _hashingMethods {
 	ulong(*ChainHashSafe)(const char* bytes, const ulong size, const ulong previousHash);
 	// Chain hashes a single byte
 	ulong(*ChainHashSingle)(const char byte, const ulong previousHash);
+	void (*RunUnitTests)(void);
+	// Measures hashing throughput from 16B to 16MB, these are not ran on start
+	void (*RunBenchmarks)(void);
 };
 
 extern const struct _hashingMethods Hashing;
\ No newline at end of file
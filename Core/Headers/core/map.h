@@ -0,0 +1,255 @@
+#pragma once
+
+#include "core/csharp.h"
+#include "core/memory.h"
+#include "core/hashing.h"
+#include <stddef.h>
+#include <string.h>
+
+// TEMPLATE
+
+// Open addressing hash map using robin hood linear probing, entries that are further from their
+// ideal slot steal the slots of entries that are closer to theirs so every probe sequence stays short
+// and lookups for missing keys can stop early. Removal shifts the following entries back
+// instead of leaving tombstones.
+
+#define _EXPAND_map(key, value) key##_##value##_map
+#define _EXPAND_Maps(key, value) key##_##value##_map##Maps
+
+// Creates a map of the given key and value types, remember to define the map if this fails to compile
+#define map(key, value) _EXPAND_map(key, value)
+// Convenience methods that can be used with a map(key, value)
+#define maps(key, value) _EXPAND_Maps(key, value)
+
+#define _EXPAND_MAP_STRUCT_NAME(key, value) _map_##key##_##value
+#define _EXPAND_MAP_ENTRY_NAME(key, value) _map_entry_##key##_##value
+#define _EXPAND_MAP_METHOD_NAME(key, value, method) _map_##key##_##value##_##method
+
+// the most significant bit of an entry's hash is set when the entry is in use
+#define MAP_OCCUPIED_BIT ((ulong)1 << 63)
+
+#define _MAP_DEFINE_STRUCT(key, value) struct _EXPAND_MAP_ENTRY_NAME(key, value)\
+{\
+	/* The hash of the key with MAP_OCCUPIED_BIT set, 0 when the slot is empty */\
+	ulong Hash;\
+	key Key;\
+	value Value;\
+};\
+struct _EXPAND_MAP_STRUCT_NAME(key, value)\
+{\
+	/* The backing entries, Capacity + 1 entries are allocated, the last is scratch space */\
+	struct _EXPAND_MAP_ENTRY_NAME(key, value)* Entries;\
+	/* The size in bytes of a single entry */\
+	ulong EntrySize;\
+	/* The offset in bytes of the key within an entry */\
+	ulong KeyOffset;\
+	/* The size in bytes of the key */\
+	ulong KeySize;\
+	/* The offset in bytes of the value within an entry */\
+	ulong ValueOffset;\
+	/* The size in bytes of the value */\
+	ulong ValueSize;\
+	/* The number of entries the map can store, always a power of two */\
+	ulong Capacity;\
+	/* The number of entries stored in the map */\
+	ulong Count;\
+	/* The typeid of the entries stored in the map */\
+	ulong TypeId;\
+	/* Hashes a key, the bytes of the key are hashed when null */\
+	ulong(*KeyHash)(const void* keyPointer);\
+	/* Compares two keys, the bytes of the keys are compared when null */\
+	bool(*KeyEquals)(const void* left, const void* right);\
+}; \
+typedef struct _EXPAND_MAP_STRUCT_NAME(key, value)* key##_##value##_map;
+
+struct _map_entry_void { ulong Hash; };
+struct _map_void
+{
+	char* Entries;
+	ulong EntrySize;
+	ulong KeyOffset;
+	ulong KeySize;
+	ulong ValueOffset;
+	ulong ValueSize;
+	ulong Capacity;
+	ulong Count;
+	ulong TypeId;
+	ulong(*KeyHash)(const void* key);
+	bool(*KeyEquals)(const void* left, const void* right);
+};
+typedef struct _map_void* Map;
+
+DEFINE_TYPE_ID(Map);
+
+struct _mapMethods
+{
+	// Creates a map that can hold at least count entries before it resizes, the layout of the entry
+	// is provided by the typed map so keys and values keep their natural alignment
+	Map(*Create)(ulong count, ulong entrySize, ulong keyOffset, ulong keySize, ulong valueOffset, ulong valueSize, ulong typeId,
+		ulong(*keyHash)(const void* key),
+		bool(*keyEquals)(const void* left, const void* right));
+	// Ensures the map can hold at least count entries without resizing
+	void (*Reserve)(Map, ulong count);
+	// Gets a pointer to the value stored for the key, null when the key isn't in the map
+	void* (*Find)(Map, const void* key);
+	// Adds the key and value, returns false and does nothing when the key is already in the map
+	bool (*TryAdd)(Map, const void* key, const void* value);
+	// Adds the key and value, overwriting the value when the key is already in the map
+	void (*Set)(Map, const void* key, const void* value);
+	// Removes the key, returns false when the key wasn't in the map
+	bool (*Remove)(Map, const void* key);
+	// Iterates the map, cursor should start at 0, returns false when there are no more entries
+	// removing or adding entries while iterating invalidates the cursor
+	bool (*TryGetNext)(Map, ulong* cursor, void** out_key, void** out_value);
+	// Removes every entry from the map without releasing its memory
+	void (*Clear)(Map);
+	void (*Dispose)(Map);
+	void (*RunUnitTests)(void);
+};
+
+extern const struct _mapMethods Maps;
+
+// TEMPLATE FOR METHODS
+#define _EXPAND_DEFINE_MAP(key, value) _MAP_DEFINE_STRUCT(key, value)\
+DEFINE_TYPE_ID(key##_##value##_map); \
+private ulong _EXPAND_MAP_METHOD_NAME(key, value, DefaultKeyHash)(const void* keyPointer)\
+{\
+	/* strings are compared by their contents, not by their address */\
+	if (IsTypeof(*(key*)keyPointer, string))\
+	{\
+		const string keyString = *(const string*)keyPointer;\
+		return Hashing.HashSafe((const char*)keyString->Values, keyString->Count * keyString->ElementSize);\
+	}\
+	return Hashing.HashSafe(keyPointer, sizeof(key));\
+}\
+private bool _EXPAND_MAP_METHOD_NAME(key, value, DefaultKeyEquals)(const void* left, const void* right)\
+{\
+	if (IsTypeof(*(key*)left, string))\
+	{\
+		const string leftString = *(const string*)left;\
+		const string rightString = *(const string*)right;\
+		return leftString->Count is rightString->Count and\
+			memcmp(leftString->Values, rightString->Values, leftString->Count * leftString->ElementSize) is 0;\
+	}\
+	return memcmp(left, right, sizeof(key)) is 0;\
+}\
+private map(key, value) _EXPAND_MAP_METHOD_NAME(key, value, CreateWith)(ulong count, ulong(*keyHash)(const key* keyPointer), bool(*keyEquals)(const key* leftKey, const key* rightKey))\
+{\
+	REGISTER_TYPE(key##_##value##_map); \
+	return (map(key, value))Maps.Create(count,\
+		sizeof(struct _EXPAND_MAP_ENTRY_NAME(key, value)),\
+		offsetof(struct _EXPAND_MAP_ENTRY_NAME(key, value), Key), sizeof(key),\
+		offsetof(struct _EXPAND_MAP_ENTRY_NAME(key, value), Value), sizeof(value),\
+		key##_##value##_mapTypeId,\
+		(ulong(*)(const void*))keyHash,\
+		(bool(*)(const void*, const void*))keyEquals);\
+}\
+private map(key, value) _EXPAND_MAP_METHOD_NAME(key, value, Create)(ulong count)\
+{\
+	return _EXPAND_MAP_METHOD_NAME(key, value, CreateWith)(count,\
+		(ulong(*)(const key*))_EXPAND_MAP_METHOD_NAME(key, value, DefaultKeyHash),\
+		(bool(*)(const key*, const key*))_EXPAND_MAP_METHOD_NAME(key, value, DefaultKeyEquals));\
+}\
+private void _EXPAND_MAP_METHOD_NAME(key, value, Reserve)(map(key, value) map, ulong count)\
+{\
+	Maps.Reserve((Map)map, count);\
+}\
+private bool _EXPAND_MAP_METHOD_NAME(key, value, TryAdd)(map(key, value) map, key mapKey, value mapValue)\
+{\
+	return Maps.TryAdd((Map)map, &mapKey, &mapValue);\
+}\
+private void _EXPAND_MAP_METHOD_NAME(key, value, Set)(map(key, value) map, key mapKey, value mapValue)\
+{\
+	Maps.Set((Map)map, &mapKey, &mapValue);\
+}\
+private bool _EXPAND_MAP_METHOD_NAME(key, value, TryGet)(map(key, value) map, key mapKey, value* out_value)\
+{\
+	value* result = Maps.Find((Map)map, &mapKey);\
+	if (result is null)\
+	{\
+		return false;\
+	}\
+	*out_value = *result;\
+	return true;\
+}\
+private value _EXPAND_MAP_METHOD_NAME(key, value, Get)(map(key, value) map, key mapKey)\
+{\
+	value* result = Maps.Find((Map)map, &mapKey);\
+	if (result is null)\
+	{\
+		throw(ItemNotFoundInCollectionException);\
+		return (value){ 0 };\
+	}\
+	return *result;\
+}\
+private value* _EXPAND_MAP_METHOD_NAME(key, value, At)(map(key, value) map, key mapKey)\
+{\
+	return Maps.Find((Map)map, &mapKey);\
+}\
+private bool _EXPAND_MAP_METHOD_NAME(key, value, ContainsKey)(map(key, value) map, key mapKey)\
+{\
+	return Maps.Find((Map)map, &mapKey) isnt null;\
+}\
+private bool _EXPAND_MAP_METHOD_NAME(key, value, Remove)(map(key, value) map, key mapKey)\
+{\
+	return Maps.Remove((Map)map, &mapKey);\
+}\
+private bool _EXPAND_MAP_METHOD_NAME(key, value, TryGetNext)(map(key, value) map, ulong* cursor, key** out_key, value** out_value)\
+{\
+	return Maps.TryGetNext((Map)map, cursor, (void**)out_key, (void**)out_value);\
+}\
+private void _EXPAND_MAP_METHOD_NAME(key, value, ForeachWithContext)(map(key, value) map, void* context, void(*method)(void* context, key* entryKey, value* entryValue))\
+{\
+	ulong cursor = 0;\
+	key* entryKey;\
+	value* entryValue;\
+	while (Maps.TryGetNext((Map)map, &cursor, (void**)&entryKey, (void**)&entryValue))\
+	{\
+		method(context, entryKey, entryValue);\
+	}\
+}\
+private void _EXPAND_MAP_METHOD_NAME(key, value, Clear)(map(key, value) map)\
+{\
+	Maps.Clear((Map)map);\
+}\
+private void _EXPAND_MAP_METHOD_NAME(key, value, Dispose)(map(key, value) map)\
+{\
+	Maps.Dispose((Map)map);\
+}\
+const static struct _map_##key##_##value##_methods\
+{\
+	map(key, value) (*Create)(ulong count);\
+	map(key, value) (*CreateWith)(ulong count, ulong(*keyHash)(const key* keyPointer), bool(*keyEquals)(const key* leftKey, const key* rightKey));\
+	void (*Reserve)(map(key, value), ulong count);\
+	bool (*TryAdd)(map(key, value), key, value);\
+	void (*Set)(map(key, value), key, value);\
+	bool (*TryGet)(map(key, value), key, value* out_value);\
+	value (*Get)(map(key, value), key);\
+	value* (*At)(map(key, value), key);\
+	bool (*ContainsKey)(map(key, value), key);\
+	bool (*Remove)(map(key, value), key);\
+	bool (*TryGetNext)(map(key, value), ulong* cursor, key** out_key, value** out_value);\
+	void (*ForeachWithContext)(map(key, value), void* context, void(*method)(void* context, key* entryKey, value* entryValue));\
+	void (*Clear)(map(key, value));\
+	void (*Dispose)(map(key, value));\
+} key##_##value##_map##Maps = \
+{\
+	.Create = _EXPAND_MAP_METHOD_NAME(key, value, Create),\
+	.CreateWith = _EXPAND_MAP_METHOD_NAME(key, value, CreateWith),\
+	.Reserve = _EXPAND_MAP_METHOD_NAME(key, value, Reserve),\
+	.TryAdd = _EXPAND_MAP_METHOD_NAME(key, value, TryAdd),\
+	.Set = _EXPAND_MAP_METHOD_NAME(key, value, Set),\
+	.TryGet = _EXPAND_MAP_METHOD_NAME(key, value, TryGet),\
+	.Get = _EXPAND_MAP_METHOD_NAME(key, value, Get),\
+	.At = _EXPAND_MAP_METHOD_NAME(key, value, At),\
+	.ContainsKey = _EXPAND_MAP_METHOD_NAME(key, value, ContainsKey),\
+	.Remove = _EXPAND_MAP_METHOD_NAME(key, value, Remove),\
+	.TryGetNext = _EXPAND_MAP_METHOD_NAME(key, value, TryGetNext),\
+	.ForeachWithContext = _EXPAND_MAP_METHOD_NAME(key, value, ForeachWithContext),\
+	.Clear = _EXPAND_MAP_METHOD_NAME(key, value, Clear),\
+	.Dispose = _EXPAND_MAP_METHOD_NAME(key, value, Dispose)\
+};
+
+#define _DEFINE_MAP(key, value) _EXPAND_DEFINE_MAP(key, value)
+// Defines map(key, value), both arguments are expanded first so map(string, int) works
+#define DEFINE_MAP(key, value) _DEFINE_MAP(key, value)
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "core/csharp.h"
+#include "core/math/vectors.h"
+#include "core/math/quaternions.h"
+
+// Matrix math for hot loops over many matrices, everything is read and written through pointers rather than passing
+// 64 byte matrices by value. Uses SSE on x64, AVX as well when the compiler targets it, and plain floats everywhere
+// else, every path gives the same matrices as the cglm calls they replace to within a few bits
+struct _matrixKernelMethods {
+	// Writes translation * rotation * scale, the matrix
+	// Matrix4s.Scale(Quaternions.RotateMatrix(rotation, Matrix4s.Translate(Matrix4.Identity, position)), scale) returns
+	void (*Compose)(const vector3* position, const quaternion* rotation, const vector3* scale, matrix4* destination);
+	// Composes the matrix of every slot in slots from the same slot of each array and writes it to that slot of
+	// destinations, slots don't have to be in order
+	void (*ComposeSlots)(const vector3* positions, const quaternion* rotations, const vector3* scales, const ulong* slots, ulong count, matrix4* destinations);
+	// destination = left * right, destination may be left or right
+	void (*Multiply)(const matrix4* left, const matrix4* right, matrix4* destination);
+	// destinations[i] = lefts[i] * rights[i] for count matrices
+	void (*MultiplyArrays)(const matrix4* lefts, const matrix4* rights, matrix4* destinations, ulong count);
+	void (*RunUnitTests)(void);
+	// Measures composing and multiplying a million matrices against the cglm calls
+	void (*RunBenchmarks)(void);
+};
+
+extern const struct _matrixKernelMethods MatrixKernels;
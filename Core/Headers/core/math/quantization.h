@@ -0,0 +1,32 @@
+#pragma once
+
+#include "core/csharp.h"
+#include "core/math/vectors.h"
+
+// the largest angle in radians between a unit vector and its decoded octahedral encoding
+#define MAX_OCTAHEDRAL_ERROR 0.00015f
+
+typedef struct _octahedral octahedral;
+
+// A unit vector projected onto an octahedron that is unfolded onto a square, stored as two normalized 16 bit integers
+struct _octahedral {
+	short x;
+	short y;
+};
+
+// Packs floats into the smaller integer and floating point formats graphics devices can read attributes from, every
+// decoder matches what the device does when it reads the same bits
+struct _quantizationMethods {
+	// Encodes a unit vector as the octahedral value that decodes closest to it
+	octahedral (*EncodeOctahedral)(vector3 normal);
+	vector3 (*DecodeOctahedral)(octahedral encoded);
+	// Converts to the nearest 16 bit float(ties to even), values too large for a half become infinity
+	ushort (*FloatToHalf)(float value);
+	float (*HalfToFloat)(ushort value);
+	// Maps 0.0 to 1.0 onto 0 to 65535, values outside of that are clamped
+	ushort (*EncodeUnorm16)(float value);
+	float (*DecodeUnorm16)(ushort value);
+	void (*RunUnitTests)(void);
+};
+
+extern const struct _quantizationMethods Quantization;
@@ -6,10 +6,19 @@
 
 #include "core/csharp.h"
 
+// Alloc, Free, Calloc and RegisterTypeName are safe to call from any thread, every thread
+// records its own statistics which are merged whenever they are read so counts are never lost
 struct _memoryMethods {
-	ulong FreeCount;
-	ulong AllocCount;
-	ulong AllocSize;
+	// Gets the number of calls to Free() made by every thread
+	ulong(*FreeCount)(void);
+	// Gets the number of calls to Alloc() made by every thread
+	ulong(*AllocCount)(void);
+	// Gets the number of bytes allocated with Alloc() by every thread
+	ulong(*AllocSize)(void);
+	// The number of allocations made from the frame arena since the start of the program
+	ulong ArenaAllocCount;
+	// The number of bytes handed out by the frame arena since the last ArenaReset()
+	ulong ArenaAllocSize;
 	void (*PrintAlloc)(FILE* stream);
 	void (*PrintFree)(FILE* stream);
 	// MemoryID for a generic block of memory with no associated type
@@ -18,17 +27,17 @@ struct _memoryMethods {
 	const ulong String;
 	/// <summary>
 	/// Safely allocates the provided size of memory, otherwise throws OutOfMemoryException and exits program forcibly, 
-	/// use Memory.AllocCount for the number of calls to this method, use AllocSize() for the amount of memory allocated using this method
+	/// use Memory.AllocCount() for the number of calls to this method, use AllocSize() for the amount of memory allocated using this method
 	/// typeID is the id of the registed type name
 	/// </summary>
 	void* (*Alloc)(ulong size, ulong typeID);
-	// Safely frees the provided block of memory, use Memory.FreeCount to get number of times this method was invoked
+	// Safely frees the provided block of memory, use Memory.FreeCount() to get number of times this method was invoked
 	void (*Free)(void* address, ulong typeID);
 	// This function returns a pointer to the allocated memory, or NULL if the request fails.
 	void* (*Calloc)(ulong nitems, ulong size, ulong typeID);
 	/// <summary>
 	/// Safely allocates the provided size of memory with the provided alignment, otherwise throws OutOfMemoryException and exits program forcibly, 
-	/// use Memory.AllocCount for the number of calls to this method, use AllocSize() for the amount of memory allocated using this method
+	/// use Memory.AllocCount() for the number of calls to this method, use AllocSize() for the amount of memory allocated using this method
 	/// </summary>
 	void* (*AllocAligned)(ulong alignment, ulong size, ulong typeID);
 
@@ -46,10 +55,33 @@ struct _memoryMethods {
 	// returns TRUE(1) when realloced, FALSE(0) when the bytes were copied
 	bool (*ReallocOrCopy)(void** address, ulong previousLength, ulong newLength, ulong typeID);
 
+	/// <summary>
+	/// Allocates a zeroed block of memory from the per-frame linear arena, the block stays valid until the next
+	/// call to ArenaReset(), DO NOT call Free() on the returned address.
+	/// Use this for transient, frame-lifetime data; typeID is still tracked per type.
+	/// NOT thread safe, only call this from the main thread
+	/// </summary>
+	void* (*ArenaAlloc)(ulong size, ulong typeID);
+	// Releases every block handed out by ArenaAlloc since the last reset, the engine calls this once per frame
+	void (*ArenaReset)(void);
+
+	/// <summary>
+	/// Allocates a zeroed fixed-size block from the slab pool owned by the registered typeID,
+	/// every call for the same typeID must request the same size otherwise throws TypeMismatchException.
+	/// Blocks are handed out from contiguous free-listed slabs, use this for hot structs that are created and
+	/// destroyed often; typeID must have been registered with REGISTER_TYPE or RegisterTypeName.
+	/// NOT thread safe, only call this from the main thread
+	/// </summary>
+	void* (*PoolAlloc)(ulong size, ulong typeID);
+	// Returns a block allocated with PoolAlloc to the pool of the provided typeID, use Memory.FreeCount() to get number of times this method was invoked
+	void (*PoolFree)(void* address, ulong typeID);
+
 	// registers the provided typename and returns the id that should be passed into the Alloc() method
 	void(*RegisterTypeName)(const char* name, ulong* out_typeId);
 	// performs memcmp while also performing a hash at the same time
 	int (*CompareMemoryAndHash)(const char* left, ulong leftSize, const char* right, ulong rightSize, ulong* out_leftHash, ulong* out_rightHash);
+
+	void (*RunUnitTests)(void);
 };
 
 extern struct _memoryMethods Memory;
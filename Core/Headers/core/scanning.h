@@ -0,0 +1,21 @@
+#pragma once
+
+#include "core/csharp.h"
+
+// Locale independent number parsing that never allocates and works on spans of characters that don't have to be
+// terminated, every method skips leading whitespace and on success moves the cursor past the characters it read,
+// on failure the cursor is not moved
+struct _scanningMethods {
+	// Reads [-+]digits[.digits][(e|E)[-+]digits], inf, infinity or nan, the result is always the float nearest to the
+	// decimal value(ties to even) exactly like a correctly rounded strtof in the "C" locale
+	bool (*TryScanFloat)(const char** cursor, const char* end, float* out_value);
+	// Reads [-+]digits, returns false when the value does not fit in a long long
+	bool (*TryScanInteger)(const char** cursor, const char* end, long long* out_value);
+	// Reads [0x]hexdigits, returns false when the value does not fit in a ulong
+	bool (*TryScanHex)(const char** cursor, const char* end, ulong* out_value);
+	void (*RunUnitTests)(void);
+	// Measures the throughput of the scanner against sscanf and strtof
+	void (*RunBenchmarks)(void);
+};
+
+extern const struct _scanningMethods Scanning;
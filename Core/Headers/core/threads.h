@@ -0,0 +1,52 @@
+#pragma once
+
+#include "core/csharp.h"
+
+// marks a static variable as having a separate instance for every thread
+#ifdef _WIN32
+#define ThreadStatic __declspec(thread)
+#else
+#define ThreadStatic _Thread_local
+#endif
+
+typedef struct _thread* Thread;
+
+struct _thread {
+	// The operating system handle for this thread
+	void* Handle;
+	// The method this thread invokes
+	void (*Method)(void* state);
+	// The state provided to Method
+	void* State;
+};
+
+struct _threadMethods {
+	// Starts a new thread that invokes the provided method with the provided state
+	Thread(*Start)(void(*method)(void* state), void* state);
+	// Blocks the calling thread until the provided thread has finished, then disposes of the thread
+	void (*Join)(Thread);
+	// Gets the number of logical processors available to this process
+	ulong(*ProcessorCount)(void);
+	// Invokes method once for every index in [0, count) across up to ProcessorCount threads, the calling thread
+	// does work as well, returns once every index has been processed, indices are processed in no particular order.
+	// Safe to call from any thread and from inside method, calls that overlap share the same worker threads and
+	// the calling thread sleeps while the last of its indices finish on other threads
+	void (*ParallelFor)(ulong count, void* state, void(*method)(void* state, ulong index));
+};
+
+extern const struct _threadMethods Threads;
+
+typedef struct _semaphore* Semaphore;
+
+// Counting semaphores used to put threads to sleep until work is available
+struct _semaphoreMethods {
+	// Creates a new semaphore that starts with the provided count
+	Semaphore(*Create)(ulong initialCount);
+	// Increments the count, waking one of the threads blocked in Wait if there are any
+	void (*Release)(Semaphore);
+	// Blocks the calling thread until the count is above zero, then decrements it
+	void (*Wait)(Semaphore);
+	void (*Dispose)(Semaphore);
+};
+
+extern const struct _semaphoreMethods Semaphores;
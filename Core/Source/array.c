@@ -5,6 +5,7 @@
 #include "core/cunit.h"
 
 private Array Create(ulong elementSize, ulong count, ulong typeId);
+private Array CreateInline(ulong elementSize, ulong inlineCount, ulong typeId);
 private ulong GetNextAvailableIndex(Array);
 private void AutoResize(Array);
 private void Resize(Array, ulong newCount);
@@ -13,34 +14,69 @@ private void Append(Array, void*);
 private void RemoveIndex(Array, ulong index);
 private void InsertionSort(Array, bool(comparator)(void* leftMemoryBlock, void* rightMemoryBlock));
 private void Swap(Array, ulong firstIndex, ulong secondIndex);
+private void Sort(Array, bool(comparator)(void* leftMemoryBlock, void* rightMemoryBlock));
+private void StableSort(Array, bool(comparator)(void* leftMemoryBlock, void* rightMemoryBlock));
+private void RadixSort(Array, ulong(*keySelector)(void* item));
 private Array AppendArray(Array array, Array appendedValue);
+private Array AppendCArray(Array array, const void* values, ulong count);
+private void Reserve(Array array, ulong count);
 private void* At(Array array, ulong index);
 private void Clear(Array array);
 private void Foreach(Array array, void(*method)(void* item));
 private void ForeachWithContext(Array array, void* context, void(*method)(void* context, void* item));
 private Array InsertArray(Array dest, Array src, ulong index);
 private bool Equals(Array left, Array right);
+private void RunBenchmarks(void);
 
 const struct _arrayMethods Arrays = {
 	.Create = Create,
+	.CreateInline = CreateInline,
 	.AutoResize = AutoResize,
 	.Resize = Resize,
 	.Append = Append,
 	.InsertionSort = InsertionSort,
+	.Sort = Sort,
+	.StableSort = StableSort,
+	.RadixSort = RadixSort,
 	.RemoveIndex = RemoveIndex,
 	.Swap = Swap,
 	.Dispose = Dispose,
 	.AppendArray = AppendArray,
+	.AppendCArray = AppendCArray,
+	.Reserve = Reserve,
 	.InsertArray = InsertArray,
 	.At = At,
 	.Clear = Clear,
 	.Foreach = Foreach,
 	.ForeachWithContext = ForeachWithContext,
-	.Equals = Equals
+	.Equals = Equals,
+	.RunBenchmarks = RunBenchmarks
 };
 
+// inline values start on a 16 byte boundary after the header so any element type stays aligned
+#define INLINE_VALUES_OFFSET ((sizeof(struct _array_void) + 15) & ~(ulong)15)
+
+private void InitializeArray(Array array, ulong elementSize, ulong count, ulong typeId)
+{
+	array->Count = 0;
+	array->ElementSize = elementSize;
+	array->TypeId = typeId;
+	array->Size = (elementSize * count) + 1;
+	array->Capacity = count;
+	array->Dirty = true;
+	array->AutoHash = true;
+	array->StackObject = false;
+	array->Hash = 0;
+}
+
 private Array Create(ulong elementSize, ulong count, ulong typeId)
 {
+	// small arrays are the common case, keep them to a single allocation
+	if ((elementSize * count) + 1 <= ARRAY_INLINE_SIZE)
+	{
+		return CreateInline(elementSize, count, typeId);
+	}
+
 	REGISTER_TYPE(Array);
 
 	array(void) array = Memory.Alloc(sizeof(struct _array_void), ArrayTypeId);
@@ -50,19 +86,47 @@ private Array Create(ulong elementSize, ulong count, ulong typeId)
 	// always terminated, regardless if their strings or not
 	array->Values = Memory.Alloc((elementSize * count) + 1, typeId);
 
-	array->Count = 0;
-	array->ElementSize = elementSize;
-	array->TypeId = typeId;
-	array->Size = (elementSize * count) + 1;
-	array->Capacity = count;
-	array->Dirty = true;
-	array->AutoHash = true;
-	array->StackObject = false;
-	array->Hash = 0;
+	InitializeArray(array, elementSize, count, typeId);
+
+	array->InlineValues = false;
+
+	return array;
+}
+
+private Array CreateInline(ulong elementSize, ulong inlineCount, ulong typeId)
+{
+	REGISTER_TYPE(Array);
+
+	// alloc one more byte so its terminated, the header and values share one zeroed block
+	array(void) array = Memory.Alloc(INLINE_VALUES_OFFSET + (elementSize * inlineCount) + 1, ArrayTypeId);
+
+	array->Values = (char*)array + INLINE_VALUES_OFFSET;
+
+	InitializeArray(array, elementSize, inlineCount, typeId);
+
+	array->InlineValues = true;
 
 	return array;
 }
 
+// Moves the values into a block of newSize bytes, inline values can't be
+// realloc'd since they share a block with the header so they're copied to the heap instead
+private void ReallocValues(Array array, ulong newSize)
+{
+	if (array->InlineValues is false)
+	{
+		Memory.ReallocOrCopy(&array->Values, array->Size, newSize, array->TypeId);
+		return;
+	}
+
+	void* values = Memory.Alloc(newSize, array->TypeId);
+
+	memcpy(values, array->Values, min(array->Size, newSize));
+
+	array->Values = values;
+	array->InlineValues = false;
+}
+
 private ulong HashArray(Array array)
 {
 	array->Hash = Hashing.HashSafe(array->Values, array->Count * array->ElementSize);
@@ -80,18 +144,9 @@ private void Append(Array array, void* value)
 
 		array->Count = safe_add(array->Count, 1);
 
-		if (array->AutoHash)
-		{
-			// we only have to hash the new value
-			if (array->Dirty is false and array->AutoHash)
-			{
-				array->Hash = Hashing.ChainHashSafe(value, array->ElementSize, array->Hash);
-			}
-			else
-			{
-				HashArray(array);
-			}
-		}
+		// hashing is deferred until Hash() or Equals() so bulk appends stay O(1)
+		// even after the array was mutated with Swap, RemoveIndex etc..
+		array->Dirty = true;
 	}
 	else
 	{
@@ -124,7 +179,7 @@ private void AutoResize(Array array)
 	else
 	{
 		// alloc one more byte so its terminated
-		Memory.ReallocOrCopy(&array->Values, array->Size, newSize + 1, array->TypeId);
+		ReallocValues(array, newSize + 1);
 	}
 
 	array->Capacity = newSize / array->ElementSize;
@@ -142,8 +197,12 @@ private void Resize(Array array, ulong newCount)
 
 	if (newCount is 0)
 	{
-		Memory.Free(array->Values, array->TypeId);
+		if (array->InlineValues is false)
+		{
+			Memory.Free(array->Values, array->TypeId);
+		}
 		array->Values = null;
+		array->InlineValues = false;
 		array->Size = 0;
 		array->Count = 0;
 		return;
@@ -151,7 +210,7 @@ private void Resize(Array array, ulong newCount)
 
 	ulong newSize = array->ElementSize * newCount;
 
-	Memory.ReallocOrCopy(&array->Values, array->Size, newSize + 1, array->TypeId);
+	ReallocValues(array, newSize + 1);
 
 	array->Size = newSize + 1;
 	array->Count = newCount;
@@ -174,55 +233,417 @@ private void RemoveIndex(Array array, ulong index)
 	array->Hash = 0;
 }
 
-private void Swap(Array array, ulong firstIndex, ulong secondIndex)
+// the largest element the sorts will keep on the stack as scratch space
+#define SORT_STACK_ELEMENT_SIZE 128
+// ranges at or below this size are insertion sorted
+#define SORT_INSERTION_THRESHOLD 16
+
+private void SwapElements(char* left, char* right, ulong size)
 {
-	char* firstSourcePointer = At(array, firstIndex);
-	char* secondSourcePointer = At(array, secondIndex);
+	char temp[SORT_STACK_ELEMENT_SIZE];
 
-	for (ulong i = 0; i < array->ElementSize / sizeof(char); i++)
+	while (size > 0)
 	{
-		ulong offset = (sizeof(char) * i);
+		const ulong chunk = min(size, sizeof(temp));
 
-		char* firstPointer = firstSourcePointer + offset;
-		char* secondPointer = secondSourcePointer + offset;
+		memcpy(temp, left, chunk);
+		memcpy(left, right, chunk);
+		memcpy(right, temp, chunk);
 
-		char tmp = *firstPointer;
-		*firstPointer = *secondPointer;
-		*secondPointer = tmp;
+		left += chunk;
+		right += chunk;
+		size -= chunk;
 	}
+}
+
+private void CopyElement(char* destination, const char* source, ulong size)
+{
+	// most sorted arrays are of primitives or pointers, a memcpy of a constant size compiles to a single move while
+	// one of a variable size stays a call. Elements are only char aligned so they can't be dereferenced as wider types
+	switch (size)
+	{
+	case sizeof(unsigned int):
+		memcpy(destination, source, sizeof(unsigned int));
+		break;
+	case sizeof(ulong):
+		memcpy(destination, source, sizeof(ulong));
+		break;
+	default:
+		memcpy(destination, source, size);
+		break;
+	}
+}
+
+private void Swap(Array array, ulong firstIndex, ulong secondIndex)
+{
+	SwapElements(At(array, firstIndex), At(array, secondIndex), array->ElementSize);
 
 	array->Dirty = true;
 	array->Hash = 0;
 }
 
+// comparators return true when the left element belongs after the right element
+typedef bool(*SortComparator)(void* leftMemoryBlock, void* rightMemoryBlock);
+
+// scratch space for a single element, on the stack unless the element is too large. This doesn't come from
+// Memory.ArenaAlloc, arrays can be sorted from any thread and by tools like the generics expander that never reset the
+// arena, the arena is main thread only and would grow with every sort there
+private char* RentElement(ulong size, char* stackBuffer)
+{
+	return size <= SORT_STACK_ELEMENT_SIZE ? stackBuffer : Memory.Alloc(size, Memory.GenericMemoryBlock);
+}
+
+private void ReturnElement(char* element, ulong size)
+{
+	if (size > SORT_STACK_ELEMENT_SIZE)
+	{
+		Memory.Free(element, Memory.GenericMemoryBlock);
+	}
+}
+
+// stable, shifts the larger elements to the right instead of swapping them one at a time
+private void InsertionSortRange(char* values, ulong count, ulong size, SortComparator comparator, char* temp)
+{
+	for (ulong rightIndex = 1; rightIndex < count; rightIndex++)
+	{
+		char* item = values + (rightIndex * size);
+
+		if (comparator(item - size, item) is false)
+		{
+			continue;
+		}
+
+		CopyElement(temp, item, size);
+
+		ulong index = rightIndex;
+		while (index > 0 and comparator(values + ((index - 1) * size), temp))
+		{
+			--index;
+		}
+
+		memmove(values + ((index + 1) * size), values + (index * size), (rightIndex - index) * size);
+
+		CopyElement(values + (index * size), temp, size);
+	}
+}
+
+private void SiftDown(char* values, ulong root, ulong count, ulong size, SortComparator comparator)
+{
+	while (true)
+	{
+		ulong child = (root * 2) + 1;
+
+		if (child >= count)
+		{
+			return;
+		}
+
+		// pick the child that belongs furthest right
+		if (child + 1 < count and comparator(values + ((child + 1) * size), values + (child * size)))
+		{
+			++child;
+		}
+
+		if (comparator(values + (child * size), values + (root * size)) is false)
+		{
+			return;
+		}
+
+		SwapElements(values + (root * size), values + (child * size), size);
+
+		root = child;
+	}
+}
+
+private void HeapSortRange(char* values, ulong count, ulong size, SortComparator comparator)
+{
+	for (ulong i = count / 2; i-- > 0;)
+	{
+		SiftDown(values, i, count, size, comparator);
+	}
+
+	for (ulong end = count - 1; end > 0; end--)
+	{
+		SwapElements(values, values + (end * size), size);
+		SiftDown(values, 0, end, size, comparator);
+	}
+}
+
+private void IntroSortRange(char* values, ulong count, ulong size, SortComparator comparator, char* pivot, ulong depth)
+{
+	while (count > SORT_INSERTION_THRESHOLD)
+	{
+		// quicksort degraded on this input, heapsort keeps the worst case O(n log n)
+		if (depth is 0)
+		{
+			HeapSortRange(values, count, size, comparator);
+			return;
+		}
+
+		--depth;
+
+		// order the first, middle and last elements so they act as sentinels for the partition
+		char* first = values;
+		char* middle = values + ((count / 2) * size);
+		char* last = values + ((count - 1) * size);
+
+		if (comparator(first, middle)) SwapElements(first, middle, size);
+		if (comparator(middle, last)) SwapElements(middle, last, size);
+		if (comparator(first, middle)) SwapElements(first, middle, size);
+
+		CopyElement(pivot, middle, size);
+
+		ulong left = 0;
+		ulong right = count - 1;
+
+		while (true)
+		{
+			do { ++left; } while (comparator(pivot, values + (left * size)));
+			do { --right; } while (comparator(values + (right * size), pivot));
+
+			if (left >= right)
+			{
+				break;
+			}
+
+			SwapElements(values + (left * size), values + (right * size), size);
+		}
+
+		// recurse into the smaller half so the stack depth stays O(log n)
+		const ulong leftCount = left;
+		const ulong rightCount = count - left;
+
+		if (leftCount < rightCount)
+		{
+			IntroSortRange(values, leftCount, size, comparator, pivot, depth);
+
+			values += leftCount * size;
+			count = rightCount;
+		}
+		else
+		{
+			IntroSortRange(values + (leftCount * size), rightCount, size, comparator, pivot, depth);
+
+			count = leftCount;
+		}
+	}
+
+	InsertionSortRange(values, count, size, comparator, pivot);
+}
+
 private void InsertionSort(Array array, bool(comparator)(void* leftMemoryBlock, void* rightMemoryBlock))
 {
-	// chat gpt generated insertion sort cuz im lazy
-	// and i got punished for it because this creates a buffer
-	// overrun somwhere that i now have to debug
-	char* tempPointer = Memory.Alloc(array->ElementSize, Memory.GenericMemoryBlock);
+	char stackBuffer[SORT_STACK_ELEMENT_SIZE];
+	char* temp = RentElement(array->ElementSize, stackBuffer);
+
+	InsertionSortRange(array->Values, array->Count, array->ElementSize, comparator, temp);
+
+	ReturnElement(temp, array->ElementSize);
+
+	array->Dirty = true;
+	array->Hash = 0;
+}
+
+private void Sort(Array array, bool(comparator)(void* leftMemoryBlock, void* rightMemoryBlock))
+{
+	if (array->Count < 2)
+	{
+		return;
+	}
+
+	char stackBuffer[SORT_STACK_ELEMENT_SIZE];
+	char* pivot = RentElement(array->ElementSize, stackBuffer);
+
+	// 2 * log2(n) partitions before falling back to heapsort
+	ulong depth = 0;
+	for (ulong count = array->Count; count > 1; count >>= 1)
+	{
+		depth += 2;
+	}
+
+	IntroSortRange(array->Values, array->Count, array->ElementSize, comparator, pivot, depth);
+
+	ReturnElement(pivot, array->ElementSize);
+
+	array->Dirty = true;
+	array->Hash = 0;
+}
+
+private void Merge(const char* source, ulong start, ulong middle, ulong end, char* destination, ulong size, SortComparator comparator)
+{
+	ulong left = start;
+	ulong right = middle;
+	ulong index = start;
+
+	// the runs are already in order relative to each other
+	if (middle is end or comparator(source + ((middle - 1) * size), source + (middle * size)) is false)
+	{
+		memcpy(destination + (start * size), source + (start * size), (end - start) * size);
+		return;
+	}
+
+	while (left < middle and right < end)
+	{
+		// only take from the right run when it's strictly smaller so equal elements keep their order
+		if (comparator(source + (left * size), source + (right * size)))
+		{
+			CopyElement(destination + (index * size), source + (right * size), size);
+			++right;
+		}
+		else
+		{
+			CopyElement(destination + (index * size), source + (left * size), size);
+			++left;
+		}
+
+		++index;
+	}
+
+	memcpy(destination + (index * size), source + (left * size), (middle - left) * size);
+	index += middle - left;
+
+	memcpy(destination + (index * size), source + (right * size), (end - right) * size);
+}
+
+private void StableSort(Array array, bool(comparator)(void* leftMemoryBlock, void* rightMemoryBlock))
+{
+	const ulong count = array->Count;
+	const ulong size = array->ElementSize;
+
+	if (count < 2)
+	{
+		return;
+	}
+
+	char stackBuffer[SORT_STACK_ELEMENT_SIZE];
+	char* temp = RentElement(size, stackBuffer);
+
+	// bottom up merge sort, start with insertion sorted runs
+	for (ulong start = 0; start < count; start += SORT_INSERTION_THRESHOLD)
+	{
+		InsertionSortRange((char*)array->Values + (start * size), min(SORT_INSERTION_THRESHOLD, count - start), size, comparator, temp);
+	}
+
+	ReturnElement(temp, size);
+
+	if (count > SORT_INSERTION_THRESHOLD)
+	{
+		char* scratch = Memory.Alloc(count * size, Memory.GenericMemoryBlock);
+
+		char* source = array->Values;
+		char* destination = scratch;
+
+		for (ulong width = SORT_INSERTION_THRESHOLD; width < count; width <<= 1)
+		{
+			for (ulong start = 0; start < count; start += width << 1)
+			{
+				const ulong middle = min(start + width, count);
+				const ulong end = min(start + (width << 1), count);
+
+				Merge(source, start, middle, end, destination, size, comparator);
+			}
+
+			char* swap = source;
+			source = destination;
+			destination = swap;
+		}
+
+		if (source isnt array->Values)
+		{
+			memcpy(array->Values, source, count * size);
+		}
+
+		Memory.Free(scratch, Memory.GenericMemoryBlock);
+	}
+
+	array->Dirty = true;
+	array->Hash = 0;
+}
+
+// the number of bits sorted by each pass of the radix sort
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES (64 / RADIX_BITS)
+
+private void RadixSort(Array array, ulong(*keySelector)(void* item))
+{
+	const ulong count = array->Count;
+	const ulong size = array->ElementSize;
+
+	if (count < 2)
+	{
+		return;
+	}
+
+	ulong* keys = Memory.Alloc(count * sizeof(ulong), Memory.GenericMemoryBlock);
+	ulong* scratchKeys = Memory.Alloc(count * sizeof(ulong), Memory.GenericMemoryBlock);
+	char* scratchValues = Memory.Alloc(count * size, Memory.GenericMemoryBlock);
+
+	// histogram every digit in a single pass over the keys
+	ulong* histograms = Memory.Alloc(RADIX_PASSES * RADIX_BUCKETS * sizeof(ulong), Memory.GenericMemoryBlock);
 
-	int leftIndex = 0;
+	for (ulong i = 0; i < count; i++)
+	{
+		const ulong key = keySelector(At(array, i));
 
-	for (int rightIndex = 1; rightIndex < array->Count; rightIndex++) {
-		memcpy(tempPointer, At(array, rightIndex), array->ElementSize);
+		keys[i] = key;
 
-		leftIndex = rightIndex - 1;
+		for (ulong pass = 0; pass < RADIX_PASSES; pass++)
+		{
+			++(histograms[(pass * RADIX_BUCKETS) + ((key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1))]);
+		}
+	}
+
+	char* values = array->Values;
+
+	for (ulong pass = 0; pass < RADIX_PASSES; pass++)
+	{
+		ulong* offsets = histograms + (pass * RADIX_BUCKETS);
 
-		char* leftPointer = At(array, leftIndex);
+		// when every key shares this digit the pass wouldn't move anything, small keys skip most passes
+		if (offsets[(keys[0] >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)] is count)
+		{
+			continue;
+		}
 
-		while (leftIndex >= 0 && comparator(leftPointer, tempPointer)) {
-			Swap(array, leftIndex + 1, leftIndex);
+		ulong total = 0;
+		for (ulong bucket = 0; bucket < RADIX_BUCKETS; bucket++)
+		{
+			const ulong bucketCount = offsets[bucket];
+			offsets[bucket] = total;
+			total += bucketCount;
+		}
 
-			leftIndex = leftIndex - 1;
+		for (ulong i = 0; i < count; i++)
+		{
+			const ulong key = keys[i];
+			const ulong destination = offsets[(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
 
-			leftPointer = At(array, leftIndex);
+			scratchKeys[destination] = key;
+			CopyElement(scratchValues + (destination * size), values + (i * size), size);
 		}
 
-		memcpy(At(array, leftIndex + 1), tempPointer, array->ElementSize);
+		ulong* swapKeys = keys;
+		keys = scratchKeys;
+		scratchKeys = swapKeys;
+
+		char* swapValues = values;
+		values = scratchValues;
+		scratchValues = swapValues;
+	}
+
+	// an odd number of passes leaves the sorted values in the scratch buffer
+	if (values isnt array->Values)
+	{
+		memcpy(array->Values, values, count * size);
+
+		scratchValues = values;
 	}
 
-	Memory.Free(tempPointer, Memory.GenericMemoryBlock);
+	Memory.Free(histograms, Memory.GenericMemoryBlock);
+	Memory.Free(scratchValues, Memory.GenericMemoryBlock);
+	Memory.Free(scratchKeys, Memory.GenericMemoryBlock);
+	Memory.Free(keys, Memory.GenericMemoryBlock);
 
 	array->Dirty = true;
 	array->Hash = 0;
@@ -234,14 +655,70 @@ private void* At(Array array, ulong index)
 	return (char*)array->Values + (index * array->ElementSize);
 }
 
+private void Reserve(Array array, ulong count)
+{
+	if (count <= array->Capacity)
+	{
+		return;
+	}
+
+	// if a user allocs a array on the stack they can't modify past the given
+	// memory block without overwriting stack stuff
+	if (array->StackObject)
+	{
+		throw(StackObjectModifiedException);
+	}
+
+	const ulong newSize = array->ElementSize * count;
+
+	// alloc one more byte so its terminated
+	ReallocValues(array, newSize + 1);
+
+	array->Capacity = count;
+	array->Size = newSize + 1;
+}
+
+private Array AppendCArray(Array array, const void* values, ulong count)
+{
+	if (count is 0)
+	{
+		return array;
+	}
+
+	const ulong requiredCount = safe_add(array->Count, count);
+
+	if (requiredCount > array->Capacity)
+	{
+		// the values may live inside of this array, find them again after we move
+		const char* start = array->Values;
+		const bool overlaps = (const char*)values >= start and (const char*)values < start + array->Size;
+		const ulong offset = (const char*)values - start;
+
+		// grow geometrically so repeated bulk appends stay amortized O(1)
+		Reserve(array, max(requiredCount, array->Capacity << 1));
+
+		if (overlaps)
+		{
+			values = (const char*)array->Values + offset;
+		}
+	}
+
+	memcpy(At(array, array->Count), values, count * array->ElementSize);
+
+	array->Count = requiredCount;
+	array->Dirty = true;
+
+	return array;
+}
+
 private Array AppendArray(Array destinationArray, Array values)
 {
-	for (ulong i = 0; i < values->Count; i++)
+	if (destinationArray->ElementSize isnt values->ElementSize)
 	{
-		Arrays.Append(destinationArray, At(values, i));
+		throw(TypeMismatchException);
 	}
 
-	return destinationArray;
+	return AppendCArray(destinationArray, values->Values, values->Count);
 }
 
 private Array InsertArray(Array destination, Array source, ulong index)
@@ -277,7 +754,7 @@ private void Clear(Array array)
 		memset(array->Values, 0, array->Size);
 	}
 	array->Count = 0;
-	array->Dirty = false;
+	array->Dirty = true;
 	array->Hash = 0;
 }
 
@@ -311,7 +788,11 @@ private void Dispose(Array array)
 		throw(StackObjectModifiedException);
 	}
 
-	Memory.Free(array->Values, array->TypeId);
+	if (array->InlineValues is false)
+	{
+		Memory.Free(array->Values, array->TypeId);
+	}
+
 	Memory.Free(array, ArrayTypeId);
 }
 
@@ -509,7 +990,274 @@ TEST(Hashing)
 	return true;
 }
 
+TEST(LazyHashing)
+{
+	array(int) numbers = dynamic_array(int, 4);
+
+	arrays(int).Append(numbers, 1);
+	arrays(int).Append(numbers, 2);
+
+	// appending should never hash
+	IsTrue(numbers->Dirty);
+
+	const ulong firstHash = arrays(int).Hash(numbers);
+
+	IsFalse(numbers->Dirty);
+
+	arrays(int).Swap(numbers, 0, 1);
+	arrays(int).Append(numbers, 3);
+
+	IsTrue(numbers->Dirty);
+
+	array(int) expected = auto_stack_array(int, 2, 1, 3);
+
+	IsEqual(arrays(int).Hash(expected), arrays(int).Hash(numbers));
+	IsTrue(firstHash isnt numbers->Hash);
+
+	// a cleared array must not keep a stale hash
+	arrays(int).Clear(numbers);
+
+	IsTrue(arrays(int).Equals(numbers, empty_stack_array(int, 1)));
+
+	arrays(int).Dispose(numbers);
+
+	return true;
+}
+
+// the previous Append behaviour, rehashes the entire array when it was mutated
+// since the last append, otherwise chains the hash of the new value
+private void EagerHashAppend(Array array, void* value)
+{
+	const bool wasDirty = array->Dirty;
+	const ulong previousHash = array->Hash;
+
+	Append(array, value);
+
+	if (wasDirty)
+	{
+		HashArray(array);
+	}
+	else
+	{
+		array->Hash = Hashing.ChainHashSafe(value, array->ElementSize, previousHash);
+		array->Dirty = false;
+	}
+}
+
+TEST(AppendBenchmark)
+{
+	const int count = 1000000;
+	// how many appends happen between every swap
+	const int swapInterval = 1024;
+
+	array(int) eager = dynamic_array(int, 1);
+	array(int) lazy = dynamic_array(int, 1);
+
+	fprintf(__test_stream, "\t1M appends with swaps, eager hashing: ");
+	Benchmark(
+		for (int i = 0; i < count; i++)
+		{
+			EagerHashAppend((Array)eager, &i);
+
+			if ((i % swapInterval) is 0)
+			{
+				arrays(int).Swap(eager, 0, eager->Count - 1);
+			}
+		}
+	arrays(int).Hash(eager);
+	, __test_stream);
+
+	fprintf(__test_stream, NEWLINE"\t1M appends with swaps, lazy hashing: ");
+	Benchmark(
+		for (int i = 0; i < count; i++)
+		{
+			arrays(int).Append(lazy, i);
+
+			if ((i % swapInterval) is 0)
+			{
+				arrays(int).Swap(lazy, 0, lazy->Count - 1);
+			}
+		}
+	arrays(int).Hash(lazy);
+	, __test_stream);
+	fprintf(__test_stream, NEWLINE);
+
+	IsEqual(eager->Hash, lazy->Hash);
+	IsTrue(arrays(int).Equals(eager, lazy));
+
+	arrays(int).Dispose(eager);
+	arrays(int).Dispose(lazy);
+
+	return true;
+}
+
+TEST(BulkAppend)
+{
+	array(int) numbers = dynamic_array(int, 1);
+
+	const int values[] = { 1, 2, 3, 4, 5 };
+
+	arrays(int).AppendCArray(numbers, values, 5);
+
+	IsEqual((ulong)5, numbers->Count);
+	IsTrue(arrays(int).Equals(numbers, auto_stack_array(int, 1, 2, 3, 4, 5)));
+
+	// appending an array to itself must survive the resize
+	arrays(int).AppendArray(numbers, numbers);
+
+	IsTrue(arrays(int).Equals(numbers, auto_stack_array(int, 1, 2, 3, 4, 5, 1, 2, 3, 4, 5)));
+
+	array(int) clone = arrays(int).Clone(numbers);
+
+	IsTrue(arrays(int).Equals(numbers, clone));
+
+	// reserving should never shrink or move the count
+	arrays(int).Reserve(clone, 1);
+	IsEqual((ulong)10, clone->Count);
+
+	arrays(int).Reserve(clone, 100);
+	IsEqual((ulong)100, clone->Capacity);
+	IsTrue(arrays(int).Equals(numbers, clone));
+
+	arrays(int).Dispose(numbers);
+	arrays(int).Dispose(clone);
+
+	return true;
+}
+
+TEST(InlineStorage)
+{
+	const ulong previousAllocCount = Memory.AllocCount();
+
+	array(int) numbers = inline_array(int, 4);
+
+	// the header and values should be a single allocation
+	IsEqual((ulong)1, Memory.AllocCount() - previousAllocCount);
+	IsTrue(numbers->InlineValues);
+	IsEqual((ulong)4, numbers->Capacity);
+
+	for (int i = 0; i < 4; i++)
+	{
+		arrays(int).Append(numbers, i);
+	}
+
+	IsTrue(numbers->InlineValues);
+	IsEqual(2, at(numbers, 2));
+
+	partial_array(int) tail = *stack_subarray_back(int, numbers, 2);
+	IsEqual((ulong)2, tail.Count);
+	IsEqual(3, tail.Values[1]);
+
+	// growing past the inline capacity moves the values to the heap
+	arrays(int).Append(numbers, 4);
+
+	IsFalse(numbers->InlineValues);
+	IsEqual((ulong)5, numbers->Count);
+	IsTrue(arrays(int).Equals(numbers, auto_stack_array(int, 0, 1, 2, 3, 4)));
+
+	arrays(int).Dispose(numbers);
+
+	// small arrays created normally should also be inline
+	array(int) small = dynamic_array(int, 2);
+	IsTrue(small->InlineValues);
+
+	arrays(int).Reserve(small, 3);
+	IsFalse(small->InlineValues);
+
+	arrays(int).Dispose(small);
+
+	array(int) large = dynamic_array(int, ARRAY_INLINE_SIZE);
+	IsFalse(large->InlineValues);
+
+	arrays(int).Dispose(large);
+
+	return true;
+}
+
+TEST(BulkAppendBenchmark)
+{
+	const int count = 1000000;
+
+	array(int) source = dynamic_array(int, count);
+
+	for (int i = 0; i < count; i++)
+	{
+		arrays(int).Append(source, i);
+	}
+
+	array(int) elementWise = dynamic_array(int, 1);
+	array(int) bulk = dynamic_array(int, 1);
+
+	fprintf(__test_stream, "\t1M element-wise appends: ");
+	Benchmark(
+		for (int i = 0; i < count; i++)
+		{
+			arrays(int).Append(elementWise, at(source, i));
+		}
+	, __test_stream);
+
+	fprintf(__test_stream, NEWLINE"\t1M bulk append: ");
+	Benchmark(arrays(int).AppendArray(bulk, source), __test_stream);
+	fprintf(__test_stream, NEWLINE);
+
+	IsTrue(arrays(int).Equals(elementWise, bulk));
+
+	arrays(int).Dispose(source);
+	arrays(int).Dispose(elementWise);
+	arrays(int).Dispose(bulk);
+
+	return true;
+}
+
 DEFINE_COMPARATOR(byte, GreaterThan, > );
+DEFINE_COMPARATOR(int, IntGreaterThan, > );
+DEFINE_COMPARATOR(float, FloatGreaterThan, > );
+
+private bool FirstGreaterThan(tuple(int, int)* left, tuple(int, int)* right)
+{
+	return left->First > right->First;
+}
+
+private ulong IntKey(int* value)
+{
+	return RadixKeyFromInt(*value);
+}
+
+private ulong FloatKey(float* value)
+{
+	return RadixKeyFromFloat(*value);
+}
+
+// deterministic test data so failures are reproducible
+private unsigned int NextTestValue(ulong* state)
+{
+	*state = (*state * 6364136223846793005ull) + 1442695040888963407ull;
+	return (unsigned int)(*state >> 33);
+}
+
+private array(int) CreateRandomInts(ulong count, ulong seed)
+{
+	array(int) result = dynamic_array(int, count);
+
+	for (ulong i = 0; i < count; i++)
+	{
+		arrays(int).Append(result, (int)NextTestValue(&seed));
+	}
+
+	return result;
+}
+
+private bool IsSortedInts(array(int) values)
+{
+	for (ulong i = 1; i < values->Count; i++)
+	{
+		if (at(values, i - 1) > at(values, i))
+		{
+			return false;
+		}
+	}
+	return true;
+}
 
 TEST(Sorting)
 {
@@ -521,13 +1269,151 @@ TEST(Sorting)
 
 	IsEqual(expected, data);
 
+	// every sort should agree on random data, including negatives and duplicates
+	array(int) introsorted = CreateRandomInts(5000, 1);
+	arrays(int).Append(introsorted, -5);
+	arrays(int).Append(introsorted, -5);
+	arrays(int).Append(introsorted, 0);
+
+	array(int) mergeSorted = arrays(int).Clone(introsorted);
+	array(int) radixSorted = arrays(int).Clone(introsorted);
+
+	arrays(int).Sort(introsorted, IntGreaterThan);
+	arrays(int).StableSort(mergeSorted, IntGreaterThan);
+	arrays(int).RadixSort(radixSorted, IntKey);
+
+	IsTrue(IsSortedInts(introsorted));
+	IsTrue(arrays(int).Equals(introsorted, mergeSorted));
+	IsTrue(arrays(int).Equals(introsorted, radixSorted));
+
+	// already sorted and reversed inputs are the worst case for a naive quicksort
+	arrays(int).Sort(introsorted, IntGreaterThan);
+	IsTrue(arrays(int).Equals(introsorted, mergeSorted));
+
+	for (ulong i = 0; i < introsorted->Count / 2; i++)
+	{
+		arrays(int).Swap(introsorted, i, introsorted->Count - 1 - i);
+	}
+
+	arrays(int).Sort(introsorted, IntGreaterThan);
+	IsTrue(arrays(int).Equals(introsorted, mergeSorted));
+
+	arrays(int).Dispose(introsorted);
+	arrays(int).Dispose(mergeSorted);
+	arrays(int).Dispose(radixSorted);
+
+	array(float) floats = auto_stack_array(float, 3.5f, -1.0f, 0.0f, -7.25f, 100.0f, -0.5f);
+
+	arrays(float).RadixSort(floats, FloatKey);
+
+	IsTrue(arrays(float).Equals(floats, auto_stack_array(float, -7.25f, -1.0f, -0.5f, 0.0f, 3.5f, 100.0f)));
+
+	return true;
+}
+
+TEST(StableSorting)
+{
+	array(tuple(int, int)) pairs = dynamic_array(tuple(int, int), 1000);
+
+	ulong seed = 7;
+	for (int i = 0; i < 1000; i++)
+	{
+		// few distinct keys so there are many ties, the second value remembers the original order
+		arrays(tuple(int, int)).Append(pairs, (tuple(int, int)) { NextTestValue(&seed) % 10, i });
+	}
+
+	arrays(tuple(int, int)).StableSort(pairs, FirstGreaterThan);
+
+	bool stable = true;
+	for (ulong i = 1; i < pairs->Count; i++)
+	{
+		const tuple(int, int) previous = at(pairs, i - 1);
+		const tuple(int, int) current = at(pairs, i);
+
+		stable &= previous.First < current.First or (previous.First is current.First and previous.Second < current.Second);
+	}
+
+	IsTrue(stable);
+
+	arrays(tuple(int, int)).Dispose(pairs);
+
+	return true;
+}
+
+private int CompareInts(const void* left, const void* right)
+{
+	const int leftValue = *(const int*)left;
+	const int rightValue = *(const int*)right;
+
+	return leftValue < rightValue ? -1 : leftValue > rightValue;
+}
+
+TEST(SortBenchmark)
+{
+	const ulong counts[] = { 1000, 100000, 10000000 };
+
+	for (ulong i = 0; i < sizeof(counts) / sizeof(ulong); i++)
+	{
+		const ulong count = counts[i];
+
+		array(int) source = CreateRandomInts(count, count);
+		array(int) values = arrays(int).Clone(source);
+
+		fprintf(__test_stream, "\t%lli ints"NEWLINE, count);
+
+		// insertion sort is O(n^2), only time it where it finishes
+		if (count <= 1000)
+		{
+			fprintf(__test_stream, "\t\tInsertionSort: ");
+			Benchmark(arrays(int).InsertionSort(values, IntGreaterThan), __test_stream);
+			fprintf(__test_stream, NEWLINE);
+			IsTrue(IsSortedInts(values));
+		}
+
+		memcpy(values->Values, source->Values, count * sizeof(int));
+		fprintf(__test_stream, "\t\tqsort: ");
+		Benchmark(qsort(values->Values, count, sizeof(int), CompareInts), __test_stream);
+		fprintf(__test_stream, NEWLINE);
+
+		memcpy(values->Values, source->Values, count * sizeof(int));
+		fprintf(__test_stream, "\t\tSort: ");
+		Benchmark(arrays(int).Sort(values, IntGreaterThan), __test_stream);
+		fprintf(__test_stream, NEWLINE);
+		IsTrue(IsSortedInts(values));
+
+		memcpy(values->Values, source->Values, count * sizeof(int));
+		fprintf(__test_stream, "\t\tStableSort: ");
+		Benchmark(arrays(int).StableSort(values, IntGreaterThan), __test_stream);
+		fprintf(__test_stream, NEWLINE);
+		IsTrue(IsSortedInts(values));
+
+		memcpy(values->Values, source->Values, count * sizeof(int));
+		fprintf(__test_stream, "\t\tRadixSort: ");
+		Benchmark(arrays(int).RadixSort(values, IntKey), __test_stream);
+		fprintf(__test_stream, NEWLINE);
+		IsTrue(IsSortedInts(values));
+
+		arrays(int).Dispose(source);
+		arrays(int).Dispose(values);
+	}
+
 	return true;
 }
 
 TEST_SUITE(RunUnitTests,
 	APPEND_TEST(Hashing)
 	APPEND_TEST(Equals)
+	APPEND_TEST(LazyHashing)
 	APPEND_TEST(Sorting)
+	APPEND_TEST(StableSorting)
+	APPEND_TEST(BulkAppend)
+	APPEND_TEST(InlineStorage)
+);
+
+TEST_SUITE(RunBenchmarks,
+	APPEND_TEST(AppendBenchmark)
+	APPEND_TEST(BulkAppendBenchmark)
+	APPEND_TEST(SortBenchmark)
 );
 
 OnStart(11)
@@ -5,6 +5,17 @@
 #include <string.h>
 #include <stdlib.h>
 #include "core/os.h"
+#include "core/cunit.h"
+
+#ifdef _WIN32
+// kept out of the headers, windows.h defines macros that clash with engine names
+#include "windows.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 private bool TryOpen(const string, FileMode fileMode, File* out_file);
 private File Open(const string path, FileMode fileMode);
@@ -18,6 +29,12 @@ private bool TryGetSequenceCount(File file, const string targetSequence, const s
 private bool TryClose(File file);
 private void Close(File file);
 private bool TryVerifyCleanup(void);
+private string MapFile(const string path);
+private bool TryMapFile(const string path, string* out_view);
+private void UnmapFile(string view);
+private bool TryGetNextLine(const string view, ulong* cursor, partial_string* out_line);
+private bool TryGetInfo(const string path, ulong* out_size, ulong* out_lastModified);
+private void RunUnitTests(void);
 
 const struct _fileMethods Files = {
 	.UseAssetDirectories = true,
@@ -36,7 +53,13 @@ const struct _fileMethods Files = {
 	.TryGetSequenceCount = &TryGetSequenceCount,
 	.TryClose = &TryClose,
 	.Close = &Close,
-	.TryVerifyCleanup = &TryVerifyCleanup
+	.TryVerifyCleanup = &TryVerifyCleanup,
+	.Map = &MapFile,
+	.TryMap = &TryMapFile,
+	.Unmap = &UnmapFile,
+	.TryGetNextLine = &TryGetNextLine,
+	.TryGetInfo = &TryGetInfo,
+	.RunUnitTests = &RunUnitTests
 };
 
 // the number of file handles opened using this file
@@ -115,7 +138,7 @@ private bool TryOpen(const string path, FileMode fileMode, File* out_file)
 
 private File Open(const string path, FileMode fileMode)
 {
-	Guard(strings.Empty(path));
+	Guard(strings.Empty(path) is false);
 	GuardNotNull(fileMode);
 
 	File file;
@@ -155,42 +178,41 @@ private ulong GetFileSize(const File file)
 	return count;
 }
 
-private string ReadFile(const File file)
+// reads the entire file into the provided string with a single read, returns false if the read failed
+private bool TryReadInto(const File file, string result, ulong length)
 {
-	ulong length = GetFileSize(file);
-
-	string result = strings.Create(length + 1);
-
-	at(result, length) = '\0'; // add line terminator
+	strings.Reserve(result, length);
 
 	rewind(file);
 
-	for (ulong i = 0; i < length; i++)
+	// text mode streams may translate line endings so fewer bytes than the size of the file can be read
+	const ulong bytesRead = fread(result->Values, sizeof(byte), length, file);
+
+	if (ferror(file) isnt 0)
 	{
-		int c = fgetc(file);
+		return false;
+	}
 
-		if (c is EOF)
-		{
-			// check to see what error we got
-			// if we got 0 then the stream was likely not started at the beginning and we reached EOF early
-			int error = ferror(file);
+	result->Count = bytesRead;
+	result->Dirty = true;
 
-			// if the error we got was actually an error we should return early
-			// only attempt rewinding once
-			if (error != 0)
-			{
-				strings.Dispose(result);
-				fprintf(stderr, "An error occurred while reading the file at ptr: %llix, Error Code %i", (ulong)file, ferror(file));
-				throw(FailedToReadFileException);
-			}
+	// the backing array is always one larger than the capacity, keep the string terminated
+	result->Values[bytesRead] = '\0';
 
-			at(result, i) = '\0';
-			safe_increment(result->Count);
-			break;
-		}
+	return true;
+}
+
+private string ReadFile(const File file)
+{
+	ulong length = GetFileSize(file);
+
+	string result = strings.Create(length);
 
-		at(result, i) = (char)c;
-		safe_increment(result->Count);
+	if (TryReadInto(file, result, length) is false)
+	{
+		strings.Dispose(result);
+		fprintf(stderr, "An error occurred while reading the file at ptr: %llix, Error Code %i", (ulong)file, ferror(file));
+		throw(FailedToReadFileException);
 	}
 
 	return result;
@@ -202,35 +224,12 @@ private bool TryReadFile(const File file, string* out_data)
 
 	const ulong length = GetFileSize(file);
 
-	string result = strings.Create(length + 1);
+	string result = strings.Create(length);
 
-	at(result, length) = '\0'; // add line terminator
-
-	rewind(file);
-
-	for (ulong i = 0; i < length; i++)
+	if (TryReadInto(file, result, length) is false)
 	{
-		int c = fgetc(file);
-
-		if (c is EOF)
-		{
-			// check to see what error we got
-			// if we got 0 then the stream was likely not started at the beginning and we reached EOF early
-			int error = ferror(file);
-
-			// if the error we got was actually an error we should return early
-			// only attempt rewinding once
-			if (error != 0)
-			{
-				strings.Dispose(result);
-				return false;
-			}
-
-			at(result, i) = '\0';
-			break;
-		}
-
-		at(result, i) = (char)c;
+		strings.Dispose(result);
+		return false;
 	}
 
 	*out_data = result;
@@ -416,4 +415,421 @@ private bool TryVerifyCleanup(void)
 	}
 
 	return Global_Files_Opened == Global_Files_Closed;
-}
\ No newline at end of file
+}
+// the view returned by Map is the first member so the handles can be found again from it in Unmap
+typedef struct _mappedFile* MappedFile;
+
+struct _mappedFile
+{
+	partial_string View;
+	// the os handle of the file, unused outside of windows
+	void* File;
+	// the os handle of the file mapping, unused outside of windows
+	void* Mapping;
+};
+
+DEFINE_TYPE_ID(MappedFile);
+
+// views are never written to, empty files point here since zero length mappings aren't allowed
+static byte EmptyMappedFile[1] = { 0 };
+
+private bool TryMapFileInternal(const string path, string* out_view)
+{
+	*out_view = null;
+
+	if (path is null || strings.Empty(path))
+	{
+		return false;
+	}
+
+	void* fileHandle = null;
+	void* mappingHandle = null;
+	byte* values = EmptyMappedFile;
+	ulong length = 0;
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path->Values, GENERIC_READ, FILE_SHARE_READ, null, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, null);
+
+	if (file is INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(file, &size) is false)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	length = (ulong)size.QuadPart;
+
+	if (length isnt 0)
+	{
+		HANDLE mapping = CreateFileMappingA(file, null, PAGE_READONLY, 0, 0, null);
+
+		if (mapping is null)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		values = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+		if (values is null)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		mappingHandle = mapping;
+	}
+
+	fileHandle = file;
+#else
+	const int file = open(path->Values, O_RDONLY);
+
+	if (file < 0)
+	{
+		return false;
+	}
+
+	struct stat status;
+	if (fstat(file, &status) isnt 0)
+	{
+		close(file);
+		return false;
+	}
+
+	length = (ulong)status.st_size;
+
+	if (length isnt 0)
+	{
+		void* mapping = mmap(null, length, PROT_READ, MAP_PRIVATE, file, 0);
+
+		if (mapping is MAP_FAILED)
+		{
+			close(file);
+			return false;
+		}
+
+		madvise(mapping, length, MADV_SEQUENTIAL);
+
+		values = mapping;
+	}
+
+	// the mapping keeps its own reference to the file
+	close(file);
+#endif
+
+	REGISTER_TYPE(MappedFile);
+
+	MappedFile mappedFile = Memory.Alloc(sizeof(struct _mappedFile), MappedFileTypeId);
+
+	mappedFile->File = fileHandle;
+	mappedFile->Mapping = mappingHandle;
+
+	// the view is marked as a stack object so it can't be resized, appended to or disposed
+	mappedFile->View = (partial_string){
+		.Values = values,
+		.Size = length,
+		.ElementSize = sizeof(byte),
+		.Capacity = length,
+		.Count = length,
+		.TypeId = 0,
+		.StackObject = true,
+		.Dirty = true,
+		.Hash = 0,
+		.AutoHash = true
+	};
+
+	++(Global_Files_Opened);
+
+	*out_view = &mappedFile->View;
+
+	return true;
+}
+
+private bool TryMapFile(const string path, string* out_view)
+{
+	if (TryMapFileInternal(path, out_view))
+	{
+		return true;
+	}
+
+	// check alternate paths
+	if (Files.UseAssetDirectories and path isnt null)
+	{
+		for (int i = 0; i < Files.AssetDirectories->Count; i++)
+		{
+			const string directory = arrays(string).ValueAt(Files.AssetDirectories, i);
+
+			string newPath = empty_stack_array(byte, _MAX_PATH);
+
+			strings.AppendArray(newPath, directory);
+
+			strings.AppendArray(newPath, path);
+
+			if (TryMapFileInternal(newPath, out_view))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+private string MapFile(const string path)
+{
+	string view;
+
+	if (TryMapFile(path, &view))
+	{
+		return view;
+	}
+
+	fprintf(stderr, "Failed to map file %s"NEWLINE, path ? path->Values : "null");
+	throw(FailedToOpenFileException);
+
+	// we shouldn't be able to get here, but it's possible if __debugbreak() is continued
+	return null;
+}
+
+private void UnmapFile(string view)
+{
+	if (view is null)
+	{
+		return;
+	}
+
+	MappedFile mappedFile = (MappedFile)view;
+
+	if (view->Values isnt EmptyMappedFile)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(view->Values);
+#else
+		munmap(view->Values, view->Count);
+#endif
+	}
+
+#ifdef _WIN32
+	if (mappedFile->Mapping isnt null)
+	{
+		CloseHandle(mappedFile->Mapping);
+	}
+
+	CloseHandle(mappedFile->File);
+#endif
+
+	++(Global_Files_Closed);
+
+	Memory.Free(mappedFile, MappedFileTypeId);
+}
+
+private bool TryGetInfoInternal(const string path, ulong* out_size, ulong* out_lastModified)
+{
+	if (path is null || strings.Empty(path))
+	{
+		return false;
+	}
+
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (GetFileAttributesExA(path->Values, GetFileExInfoStandard, &attributes) is false)
+	{
+		return false;
+	}
+
+	*out_size = ((ulong)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+	*out_lastModified = ((ulong)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+#else
+	struct stat status;
+	if (stat(path->Values, &status) isnt 0)
+	{
+		return false;
+	}
+
+	*out_size = (ulong)status.st_size;
+	*out_lastModified = (ulong)status.st_mtime;
+#endif
+
+	return true;
+}
+
+private bool TryGetInfo(const string path, ulong* out_size, ulong* out_lastModified)
+{
+	if (TryGetInfoInternal(path, out_size, out_lastModified))
+	{
+		return true;
+	}
+
+	// check alternate paths
+	if (Files.UseAssetDirectories and path isnt null)
+	{
+		for (int i = 0; i < Files.AssetDirectories->Count; i++)
+		{
+			const string directory = arrays(string).ValueAt(Files.AssetDirectories, i);
+
+			string newPath = empty_stack_array(byte, _MAX_PATH);
+
+			strings.AppendArray(newPath, directory);
+
+			strings.AppendArray(newPath, path);
+
+			if (TryGetInfoInternal(newPath, out_size, out_lastModified))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+private bool TryGetNextLine(const string view, ulong* cursor, partial_string* out_line)
+{
+	const ulong start = *cursor;
+
+	if (start >= view->Count)
+	{
+		return false;
+	}
+
+	const byte* values = (const byte*)view->Values;
+
+	const byte* newLine = memchr(values + start, '\n', view->Count - start);
+
+	ulong end = newLine ? (ulong)(newLine - values) : view->Count;
+
+	// skip the \n for the next line
+	*cursor = newLine ? end + 1 : end;
+
+	if (end > start and values[end - 1] is '\r')
+	{
+		--end;
+	}
+
+	const ulong length = end - start;
+
+	*out_line = (partial_string){
+		.Values = (byte*)values + start,
+		.Size = length,
+		.ElementSize = sizeof(byte),
+		.Capacity = length,
+		.Count = length,
+		.TypeId = 0,
+		.StackObject = true,
+		.Dirty = true,
+		.Hash = 0,
+		.AutoHash = true
+	};
+
+	return true;
+}
+
+private void WriteTestFile(const string path, const char* contents)
+{
+	File file = Open(path, FileModes.Create);
+
+	fwrite(contents, 1, strlen(contents), file);
+
+	Close(file);
+}
+
+TEST(MapMatchesReadAll)
+{
+	string path = stack_string("file_map_test.txt");
+
+	WriteTestFile(path, "v 1.0 2.0 3.0\r\nvn 0 1 0\n\nf 1/1/1 2/2/2 3/3/3");
+
+	string data = ReadAll(path);
+	string view = MapFile(path);
+
+	IsEqual(data->Count, view->Count);
+	IsTrue(memcmp(data->Values, view->Values, data->Count) is 0);
+	IsTrue(strings.Equals(data, view));
+
+	// the view can't be modified
+	IsTrue(view->StackObject);
+
+	const char* expected[] = { "v 1.0 2.0 3.0", "vn 0 1 0", "", "f 1/1/1 2/2/2 3/3/3" };
+
+	ulong cursor = 0;
+	ulong lineCount = 0;
+	partial_string line;
+
+	while (TryGetNextLine(view, &cursor, &line))
+	{
+		// lines should point directly into the view
+		IsTrue(line.Values >= view->Values and line.Values + line.Count <= view->Values + view->Count);
+		IsEqual((ulong)strlen(expected[lineCount]), line.Count);
+		IsTrue(memcmp(expected[lineCount], line.Values, line.Count) is 0);
+
+		++lineCount;
+	}
+
+	IsEqual((ulong)4, lineCount);
+	IsEqual(view->Count, cursor);
+
+	UnmapFile(view);
+	strings.Dispose(data);
+
+	remove(path->Values);
+
+	return true;
+}
+
+TEST(MapEmptyFile)
+{
+	string path = stack_string("file_map_empty_test.txt");
+
+	WriteTestFile(path, "");
+
+	string view;
+	IsTrue(TryMapFile(path, &view));
+	IsEqual((ulong)0, view->Count);
+
+	ulong cursor = 0;
+	partial_string line;
+	IsFalse(TryGetNextLine(view, &cursor, &line));
+
+	UnmapFile(view);
+
+	remove(path->Values);
+
+	string missing = stack_string("file_map_missing_test.txt");
+
+	IsFalse(TryMapFileInternal(missing, &view));
+	IsNull(view);
+
+	return true;
+}
+
+TEST(InfoMatchesSize)
+{
+	string path = stack_string("file_info_test.txt");
+
+	WriteTestFile(path, "v 1.0 2.0 3.0");
+
+	ulong size;
+	ulong lastModified;
+	IsTrue(TryGetInfo(path, &size, &lastModified));
+	IsEqual((ulong)13, size);
+	IsNotZero(lastModified);
+
+	remove(path->Values);
+
+	IsFalse(TryGetInfoInternal(path, &size, &lastModified));
+
+	return true;
+}
+
+TEST_SUITE(
+	RunUnitTests,
+	APPEND_TEST(MapMatchesReadAll)
+	APPEND_TEST(MapEmptyFile)
+	APPEND_TEST(InfoMatchesSize)
+);
@@ -1,4 +1,5 @@
 #include "core/math/floats.h"
+#include "core/scanning.h"
 
 bool TryDeserialize(const char* buffer, ulong bufferLength, float* out_float);
 static void SerializeStream(File stream, float value);
@@ -10,8 +11,7 @@ const struct _floatMethods Floats = {
 
 bool TryDeserialize(const char* buffer, ulong bufferLength, float* out_float)
 {
-	ignore_unused(bufferLength);
-	return sscanf_s(buffer, "%f", out_float) == 1;
+	return Scanning.TryScanFloat(&buffer, buffer + bufferLength, out_float);
 }
 
 static void SerializeStream(File stream, float value)
@@ -1,46 +1,278 @@
 #include "core/hashing.h"
 #include "core/csharp.h"
+#include "core/atomics.h"
+#include <string.h>
+
+// The streaming core is CRC-64/XZ (ECMA-182, reflected). Unlike block hashes such as wyhash or xxh3
+// a CRC can be resumed from ANY byte boundary, which array appends and ChainHash rely on:
+//		ChainHashSafe(b, HashSafe(a)) is HashSafe(a + b)
+// The CRC register is run through an invertible avalanche mix (murmur3's fmix64) before being returned
+// so every output bit depends on every input bit, chaining un-mixes the previous hash to resume the register.
+// Large inputs are folded 64 bytes at a time with carry-less multiplication when the CPU supports it.
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define HASHING_CARRYLESS_MULTIPLY
+#endif
+
+// reflected ECMA-182 polynomial
+#define CRC64_POLYNOMIAL 0xC96C5795D7870F42ull
+// the register value used when there is no previous hash
+#define HASH_SEED 0xFFFFFFFFFFFFFFFFull
+// the smallest input that is worth folding with carry-less multiplication
+#define FOLD_THRESHOLD 256
 
 private ulong Hash(const char* bytes);
 private ulong ChainHash(const char* bytes, const ulong previousHash);
 private ulong HashSafe(const char* bytes, ulong size);
 private ulong ChainHashSafe(const char* bytes, const ulong size, const ulong previousHash);
 private ulong ChainHashSingle(const char byte, const ulong previousHash);
+private void RunUnitTests(void);
+private void RunBenchmarks(void);
 
 const struct _hashingMethods Hashing = {
 	.Hash = &Hash,
 	.ChainHash = &ChainHash,
 	.HashSafe = HashSafe,
 	.ChainHashSafe = ChainHashSafe,
-	.ChainHashSingle = ChainHashSingle
+	.ChainHashSingle = ChainHashSingle,
+	.RunUnitTests = RunUnitTests,
+	.RunBenchmarks = RunBenchmarks
 };
 
-private ulong ChainHashSingle(const char byte, const ulong previousHash)
+// slicing-by-8 tables, Crc64Tables[0] is the standard byte-at-a-time table
+static ulong Crc64Tables[8][256];
+
+#define TablesUninitialized 0
+#define TablesInitializing 1
+#define TablesInitialized 2
+
+static volatile long TablesState = TablesUninitialized;
+
+private void CreateTables(void)
+{
+	for (ulong i = 0; i < 256; i++)
+	{
+		ulong crc = i;
+
+		for (int bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 1) ? (crc >> 1) ^ CRC64_POLYNOMIAL : crc >> 1;
+		}
+
+		Crc64Tables[0][i] = crc;
+	}
+
+	for (ulong i = 0; i < 256; i++)
+	{
+		for (int slice = 1; slice < 8; slice++)
+		{
+			const ulong previous = Crc64Tables[slice - 1][i];
+
+			Crc64Tables[slice][i] = (previous >> 8) ^ Crc64Tables[0][previous & 0xFF];
+		}
+	}
+}
+
+private void EnsureTables(void)
 {
-	ulong hash = previousHash is 0 ? 5381 : previousHash;
+	if (TablesState is TablesInitialized)
+	{
+		return;
+	}
 
-	hash = ((hash << 5) + hash) + byte; /* hash * 33 + c */
+	// hashing happens from any thread (type registration) so only one thread builds the tables
+	if (AtomicCompareExchange32(TablesState, TablesInitializing, TablesUninitialized) is TablesUninitialized)
+	{
+		CreateTables();
+
+		AtomicExchange32(TablesState, TablesInitialized);
+
+		return;
+	}
+
+	while (TablesState isnt TablesInitialized)
+	{
+		SpinWait();
+	}
+}
+
+// murmur3 fmix64, a bijection so it can be undone by Unmix
+private ulong Mix(ulong state)
+{
+	state ^= state >> 33;
+	state *= 0xFF51AFD7ED558CCDull;
+	state ^= state >> 33;
+	state *= 0xC4CEB9FE1A85EC53ull;
+	state ^= state >> 33;
+
+	return state;
+}
+
+private ulong Unmix(ulong hash)
+{
+	// x ^= x >> 33 is its own inverse, the multipliers are undone with their modular inverses
+	hash ^= hash >> 33;
+	hash *= 0x9CB4B2F8129337DBull;
+	hash ^= hash >> 33;
+	hash *= 0x4F74430C22A54005ull;
+	hash ^= hash >> 33;
 
 	return hash;
 }
 
-private ulong ChainHashSafe(const char* bytes, const ulong size, const ulong previousHash)
+private ulong ResumeState(const ulong previousHash)
 {
-	// modified djb2 hash
-	/*http://www.cse.yorku.ca/~oz/hash.html*/
+	EnsureTables();
 
-	ulong hash = previousHash is 0 ? 5381 : previousHash;
+	return previousHash is 0 ? HASH_SEED : Unmix(previousHash);
+}
 
-	for (ulong i = 0; i < size; i++)
+private ulong ReadUlong(const byte* bytes)
+{
+	ulong value;
+	memcpy(&value, bytes, sizeof(ulong));
+	return value;
+}
+
+private ulong UpdateWithTables(ulong state, const byte* bytes, ulong size)
+{
+	// align to 8 so the main loop can consume an entire ulong at a time
+	while (size > 0 and ((ulong)bytes & 7) isnt 0)
+	{
+		state = Crc64Tables[0][(state ^ *bytes++) & 0xFF] ^ (state >> 8);
+		--size;
+	}
+
+	while (size >= 8)
 	{
-		const int c = bytes[i];
+		state ^= ReadUlong(bytes);
+
+		state = Crc64Tables[7][state & 0xFF] ^
+			Crc64Tables[6][(state >> 8) & 0xFF] ^
+			Crc64Tables[5][(state >> 16) & 0xFF] ^
+			Crc64Tables[4][(state >> 24) & 0xFF] ^
+			Crc64Tables[3][(state >> 32) & 0xFF] ^
+			Crc64Tables[2][(state >> 40) & 0xFF] ^
+			Crc64Tables[1][(state >> 48) & 0xFF] ^
+			Crc64Tables[0][state >> 56];
 
-		hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
+		bytes += 8;
+		size -= 8;
 	}
 
-	return hash;
+	while (size-- > 0)
+	{
+		state = Crc64Tables[0][(state ^ *bytes++) & 0xFF] ^ (state >> 8);
+	}
+
+	return state;
+}
+
+#ifdef HASHING_CARRYLESS_MULTIPLY
+
+// reflected (x^n mod P) constants, one less than the fold distance since a carry-less multiply
+// of two reflected values is itself shifted by one
+// fold by 512 bits: x^(512 + 64 - 1), x^(512 - 1)
+#define FOLD_512_LOW 0x6AE3EFBB9DD441F3ull
+#define FOLD_512_HIGH 0x081F6054A7842DF4ull
+// fold by 128 bits: x^(128 + 64 - 1), x^(128 - 1)
+#define FOLD_128_LOW 0xE05DD497CA393AE4ull
+#define FOLD_128_HIGH 0xDABE95AFC7875F40ull
+
+private bool SupportsCarrylessMultiply(void)
+{
+	// -1 until we've asked the cpu, racing threads will all write the same answer
+	static int supported = -1;
+
+	if (supported is - 1)
+	{
+		int info[4];
+		__cpuid(info, 1);
+
+		// ecx bit 1 is PCLMULQDQ
+		supported = (info[2] & (1 << 1)) isnt 0;
+	}
+
+	return supported;
+}
+
+private __m128i Fold(__m128i value, __m128i constants)
+{
+	return _mm_xor_si128(
+		_mm_clmulepi64_si128(value, constants, 0x00),
+		_mm_clmulepi64_si128(value, constants, 0x11));
+}
+
+// folds the first (size & ~63) bytes into a single 128 bit remainder and returns the register
+// as if every one of those bytes had been consumed, the caller consumes the remaining bytes
+private ulong UpdateWithFolding(ulong state, const byte* bytes, ulong size)
+{
+	const __m128i fold512 = _mm_set_epi64x((long long)FOLD_512_HIGH, (long long)FOLD_512_LOW);
+	const __m128i fold128 = _mm_set_epi64x((long long)FOLD_128_HIGH, (long long)FOLD_128_LOW);
+
+	// the register is equivalent to xoring it into the first 8 bytes of the message
+	__m128i first = _mm_xor_si128(_mm_loadu_si128((const __m128i*)bytes), _mm_set_epi64x(0, (long long)state));
+	__m128i second = _mm_loadu_si128((const __m128i*)(bytes + 16));
+	__m128i third = _mm_loadu_si128((const __m128i*)(bytes + 32));
+	__m128i fourth = _mm_loadu_si128((const __m128i*)(bytes + 48));
+
+	const ulong blocks = size / 64;
+
+	for (ulong i = 1; i < blocks; i++)
+	{
+		const byte* block = bytes + (i * 64);
+
+		first = _mm_xor_si128(Fold(first, fold512), _mm_loadu_si128((const __m128i*)block));
+		second = _mm_xor_si128(Fold(second, fold512), _mm_loadu_si128((const __m128i*)(block + 16)));
+		third = _mm_xor_si128(Fold(third, fold512), _mm_loadu_si128((const __m128i*)(block + 32)));
+		fourth = _mm_xor_si128(Fold(fourth, fold512), _mm_loadu_si128((const __m128i*)(block + 48)));
+	}
+
+	second = _mm_xor_si128(Fold(first, fold128), second);
+	third = _mm_xor_si128(Fold(second, fold128), third);
+	fourth = _mm_xor_si128(Fold(third, fold128), fourth);
+
+	// the remainder is congruent to the whole message, run it through the tables with an empty register
+	byte remainder[16];
+	_mm_storeu_si128((__m128i*)remainder, fourth);
+
+	return UpdateWithTables(0, remainder, sizeof(remainder));
 }
 
+#endif
+
+private ulong Update(ulong state, const byte* bytes, ulong size)
+{
+#ifdef HASHING_CARRYLESS_MULTIPLY
+	if (size >= FOLD_THRESHOLD and SupportsCarrylessMultiply())
+	{
+		const ulong foldedSize = size & ~(ulong)63;
+
+		state = UpdateWithFolding(state, bytes, foldedSize);
+
+		bytes += foldedSize;
+		size -= foldedSize;
+	}
+#endif
+
+	return UpdateWithTables(state, bytes, size);
+}
+
+private ulong ChainHashSingle(const char byte, const ulong previousHash)
+{
+	ulong state = ResumeState(previousHash);
+
+	state = Crc64Tables[0][(state ^ (unsigned char)byte) & 0xFF] ^ (state >> 8);
+
+	return Mix(state);
+}
+
+private ulong ChainHashSafe(const char* bytes, const ulong size, const ulong previousHash)
+{
+	ulong state = ResumeState(previousHash);
+
+	return Mix(Update(state, (const byte*)bytes, size));
+}
 
 private ulong HashSafe(const char* bytes, ulong size)
 {
@@ -49,22 +281,261 @@ private ulong HashSafe(const char* bytes, ulong size)
 
 private ulong ChainHash(const char* bytes, const ulong previousHash)
 {
-	// modified djb2 hash
-	/*http://www.cse.yorku.ca/~oz/hash.html*/
+	return ChainHashSafe(bytes, strlen(bytes), previousHash);
+}
+
+private ulong Hash(const char* bytes)
+{
+	return ChainHash(bytes, 0);
+}
+
+#include "core/cunit.h"
+#include "core/memory.h"
+#include <time.h>
+
+// deterministic test data so failures are reproducible
+private ulong NextTestValue(ulong* state)
+{
+	ulong value = (*state += 0x9E3779B97F4A7C15ull);
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+	return value ^ (value >> 31);
+}
 
-	ulong hash = previousHash is 0 ? 5381 : previousHash;
+private void FillTestData(byte* buffer, ulong size, ulong seed)
+{
+	for (ulong i = 0; i < size; i++)
+	{
+		buffer[i] = (byte)NextTestValue(&seed);
+	}
+}
 
-	int c;
+// the previous hash, kept as a baseline for the benchmarks
+private ulong Djb2(const char* bytes, ulong size)
+{
+	ulong hash = 5381;
 
-#pragma warning (disable : 4706)
-	while (c = *bytes++)
-		hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
-#pragma warning (default : 4706)
+	for (ulong i = 0; i < size; i++)
+	{
+		hash = ((hash << 5) + hash) + bytes[i];
+	}
 
 	return hash;
 }
 
-private ulong Hash(const char* bytes)
+TEST(MatchesCrc64CheckValue)
 {
-	return ChainHash(bytes, 0);
-}
\ No newline at end of file
+	// CRC-64/XZ check value for "123456789"
+	const ulong hash = Hashing.Hash("123456789");
+
+	IsEqual(0x995DC9BBDF1939FAull, Unmix(hash) ^ HASH_SEED);
+
+	return true;
+}
+
+TEST(ChainingMatchesWholeHash)
+{
+	const ulong size = 4096 + 37;
+
+	byte* data = Memory.Alloc(size, Memory.GenericMemoryBlock);
+
+	FillTestData(data, size, 7);
+
+	const ulong expected = Hashing.HashSafe((char*)data, size);
+
+	bool allMatch = true;
+
+	// split at every offset so both the folded and table paths get resumed from odd positions
+	for (ulong split = 0; split <= size; split++)
+	{
+		const ulong first = Hashing.HashSafe((char*)data, split);
+		const ulong chained = Hashing.ChainHashSafe((char*)data + split, size - split, first);
+
+		allMatch &= chained is expected;
+	}
+
+	IsTrue(allMatch);
+
+	ulong single = 0;
+	for (ulong i = 0; i < size; i++)
+	{
+		single = Hashing.ChainHashSingle(data[i], single);
+	}
+
+	IsEqual(expected, single);
+
+#ifdef HASHING_CARRYLESS_MULTIPLY
+	// the folded path must produce the exact same register as the tables
+	IsEqual(UpdateWithTables(HASH_SEED, data, size), Update(HASH_SEED, data, size));
+#endif
+
+	Memory.Free(data, Memory.GenericMemoryBlock);
+
+	return true;
+}
+
+TEST(Avalanche)
+{
+	const ulong sampleCount = 2000;
+	const ulong size = 32;
+
+	byte data[32];
+
+	// how many times each output bit flipped
+	ulong flips[64] = { 0 };
+	ulong trials = 0;
+
+	for (ulong sample = 0; sample < sampleCount; sample++)
+	{
+		FillTestData(data, size, sample);
+
+		const ulong original = Hashing.HashSafe((char*)data, size);
+
+		for (ulong bit = 0; bit < size * 8; bit++)
+		{
+			data[bit / 8] ^= (byte)(1 << (bit % 8));
+
+			const ulong changed = original ^ Hashing.HashSafe((char*)data, size);
+
+			data[bit / 8] ^= (byte)(1 << (bit % 8));
+
+			for (int outputBit = 0; outputBit < 64; outputBit++)
+			{
+				flips[outputBit] += (changed >> outputBit) & 1;
+			}
+
+			++trials;
+		}
+	}
+
+	// every output bit should flip for roughly half of all single bit input changes
+	double worstBias = 0.0;
+	for (int outputBit = 0; outputBit < 64; outputBit++)
+	{
+		const double probability = (double)flips[outputBit] / (double)trials;
+		const double bias = probability > 0.5 ? probability - 0.5 : 0.5 - probability;
+
+		worstBias = bias > worstBias ? bias : worstBias;
+	}
+
+	fprintf(__test_stream, "\tworst output bit bias: %lf"NEWLINE, worstBias);
+
+	IsTrue(worstBias < 0.01);
+
+	return true;
+}
+
+private int CompareUlongs(const void* left, const void* right)
+{
+	const ulong leftValue = *(const ulong*)left;
+	const ulong rightValue = *(const ulong*)right;
+
+	return leftValue < rightValue ? -1 : leftValue > rightValue;
+}
+
+TEST(Collisions)
+{
+	const ulong count = 1 << 20;
+
+	ulong* hashes = Memory.Alloc(sizeof(ulong) * count, Memory.GenericMemoryBlock);
+
+	// sequential integers and similar short strings are the worst case for weak hashes
+	for (ulong i = 0; i < count / 2; i++)
+	{
+		hashes[i] = Hashing.HashSafe((char*)&i, sizeof(ulong));
+	}
+
+	char name[32];
+	for (ulong i = 0; i < count / 2; i++)
+	{
+		const int length = sprintf_s(name, sizeof(name), "Type%lli", i);
+		hashes[(count / 2) + i] = Hashing.HashSafe(name, length);
+	}
+
+	// bucket the low bits like the type registry does
+	ulong buckets[1024] = { 0 };
+	for (ulong i = 0; i < count; i++)
+	{
+		++(buckets[hashes[i] % 1024]);
+	}
+
+	ulong fullestBucket = 0;
+	for (int i = 0; i < 1024; i++)
+	{
+		fullestBucket = max(fullestBucket, buckets[i]);
+	}
+
+	qsort(hashes, count, sizeof(ulong), CompareUlongs);
+
+	ulong collisions = 0;
+	for (ulong i = 1; i < count; i++)
+	{
+		collisions += hashes[i] is hashes[i - 1];
+	}
+
+	IsEqual((ulong)0, collisions);
+
+	// expected 1024 per bucket, a good hash stays within a few standard deviations (32)
+	IsTrue(fullestBucket < 1024 + (32 * 6));
+
+	Memory.Free(hashes, Memory.GenericMemoryBlock);
+
+	return true;
+}
+
+TEST(Benchmark)
+{
+	const ulong maxSize = 16 * 1024 * 1024;
+
+	byte* data = Memory.Alloc(maxSize, Memory.GenericMemoryBlock);
+
+	FillTestData(data, maxSize, 42);
+
+	volatile ulong sink = 0;
+
+	// 16B to 16MB, every size hashes the same total number of bytes
+	const ulong totalSize = 64 * 1024 * 1024;
+
+	for (ulong size = 16; size <= maxSize; size *= 16)
+	{
+		const ulong iterations = totalSize / size;
+
+		clock_t start = clock();
+		for (ulong i = 0; i < iterations; i++)
+		{
+			sink ^= Hashing.HashSafe((char*)data, size);
+		}
+		const double hashSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		start = clock();
+		for (ulong i = 0; i < iterations; i++)
+		{
+			sink ^= Djb2((char*)data, size);
+		}
+		const double djb2Seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		const double megabytes = (double)totalSize / (1024.0 * 1024.0);
+
+		fprintf(__test_stream, "\t%10lli bytes: HashSafe %10.1lf MB/s djb2 %10.1lf MB/s"NEWLINE,
+			size,
+			megabytes / max(hashSeconds, 1e-6),
+			megabytes / max(djb2Seconds, 1e-6));
+	}
+
+	Memory.Free(data, Memory.GenericMemoryBlock);
+
+	return true;
+}
+
+TEST_SUITE(
+	RunUnitTests,
+	APPEND_TEST(MatchesCrc64CheckValue)
+	APPEND_TEST(ChainingMatchesWholeHash)
+	APPEND_TEST(Avalanche)
+	APPEND_TEST(Collisions)
+);
+
+TEST_SUITE(
+	RunBenchmarks,
+	APPEND_TEST(Benchmark)
+);
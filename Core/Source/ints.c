@@ -1,4 +1,6 @@
 #include "core/math/ints.h"
+#include "core/scanning.h"
+#include <ctype.h>
 
 static bool TryDeserialize(const char* buffer, ulong bufferLength, ulong* out_value);
 static void Serialize(File stream, ulong value);
@@ -8,14 +10,73 @@ const struct _intMethods Ints = {
 	.Serialize = &Serialize
 };
 
-#pragma warning(disable: 4100) // disable warning for unused bufferLength
+static bool TryScanOctal(const char** cursor, const char* end, ulong* out_value)
+{
+	const char* position = *cursor;
+	ulong value = 0;
+
+	for (; position < end and *position >= '0' and *position <= '7'; ++position)
+	{
+		if (value >> 61 isnt 0)
+		{
+			return false;
+		}
+
+		value = (value << 3) | (ulong)(*position - '0');
+	}
+
+	*out_value = value;
+	*cursor = position;
+
+	return true;
+}
+
 static bool TryDeserialize(const char* buffer, ulong bufferLength, ulong* out_value)
 {
-	int count = sscanf_s(buffer, "%lli", out_value);
+	const char* end = buffer + bufferLength;
+	const char* position = buffer;
+
+	while (position < end and isspace((unsigned char)*position))
+	{
+		++position;
+	}
+
+	const char* digits = position;
+
+	if (digits < end and (*digits is '-' or *digits is '+'))
+	{
+		++digits;
+	}
+
+	// values are written signed decimal, but files written by hand used to be read with %lli which also takes
+	// 0x prefixed hex and 0 prefixed octal
+	const bool hex = end - digits > 2 and digits[0] is '0' and (digits[1] | 0x20) is 'x';
+	const bool octal = hex is false and end - digits > 1 and digits[0] is '0' and digits[1] >= '0' and digits[1] <= '7';
+
+	if (hex is false and octal is false)
+	{
+		return Scanning.TryScanInteger(&position, end, (long long*)out_value);
+	}
+
+	ulong value;
+
+	if (hex ? Scanning.TryScanHex(&digits, end, &value) is false : TryScanOctal(&digits, end, &value) is false)
+	{
+		return false;
+	}
+
+	const bool negative = *position is '-';
+	const ulong limit = negative ? 0x8000000000000000ull : 0x7FFFFFFFFFFFFFFFull;
+
+	if (value > limit)
+	{
+		return false;
+	}
+
+	*out_value = negative ? 0 - value : value;
 
-	return count == 1;
+	return true;
 }
-#pragma warning(default: 4100)
 
 static void Serialize(File stream, ulong value)
 {
@@ -0,0 +1,548 @@
+#include "core/array.h"
+#include "core/map.h"
+#include "core/memory.h"
+#include <string.h>
+
+private Map Create(ulong count, ulong entrySize, ulong keyOffset, ulong keySize, ulong valueOffset, ulong valueSize, ulong typeId,
+	ulong(*keyHash)(const void* key),
+	bool(*keyEquals)(const void* left, const void* right));
+private void Reserve(Map, ulong count);
+private void* Find(Map, const void* key);
+private bool TryAdd(Map, const void* key, const void* value);
+private void Set(Map, const void* key, const void* value);
+private bool Remove(Map, const void* key);
+private bool TryGetNext(Map, ulong* cursor, void** out_key, void** out_value);
+private void Clear(Map);
+private void Dispose(Map);
+private void RunUnitTests(void);
+
+const struct _mapMethods Maps = {
+	.Create = Create,
+	.Reserve = Reserve,
+	.Find = Find,
+	.TryAdd = TryAdd,
+	.Set = Set,
+	.Remove = Remove,
+	.TryGetNext = TryGetNext,
+	.Clear = Clear,
+	.Dispose = Dispose,
+	.RunUnitTests = RunUnitTests
+};
+
+// the smallest number of entries a map allocates
+#define MAP_MINIMUM_CAPACITY 8
+// the map resizes once it's more than 7/8ths full, robin hood probing keeps probes short even this full
+#define MAP_MAXIMUM_LOAD(capacity) ((capacity) - ((capacity) >> 3))
+
+private ulong* EntryHash(Map map, ulong index)
+{
+	return (ulong*)(map->Entries + (index * map->EntrySize));
+}
+
+private char* EntryKey(Map map, char* entry)
+{
+	return entry + map->KeyOffset;
+}
+
+private char* EntryValue(Map map, char* entry)
+{
+	return entry + map->ValueOffset;
+}
+
+// the entry after the last slot is never occupied, inserts use it to carry the displaced entry
+private char* ScratchEntry(Map map)
+{
+	return map->Entries + (map->Capacity * map->EntrySize);
+}
+
+private ulong HashKey(Map map, const void* key)
+{
+	const ulong hash = map->KeyHash ? map->KeyHash(key) : Hashing.HashSafe(key, map->KeySize);
+
+	return hash | MAP_OCCUPIED_BIT;
+}
+
+private bool KeysEqual(Map map, const void* left, const void* right)
+{
+	return map->KeyEquals ? map->KeyEquals(left, right) : memcmp(left, right, map->KeySize) is 0;
+}
+
+// how far the entry at index is from the slot its hash wants
+private ulong ProbeDistance(Map map, ulong hash, ulong index)
+{
+	return (index - hash) & (map->Capacity - 1);
+}
+
+private void SwapEntries(char* left, char* right, ulong size)
+{
+	char temp[128];
+
+	while (size > 0)
+	{
+		const ulong chunk = min(size, sizeof(temp));
+
+		memcpy(temp, left, chunk);
+		memcpy(left, right, chunk);
+		memcpy(right, temp, chunk);
+
+		left += chunk;
+		right += chunk;
+		size -= chunk;
+	}
+}
+
+private ulong CapacityFor(ulong count)
+{
+	ulong capacity = MAP_MINIMUM_CAPACITY;
+
+	while (MAP_MAXIMUM_LOAD(capacity) < count)
+	{
+		capacity <<= 1;
+	}
+
+	return capacity;
+}
+
+private Map Create(ulong count, ulong entrySize, ulong keyOffset, ulong keySize, ulong valueOffset, ulong valueSize, ulong typeId,
+	ulong(*keyHash)(const void* key),
+	bool(*keyEquals)(const void* left, const void* right))
+{
+	REGISTER_TYPE(Map);
+
+	Map map = Memory.Alloc(sizeof(struct _map_void), MapTypeId);
+
+	map->EntrySize = entrySize;
+	map->KeyOffset = keyOffset;
+	map->KeySize = keySize;
+	map->ValueOffset = valueOffset;
+	map->ValueSize = valueSize;
+	map->TypeId = typeId;
+	map->KeyHash = keyHash;
+	map->KeyEquals = keyEquals;
+	map->Count = 0;
+	map->Capacity = CapacityFor(count);
+
+	// alloc one more entry for scratch space
+	map->Entries = Memory.Alloc((map->Capacity + 1) * entrySize, typeId);
+
+	return map;
+}
+
+// places an entry whose key is known to not be in the map, the entry is clobbered
+private char* Insert(Map map, char* entry)
+{
+	const ulong mask = map->Capacity - 1;
+
+	ulong index = *(ulong*)entry & mask;
+	ulong distance = 0;
+
+	// where the callers entry ended up, the entry we carry changes as we displace others
+	char* result = null;
+
+	while (true)
+	{
+		char* slot = (char*)EntryHash(map, index);
+		const ulong slotHash = *(ulong*)slot;
+
+		if (slotHash is 0)
+		{
+			memcpy(slot, entry, map->EntrySize);
+
+			++(map->Count);
+
+			return result ? result : slot;
+		}
+
+		// take from the rich, the slot's entry is closer to home than we are so it moves instead
+		const ulong slotDistance = ProbeDistance(map, slotHash, index);
+
+		if (slotDistance < distance)
+		{
+			SwapEntries(slot, entry, map->EntrySize);
+
+			if (result is null)
+			{
+				result = slot;
+			}
+
+			distance = slotDistance;
+		}
+
+		index = (index + 1) & mask;
+		++distance;
+	}
+}
+
+private void Resize(Map map, ulong capacity)
+{
+	char* previousEntries = map->Entries;
+	const ulong previousCapacity = map->Capacity;
+
+	map->Entries = Memory.Alloc((capacity + 1) * map->EntrySize, map->TypeId);
+	map->Capacity = capacity;
+	map->Count = 0;
+
+	char* scratch = ScratchEntry(map);
+
+	for (ulong i = 0; i < previousCapacity; i++)
+	{
+		char* entry = previousEntries + (i * map->EntrySize);
+
+		if (*(ulong*)entry isnt 0)
+		{
+			memcpy(scratch, entry, map->EntrySize);
+			Insert(map, scratch);
+		}
+	}
+
+	Memory.Free(previousEntries, map->TypeId);
+}
+
+private void Reserve(Map map, ulong count)
+{
+	const ulong capacity = CapacityFor(count);
+
+	if (capacity > map->Capacity)
+	{
+		Resize(map, capacity);
+	}
+}
+
+private char* FindEntry(Map map, const void* key, ulong hash)
+{
+	const ulong mask = map->Capacity - 1;
+
+	ulong index = hash & mask;
+	ulong distance = 0;
+
+	while (true)
+	{
+		char* slot = (char*)EntryHash(map, index);
+		const ulong slotHash = *(ulong*)slot;
+
+		// an entry closer to home than we are means our key would have taken this slot
+		if (slotHash is 0 or ProbeDistance(map, slotHash, index) < distance)
+		{
+			return null;
+		}
+
+		if (slotHash is hash and KeysEqual(map, key, EntryKey(map, slot)))
+		{
+			return slot;
+		}
+
+		index = (index + 1) & mask;
+		++distance;
+	}
+}
+
+private void* Find(Map map, const void* key)
+{
+	char* entry = FindEntry(map, key, HashKey(map, key));
+
+	return entry ? EntryValue(map, entry) : null;
+}
+
+private char* AddEntry(Map map, const void* key, const void* value, ulong hash)
+{
+	if (map->Count + 1 > MAP_MAXIMUM_LOAD(map->Capacity))
+	{
+		Resize(map, map->Capacity << 1);
+	}
+
+	char* scratch = ScratchEntry(map);
+
+	memset(scratch, 0, map->EntrySize);
+
+	*(ulong*)scratch = hash;
+	memcpy(EntryKey(map, scratch), key, map->KeySize);
+	memcpy(EntryValue(map, scratch), value, map->ValueSize);
+
+	return Insert(map, scratch);
+}
+
+private bool TryAdd(Map map, const void* key, const void* value)
+{
+	const ulong hash = HashKey(map, key);
+
+	if (FindEntry(map, key, hash) isnt null)
+	{
+		return false;
+	}
+
+	AddEntry(map, key, value, hash);
+
+	return true;
+}
+
+private void Set(Map map, const void* key, const void* value)
+{
+	const ulong hash = HashKey(map, key);
+
+	char* entry = FindEntry(map, key, hash);
+
+	if (entry isnt null)
+	{
+		memcpy(EntryValue(map, entry), value, map->ValueSize);
+		return;
+	}
+
+	AddEntry(map, key, value, hash);
+}
+
+private bool Remove(Map map, const void* key)
+{
+	char* entry = FindEntry(map, key, HashKey(map, key));
+
+	if (entry is null)
+	{
+		return false;
+	}
+
+	const ulong mask = map->Capacity - 1;
+
+	ulong index = (entry - map->Entries) / map->EntrySize;
+
+	// shift every following entry that isn't already home back by one, no tombstones needed
+	while (true)
+	{
+		const ulong nextIndex = (index + 1) & mask;
+
+		char* slot = (char*)EntryHash(map, index);
+		char* next = (char*)EntryHash(map, nextIndex);
+
+		const ulong nextHash = *(ulong*)next;
+
+		if (nextHash is 0 or ProbeDistance(map, nextHash, nextIndex) is 0)
+		{
+			memset(slot, 0, map->EntrySize);
+			break;
+		}
+
+		memcpy(slot, next, map->EntrySize);
+
+		index = nextIndex;
+	}
+
+	--(map->Count);
+
+	return true;
+}
+
+private bool TryGetNext(Map map, ulong* cursor, void** out_key, void** out_value)
+{
+	for (ulong index = *cursor; index < map->Capacity; index++)
+	{
+		char* entry = (char*)EntryHash(map, index);
+
+		if (*(ulong*)entry isnt 0)
+		{
+			*out_key = EntryKey(map, entry);
+			*out_value = EntryValue(map, entry);
+			*cursor = index + 1;
+
+			return true;
+		}
+	}
+
+	*cursor = map->Capacity;
+
+	return false;
+}
+
+private void Clear(Map map)
+{
+	memset(map->Entries, 0, (map->Capacity + 1) * map->EntrySize);
+
+	map->Count = 0;
+}
+
+private void Dispose(Map map)
+{
+	if (map is null)
+	{
+		return;
+	}
+
+	Memory.Free(map->Entries, map->TypeId);
+	Memory.Free(map, MapTypeId);
+}
+
+#include "core/cunit.h"
+
+DEFINE_MAP(ulong, ulong);
+DEFINE_MAP(string, int);
+
+TEST(AddGetRemove)
+{
+	map(ulong, ulong) numbers = maps(ulong, ulong).Create(0);
+
+	const ulong count = 10000;
+
+	bool allAdded = true;
+	for (ulong i = 0; i < count; i++)
+	{
+		allAdded &= maps(ulong, ulong).TryAdd(numbers, i, i * 3);
+	}
+
+	IsTrue(allAdded);
+	IsEqual(count, numbers->Count);
+
+	// duplicate keys are rejected and leave the value alone
+	IsFalse(maps(ulong, ulong).TryAdd(numbers, 5, 0));
+	IsEqual((ulong)15, maps(ulong, ulong).Get(numbers, 5));
+
+	maps(ulong, ulong).Set(numbers, 5, 1);
+	IsEqual((ulong)1, maps(ulong, ulong).Get(numbers, 5));
+
+	// remove every even key, the odd keys must survive the backward shifting
+	bool allRemoved = true;
+	for (ulong i = 0; i < count; i += 2)
+	{
+		allRemoved &= maps(ulong, ulong).Remove(numbers, i);
+	}
+
+	IsTrue(allRemoved);
+	IsFalse(maps(ulong, ulong).Remove(numbers, 0));
+	IsEqual(count / 2, numbers->Count);
+
+	bool allFound = true;
+	for (ulong i = 0; i < count; i++)
+	{
+		ulong value;
+		const bool found = maps(ulong, ulong).TryGet(numbers, i, &value);
+
+		allFound &= (i % 2) is 0 ? found is false : found and (i is 5 or value is i * 3);
+	}
+
+	IsTrue(allFound);
+
+	maps(ulong, ulong).Clear(numbers);
+
+	IsZero(numbers->Count);
+	IsFalse(maps(ulong, ulong).ContainsKey(numbers, 1));
+
+	maps(ulong, ulong).Dispose(numbers);
+
+	return true;
+}
+
+private void SumValues(void* context, ulong* key, ulong* value)
+{
+	ignore_unused(key);
+
+	*(ulong*)context += *value;
+}
+
+TEST(Iteration)
+{
+	map(ulong, ulong) numbers = maps(ulong, ulong).Create(16);
+
+	for (ulong i = 1; i <= 100; i++)
+	{
+		maps(ulong, ulong).TryAdd(numbers, i, i);
+	}
+
+	ulong cursor = 0;
+	ulong* key;
+	ulong* value;
+
+	ulong keySum = 0;
+	ulong visited = 0;
+	while (maps(ulong, ulong).TryGetNext(numbers, &cursor, &key, &value))
+	{
+		keySum += *key;
+		++visited;
+	}
+
+	IsEqual((ulong)100, visited);
+	IsEqual((ulong)5050, keySum);
+
+	ulong valueSum = 0;
+	maps(ulong, ulong).ForeachWithContext(numbers, &valueSum, SumValues);
+
+	IsEqual((ulong)5050, valueSum);
+
+	maps(ulong, ulong).Dispose(numbers);
+
+	return true;
+}
+
+TEST(StringKeys)
+{
+	map(string, int) names = maps(string, int).Create(4);
+
+	// the map stores the string, not a copy, so the keys must outlive the map
+	string first = stack_string("first");
+	string second = stack_string("second");
+
+	IsTrue(maps(string, int).TryAdd(names, first, 1));
+	IsTrue(maps(string, int).TryAdd(names, second, 2));
+
+	// different addresses, same contents
+	string key = dynamic_string("second");
+
+	IsEqual(2, maps(string, int).Get(names, key));
+	IsFalse(maps(string, int).TryAdd(names, key, 3));
+	IsFalse(maps(string, int).ContainsKey(names, stack_string("third")));
+
+	strings.Dispose(key);
+	maps(string, int).Dispose(names);
+
+	return true;
+}
+
+TEST(Benchmark)
+{
+	const ulong lookups = 10000;
+	const ulong sizes[] = { 16, 256, 4096, 16384 };
+
+	volatile ulong sink = 0;
+
+	for (ulong sizeIndex = 0; sizeIndex < sizeof(sizes) / sizeof(ulong); sizeIndex++)
+	{
+		const ulong size = sizes[sizeIndex];
+
+		array(ulong) keys = dynamic_array(ulong, size);
+		map(ulong, ulong) numbers = maps(ulong, ulong).Create(size);
+
+		for (ulong i = 0; i < size; i++)
+		{
+			// spread the keys out so they don't hash into a neat sequence
+			const ulong key = i * 0x9E3779B97F4A7C15ull;
+
+			arrays(ulong).Append(keys, key);
+			maps(ulong, ulong).TryAdd(numbers, key, i);
+		}
+
+		fprintf(__test_stream, "\t%lli entries, %lli lookups linear scan: ", size, lookups);
+		Benchmark(
+			for (ulong i = 0; i < lookups; i++)
+			{
+				sink += arrays(ulong).IndexOf(keys, ((i * 7919) % size) * 0x9E3779B97F4A7C15ull);
+			}
+		, __test_stream);
+
+		fprintf(__test_stream, " map: ");
+		Benchmark(
+			for (ulong i = 0; i < lookups; i++)
+			{
+				sink += maps(ulong, ulong).Get(numbers, ((i * 7919) % size) * 0x9E3779B97F4A7C15ull);
+			}
+		, __test_stream);
+		fprintf(__test_stream, NEWLINE);
+
+		arrays(ulong).Dispose(keys);
+		maps(ulong, ulong).Dispose(numbers);
+	}
+
+	return true;
+}
+
+TEST_SUITE(
+	RunUnitTests,
+	APPEND_TEST(AddGetRemove)
+	APPEND_TEST(Iteration)
+	APPEND_TEST(StringKeys)
+	APPEND_TEST(Benchmark)
+);
@@ -0,0 +1,555 @@
+#include "core/math/matrixKernels.h"
+#include "core/cunit.h"
+#include "core/memory.h"
+#include <math.h>
+#include <string.h>
+#include <float.h>
+#include <time.h>
+
+// SSE2 is part of x64 so it never has to be asked for, AVX is only used when the whole build targets it the same way
+// cglm decides
+#if defined(_M_X64) || defined(__x86_64__)
+#define MATRIX_KERNELS_SSE
+#include <immintrin.h>
+#endif
+
+// the furthest a kernel may be from cglm, in units of the last place of the largest entry of the column
+#define MAX_KERNEL_ERROR_BITS 4
+
+private void Compose(const vector3* position, const quaternion* rotation, const vector3* scale, matrix4* destination);
+private void ComposeSlots(const vector3* positions, const quaternion* rotations, const vector3* scales, const ulong* slots, ulong count, matrix4* destinations);
+private void Multiply(const matrix4* left, const matrix4* right, matrix4* destination);
+private void MultiplyArrays(const matrix4* lefts, const matrix4* rights, matrix4* destinations, ulong count);
+private void RunUnitTests(void);
+private void RunBenchmarks(void);
+
+const struct _matrixKernelMethods MatrixKernels = {
+	.Compose = &Compose,
+	.ComposeSlots = &ComposeSlots,
+	.Multiply = &Multiply,
+	.MultiplyArrays = &MultiplyArrays,
+	.RunUnitTests = &RunUnitTests,
+	.RunBenchmarks = &RunBenchmarks
+};
+
+private void Compose(const vector3* position, const quaternion* rotation, const vector3* scale, matrix4* destination)
+{
+	const float x = rotation->x;
+	const float y = rotation->y;
+	const float z = rotation->z;
+	const float w = rotation->w;
+
+	// the same steps in the same order as glm_quat_mat4 so both round the same way, cglm sums the norm in pairs on
+	// every cpu with SSE. Translating an identity matrix and rotating it are exact so only the rotation and the scale
+	// are left
+	const float norm = sqrtf(((x * x) + (y * y)) + ((z * z) + (w * w)));
+	const float s = norm > 0.0f ? 2.0f / norm : 0.0f;
+
+	const float xx = s * x * x;
+	const float xy = s * x * y;
+	const float xz = s * x * z;
+	const float yy = s * y * y;
+	const float yz = s * y * z;
+	const float zz = s * z * z;
+	const float wx = s * w * x;
+	const float wy = s * w * y;
+	const float wz = s * w * z;
+
+	destination->Column1 = (vector4){ (1.0f - yy - zz) * scale->x, (xy + wz) * scale->x, (xz - wy) * scale->x, 0.0f };
+	destination->Column2 = (vector4){ (xy - wz) * scale->y, (1.0f - xx - zz) * scale->y, (yz + wx) * scale->y, 0.0f };
+	destination->Column3 = (vector4){ (xz + wy) * scale->z, (yz - wx) * scale->z, (1.0f - xx - yy) * scale->z, 0.0f };
+	destination->Column4 = (vector4){ position->x, position->y, position->z, 1.0f };
+}
+
+#ifdef MATRIX_KERNELS_SSE
+
+private __m128 GatherX(const vector3* vectors, const ulong* slots)
+{
+	return _mm_set_ps(vectors[slots[3]].x, vectors[slots[2]].x, vectors[slots[1]].x, vectors[slots[0]].x);
+}
+
+private __m128 GatherY(const vector3* vectors, const ulong* slots)
+{
+	return _mm_set_ps(vectors[slots[3]].y, vectors[slots[2]].y, vectors[slots[1]].y, vectors[slots[0]].y);
+}
+
+private __m128 GatherZ(const vector3* vectors, const ulong* slots)
+{
+	return _mm_set_ps(vectors[slots[3]].z, vectors[slots[2]].z, vectors[slots[1]].z, vectors[slots[0]].z);
+}
+
+// turns four lanes of x, y, z and w back into one column of each of the four matrices
+private void ScatterColumn(__m128 x, __m128 y, __m128 z, __m128 w, const ulong* slots, matrix4* destinations, ulong column)
+{
+	_MM_TRANSPOSE4_PS(x, y, z, w);
+
+	_mm_storeu_ps((float*)&destinations[slots[0]] + (column * 4), x);
+	_mm_storeu_ps((float*)&destinations[slots[1]] + (column * 4), y);
+	_mm_storeu_ps((float*)&destinations[slots[2]] + (column * 4), z);
+	_mm_storeu_ps((float*)&destinations[slots[3]] + (column * 4), w);
+}
+
+// Compose for four slots at once, every lane holds one transform
+private void ComposeFour(const vector3* positions, const quaternion* rotations, const vector3* scales, const ulong* slots, matrix4* destinations)
+{
+	__m128 x = _mm_loadu_ps((const float*)&rotations[slots[0]]);
+	__m128 y = _mm_loadu_ps((const float*)&rotations[slots[1]]);
+	__m128 z = _mm_loadu_ps((const float*)&rotations[slots[2]]);
+	__m128 w = _mm_loadu_ps((const float*)&rotations[slots[3]]);
+
+	_MM_TRANSPOSE4_PS(x, y, z, w);
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	const __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(w, w)));
+	const __m128 norm = _mm_sqrt_ps(dot);
+
+	// a zero quaternion divides by zero, the mask turns that lane's infinity into the 0 Compose uses
+	const __m128 s = _mm_and_ps(_mm_cmpgt_ps(norm, zero), _mm_div_ps(_mm_set1_ps(2.0f), norm));
+
+	const __m128 sx = _mm_mul_ps(s, x);
+	const __m128 sy = _mm_mul_ps(s, y);
+	const __m128 sz = _mm_mul_ps(s, z);
+	const __m128 sw = _mm_mul_ps(s, w);
+
+	const __m128 xx = _mm_mul_ps(sx, x);
+	const __m128 xy = _mm_mul_ps(sx, y);
+	const __m128 xz = _mm_mul_ps(sx, z);
+	const __m128 yy = _mm_mul_ps(sy, y);
+	const __m128 yz = _mm_mul_ps(sy, z);
+	const __m128 zz = _mm_mul_ps(sz, z);
+	const __m128 wx = _mm_mul_ps(sw, x);
+	const __m128 wy = _mm_mul_ps(sw, y);
+	const __m128 wz = _mm_mul_ps(sw, z);
+
+	const __m128 scaleX = GatherX(scales, slots);
+	const __m128 scaleY = GatherY(scales, slots);
+	const __m128 scaleZ = GatherZ(scales, slots);
+
+	ScatterColumn(
+		_mm_mul_ps(_mm_sub_ps(_mm_sub_ps(one, yy), zz), scaleX),
+		_mm_mul_ps(_mm_add_ps(xy, wz), scaleX),
+		_mm_mul_ps(_mm_sub_ps(xz, wy), scaleX),
+		zero,
+		slots, destinations, 0);
+
+	ScatterColumn(
+		_mm_mul_ps(_mm_sub_ps(xy, wz), scaleY),
+		_mm_mul_ps(_mm_sub_ps(_mm_sub_ps(one, xx), zz), scaleY),
+		_mm_mul_ps(_mm_add_ps(yz, wx), scaleY),
+		zero,
+		slots, destinations, 1);
+
+	ScatterColumn(
+		_mm_mul_ps(_mm_add_ps(xz, wy), scaleZ),
+		_mm_mul_ps(_mm_sub_ps(yz, wx), scaleZ),
+		_mm_mul_ps(_mm_sub_ps(_mm_sub_ps(one, xx), yy), scaleZ),
+		zero,
+		slots, destinations, 2);
+
+	ScatterColumn(GatherX(positions, slots), GatherY(positions, slots), GatherZ(positions, slots), one, slots, destinations, 3);
+}
+
+// one column of left * right, the sums are in the same order as glm_mat4_mul
+private __m128 MultiplyColumn(__m128 left0, __m128 left1, __m128 left2, __m128 left3, __m128 column)
+{
+	__m128 result = _mm_mul_ps(_mm_shuffle_ps(column, column, _MM_SHUFFLE(0, 0, 0, 0)), left0);
+
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(column, column, _MM_SHUFFLE(1, 1, 1, 1)), left1));
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(column, column, _MM_SHUFFLE(2, 2, 2, 2)), left2));
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(column, column, _MM_SHUFFLE(3, 3, 3, 3)), left3));
+
+	return result;
+}
+
+#endif
+
+private void ComposeSlots(const vector3* positions, const quaternion* rotations, const vector3* scales, const ulong* slots, ulong count, matrix4* destinations)
+{
+	ulong i = 0;
+
+#ifdef MATRIX_KERNELS_SSE
+	for (; i + 4 <= count; i += 4)
+	{
+		ComposeFour(positions, rotations, scales, slots + i, destinations);
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		const ulong slot = slots[i];
+
+		Compose(&positions[slot], &rotations[slot], &scales[slot], &destinations[slot]);
+	}
+}
+
+private void Multiply(const matrix4* left, const matrix4* right, matrix4* destination)
+{
+#ifdef MATRIX_KERNELS_SSE
+	const float* leftValues = (const float*)left;
+	const float* rightValues = (const float*)right;
+
+	const __m128 left0 = _mm_loadu_ps(leftValues);
+	const __m128 left1 = _mm_loadu_ps(leftValues + 4);
+	const __m128 left2 = _mm_loadu_ps(leftValues + 8);
+	const __m128 left3 = _mm_loadu_ps(leftValues + 12);
+
+	const __m128 right0 = _mm_loadu_ps(rightValues);
+	const __m128 right1 = _mm_loadu_ps(rightValues + 4);
+	const __m128 right2 = _mm_loadu_ps(rightValues + 8);
+	const __m128 right3 = _mm_loadu_ps(rightValues + 12);
+
+	// everything is loaded before anything is stored so the destination can be either side
+	float* values = (float*)destination;
+
+	_mm_storeu_ps(values, MultiplyColumn(left0, left1, left2, left3, right0));
+	_mm_storeu_ps(values + 4, MultiplyColumn(left0, left1, left2, left3, right1));
+	_mm_storeu_ps(values + 8, MultiplyColumn(left0, left1, left2, left3, right2));
+	_mm_storeu_ps(values + 12, MultiplyColumn(left0, left1, left2, left3, right3));
+#else
+	const float* l = (const float*)left;
+	const float* r = (const float*)right;
+
+	float result[16];
+
+	for (ulong column = 0; column < 4; column++)
+	{
+		for (ulong row = 0; row < 4; row++)
+		{
+			result[(column * 4) + row] =
+				(l[row] * r[column * 4]) +
+				(l[4 + row] * r[(column * 4) + 1]) +
+				(l[8 + row] * r[(column * 4) + 2]) +
+				(l[12 + row] * r[(column * 4) + 3]);
+		}
+	}
+
+	memcpy(destination, result, sizeof(result));
+#endif
+}
+
+#ifdef __AVX__
+
+// two columns of left * right at once, the left columns are repeated in both halves
+private __m256 MultiplyColumnPair(__m256 left0, __m256 left1, __m256 left2, __m256 left3, __m256 columns)
+{
+	__m256 result = _mm256_mul_ps(_mm256_permute_ps(columns, _MM_SHUFFLE(0, 0, 0, 0)), left0);
+
+	result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_permute_ps(columns, _MM_SHUFFLE(1, 1, 1, 1)), left1));
+	result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_permute_ps(columns, _MM_SHUFFLE(2, 2, 2, 2)), left2));
+	result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_permute_ps(columns, _MM_SHUFFLE(3, 3, 3, 3)), left3));
+
+	return result;
+}
+
+#endif
+
+private void MultiplyArrays(const matrix4* lefts, const matrix4* rights, matrix4* destinations, ulong count)
+{
+	for (ulong i = 0; i < count; i++)
+	{
+#ifdef __AVX__
+		const float* leftValues = (const float*)&lefts[i];
+		const float* rightValues = (const float*)&rights[i];
+
+		const __m256 left0 = _mm256_broadcast_ps((const __m128*)leftValues);
+		const __m256 left1 = _mm256_broadcast_ps((const __m128*)(leftValues + 4));
+		const __m256 left2 = _mm256_broadcast_ps((const __m128*)(leftValues + 8));
+		const __m256 left3 = _mm256_broadcast_ps((const __m128*)(leftValues + 12));
+
+		const __m256 firstColumns = _mm256_loadu_ps(rightValues);
+		const __m256 lastColumns = _mm256_loadu_ps(rightValues + 8);
+
+		float* values = (float*)&destinations[i];
+
+		_mm256_storeu_ps(values, MultiplyColumnPair(left0, left1, left2, left3, firstColumns));
+		_mm256_storeu_ps(values + 8, MultiplyColumnPair(left0, left1, left2, left3, lastColumns));
+#else
+		Multiply(&lefts[i], &rights[i], &destinations[i]);
+#endif
+	}
+}
+
+// how many units in the last place of the largest entry of its column each entry of actual is from expected
+private float ErrorBits(const matrix4 expected, const matrix4 actual)
+{
+	const float* expectedValues = (const float*)&expected;
+	const float* actualValues = (const float*)&actual;
+
+	float largest = 0.0f;
+
+	for (ulong column = 0; column < 4; column++)
+	{
+		float magnitude = FLT_MIN;
+
+		for (ulong row = 0; row < 4; row++)
+		{
+			magnitude = max(magnitude, fabsf(expectedValues[(column * 4) + row]));
+		}
+
+		for (ulong row = 0; row < 4; row++)
+		{
+			const ulong index = (column * 4) + row;
+
+			largest = max(largest, fabsf(expectedValues[index] - actualValues[index]) / (magnitude * FLT_EPSILON));
+		}
+	}
+
+	return largest;
+}
+
+private ulong NextRandom(ulong* state)
+{
+	*state = (*state * 6364136223846793005ull) + 1442695040888963407ull;
+
+	return *state >> 33;
+}
+
+// a float from -range to range
+private float RandomFloat(ulong* state, float range)
+{
+	return (((float)(NextRandom(state) & 0xFFFFFF) / (float)0xFFFFFF) * 2.0f * range) - range;
+}
+
+private void RandomTransform(ulong* state, vector3* position, quaternion* rotation, vector3* scale)
+{
+	*position = (vector3){ RandomFloat(state, 100.0f), RandomFloat(state, 100.0f), RandomFloat(state, 100.0f) };
+
+	vector3 axis = { RandomFloat(state, 1.0f), RandomFloat(state, 1.0f), RandomFloat(state, 1.0f) };
+
+	if (axis.x is 0.0f and axis.y is 0.0f and axis.z is 0.0f)
+	{
+		axis = Vector3.Up;
+	}
+
+	*rotation = Quaternions.Create(RandomFloat(state, 4.0f), axis);
+
+	*scale = (vector3){ RandomFloat(state, 4.0f), RandomFloat(state, 4.0f), RandomFloat(state, 4.0f) };
+}
+
+private matrix4 ComposeWithCglm(const vector3 position, const quaternion rotation, const vector3 scale)
+{
+	return Matrix4s.Scale(Quaternions.RotateMatrix(rotation, Matrix4s.Translate(Matrix4.Identity, position)), scale);
+}
+
+TEST(ComposeMatchesCglm)
+{
+	const ulong count = 1003;
+
+	vector3* positions = Memory.Alloc(count * sizeof(vector3), Memory.GenericMemoryBlock);
+	quaternion* rotations = Memory.Alloc(count * sizeof(quaternion), Memory.GenericMemoryBlock);
+	vector3* scales = Memory.Alloc(count * sizeof(vector3), Memory.GenericMemoryBlock);
+	matrix4* matrices = Memory.Alloc(count * sizeof(matrix4), Memory.GenericMemoryBlock);
+	ulong* slots = Memory.Alloc(count * sizeof(ulong), Memory.GenericMemoryBlock);
+
+	ulong random = 3;
+
+	for (ulong i = 0; i < count; i++)
+	{
+		RandomTransform(&random, &positions[i], &rotations[i], &scales[i]);
+
+		slots[i] = i;
+	}
+
+	// quaternions that drifted away from unit length, and one that is all zeros
+	for (ulong i = 0; i < count; i += 7)
+	{
+		rotations[i].x *= 3.0f;
+		rotations[i].y *= 3.0f;
+		rotations[i].z *= 3.0f;
+		rotations[i].w *= 3.0f;
+	}
+
+	rotations[5] = (quaternion){ 0 };
+
+	// slots come in any order, only every other slot is written
+	for (ulong i = count - 1; i > 0; i--)
+	{
+		const ulong other = NextRandom(&random) % (i + 1);
+		const ulong swap = slots[i];
+
+		slots[i] = slots[other];
+		slots[other] = swap;
+	}
+
+	const ulong composed = count / 2;
+
+	ComposeSlots(positions, rotations, scales, slots, composed, matrices);
+
+	float largest = 0.0f;
+
+	for (ulong i = 0; i < count; i++)
+	{
+		const matrix4 expected = ComposeWithCglm(positions[i], rotations[i], scales[i]);
+
+		matrix4 single;
+		Compose(&positions[i], &rotations[i], &scales[i], &single);
+
+		largest = max(largest, ErrorBits(expected, single));
+
+		if (i < composed)
+		{
+			largest = max(largest, ErrorBits(ComposeWithCglm(positions[slots[i]], rotations[slots[i]], scales[slots[i]]), matrices[slots[i]]));
+		}
+	}
+
+	for (ulong i = composed; i < count; i++)
+	{
+		IsTrue(matrices[slots[i]].Column4.w is 0.0f);
+	}
+
+	fprintf(__test_stream, "\tlargest compose error %.2f bits"NEWLINE, largest);
+
+	IsTrue(largest <= MAX_KERNEL_ERROR_BITS);
+
+	Memory.Free(positions, Memory.GenericMemoryBlock);
+	Memory.Free(rotations, Memory.GenericMemoryBlock);
+	Memory.Free(scales, Memory.GenericMemoryBlock);
+	Memory.Free(matrices, Memory.GenericMemoryBlock);
+	Memory.Free(slots, Memory.GenericMemoryBlock);
+
+	return true;
+}
+
+TEST(MultiplyMatchesCglm)
+{
+	const ulong count = 1001;
+
+	matrix4* lefts = Memory.Alloc(count * sizeof(matrix4), Memory.GenericMemoryBlock);
+	matrix4* rights = Memory.Alloc(count * sizeof(matrix4), Memory.GenericMemoryBlock);
+	matrix4* results = Memory.Alloc(count * sizeof(matrix4), Memory.GenericMemoryBlock);
+
+	ulong random = 11;
+
+	for (ulong i = 0; i < count; i++)
+	{
+		vector3 position;
+		quaternion rotation;
+		vector3 scale;
+
+		RandomTransform(&random, &position, &rotation, &scale);
+		lefts[i] = ComposeWithCglm(position, rotation, scale);
+
+		// right sides that aren't affine too
+		float* values = (float*)&rights[i];
+
+		for (ulong value = 0; value < 16; value++)
+		{
+			values[value] = RandomFloat(&random, 10.0f);
+		}
+	}
+
+	MultiplyArrays(lefts, rights, results, count);
+
+	float largest = 0.0f;
+
+	for (ulong i = 0; i < count; i++)
+	{
+		const matrix4 expected = Matrix4s.Multiply(lefts[i], rights[i]);
+
+		largest = max(largest, ErrorBits(expected, results[i]));
+
+		matrix4 single;
+		Multiply(&lefts[i], &rights[i], &single);
+
+		largest = max(largest, ErrorBits(expected, single));
+
+		// writing over either side gives the same answer
+		matrix4 left = lefts[i];
+		matrix4 right = rights[i];
+
+		Multiply(&left, &rights[i], &left);
+		Multiply(&lefts[i], &right, &right);
+
+		largest = max(largest, ErrorBits(expected, left));
+		largest = max(largest, ErrorBits(expected, right));
+	}
+
+	fprintf(__test_stream, "\tlargest multiply error %.2f bits"NEWLINE, largest);
+
+	IsTrue(largest <= MAX_KERNEL_ERROR_BITS);
+
+	Memory.Free(lefts, Memory.GenericMemoryBlock);
+	Memory.Free(rights, Memory.GenericMemoryBlock);
+	Memory.Free(results, Memory.GenericMemoryBlock);
+
+	return true;
+}
+
+TEST_SUITE(
+	RunUnitTests,
+	APPEND_TEST(ComposeMatchesCglm)
+	APPEND_TEST(MultiplyMatchesCglm)
+);
+
+TEST(Benchmark)
+{
+	const ulong count = 1000000;
+	const ulong runs = 5;
+
+	vector3* positions = Memory.Alloc(count * sizeof(vector3), Memory.GenericMemoryBlock);
+	quaternion* rotations = Memory.Alloc(count * sizeof(quaternion), Memory.GenericMemoryBlock);
+	vector3* scales = Memory.Alloc(count * sizeof(vector3), Memory.GenericMemoryBlock);
+	ulong* slots = Memory.Alloc(count * sizeof(ulong), Memory.GenericMemoryBlock);
+	matrix4* locals = Memory.Alloc(count * sizeof(matrix4), Memory.GenericMemoryBlock);
+	matrix4* worlds = Memory.Alloc(count * sizeof(matrix4), Memory.GenericMemoryBlock);
+
+	ulong random = 5;
+
+	for (ulong i = 0; i < count; i++)
+	{
+		RandomTransform(&random, &positions[i], &rotations[i], &scales[i]);
+
+		slots[i] = i;
+	}
+
+	// every local matrix is composed then multiplied by the one before it, which stands in for its parent
+	double cglmSeconds = 0.0;
+	double kernelSeconds = 0.0;
+
+	for (ulong run = 0; run < runs; run++)
+	{
+		clock_t start = clock();
+
+		for (ulong i = 0; i < count; i++)
+		{
+			locals[i] = ComposeWithCglm(positions[i], rotations[i], scales[i]);
+		}
+
+		for (ulong i = 1; i < count; i++)
+		{
+			worlds[i] = Matrix4s.Multiply(locals[i - 1], locals[i]);
+		}
+
+		cglmSeconds += (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		start = clock();
+
+		ComposeSlots(positions, rotations, scales, slots, count, locals);
+
+		MultiplyArrays(locals, locals + 1, worlds + 1, count - 1);
+
+		kernelSeconds += (double)(clock() - start) / CLOCKS_PER_SEC;
+	}
+
+	fprintf(__test_stream, "\t%llu transforms: cglm %7.3lf ms kernels %7.3lf ms (%.2lfx)"NEWLINE,
+		count,
+		cglmSeconds * 1000.0 / runs,
+		kernelSeconds * 1000.0 / runs,
+		cglmSeconds / max(kernelSeconds, 1e-9));
+
+	Memory.Free(positions, Memory.GenericMemoryBlock);
+	Memory.Free(rotations, Memory.GenericMemoryBlock);
+	Memory.Free(scales, Memory.GenericMemoryBlock);
+	Memory.Free(slots, Memory.GenericMemoryBlock);
+	Memory.Free(locals, Memory.GenericMemoryBlock);
+	Memory.Free(worlds, Memory.GenericMemoryBlock);
+
+	return true;
+}
+
+TEST_SUITE(
+	RunBenchmarks,
+	APPEND_TEST(Benchmark)
+);
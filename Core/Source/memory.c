@@ -5,6 +5,8 @@
 #include "core/memory.h"
 #include "core/csharp.h"
 #include "core/hashing.h"
+#include "core/atomics.h"
+#include "core/threads.h"
 
 static char GetByteGrouping(ulong value);
 static void PrintGroupedNumber(FILE* stream, ulong value);
@@ -21,11 +23,19 @@ static void RegisterTypeName(const char* name, ulong* out_typeId);
 private void PrintAlloc(FILE* stream);
 private void PrintFree(FILE* stream);
 private int CompareMemoryAndHash(const char* left, ulong leftSize, const char* right, ulong rightSize, ulong* out_leftHash, ulong* out_rightHash);
-
+static void* ArenaAlloc(ulong size, ulong typeID);
+static void ArenaReset(void);
+static void* PoolAlloc(ulong size, ulong typeID);
+static void PoolFree(void* address, ulong typeID);
+private ulong AllocCount(void);
+private ulong FreeCount(void);
+private ulong AllocSize(void);
+private void RunUnitTests(void);
 
 struct _memoryMethods Memory = {
-	.AllocSize = 0,
-	.AllocSize = 0,
+	.AllocCount = AllocCount,
+	.FreeCount = FreeCount,
+	.AllocSize = AllocSize,
 	.GenericMemoryBlock = 0x0,
 	.String = 0x01,
 	.Alloc = &SafeAlloc,
@@ -38,21 +48,51 @@ struct _memoryMethods Memory = {
 	.RegisterTypeName = &RegisterTypeName,
 	.PrintAlloc = PrintAlloc,
 	.PrintFree = PrintFree,
-	.CompareMemoryAndHash = CompareMemoryAndHash
+	.CompareMemoryAndHash = CompareMemoryAndHash,
+	.ArenaAlloc = ArenaAlloc,
+	.ArenaReset = ArenaReset,
+	.PoolAlloc = PoolAlloc,
+	.PoolFree = PoolFree,
+	.RunUnitTests = RunUnitTests
 };
 
 #define MAX_TYPENAME_LENGTH 1024
 #define MAX_REGISTERED_TYPENAMES 1024
 
+// the target size in bytes of a single pool slab
+#define POOL_SLAB_SIZE (16 * 1024)
+// the minimum number of blocks a slab should contain regardless of the size of the block
+#define POOL_MINIMUM_BLOCKS_PER_SLAB 16
+// pool blocks are rounded up to this so every block within a slab is suitable for any type
+#define POOL_ALIGNMENT 16
+
+struct _memoryPool {
+	// the size in bytes of every block handed out by this pool, 0 until the first PoolAlloc
+	ulong BlockSize;
+	// singly linked list of free blocks, the first bytes of a free block are the address of the next free block
+	void* FreeList;
+	// singly linked list of slabs owned by this pool, the first bytes of a slab are the address of the previous slab
+	void* Slabs;
+	// the amount of slabs this pool has allocated
+	ulong SlabCount;
+};
+
+// the slot is free to be claimed
+#define TypeNameUnused 0
+// the slot has been claimed by a thread that's still writing the Id and Name
+#define TypeNameClaimed 1
+// the slot's Id and Name are written and safe to read
+#define TypeNamePublished 2
+
 struct _typeName {
 	ulong Id;
 	const char Name[MAX_TYPENAME_LENGTH];
-	// the amount of active instances 
-	ulong Active;
-	// the amount of freed instances
-	ulong Freed;
-	// Whether or not this block of the hash table is used
-	bool Used;
+	// the amount of instances allocated from the frame arena since the last reset
+	ulong Arena;
+	// the fixed-size block pool for this type, only used by PoolAlloc and PoolFree
+	struct _memoryPool Pool;
+	// Whether or not this block of the hash table is used, one of the TypeName* states
+	volatile long Used;
 };
 
 struct _typeName RegisteredTypeNames[MAX_REGISTERED_TYPENAMES] =
@@ -60,47 +100,154 @@ struct _typeName RegisteredTypeNames[MAX_REGISTERED_TYPENAMES] =
 	{
 		.Id = 0,
 		.Name = "GenericMemoryBlock",
-		.Active = 0,
-		.Freed = 0,
-		.Used = true
+		.Used = TypeNamePublished
 	},
 	{
 		.Id = 1,
 		.Name = "String",
-		.Active = 0,
-		.Freed = 0,
-		.Used = true
+		.Used = TypeNamePublished
 	}
 };
 
-private int CompareMemoryAndHash(const char* left, ulong leftSize, const char* right, ulong rightSize, ulong* out_leftHash, ulong* out_rightHash)
+// the smallest block the frame arena will request from the OS
+#define ARENA_BLOCK_SIZE (1024 * 1024)
+// every arena allocation is rounded up to this so returned addresses are suitable for any type
+#define ARENA_ALIGNMENT 16
+
+struct _arenaBlock {
+	// the next block in the chain, blocks are kept between resets and reused
+	struct _arenaBlock* Next;
+	// the usable size in bytes of this block
+	ulong Size;
+	// the offset in bytes of the next free byte within this block
+	ulong Offset;
+	// the start of the usable memory of this block, directly follows the header
+	char* Data;
+};
+
+struct _arenaState {
+	struct _arenaBlock* Head;
+	struct _arenaBlock* Current;
+};
+
+static struct _arenaState Arena = {
+	.Head = null,
+	.Current = null
+};
+
+// Allocation statistics owned by a single thread, every thread writes only to its own
+// statistics so the hot path never needs an interlocked operation, readers merge all of them
+struct _memoryStatistics {
+	// the statistics of the next thread
+	struct _memoryStatistics* Next;
+	ulong AllocCount;
+	ulong FreeCount;
+	ulong AllocSize;
+	// the amount of active instances per registered type
+	ulong Active[MAX_REGISTERED_TYPENAMES];
+	// the amount of freed instances per registered type
+	ulong Freed[MAX_REGISTERED_TYPENAMES];
+};
+
+// the statistics of every thread that has ever allocated, entries are never removed so
+// counts made by threads that have since exited are kept
+static struct _memoryStatistics* volatile StatisticsHead = null;
+
+// the statistics of the calling thread, created on the first allocation the thread makes
+static ThreadStatic struct _memoryStatistics* ThreadStatistics = null;
+
+private struct _memoryStatistics* CreateThreadStatistics(void)
 {
-	ulong leftHash = 0;
-	ulong rightHash = 0;
+	// these live for the lifetime of the program so they're deliberately not tracked
+	struct _memoryStatistics* statistics = calloc(1, sizeof(struct _memoryStatistics));
 
-	const int length = min(leftSize, rightSize);
+	if (statistics is null)
+	{
+		throw(OutOfMemoryException);
+	}
 
-	for (ulong i = 0; i < length; i++)
+	// lock-free push onto the front of the list
+	struct _memoryStatistics* head;
+	do
 	{
-		const char leftByte = left[i];
-		const char rightByte = right[i];
+		head = StatisticsHead;
+		statistics->Next = head;
+	} while (AtomicCompareExchange(StatisticsHead, statistics, head) isnt (ulong)head);
 
-		leftHash = Hashing.ChainHashSingle(leftByte, leftHash);
-		rightHash = Hashing.ChainHashSingle(rightByte, rightHash);
+	ThreadStatistics = statistics;
 
-		if (leftByte != rightByte)
-		{
-			*out_leftHash = leftHash;
-			*out_rightHash = rightHash;
+	return statistics;
+}
 
-			return leftByte > rightByte ? 1 : -1;
-		}
+private struct _memoryStatistics* LocalStatistics(void)
+{
+	struct _memoryStatistics* statistics = ThreadStatistics;
+
+	return statistics isnt null ? statistics : CreateThreadStatistics();
+}
+
+private ulong AllocCount(void)
+{
+	ulong result = 0;
+
+	for (struct _memoryStatistics* statistics = StatisticsHead; statistics isnt null; statistics = statistics->Next)
+	{
+		result += statistics->AllocCount;
 	}
 
-	*out_leftHash = leftHash;
-	*out_rightHash = rightHash;
+	return result;
+}
 
-	return 0;
+private ulong FreeCount(void)
+{
+	ulong result = 0;
+
+	for (struct _memoryStatistics* statistics = StatisticsHead; statistics isnt null; statistics = statistics->Next)
+	{
+		result += statistics->FreeCount;
+	}
+
+	return result;
+}
+
+private ulong AllocSize(void)
+{
+	ulong result = 0;
+
+	for (struct _memoryStatistics* statistics = StatisticsHead; statistics isnt null; statistics = statistics->Next)
+	{
+		result += statistics->AllocSize;
+	}
+
+	return result;
+}
+
+// merges the per-thread active and freed counts for the type at the provided registry index
+private void GetTypeStatistics(ulong index, ulong* out_active, ulong* out_freed)
+{
+	ulong active = 0;
+	ulong freed = 0;
+
+	for (struct _memoryStatistics* statistics = StatisticsHead; statistics isnt null; statistics = statistics->Next)
+	{
+		active += statistics->Active[index];
+		freed += statistics->Freed[index];
+	}
+
+	*out_active = active;
+	*out_freed = freed;
+}
+
+private int CompareMemoryAndHash(const char* left, ulong leftSize, const char* right, ulong rightSize, ulong* out_leftHash, ulong* out_rightHash)
+{
+	// callers cache these hashes, so they must cover the entire buffer even when the comparison
+	// would stop early, hashing in bulk is far faster than hashing byte by byte alongside the compare
+	*out_leftHash = Hashing.HashSafe(left, leftSize);
+	*out_rightHash = Hashing.HashSafe(right, rightSize);
+
+	const int result = memcmp(left, right, min(leftSize, rightSize));
+
+	return result > 0 ? 1 : result < 0 ? -1 : 0;
 }
 
 /// <summary>
@@ -111,19 +258,27 @@ private void PrintAlloc(FILE* stream)
 {
 	// determine how to shorten the number of bytes
 	fprintf(stream, "Allocated ");
-	PrintGroupedNumber(stream, Memory.AllocSize);
-	fprintf(stream, " (%lli)\n", Memory.AllocCount);
+	PrintGroupedNumber(stream, AllocSize());
+	fprintf(stream, " (%lli)\n", AllocCount());
 
 	// manually register typename for generic memory
 	for (ulong i = 0; i < MAX_REGISTERED_TYPENAMES; i++)
 	{
 		const struct _typeName* typeName = &RegisteredTypeNames[i];
 
-		if (typeName->Used)
+		if (typeName->Used is TypeNamePublished)
 		{
-			fprintf(stream, "Type: %-32s	Active: %-16lli	Freed: %-16lli\n", typeName->Name, typeName->Active, typeName->Freed);
+			ulong active;
+			ulong freed;
+			GetTypeStatistics(i, &active, &freed);
+
+			fprintf(stream, "Type: %-32s	Active: %-16lli	Freed: %-16lli\n", typeName->Name, active, freed);
 		}
 	}
+
+	fprintf(stream, "Arena ");
+	PrintGroupedNumber(stream, Memory.ArenaAllocSize);
+	fprintf(stream, " (%lli)\n", Memory.ArenaAllocCount);
 }
 
 /// <summary>
@@ -132,7 +287,7 @@ private void PrintAlloc(FILE* stream)
 /// <param name="stream"></param>
 private void PrintFree(FILE* stream)
 {
-	fprintf(stream, "Free Count (%lli) ", Memory.FreeCount);
+	fprintf(stream, "Free Count (%lli) ", FreeCount());
 }
 
 /// <summary>
@@ -150,13 +305,13 @@ static void* SafeCalloc(ulong nitems, ulong size, ulong typeID)
 		throw(OutOfMemoryException);
 	}
 
-	Memory.AllocSize += nitems * size;
+	struct _memoryStatistics* statistics = LocalStatistics();
 
-	++Memory.AllocCount;
+	statistics->AllocSize += nitems * size;
 
-	const ulong index = typeID % MAX_REGISTERED_TYPENAMES;
+	++(statistics->AllocCount);
 
-	++(RegisteredTypeNames[index].Active);
+	++(statistics->Active[typeID % MAX_REGISTERED_TYPENAMES]);
 
 	return ptr;
 }
@@ -170,75 +325,267 @@ static void RegisterTypeName(const char* name, ulong* out_typeId)
 
 	ulong hash = Hashing.Hash(name);
 
-	ulong index = hash % MAX_REGISTERED_TYPENAMES;
+	// lock-free insert, slots are claimed with a compare exchange so only one thread can
+	// ever write a slot, everyone else waits for the write to be published then compares ids
+	while (true)
+	{
+		struct _typeName* typeName = &RegisteredTypeNames[hash % MAX_REGISTERED_TYPENAMES];
+
+		if (AtomicCompareExchange32(typeName->Used, TypeNameClaimed, TypeNameUnused) is TypeNameUnused)
+		{
+			typeName->Id = hash;
 
-	ulong previousFreed = 0;
-	ulong previousActive = 0;
+			ulong length = min(strlen(name), MAX_TYPENAME_LENGTH - 1);
 
-	// make sure we have an unused piece of the hash table
-	while (RegisteredTypeNames[index].Used)
-	{
-		if (RegisteredTypeNames[index].Id == hash)
+#pragma warning (disable : 4090)
+			char* ptr = typeName->Name;
+#pragma warning (default : 4090)
+
+			memcpy(ptr, name, length);
+
+			AtomicExchange32(typeName->Used, TypeNamePublished);
+
+			break;
+		}
+
+		while (typeName->Used isnt TypeNamePublished)
 		{
-			previousFreed = RegisteredTypeNames[index].Freed;
-			previousActive = RegisteredTypeNames[index].Active;
+			SpinWait();
+		}
 
+		// already registered, possibly by another thread
+		if (typeName->Id == hash)
+		{
 			break;
 		}
 
 		++hash;
-		index = hash % MAX_REGISTERED_TYPENAMES;
 	}
 
-	// check to see if we already set it
-	if (RegisteredTypeNames[index].Id == hash)
+	// set out var
+	*out_typeId = hash;
+}
+
+static void* SafeAlloc(ulong size, ulong typeID)
+{
+	if (size is 0)
+	{
+		return null;
+	}
+
+	void* ptr = calloc(1, size);
+
+	if (ptr is null)
 	{
-		// set out var
-		*out_typeId = hash;
+		throw(OutOfMemoryException);
 	}
 
-	RegisteredTypeNames[index].Id = hash;
-	RegisteredTypeNames[index].Freed = previousFreed;
-	RegisteredTypeNames[index].Active = previousActive;
-	RegisteredTypeNames[index].Used = true;
+	struct _memoryStatistics* statistics = LocalStatistics();
 
-	ulong length = min(strlen(name), MAX_TYPENAME_LENGTH);
+	statistics->AllocSize += size;
 
-#pragma warning (disable : 4090)
-	char* ptr = RegisteredTypeNames[index].Name;
-#pragma warning (default : 4090)
+	++(statistics->AllocCount);
 
-	memcpy(ptr, name, length);
+	++(statistics->Active[typeID % MAX_REGISTERED_TYPENAMES]);
 
-	// set out var
-	*out_typeId = hash;
+	return ptr;
 }
 
-static void* SafeAlloc(ulong size, ulong typeID)
+private struct _arenaBlock* CreateArenaBlock(ulong minimumSize)
+{
+	const ulong size = max(minimumSize, ARENA_BLOCK_SIZE);
+
+	// blocks live for the lifetime of the program and are reused after every reset
+	// so they are deliberately not tracked by AllocCount
+	struct _arenaBlock* block = calloc(1, sizeof(struct _arenaBlock) + size);
+
+	if (block is null)
+	{
+		throw(OutOfMemoryException);
+	}
+
+	block->Next = null;
+	block->Data = (char*)(block + 1);
+	block->Size = size;
+	block->Offset = 0;
+
+	return block;
+}
+
+static void* ArenaAlloc(ulong size, ulong typeID)
 {
 	if (size is 0)
 	{
 		return null;
 	}
 
-	void* ptr = calloc(1, size);
+	// round up so the next allocation remains aligned
+	const ulong alignedSize = (size + (ARENA_ALIGNMENT - 1)) & ~((ulong)ARENA_ALIGNMENT - 1);
 
-	if (ptr is null)
+	if (Arena.Current is null)
 	{
-		throw(OutOfMemoryException);
+		Arena.Head = Arena.Current = CreateArenaBlock(alignedSize);
 	}
 
-	Memory.AllocSize += size;
+	// move forward through any blocks left over from previous frames before asking for more memory
+	while (Arena.Current->Offset + alignedSize > Arena.Current->Size)
+	{
+		if (Arena.Current->Next is null)
+		{
+			Arena.Current->Next = CreateArenaBlock(alignedSize);
+		}
+
+		Arena.Current = Arena.Current->Next;
+	}
 
-	++Memory.AllocCount;
+	void* ptr = Arena.Current->Data + Arena.Current->Offset;
+
+	Arena.Current->Offset += alignedSize;
+
+	// match Alloc(), callers expect zeroed memory
+	memset(ptr, 0, size);
+
+	Memory.ArenaAllocSize += size;
+
+	++Memory.ArenaAllocCount;
 
 	const ulong index = typeID % MAX_REGISTERED_TYPENAMES;
 
-	++(RegisteredTypeNames[index].Active);
+	++(LocalStatistics()->Active[index]);
+	++(RegisteredTypeNames[index].Arena);
 
 	return ptr;
 }
 
+static void ArenaReset(void)
+{
+	for (struct _arenaBlock* block = Arena.Head; block isnt null; block = block->Next)
+	{
+		block->Offset = 0;
+	}
+
+	Arena.Current = Arena.Head;
+
+	Memory.ArenaAllocSize = 0;
+
+	struct _memoryStatistics* statistics = LocalStatistics();
+
+	// everything handed out this frame is now considered freed for its type
+	for (ulong i = 0; i < MAX_REGISTERED_TYPENAMES; i++)
+	{
+		struct _typeName* typeName = &RegisteredTypeNames[i];
+
+		statistics->Freed[i] += typeName->Arena;
+		typeName->Arena = 0;
+	}
+}
+
+private void GrowPool(struct _memoryPool* pool)
+{
+	const ulong blockCount = max(POOL_SLAB_SIZE / pool->BlockSize, POOL_MINIMUM_BLOCKS_PER_SLAB);
+
+	// the first POOL_ALIGNMENT bytes of every slab store the previous slab so the blocks stay aligned
+	// slabs live for the lifetime of the program so they're deliberately not tracked by AllocCount
+	char* slab = calloc(1, POOL_ALIGNMENT + (blockCount * pool->BlockSize));
+
+	if (slab is null)
+	{
+		throw(OutOfMemoryException);
+	}
+
+	*(void**)slab = pool->Slabs;
+	pool->Slabs = slab;
+	++(pool->SlabCount);
+
+	char* blocks = slab + POOL_ALIGNMENT;
+
+	// thread the new blocks onto the free list in address order so
+	// consecutive allocations are handed out contiguously
+	for (ulong i = blockCount; i > 0; --i)
+	{
+		void* block = blocks + ((i - 1) * pool->BlockSize);
+
+		*(void**)block = pool->FreeList;
+
+		pool->FreeList = block;
+	}
+}
+
+static void* PoolAlloc(ulong size, ulong typeID)
+{
+	if (size is 0)
+	{
+		return null;
+	}
+
+	struct _typeName* typeName = &RegisteredTypeNames[typeID % MAX_REGISTERED_TYPENAMES];
+
+	struct _memoryPool* pool = &typeName->Pool;
+
+	const ulong blockSize = (max(size, sizeof(void*)) + (POOL_ALIGNMENT - 1)) & ~((ulong)POOL_ALIGNMENT - 1);
+
+	if (pool->BlockSize is 0)
+	{
+		pool->BlockSize = blockSize;
+	}
+	else if (pool->BlockSize isnt blockSize)
+	{
+		// pools only ever hand out a single size
+		fprintf(stderr, "Pool for type %s holds blocks of %lli bytes, %lli bytes were requested", typeName->Name, pool->BlockSize, size);
+		throw(TypeMismatchException);
+	}
+
+	if (pool->FreeList is null)
+	{
+		GrowPool(pool);
+	}
+
+	void* ptr = pool->FreeList;
+
+	pool->FreeList = *(void**)ptr;
+
+	// match Alloc(), callers expect zeroed memory
+	memset(ptr, 0, size);
+
+	struct _memoryStatistics* statistics = LocalStatistics();
+
+	statistics->AllocSize += size;
+
+	++(statistics->AllocCount);
+
+	++(statistics->Active[typeID % MAX_REGISTERED_TYPENAMES]);
+
+	return ptr;
+}
+
+static void PoolFree(void* address, ulong typeID)
+{
+	if (address is null)
+	{
+		return;
+	}
+
+	struct _typeName* typeName = &RegisteredTypeNames[typeID % MAX_REGISTERED_TYPENAMES];
+
+	struct _memoryPool* pool = &typeName->Pool;
+
+	// freeing something that was never pooled would corrupt the free list
+	if (pool->BlockSize is 0)
+	{
+		throw(InvalidArgumentException);
+	}
+
+	*(void**)address = pool->FreeList;
+
+	pool->FreeList = address;
+
+	struct _memoryStatistics* statistics = LocalStatistics();
+
+	++(statistics->FreeCount);
+
+	++(statistics->Freed[typeID % MAX_REGISTERED_TYPENAMES]);
+}
+
 static void* SafeAllocAligned(ulong alignment, ulong size, ulong typeID)
 {
 	void* ptr = _aligned_malloc(alignment, size);
@@ -248,13 +595,13 @@ static void* SafeAllocAligned(ulong alignment, ulong size, ulong typeID)
 		throw(OutOfMemoryException);
 	}
 
-	Memory.AllocSize += size;
+	struct _memoryStatistics* statistics = LocalStatistics();
 
-	++Memory.AllocCount;
+	statistics->AllocSize += size;
 
-	const ulong index = typeID % MAX_REGISTERED_TYPENAMES;
+	++(statistics->AllocCount);
 
-	++(RegisteredTypeNames[index].Active);
+	++(statistics->Active[typeID % MAX_REGISTERED_TYPENAMES]);
 
 	return ptr;
 }
@@ -268,11 +615,11 @@ static void SafeFree(void* address, ulong typeID)
 
 	free(address);
 
-	++Memory.FreeCount;
+	struct _memoryStatistics* statistics = LocalStatistics();
 
-	const ulong index = typeID % MAX_REGISTERED_TYPENAMES;
+	++(statistics->FreeCount);
 
-	++(RegisteredTypeNames[index].Freed);
+	++(statistics->Freed[typeID % MAX_REGISTERED_TYPENAMES]);
 }
 
 static bool TryRealloc(void* address, const ulong previousSize, const ulong newSize, void** out_address)
@@ -439,4 +786,358 @@ static char GetByteGrouping(ulong value)
 	// if >= TB return TB
 	return 4;
 #endif
-}
\ No newline at end of file
+}
+
+#include "core/cunit.h"
+
+#define BENCHMARK_ALLOCATION_COUNT 1000000
+
+TEST(ArenaAllocIsAligned)
+{
+	Memory.ArenaReset();
+
+	char* first = Memory.ArenaAlloc(1, Memory.GenericMemoryBlock);
+	char* second = Memory.ArenaAlloc(3, Memory.GenericMemoryBlock);
+	char* third = Memory.ArenaAlloc(ARENA_BLOCK_SIZE * 2, Memory.GenericMemoryBlock);
+
+	NotNull(first);
+	NotNull(second);
+	NotNull(third);
+
+	IsZero((ulong)first % ARENA_ALIGNMENT);
+	IsZero((ulong)second % ARENA_ALIGNMENT);
+	IsZero((ulong)third % ARENA_ALIGNMENT);
+
+	IsTrue(second >= first + ARENA_ALIGNMENT);
+
+	IsNull(Memory.ArenaAlloc(0, Memory.GenericMemoryBlock));
+
+	Memory.ArenaReset();
+
+	// after reset the arena should hand out the same memory again
+	char* reused = Memory.ArenaAlloc(1, Memory.GenericMemoryBlock);
+
+	IsTrue(reused is first);
+
+	Memory.ArenaReset();
+
+	return true;
+}
+
+TEST(ArenaAllocTracksTypes)
+{
+	const ulong index = Memory.GenericMemoryBlock % MAX_REGISTERED_TYPENAMES;
+
+	Memory.ArenaReset();
+
+	ulong previousActive;
+	ulong previousFreed;
+	GetTypeStatistics(index, &previousActive, &previousFreed);
+
+	ulong active;
+	ulong freed;
+
+	for (int i = 0; i < 10; i++)
+	{
+		Memory.ArenaAlloc(sizeof(int), Memory.GenericMemoryBlock);
+	}
+
+	GetTypeStatistics(index, &active, &freed);
+
+	IsEqual(previousActive + 10, active);
+	IsEqual(previousFreed, freed);
+	IsEqual((ulong)(sizeof(int) * 10), Memory.ArenaAllocSize);
+
+	Memory.ArenaReset();
+
+	GetTypeStatistics(index, &active, &freed);
+
+	IsEqual(previousFreed + 10, freed);
+	IsEqual((ulong)0, Memory.ArenaAllocSize);
+
+	return true;
+}
+
+TEST(ArenaAllocBenchmark)
+{
+	static ulong sizes[] = { 16, 48, 64, 128, 24, 256, 32, 8 };
+
+	Memory.ArenaReset();
+
+	fprintf(__test_stream, "\tMemory.Alloc + Memory.Free x%i", BENCHMARK_ALLOCATION_COUNT);
+	Benchmark(
+		for (int i = 0; i < BENCHMARK_ALLOCATION_COUNT; i++)
+		{
+			void* ptr = Memory.Alloc(sizes[i & 7], Memory.GenericMemoryBlock);
+			Memory.Free(ptr, Memory.GenericMemoryBlock);
+		}
+	, __test_stream);
+	fprintf(__test_stream, NEWLINE);
+
+	// the first frame pays for growing the arena, every frame after that reuses the same blocks
+	for (int i = 0; i < BENCHMARK_ALLOCATION_COUNT; i++)
+	{
+		Memory.ArenaAlloc(sizes[i & 7], Memory.GenericMemoryBlock);
+	}
+	Memory.ArenaReset();
+
+	fprintf(__test_stream, "\tMemory.ArenaAlloc x%i", BENCHMARK_ALLOCATION_COUNT);
+	Benchmark(
+		for (int i = 0; i < BENCHMARK_ALLOCATION_COUNT; i++)
+		{
+			Memory.ArenaAlloc(sizes[i & 7], Memory.GenericMemoryBlock);
+		}
+	Memory.ArenaReset();
+	, __test_stream);
+	fprintf(__test_stream, NEWLINE);
+
+	return true;
+}
+
+DEFINE_TYPE_ID(PoolTestStruct);
+
+struct _poolTestStruct {
+	float Matrix[16];
+	ulong Id;
+};
+
+TEST(PoolAllocReusesBlocks)
+{
+	REGISTER_TYPE(PoolTestStruct);
+
+	struct _poolTestStruct* first = Memory.PoolAlloc(sizeof(struct _poolTestStruct), PoolTestStructTypeId);
+	struct _poolTestStruct* second = Memory.PoolAlloc(sizeof(struct _poolTestStruct), PoolTestStructTypeId);
+
+	NotNull(first);
+	NotNull(second);
+
+	IsZero((ulong)first % POOL_ALIGNMENT);
+	IsZero((ulong)second % POOL_ALIGNMENT);
+
+	// consecutive allocations from a fresh slab should be neighbours
+	IsTrue((char*)second - (char*)first is (long long)RegisteredTypeNames[PoolTestStructTypeId % MAX_REGISTERED_TYPENAMES].Pool.BlockSize);
+
+	first->Id = 12;
+
+	Memory.PoolFree(first, PoolTestStructTypeId);
+
+	struct _poolTestStruct* third = Memory.PoolAlloc(sizeof(struct _poolTestStruct), PoolTestStructTypeId);
+
+	// the most recently freed block should be handed out again, zeroed
+	IsTrue(third is first);
+	IsZero(third->Id);
+
+	Memory.PoolFree(second, PoolTestStructTypeId);
+	Memory.PoolFree(third, PoolTestStructTypeId);
+
+	return true;
+}
+
+TEST(PoolAllocTracksTypes)
+{
+	REGISTER_TYPE(PoolTestStruct);
+
+	const ulong index = PoolTestStructTypeId % MAX_REGISTERED_TYPENAMES;
+
+	ulong previousActive;
+	ulong previousFreed;
+	GetTypeStatistics(index, &previousActive, &previousFreed);
+
+	const ulong previousFreeCount = Memory.FreeCount();
+
+	ulong active;
+	ulong freed;
+
+	void* ptr = Memory.PoolAlloc(sizeof(struct _poolTestStruct), PoolTestStructTypeId);
+
+	GetTypeStatistics(index, &active, &freed);
+
+	IsEqual(previousActive + 1, active);
+
+	Memory.PoolFree(ptr, PoolTestStructTypeId);
+
+	GetTypeStatistics(index, &active, &freed);
+
+	IsEqual(previousFreed + 1, freed);
+	IsEqual(previousFreeCount + 1, Memory.FreeCount());
+
+	return true;
+}
+
+TEST(PoolAllocBenchmark)
+{
+	REGISTER_TYPE(PoolTestStruct);
+
+	static struct _poolTestStruct* live[1024];
+
+	fprintf(__test_stream, "\tMemory.Alloc + Memory.Free x%i", BENCHMARK_ALLOCATION_COUNT);
+	Benchmark(
+		for (int i = 0; i < BENCHMARK_ALLOCATION_COUNT; i += 1024)
+		{
+			for (int j = 0; j < 1024; j++)
+			{
+				live[j] = Memory.Alloc(sizeof(struct _poolTestStruct), PoolTestStructTypeId);
+			}
+			for (int j = 0; j < 1024; j++)
+			{
+				Memory.Free(live[j], PoolTestStructTypeId);
+			}
+		}
+	, __test_stream);
+	fprintf(__test_stream, NEWLINE);
+
+	fprintf(__test_stream, "\tMemory.PoolAlloc + Memory.PoolFree x%i", BENCHMARK_ALLOCATION_COUNT);
+	Benchmark(
+		for (int i = 0; i < BENCHMARK_ALLOCATION_COUNT; i += 1024)
+		{
+			for (int j = 0; j < 1024; j++)
+			{
+				live[j] = Memory.PoolAlloc(sizeof(struct _poolTestStruct), PoolTestStructTypeId);
+			}
+			for (int j = 0; j < 1024; j++)
+			{
+				Memory.PoolFree(live[j], PoolTestStructTypeId);
+			}
+		}
+	, __test_stream);
+	fprintf(__test_stream, NEWLINE);
+
+	return true;
+}
+
+#define STRESS_THREAD_COUNT 8
+#define STRESS_ALLOCATIONS_PER_THREAD 100000
+
+DEFINE_TYPE_ID(StressTestBlock);
+
+struct _stressTestState {
+	// threads spin until this is set so every thread hammers the counters at the same time
+	volatile ulong Started;
+	// the number of threads that have finished their allocations
+	volatile ulong Finished;
+};
+
+private void AllocateAndFreeOnThread(void* state)
+{
+	struct _stressTestState* stressState = state;
+
+	while (stressState->Started is false)
+	{
+		SpinWait();
+	}
+
+	// every thread registers the same type at the same time to exercise the lock free insert
+	ulong typeId = 0;
+	Memory.RegisterTypeName(nameof(StressTestBlock), &typeId);
+
+	if (typeId isnt StressTestBlockTypeId)
+	{
+		throw(InvalidLogicException);
+	}
+
+	for (int i = 0; i < STRESS_ALLOCATIONS_PER_THREAD; i++)
+	{
+		void* ptr = Memory.Alloc(16, typeId);
+		Memory.Free(ptr, typeId);
+	}
+
+	AtomicIncrement(stressState->Finished);
+}
+
+TEST(StatisticsAreExactAcrossThreads)
+{
+	REGISTER_TYPE(StressTestBlock);
+
+	const ulong index = StressTestBlockTypeId % MAX_REGISTERED_TYPENAMES;
+
+	struct _stressTestState state = {
+		.Started = false,
+		.Finished = 0
+	};
+
+	Thread threads[STRESS_THREAD_COUNT];
+
+	for (int i = 0; i < STRESS_THREAD_COUNT; i++)
+	{
+		threads[i] = Threads.Start(AllocateAndFreeOnThread, &state);
+	}
+
+	// snapshot after the threads are created so the thread's own allocations aren't counted
+	const ulong previousAllocCount = Memory.AllocCount();
+	const ulong previousFreeCount = Memory.FreeCount();
+	const ulong previousAllocSize = Memory.AllocSize();
+
+	ulong previousActive;
+	ulong previousFreed;
+	GetTypeStatistics(index, &previousActive, &previousFreed);
+
+	AtomicExchange(state.Started, true);
+
+	while (state.Finished isnt STRESS_THREAD_COUNT)
+	{
+		SpinWait();
+	}
+
+	const ulong expected = STRESS_THREAD_COUNT * STRESS_ALLOCATIONS_PER_THREAD;
+
+	ulong active;
+	ulong freed;
+	GetTypeStatistics(index, &active, &freed);
+
+	IsEqual(previousAllocCount + expected, Memory.AllocCount());
+	IsEqual(previousFreeCount + expected, Memory.FreeCount());
+	IsEqual(previousAllocSize + (expected * 16), Memory.AllocSize());
+	IsEqual(previousActive + expected, active);
+	IsEqual(previousFreed + expected, freed);
+
+	for (int i = 0; i < STRESS_THREAD_COUNT; i++)
+	{
+		Threads.Join(threads[i]);
+	}
+
+	return true;
+}
+
+static void* volatile CallocBenchmarkSink;
+
+TEST(SingleThreadedAllocBenchmark)
+{
+	REGISTER_TYPE(StressTestBlock);
+
+	const ulong expected = STRESS_THREAD_COUNT * STRESS_ALLOCATIONS_PER_THREAD;
+
+	fprintf(__test_stream, "\tMemory.Alloc + Memory.Free x%lli", expected);
+	Benchmark(
+		for (ulong i = 0; i < expected; i++)
+		{
+			void* ptr = Memory.Alloc(16, StressTestBlockTypeId);
+			Memory.Free(ptr, StressTestBlockTypeId);
+		}
+	, __test_stream);
+	fprintf(__test_stream, NEWLINE);
+
+	fprintf(__test_stream, "\tcalloc + free x%lli", expected);
+	Benchmark(
+		for (ulong i = 0; i < expected; i++)
+		{
+			// write through a volatile so the optimizer can't elide the pair
+			CallocBenchmarkSink = calloc(1, 16);
+			free(CallocBenchmarkSink);
+		}
+	, __test_stream);
+	fprintf(__test_stream, NEWLINE);
+
+	return true;
+}
+
+TEST_SUITE(
+	RunUnitTests,
+	APPEND_TEST(ArenaAllocIsAligned)
+	APPEND_TEST(ArenaAllocTracksTypes)
+	APPEND_TEST(ArenaAllocBenchmark)
+	APPEND_TEST(PoolAllocReusesBlocks)
+	APPEND_TEST(PoolAllocTracksTypes)
+	APPEND_TEST(PoolAllocBenchmark)
+	APPEND_TEST(StatisticsAreExactAcrossThreads)
+	APPEND_TEST(SingleThreadedAllocBenchmark)
+);
\ No newline at end of file
@@ -42,49 +42,54 @@ static char* ValidFalseBooleans[] = {
 	"DISABLED"
 };
 
-private bool TryParseBoolean(const char* buffer, const ulong bufferLength, bool* out_bool)
-{
-	*out_bool = false;
+// the longest word in either list
+#define MAX_BOOLEAN_LENGTH 8
 
-	char copiedString[11];
-
-	copiedString[10] = '\0';
+private bool MatchesAny(const char* word, const ulong length, char** words, const ulong count)
+{
+	for (ulong i = 0; i < count; i++)
+	{
+		if (strlen(words[i]) is length and memcmp(word, words[i], length) is 0)
+		{
+			return true;
+		}
+	}
 
-	sscanf_s(buffer, "%10s", &copiedString, 10);
+	return false;
+}
 
-	ulong length = strlen(copiedString) - 1;
+private bool TryParseBoolean(const char* buffer, const ulong bufferLength, bool* out_bool)
+{
+	*out_bool = false;
 
-	bool parsed = false;
+	ulong index = 0;
+	while (index < bufferLength and isspace((unsigned char)buffer[index]))
+	{
+		++index;
+	}
 
-	Strings.ToUpper(copiedString, strlen(copiedString), 0);
+	// only the first word is compared, upper cased so the comparison ignores case
+	char word[MAX_BOOLEAN_LENGTH];
+	ulong length = 0;
 
-	// this is probably platform dependent, 
-	// this assumes the size of a pointer address is the same size as ulong
-	// on this architexture (amdx64) ptrs are x64 and so is the size of the DWORD
-	for (ulong i = 0; i < (sizeof(ValidTrueBooleans) / sizeof(ulong)); i++)
+	for (; index < bufferLength and buffer[index] isnt '\0' and isspace((unsigned char)buffer[index]) is false; ++index)
 	{
-		if (memcmp(copiedString, ValidTrueBooleans[i], min(length, bufferLength)) is 0)
+		// anything longer than the longest valid word can't be one
+		if (length is MAX_BOOLEAN_LENGTH)
 		{
-			parsed = true;
-			*out_bool = true;
-			break;
+			return false;
 		}
+
+		word[length++] = (char)toupper((unsigned char)buffer[index]);
 	}
 
-	if (parsed is false)
+	if (MatchesAny(word, length, ValidTrueBooleans, sizeof(ValidTrueBooleans) / sizeof(char*)))
 	{
-		for (ulong i = 0; i < (sizeof(ValidFalseBooleans) / sizeof(ulong)); i++)
-		{
-			if (memcmp(copiedString, ValidFalseBooleans[i], min(length, bufferLength)) is 0)
-			{
-				parsed = true;
-				*out_bool = false;
-				break;
-			}
-		}
+		*out_bool = true;
+		return true;
 	}
 
-	return parsed;
+	return MatchesAny(word, length, ValidFalseBooleans, sizeof(ValidFalseBooleans) / sizeof(char*));
 }
 
 private bool TryParseLine(const char* buffer, const ulong bufferLength, const ulong maxStringLength, char** out_string)
@@ -299,13 +304,20 @@ TEST(Test_TryParseBoolean)
 	Test_Helper_TryParseBoolean(__test_stream, "9", false, false);
 	Test_Helper_TryParseBoolean(__test_stream, "23928398239283", false, false);
 
+	// surrounding whitespace is ignored but the whole word has to match
+	Test_Helper_TryParseBoolean(__test_stream, " on\r\n", true, true);
+	Test_Helper_TryParseBoolean(__test_stream, "\tDisabled ", true, false);
+	Test_Helper_TryParseBoolean(__test_stream, "truest", false, false);
+	Test_Helper_TryParseBoolean(__test_stream, "N", true, false);
+	Test_Helper_TryParseBoolean(__test_stream, "", false, false);
+
 	return true;
 }
 
 TEST(Test_TryParseStringArray)
 {
-	Memory.AllocCount = 0;
-	Memory.AllocSize = 0;
+	const ulong previousAllocCount = Memory.AllocCount();
+	const ulong previousFreeCount = Memory.FreeCount();
 
 	char* data = "this, should, be a, string, array";
 	ulong dataLength = strlen(data);
@@ -362,7 +374,7 @@ TEST(Test_TryParseStringArray)
 	Memory.Free(strings, Memory.String);
 
 	// ensure no memory leak
-	Assert(Memory.AllocCount <= Memory.FreeCount);
+	Assert(Memory.AllocCount() - previousAllocCount <= Memory.FreeCount() - previousFreeCount);
 
 	return true;
 }
@@ -0,0 +1,359 @@
+#include "core/math/quantization.h"
+#include "core/cunit.h"
+#include <math.h>
+#include <string.h>
+
+private octahedral EncodeOctahedral(vector3 normal);
+private vector3 DecodeOctahedral(octahedral encoded);
+private ushort FloatToHalf(float value);
+private float HalfToFloat(ushort value);
+private ushort EncodeUnorm16(float value);
+private float DecodeUnorm16(ushort value);
+private void RunUnitTests(void);
+
+const struct _quantizationMethods Quantization = {
+	.EncodeOctahedral = &EncodeOctahedral,
+	.DecodeOctahedral = &DecodeOctahedral,
+	.FloatToHalf = &FloatToHalf,
+	.HalfToFloat = &HalfToFloat,
+	.EncodeUnorm16 = &EncodeUnorm16,
+	.DecodeUnorm16 = &DecodeUnorm16,
+	.RunUnitTests = &RunUnitTests
+};
+
+// the largest value of a normalized 16 bit signed integer, -32768 decodes to -1.0 as well
+#define SNORM16_MAX 32767.0f
+#define UNORM16_MAX 65535.0f
+
+private float SignNotZero(float value)
+{
+	return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+private float DecodeSnorm16(short value)
+{
+	return max((float)value / SNORM16_MAX, -1.0f);
+}
+
+private vector3 DecodeOctahedral(octahedral encoded)
+{
+	float x = DecodeSnorm16(encoded.x);
+	float y = DecodeSnorm16(encoded.y);
+
+	const float z = 1.0f - fabsf(x) - fabsf(y);
+
+	// the lower half of the octahedron was folded over the diagonals of the square, unfold it
+	const float fold = max(-z, 0.0f);
+
+	x += x >= 0.0f ? -fold : fold;
+	y += y >= 0.0f ? -fold : fold;
+
+	const float length = sqrtf((x * x) + (y * y) + (z * z));
+
+	return (vector3) { x / length, y / length, z / length };
+}
+
+private octahedral EncodeOctahedral(vector3 normal)
+{
+	const float sum = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+
+	if (sum is 0.0f)
+	{
+		return (octahedral) { 0, 0 };
+	}
+
+	float x = normal.x / sum;
+	float y = normal.y / sum;
+
+	if (normal.z < 0.0f)
+	{
+		const float foldedX = (1.0f - fabsf(y)) * SignNotZero(x);
+		const float foldedY = (1.0f - fabsf(x)) * SignNotZero(y);
+
+		x = foldedX;
+		y = foldedY;
+	}
+
+	const float length = sqrtf((normal.x * normal.x) + (normal.y * normal.y) + (normal.z * normal.z));
+	const vector3 unit = { normal.x / length, normal.y / length, normal.z / length };
+
+	const float lowerX = floorf(x * SNORM16_MAX);
+	const float lowerY = floorf(y * SNORM16_MAX);
+
+	// rounding each component on its own isn't always closest once the vector is normalized, try all four neighbors
+	octahedral best = { 0, 0 };
+	float bestDot = -2.0f;
+
+	for (int i = 0; i < 4; i++)
+	{
+		const octahedral candidate = {
+			(short)min(lowerX + (float)(i & 1), SNORM16_MAX),
+			(short)min(lowerY + (float)(i >> 1), SNORM16_MAX)
+		};
+
+		const vector3 decoded = DecodeOctahedral(candidate);
+
+		const float dot = (decoded.x * unit.x) + (decoded.y * unit.y) + (decoded.z * unit.z);
+
+		if (dot > bestDot)
+		{
+			best = candidate;
+			bestDot = dot;
+		}
+	}
+
+	return best;
+}
+
+private ushort FloatToHalf(float value)
+{
+	uint bits;
+	memcpy(&bits, &value, sizeof(uint));
+
+	const uint sign = (bits >> 16) & 0x8000;
+	const uint magnitude = bits & 0x7FFFFFFF;
+
+	// nan stays a quiet nan
+	if (magnitude > 0x7F800000)
+	{
+		return (ushort)(sign | 0x7E00);
+	}
+
+	// 65520 is halfway between the largest half and the next power of two, it and everything above rounds to infinity
+	if (magnitude >= 0x477FF000)
+	{
+		return (ushort)(sign | 0x7C00);
+	}
+
+	// the largest float that is still closer to 0 than to the smallest subnormal half, 2^-25 ties to zero which is even
+	if (magnitude <= 0x33000000)
+	{
+		return (ushort)sign;
+	}
+
+	// below 2^-14 halves are subnormal and count in steps of 2^-24
+	if (magnitude < 0x38800000)
+	{
+		const uint exponent = magnitude >> 23;
+		const uint mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+		const uint shift = 126 - exponent;
+
+		uint result = mantissa >> shift;
+
+		const uint remainder = mantissa & ((1u << shift) - 1);
+		const uint halfway = 1u << (shift - 1);
+
+		if (remainder > halfway or (remainder is halfway and (result & 1)))
+		{
+			++result;
+		}
+
+		return (ushort)(sign | result);
+	}
+
+	// rebias the exponent from 127 to 15 and drop 13 bits of mantissa, rounding may carry into the exponent which is
+	// still the right answer
+	uint result = (magnitude - 0x38000000) >> 13;
+
+	const uint remainder = magnitude & 0x1FFF;
+
+	if (remainder > 0x1000 or (remainder is 0x1000 and (result & 1)))
+	{
+		++result;
+	}
+
+	return (ushort)(sign | result);
+}
+
+private float HalfToFloat(ushort value)
+{
+	const uint sign = (uint)(value & 0x8000) << 16;
+	const uint exponent = (value >> 10) & 0x1F;
+	const uint mantissa = value & 0x3FF;
+
+	uint bits;
+
+	if (exponent is 0x1F)
+	{
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else if (exponent isnt 0)
+	{
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	else
+	{
+		// subnormals are exact in a float, 2^-24 per step
+		const float magnitude = (float)mantissa * 5.9604644775390625e-8f;
+
+		return sign ? -magnitude : magnitude;
+	}
+
+	float result;
+	memcpy(&result, &bits, sizeof(float));
+
+	return result;
+}
+
+private ushort EncodeUnorm16(float value)
+{
+	return (ushort)((min(max(value, 0.0f), 1.0f) * UNORM16_MAX) + 0.5f);
+}
+
+private float DecodeUnorm16(ushort value)
+{
+	return (float)value / UNORM16_MAX;
+}
+
+// the angle between two unit vectors, atan2 stays accurate for the tiny angles acos can't resolve
+private double AngleBetween(const vector3 left, const vector3 right)
+{
+	const double cx = ((double)left.y * right.z) - ((double)left.z * right.y);
+	const double cy = ((double)left.z * right.x) - ((double)left.x * right.z);
+	const double cz = ((double)left.x * right.y) - ((double)left.y * right.x);
+
+	const double dot = ((double)left.x * right.x) + ((double)left.y * right.y) + ((double)left.z * right.z);
+
+	return atan2(sqrt((cx * cx) + (cy * cy) + (cz * cz)), dot);
+}
+
+TEST(OctahedralErrorIsBounded)
+{
+	// every axis, diagonal and edge of the octahedron, where the folds meet
+	const vector3 edges[] = {
+		{ 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 },
+		{ 1, 1, 0 }, { -1, 1, 0 }, { 1, -1, 0 }, { -1, -1, 0 },
+		{ 1, 1, 1 }, { -1, -1, -1 }, { 1, -1, -1 }, { -1, 1, -1 }
+	};
+
+	double largest = 0.0;
+
+	for (ulong i = 0; i < sizeof(edges) / sizeof(vector3); i++)
+	{
+		const vector3 edge = edges[i];
+		const float length = sqrtf((edge.x * edge.x) + (edge.y * edge.y) + (edge.z * edge.z));
+		const vector3 unit = { edge.x / length, edge.y / length, edge.z / length };
+
+		largest = max(largest, AngleBetween(unit, DecodeOctahedral(EncodeOctahedral(unit))));
+	}
+
+	// points spread evenly over the sphere
+	const ulong count = 200000;
+	const double goldenAngle = 2.39996322972865332;
+
+	for (ulong i = 0; i < count; i++)
+	{
+		const double z = 1.0 - (2.0 * ((double)i + 0.5) / (double)count);
+		const double radius = sqrt(1.0 - (z * z));
+		const double angle = goldenAngle * (double)i;
+
+		const vector3 unit = { (float)(radius * cos(angle)), (float)(radius * sin(angle)), (float)z };
+
+		largest = max(largest, AngleBetween(unit, DecodeOctahedral(EncodeOctahedral(unit))));
+	}
+
+	fprintf(__test_stream, "\tlargest octahedral error %e radians"NEWLINE, largest);
+
+	IsTrue(largest <= MAX_OCTAHEDRAL_ERROR);
+
+	// normals don't have to be normalized to be encoded
+	const vector3 decoded = DecodeOctahedral(EncodeOctahedral((vector3) { 0, 0, -4.0f }));
+
+	IsTrue(AngleBetween(decoded, (vector3) { 0, 0, -1.0f }) <= MAX_OCTAHEDRAL_ERROR);
+
+	return true;
+}
+
+TEST(HalvesRoundTrip)
+{
+	// every half survives the trip through a float, nans only have to stay nans
+	for (uint i = 0; i <= 0xFFFF; i++)
+	{
+		const ushort half = (ushort)i;
+		const float value = HalfToFloat(half);
+
+		if (value != value)
+		{
+			IsTrue((FloatToHalf(value) & 0x7C00) is 0x7C00 and (FloatToHalf(value) & 0x3FF) isnt 0);
+			continue;
+		}
+
+		if (FloatToHalf(value) isnt half)
+		{
+			IsEqual((uint)half, (uint)FloatToHalf(value));
+		}
+	}
+
+	IsEqual(65504.0f, HalfToFloat(0x7BFF));
+	IsEqual((uint)0x7BFF, (uint)FloatToHalf(65519.0f));
+	IsEqual((uint)0x7C00, (uint)FloatToHalf(65520.0f));
+	IsEqual((uint)0xFC00, (uint)FloatToHalf(-1e10f));
+	IsEqual((uint)0x0001, (uint)FloatToHalf(5.9604644775390625e-8f));
+	IsEqual((uint)0x0000, (uint)FloatToHalf(2.98023223876953125e-8f));
+	IsEqual((uint)0x8000, (uint)FloatToHalf(-1e-10f));
+
+	// every other float rounds to the nearest half, ties to even
+	ulong state = 7;
+
+	for (ulong i = 0; i < 1000000; i++)
+	{
+		state = (state * 6364136223846793005ull) + 1442695040888963407ull;
+
+		uint bits = (uint)(state >> 32) & 0x7FFFFFFF;
+
+		// only finite values below the largest half
+		bits %= 0x477FE000;
+
+		float value;
+		memcpy(&value, &bits, sizeof(float));
+
+		const ushort half = FloatToHalf(value);
+
+		const double nearest = HalfToFloat(half);
+		const double below = half > 0 ? HalfToFloat(half - 1) : -1.0;
+		const double above = HalfToFloat(half + 1);
+
+		const double error = fabs((double)value - nearest);
+
+		if (error > fabs((double)value - below) or error > fabs((double)value - above))
+		{
+			IsTrue(false);
+		}
+
+		// ties go to the even neighbor
+		if ((error == fabs((double)value - below) or error == fabs((double)value - above)) and error isnt 0.0)
+		{
+			IsEqual(0u, (uint)(half & 1));
+		}
+	}
+
+	return true;
+}
+
+TEST(Unorm16ErrorIsBounded)
+{
+	float largest = 0.0f;
+
+	for (ulong i = 0; i <= 1000000; i++)
+	{
+		const float value = (float)i / 1000000.0f;
+
+		largest = max(largest, fabsf(DecodeUnorm16(EncodeUnorm16(value)) - value));
+	}
+
+	// half a step, with room for the rounding of the float itself
+	IsTrue(largest <= (0.5f / UNORM16_MAX) + 1e-7f);
+
+	IsEqual((uint)0, (uint)EncodeUnorm16(-0.5f));
+	IsEqual((uint)65535, (uint)EncodeUnorm16(1.5f));
+	IsEqual(1.0f, DecodeUnorm16(65535));
+
+	return true;
+}
+
+TEST_SUITE(
+	RunUnitTests,
+	APPEND_TEST(OctahedralErrorIsBounded)
+	APPEND_TEST(HalvesRoundTrip)
+	APPEND_TEST(Unorm16ErrorIsBounded)
+);
@@ -0,0 +1,1127 @@
+#include "core/scanning.h"
+#include "core/math/ints.h"
+#include "core/cunit.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <intrin.h>
+#endif
+
+// Floats are read with the Eisel-Lemire algorithm: the first 19 significant digits are multiplied by a 128-bit
+// truncated power of five and the top bits of the product are the float's mantissa. The product is always close
+// enough to round correctly when every digit fit in those 19 (Mushtak and Lemire, "Fast Number Parsing Without
+// Fallback"), when there are more digits the value is compared exactly against the halfway point between the
+// two floats it could round to with a small big integer instead.
+
+private bool TryScanFloat(const char** cursor, const char* end, float* out_value);
+private bool TryScanInteger(const char** cursor, const char* end, long long* out_value);
+private bool TryScanHex(const char** cursor, const char* end, ulong* out_value);
+private void RunUnitTests(void);
+private void RunBenchmarks(void);
+
+const struct _scanningMethods Scanning = {
+	.TryScanFloat = &TryScanFloat,
+	.TryScanInteger = &TryScanInteger,
+	.TryScanHex = &TryScanHex,
+	.RunUnitTests = &RunUnitTests,
+	.RunBenchmarks = &RunBenchmarks
+};
+
+#define FLOAT_MANTISSA_BITS 23
+#define FLOAT_EXPONENT_BIAS 127
+#define FLOAT_INFINITE_POWER 0xFF
+#define FLOAT_SIGN_BIT 0x80000000u
+#define FLOAT_QUIET_NAN 0x7FC00000u
+
+// decimal exponents outside of this range are always zero or infinity for a 19 digit mantissa
+#define SMALLEST_POWER_OF_TEN -65
+#define LARGEST_POWER_OF_TEN 38
+
+// only these exponents can produce a product that is exactly halfway between two floats
+#define MIN_EXPONENT_ROUND_TO_EVEN -17
+#define MAX_EXPONENT_ROUND_TO_EVEN 10
+
+// the number of significant decimal digits that always fit within a ulong
+#define MAX_MANTISSA_DIGITS 19
+#define MIN_NINETEEN_DIGIT_INTEGER 1000000000000000000ull
+
+// the most significant digits that can matter when rounding to a float, any digits after these only break ties
+#define MAX_SIGNIFICANT_DIGITS 114
+
+// exponents with more digits than this over or underflow a float anyway
+#define MAX_EXPLICIT_EXPONENT 100000
+
+// 5^q for q in [SMALLEST_POWER_OF_TEN, LARGEST_POWER_OF_TEN] shifted so the top bit is set and truncated to 128 bits,
+// negative powers are rounded up
+static const ulong PowersOfFive[LARGEST_POWER_OF_TEN - SMALLEST_POWER_OF_TEN + 1][2] = {
+	{ 0x86CCBB52EA94BAEAull, 0x98E947129FC2B4E9ull },
+	{ 0xA87FEA27A539E9A5ull, 0x3F2398D747B36224ull },
+	{ 0xD29FE4B18E88640Eull, 0x8EEC7F0D19A03AADull },
+	{ 0x83A3EEEEF9153E89ull, 0x1953CF68300424ACull },
+	{ 0xA48CEAAAB75A8E2Bull, 0x5FA8C3423C052DD7ull },
+	{ 0xCDB02555653131B6ull, 0x3792F412CB06794Dull },
+	{ 0x808E17555F3EBF11ull, 0xE2BBD88BBEE40BD0ull },
+	{ 0xA0B19D2AB70E6ED6ull, 0x5B6ACEAEAE9D0EC4ull },
+	{ 0xC8DE047564D20A8Bull, 0xF245825A5A445275ull },
+	{ 0xFB158592BE068D2Eull, 0xEED6E2F0F0D56712ull },
+	{ 0x9CED737BB6C4183Dull, 0x55464DD69685606Bull },
+	{ 0xC428D05AA4751E4Cull, 0xAA97E14C3C26B886ull },
+	{ 0xF53304714D9265DFull, 0xD53DD99F4B3066A8ull },
+	{ 0x993FE2C6D07B7FABull, 0xE546A8038EFE4029ull },
+	{ 0xBF8FDB78849A5F96ull, 0xDE98520472BDD033ull },
+	{ 0xEF73D256A5C0F77Cull, 0x963E66858F6D4440ull },
+	{ 0x95A8637627989AADull, 0xDDE7001379A44AA8ull },
+	{ 0xBB127C53B17EC159ull, 0x5560C018580D5D52ull },
+	{ 0xE9D71B689DDE71AFull, 0xAAB8F01E6E10B4A6ull },
+	{ 0x9226712162AB070Dull, 0xCAB3961304CA70E8ull },
+	{ 0xB6B00D69BB55C8D1ull, 0x3D607B97C5FD0D22ull },
+	{ 0xE45C10C42A2B3B05ull, 0x8CB89A7DB77C506Aull },
+	{ 0x8EB98A7A9A5B04E3ull, 0x77F3608E92ADB242ull },
+	{ 0xB267ED1940F1C61Cull, 0x55F038B237591ED3ull },
+	{ 0xDF01E85F912E37A3ull, 0x6B6C46DEC52F6688ull },
+	{ 0x8B61313BBABCE2C6ull, 0x2323AC4B3B3DA015ull },
+	{ 0xAE397D8AA96C1B77ull, 0xABEC975E0A0D081Aull },
+	{ 0xD9C7DCED53C72255ull, 0x96E7BD358C904A21ull },
+	{ 0x881CEA14545C7575ull, 0x7E50D64177DA2E54ull },
+	{ 0xAA242499697392D2ull, 0xDDE50BD1D5D0B9E9ull },
+	{ 0xD4AD2DBFC3D07787ull, 0x955E4EC64B44E864ull },
+	{ 0x84EC3C97DA624AB4ull, 0xBD5AF13BEF0B113Eull },
+	{ 0xA6274BBDD0FADD61ull, 0xECB1AD8AEACDD58Eull },
+	{ 0xCFB11EAD453994BAull, 0x67DE18EDA5814AF2ull },
+	{ 0x81CEB32C4B43FCF4ull, 0x80EACF948770CED7ull },
+	{ 0xA2425FF75E14FC31ull, 0xA1258379A94D028Dull },
+	{ 0xCAD2F7F5359A3B3Eull, 0x096EE45813A04330ull },
+	{ 0xFD87B5F28300CA0Dull, 0x8BCA9D6E188853FCull },
+	{ 0x9E74D1B791E07E48ull, 0x775EA264CF55347Eull },
+	{ 0xC612062576589DDAull, 0x95364AFE032A819Eull },
+	{ 0xF79687AED3EEC551ull, 0x3A83DDBD83F52205ull },
+	{ 0x9ABE14CD44753B52ull, 0xC4926A9672793543ull },
+	{ 0xC16D9A0095928A27ull, 0x75B7053C0F178294ull },
+	{ 0xF1C90080BAF72CB1ull, 0x5324C68B12DD6339ull },
+	{ 0x971DA05074DA7BEEull, 0xD3F6FC16EBCA5E04ull },
+	{ 0xBCE5086492111AEAull, 0x88F4BB1CA6BCF585ull },
+	{ 0xEC1E4A7DB69561A5ull, 0x2B31E9E3D06C32E6ull },
+	{ 0x9392EE8E921D5D07ull, 0x3AFF322E62439FD0ull },
+	{ 0xB877AA3236A4B449ull, 0x09BEFEB9FAD487C3ull },
+	{ 0xE69594BEC44DE15Bull, 0x4C2EBE687989A9B4ull },
+	{ 0x901D7CF73AB0ACD9ull, 0x0F9D37014BF60A11ull },
+	{ 0xB424DC35095CD80Full, 0x538484C19EF38C95ull },
+	{ 0xE12E13424BB40E13ull, 0x2865A5F206B06FBAull },
+	{ 0x8CBCCC096F5088CBull, 0xF93F87B7442E45D4ull },
+	{ 0xAFEBFF0BCB24AAFEull, 0xF78F69A51539D749ull },
+	{ 0xDBE6FECEBDEDD5BEull, 0xB573440E5A884D1Cull },
+	{ 0x89705F4136B4A597ull, 0x31680A88F8953031ull },
+	{ 0xABCC77118461CEFCull, 0xFDC20D2B36BA7C3Eull },
+	{ 0xD6BF94D5E57A42BCull, 0x3D32907604691B4Dull },
+	{ 0x8637BD05AF6C69B5ull, 0xA63F9A49C2C1B110ull },
+	{ 0xA7C5AC471B478423ull, 0x0FCF80DC33721D54ull },
+	{ 0xD1B71758E219652Bull, 0xD3C36113404EA4A9ull },
+	{ 0x83126E978D4FDF3Bull, 0x645A1CAC083126EAull },
+	{ 0xA3D70A3D70A3D70Aull, 0x3D70A3D70A3D70A4ull },
+	{ 0xCCCCCCCCCCCCCCCCull, 0xCCCCCCCCCCCCCCCDull },
+	{ 0x8000000000000000ull, 0x0000000000000000ull },
+	{ 0xA000000000000000ull, 0x0000000000000000ull },
+	{ 0xC800000000000000ull, 0x0000000000000000ull },
+	{ 0xFA00000000000000ull, 0x0000000000000000ull },
+	{ 0x9C40000000000000ull, 0x0000000000000000ull },
+	{ 0xC350000000000000ull, 0x0000000000000000ull },
+	{ 0xF424000000000000ull, 0x0000000000000000ull },
+	{ 0x9896800000000000ull, 0x0000000000000000ull },
+	{ 0xBEBC200000000000ull, 0x0000000000000000ull },
+	{ 0xEE6B280000000000ull, 0x0000000000000000ull },
+	{ 0x9502F90000000000ull, 0x0000000000000000ull },
+	{ 0xBA43B74000000000ull, 0x0000000000000000ull },
+	{ 0xE8D4A51000000000ull, 0x0000000000000000ull },
+	{ 0x9184E72A00000000ull, 0x0000000000000000ull },
+	{ 0xB5E620F480000000ull, 0x0000000000000000ull },
+	{ 0xE35FA931A0000000ull, 0x0000000000000000ull },
+	{ 0x8E1BC9BF04000000ull, 0x0000000000000000ull },
+	{ 0xB1A2BC2EC5000000ull, 0x0000000000000000ull },
+	{ 0xDE0B6B3A76400000ull, 0x0000000000000000ull },
+	{ 0x8AC7230489E80000ull, 0x0000000000000000ull },
+	{ 0xAD78EBC5AC620000ull, 0x0000000000000000ull },
+	{ 0xD8D726B7177A8000ull, 0x0000000000000000ull },
+	{ 0x878678326EAC9000ull, 0x0000000000000000ull },
+	{ 0xA968163F0A57B400ull, 0x0000000000000000ull },
+	{ 0xD3C21BCECCEDA100ull, 0x0000000000000000ull },
+	{ 0x84595161401484A0ull, 0x0000000000000000ull },
+	{ 0xA56FA5B99019A5C8ull, 0x0000000000000000ull },
+	{ 0xCECB8F27F4200F3Aull, 0x0000000000000000ull },
+	{ 0x813F3978F8940984ull, 0x4000000000000000ull },
+	{ 0xA18F07D736B90BE5ull, 0x5000000000000000ull },
+	{ 0xC9F2C9CD04674EDEull, 0xA400000000000000ull },
+	{ 0xFC6F7C4045812296ull, 0x4D00000000000000ull },
+	{ 0x9DC5ADA82B70B59Dull, 0xF020000000000000ull },
+	{ 0xC5371912364CE305ull, 0x6C28000000000000ull },
+	{ 0xF684DF56C3E01BC6ull, 0xC732000000000000ull },
+	{ 0x9A130B963A6C115Cull, 0x3C7F400000000000ull },
+	{ 0xC097CE7BC90715B3ull, 0x4B9F100000000000ull },
+	{ 0xF0BDC21ABB48DB20ull, 0x1E86D40000000000ull },
+	{ 0x96769950B50D88F4ull, 0x1314448000000000ull }
+};
+
+// every one of these is exact so multiplying or dividing a small enough mantissa by them rounds only once
+static const float FloatPowersOfTen[] = {
+	1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+#define MAX_EXACT_FLOAT_POWER_OF_TEN 10
+#define MAX_EXACT_FLOAT_INTEGER (1ull << 24)
+
+typedef struct _decimal decimal;
+
+// a number as it was written, value = Mantissa * 10^Exponent unless Truncated is set
+struct _decimal {
+	ulong Mantissa;
+	long long Exponent;
+	bool Negative;
+	// set when there were more than 19 significant digits, Mantissa only holds the first 19 of them
+	bool Truncated;
+	const char* Integer;
+	ulong IntegerLength;
+	const char* Fraction;
+	ulong FractionLength;
+	long long ExplicitExponent;
+};
+
+private bool IsDigit(char c)
+{
+	return (unsigned char)(c - '0') < 10;
+}
+
+private bool IsWhitespace(char c)
+{
+	return c is ' ' or (unsigned char)(c - '\t') <= ('\r' - '\t');
+}
+
+private const char* SkipWhitespace(const char* cursor, const char* end)
+{
+	while (cursor < end and IsWhitespace(*cursor))
+	{
+		++cursor;
+	}
+
+	return cursor;
+}
+
+private int CountLeadingZeros(ulong value)
+{
+#ifdef _WIN32
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+
+	return 63 - (int)index;
+#else
+	return __builtin_clzll(value);
+#endif
+}
+
+struct _product {
+	ulong High;
+	ulong Low;
+};
+
+private struct _product MultiplyFull(ulong left, ulong right)
+{
+	struct _product result;
+
+#ifdef _WIN32
+	result.Low = _umul128(left, right, &result.High);
+#else
+	const unsigned __int128 product = (unsigned __int128)left * right;
+
+	result.High = (ulong)(product >> 64);
+	result.Low = (ulong)product;
+#endif
+
+	return result;
+}
+
+// Eisel-Lemire, returns the bits of the positive float nearest to mantissa * 10^exponent
+private unsigned int ComputeFloatBits(long long exponent, ulong mantissa)
+{
+	if (mantissa is 0 or exponent < SMALLEST_POWER_OF_TEN)
+	{
+		return 0;
+	}
+
+	if (exponent > LARGEST_POWER_OF_TEN)
+	{
+		return FLOAT_INFINITE_POWER << FLOAT_MANTISSA_BITS;
+	}
+
+	const int leadingZeros = CountLeadingZeros(mantissa);
+	mantissa <<= leadingZeros;
+
+	const ulong* powerOfFive = PowersOfFive[exponent - SMALLEST_POWER_OF_TEN];
+
+	// only the top bits of the product end up in the float, the low half of the power only matters
+	// when those bits could still carry
+	const ulong precisionMask = 0xFFFFFFFFFFFFFFFFull >> (FLOAT_MANTISSA_BITS + 3);
+
+	struct _product product = MultiplyFull(mantissa, powerOfFive[0]);
+
+	if ((product.High & precisionMask) is precisionMask)
+	{
+		const struct _product low = MultiplyFull(mantissa, powerOfFive[1]);
+
+		product.Low += low.High;
+		product.High += low.High > product.Low;
+	}
+
+	const int upperBit = (int)(product.High >> 63);
+	const int shift = upperBit + 64 - FLOAT_MANTISSA_BITS - 3;
+
+	ulong bits = product.High >> shift;
+
+	// floor(log2(10^exponent)) + 63 is the binary exponent of the power of five's top bit
+	int power = (int)((((152170 + 65536) * exponent) >> 16) + 63) + upperBit - leadingZeros + FLOAT_EXPONENT_BIAS;
+
+	if (power <= 0)
+	{
+		// subnormal
+		if (-power + 1 >= 64)
+		{
+			return 0;
+		}
+
+		bits >>= -power + 1;
+		bits += bits & 1;
+		bits >>= 1;
+
+		// rounding up can carry into the smallest normal exponent
+		power = bits < (1ull << FLOAT_MANTISSA_BITS) ? 0 : 1;
+
+		return (unsigned int)(bits | ((ulong)power << FLOAT_MANTISSA_BITS));
+	}
+
+	// exactly halfway, the product only has bits below the mantissa when the power of five was truncated
+	if (product.Low <= 1 and exponent >= MIN_EXPONENT_ROUND_TO_EVEN and exponent <= MAX_EXPONENT_ROUND_TO_EVEN and (bits & 3) is 1)
+	{
+		if ((bits << shift) is product.High)
+		{
+			bits &= ~1ull;
+		}
+	}
+
+	bits += bits & 1;
+	bits >>= 1;
+
+	if (bits >= (2ull << FLOAT_MANTISSA_BITS))
+	{
+		bits = 1ull << FLOAT_MANTISSA_BITS;
+		++power;
+	}
+
+	bits &= ~(1ull << FLOAT_MANTISSA_BITS);
+
+	if (power >= FLOAT_INFINITE_POWER)
+	{
+		return FLOAT_INFINITE_POWER << FLOAT_MANTISSA_BITS;
+	}
+
+	return (unsigned int)(bits | ((ulong)power << FLOAT_MANTISSA_BITS));
+}
+
+// enough for MAX_SIGNIFICANT_DIGITS digits scaled by any power of five and two a float needs
+#define BIG_INTEGER_LIMBS 40
+
+typedef struct _bigInteger bigInteger;
+
+struct _bigInteger {
+	unsigned int Limbs[BIG_INTEGER_LIMBS];
+	ulong Count;
+};
+
+private void MultiplyAddBig(bigInteger* value, unsigned int multiplier, unsigned int addend)
+{
+	ulong carry = addend;
+
+	for (ulong i = 0; i < value->Count; i++)
+	{
+		const ulong product = ((ulong)value->Limbs[i] * multiplier) + carry;
+
+		value->Limbs[i] = (unsigned int)product;
+		carry = product >> 32;
+	}
+
+	if (carry isnt 0 and value->Count < BIG_INTEGER_LIMBS)
+	{
+		value->Limbs[value->Count++] = (unsigned int)carry;
+	}
+}
+
+private void MultiplyPowerOfFiveBig(bigInteger* value, ulong power)
+{
+	// 5^13 is the largest power of five that fits in 32 bits
+	for (; power >= 13; power -= 13)
+	{
+		MultiplyAddBig(value, 1220703125u, 0);
+	}
+
+	static const unsigned int smallPowers[] = { 1, 5, 25, 125, 625, 3125, 15625, 78125, 390625, 1953125, 9765625, 48828125, 244140625 };
+
+	MultiplyAddBig(value, smallPowers[power], 0);
+}
+
+private void ShiftLeftBig(bigInteger* value, ulong bits)
+{
+	if (value->Count is 0)
+	{
+		return;
+	}
+
+	const ulong limbs = bits / 32;
+	const ulong remainder = bits % 32;
+
+	if (remainder isnt 0)
+	{
+		unsigned int carry = 0;
+
+		for (ulong i = 0; i < value->Count; i++)
+		{
+			const unsigned int limb = value->Limbs[i];
+
+			value->Limbs[i] = (limb << remainder) | carry;
+			carry = limb >> (32 - remainder);
+		}
+
+		if (carry isnt 0 and value->Count < BIG_INTEGER_LIMBS)
+		{
+			value->Limbs[value->Count++] = carry;
+		}
+	}
+
+	if (limbs isnt 0)
+	{
+		const ulong count = min(value->Count + limbs, BIG_INTEGER_LIMBS);
+
+		for (ulong i = count; i-- > limbs;)
+		{
+			value->Limbs[i] = value->Limbs[i - limbs];
+		}
+
+		memset(value->Limbs, 0, limbs * sizeof(unsigned int));
+
+		value->Count = count;
+	}
+}
+
+private int CompareBig(const bigInteger* left, const bigInteger* right)
+{
+	if (left->Count isnt right->Count)
+	{
+		return left->Count > right->Count ? 1 : -1;
+	}
+
+	for (ulong i = left->Count; i-- > 0;)
+	{
+		if (left->Limbs[i] isnt right->Limbs[i])
+		{
+			return left->Limbs[i] > right->Limbs[i] ? 1 : -1;
+		}
+	}
+
+	return 0;
+}
+
+// appends the digits to the integer, stops once it holds MAX_SIGNIFICANT_DIGITS digits
+private void AppendDigitsBig(bigInteger* value, const char* digits, ulong length, ulong* digitCount, ulong* dropped, bool* droppedNonZero)
+{
+	for (ulong i = 0; i < length; i++)
+	{
+		const unsigned int digit = digits[i] - '0';
+
+		if (*digitCount >= MAX_SIGNIFICANT_DIGITS)
+		{
+			++(*dropped);
+			*droppedNonZero |= digit isnt 0;
+			continue;
+		}
+
+		// leading zeros are not significant
+		if (*digitCount is 0 and digit is 0)
+		{
+			continue;
+		}
+
+		if (value->Count is 0)
+		{
+			value->Limbs[value->Count++] = digit;
+		}
+		else
+		{
+			MultiplyAddBig(value, 10, digit);
+		}
+
+		++(*digitCount);
+	}
+}
+
+// picks between the two floats a truncated decimal could round to by comparing every digit against the halfway point
+private unsigned int RoundTruncatedDecimal(const decimal* number, unsigned int lowerBits, unsigned int upperBits)
+{
+	bigInteger digits = { .Count = 0 };
+
+	ulong digitCount = 0;
+	ulong dropped = 0;
+	bool droppedNonZero = false;
+
+	AppendDigitsBig(&digits, number->Integer, number->IntegerLength, &digitCount, &dropped, &droppedNonZero);
+
+	// fraction digits that were dropped don't move the decimal point
+	const ulong droppedIntegerDigits = dropped;
+
+	AppendDigitsBig(&digits, number->Fraction, number->FractionLength, &digitCount, &dropped, &droppedNonZero);
+
+	// digits * 10^decimalExponent
+	const long long decimalExponent = number->ExplicitExponent - (long long)number->FractionLength + (long long)droppedIntegerDigits + (long long)(dropped - droppedIntegerDigits);
+
+	// halfway * 2^binaryExponent is the midpoint between the lower float and the one after it
+	const unsigned int exponentBits = lowerBits >> FLOAT_MANTISSA_BITS;
+	const ulong significand = exponentBits is 0 ? lowerBits : (lowerBits & ((1u << FLOAT_MANTISSA_BITS) - 1)) | (1u << FLOAT_MANTISSA_BITS);
+	const long long binaryExponent = (exponentBits is 0 ? 1 : (long long)exponentBits) - FLOAT_EXPONENT_BIAS - FLOAT_MANTISSA_BITS - 1;
+
+	bigInteger halfway = { .Count = 1 };
+	halfway.Limbs[0] = (unsigned int)((significand * 2) + 1);
+
+	// compare digits * 5^e * 2^e against halfway * 2^b with the powers of five on the side they are positive
+	long long digitsShift = 0;
+	long long halfwayShift = binaryExponent;
+
+	if (decimalExponent >= 0)
+	{
+		MultiplyPowerOfFiveBig(&digits, (ulong)decimalExponent);
+		digitsShift = decimalExponent;
+	}
+	else
+	{
+		MultiplyPowerOfFiveBig(&halfway, (ulong)-decimalExponent);
+		halfwayShift -= decimalExponent;
+	}
+
+	if (digitsShift > halfwayShift)
+	{
+		ShiftLeftBig(&digits, (ulong)(digitsShift - halfwayShift));
+	}
+	else
+	{
+		ShiftLeftBig(&halfway, (ulong)(halfwayShift - digitsShift));
+	}
+
+	int comparison = CompareBig(&digits, &halfway);
+
+	// the digits that didn't fit only push the value above the midpoint
+	if (comparison is 0 and droppedNonZero)
+	{
+		comparison = 1;
+	}
+
+	if (comparison is 0)
+	{
+		return (lowerBits & 1) is 0 ? lowerBits : upperBits;
+	}
+
+	return comparison < 0 ? lowerBits : upperBits;
+}
+
+private bool MatchesIgnoringCase(const char* position, const char* end, const char* word, ulong length)
+{
+	if ((ulong)(end - position) < length)
+	{
+		return false;
+	}
+
+	for (ulong i = 0; i < length; i++)
+	{
+		if ((position[i] | 0x20) isnt word[i])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// reads inf, infinity or nan
+private bool TryScanSpecialFloat(const char** cursor, const char* end, bool negative, unsigned int* out_bits)
+{
+	const char* position = *cursor;
+
+	if (MatchesIgnoringCase(position, end, "nan", 3))
+	{
+		*out_bits = FLOAT_QUIET_NAN;
+		*cursor = position + 3;
+	}
+	else if (MatchesIgnoringCase(position, end, "infinity", 8))
+	{
+		*out_bits = FLOAT_INFINITE_POWER << FLOAT_MANTISSA_BITS;
+		*cursor = position + 8;
+	}
+	else if (MatchesIgnoringCase(position, end, "inf", 3))
+	{
+		*out_bits = FLOAT_INFINITE_POWER << FLOAT_MANTISSA_BITS;
+		*cursor = position + 3;
+	}
+	else
+	{
+		return false;
+	}
+
+	if (negative)
+	{
+		*out_bits |= FLOAT_SIGN_BIT;
+	}
+
+	return true;
+}
+
+// reads the digits and exponent of a decimal number, on success the cursor is moved past the number
+private bool TryScanDecimal(const char** cursor, const char* end, decimal* out_decimal)
+{
+	const char* position = *cursor;
+
+	decimal number = { .Mantissa = 0, .Exponent = 0, .Negative = false, .Truncated = false };
+
+	if (position < end and (*position is '-' or *position is '+'))
+	{
+		number.Negative = *position is '-';
+		++position;
+	}
+
+	// overflow past 19 digits is fixed below by reading them again
+	ulong mantissa = 0;
+
+	number.Integer = position;
+
+	for (; position < end and IsDigit(*position); ++position)
+	{
+		mantissa = (mantissa * 10) + (ulong)(*position - '0');
+	}
+
+	number.IntegerLength = (ulong)(position - number.Integer);
+
+	number.Fraction = position;
+	number.FractionLength = 0;
+
+	if (position < end and *position is '.')
+	{
+		number.Fraction = ++position;
+
+		for (; position < end and IsDigit(*position); ++position)
+		{
+			mantissa = (mantissa * 10) + (ulong)(*position - '0');
+		}
+
+		number.FractionLength = (ulong)(position - number.Fraction);
+	}
+
+	if (number.IntegerLength + number.FractionLength is 0)
+	{
+		return false;
+	}
+
+	if (position < end and (*position is 'e' or *position is 'E'))
+	{
+		const char* exponentStart = position + 1;
+
+		bool negativeExponent = false;
+
+		if (exponentStart < end and (*exponentStart is '-' or *exponentStart is '+'))
+		{
+			negativeExponent = *exponentStart is '-';
+			++exponentStart;
+		}
+
+		// an 'e' without digits after it is not part of the number
+		if (exponentStart < end and IsDigit(*exponentStart))
+		{
+			long long explicitExponent = 0;
+
+			for (position = exponentStart; position < end and IsDigit(*position); ++position)
+			{
+				if (explicitExponent < MAX_EXPLICIT_EXPONENT)
+				{
+					explicitExponent = (explicitExponent * 10) + (*position - '0');
+				}
+			}
+
+			number.ExplicitExponent = negativeExponent ? -explicitExponent : explicitExponent;
+		}
+	}
+
+	number.Exponent = number.ExplicitExponent - (long long)number.FractionLength;
+
+	ulong digitCount = number.IntegerLength + number.FractionLength;
+
+	if (digitCount > MAX_MANTISSA_DIGITS)
+	{
+		// leading zeros are not significant
+		for (const char* digit = number.Integer; digit < position and (*digit is '0' or *digit is '.'); ++digit)
+		{
+			digitCount -= *digit is '0';
+		}
+
+		if (digitCount > MAX_MANTISSA_DIGITS)
+		{
+			number.Truncated = true;
+
+			mantissa = 0;
+
+			const char* digit = number.Integer;
+			const char* integerEnd = number.Integer + number.IntegerLength;
+
+			for (; mantissa < MIN_NINETEEN_DIGIT_INTEGER and digit < integerEnd; ++digit)
+			{
+				mantissa = (mantissa * 10) + (ulong)(*digit - '0');
+			}
+
+			if (mantissa >= MIN_NINETEEN_DIGIT_INTEGER)
+			{
+				number.Exponent = (long long)(integerEnd - digit) + number.ExplicitExponent;
+			}
+			else
+			{
+				const char* fractionEnd = number.Fraction + number.FractionLength;
+
+				for (digit = number.Fraction; mantissa < MIN_NINETEEN_DIGIT_INTEGER and digit < fractionEnd; ++digit)
+				{
+					mantissa = (mantissa * 10) + (ulong)(*digit - '0');
+				}
+
+				number.Exponent = (long long)(number.Fraction - digit) + number.ExplicitExponent;
+			}
+		}
+	}
+
+	number.Mantissa = mantissa;
+
+	*out_decimal = number;
+	*cursor = position;
+
+	return true;
+}
+
+private bool TryScanFloat(const char** cursor, const char* end, float* out_value)
+{
+	const char* position = SkipWhitespace(*cursor, end);
+
+	decimal number;
+	unsigned int bits;
+
+	if (TryScanDecimal(&position, end, &number) is false)
+	{
+		// the sign is read again when it is followed by inf or nan
+		const bool negative = position < end and *position is '-';
+		const char* special = position < end and (*position is '-' or *position is '+') ? position + 1 : position;
+
+		if (TryScanSpecialFloat(&special, end, negative, &bits) is false)
+		{
+			return false;
+		}
+
+		memcpy(out_value, &bits, sizeof(float));
+		*cursor = special;
+
+		return true;
+	}
+
+	*cursor = position;
+
+	// small enough values are exact as floats so multiplying them rounds only once
+	if (number.Truncated is false and number.Mantissa <= MAX_EXACT_FLOAT_INTEGER and
+		number.Exponent >= -MAX_EXACT_FLOAT_POWER_OF_TEN and number.Exponent <= MAX_EXACT_FLOAT_POWER_OF_TEN)
+	{
+		float value = (float)number.Mantissa;
+
+		value = number.Exponent < 0 ? value / FloatPowersOfTen[-number.Exponent] : value * FloatPowersOfTen[number.Exponent];
+
+		*out_value = number.Negative ? -value : value;
+
+		return true;
+	}
+
+	bits = ComputeFloatBits(number.Exponent, number.Mantissa);
+
+	// the true value is between mantissa and mantissa + 1, when those round differently the digits that were cut off decide
+	if (number.Truncated)
+	{
+		const unsigned int upperBits = ComputeFloatBits(number.Exponent, number.Mantissa + 1);
+
+		if (upperBits isnt bits)
+		{
+			bits = RoundTruncatedDecimal(&number, bits, upperBits);
+		}
+	}
+
+	if (number.Negative)
+	{
+		bits |= FLOAT_SIGN_BIT;
+	}
+
+	memcpy(out_value, &bits, sizeof(float));
+
+	return true;
+}
+
+private bool TryScanInteger(const char** cursor, const char* end, long long* out_value)
+{
+	const char* position = SkipWhitespace(*cursor, end);
+
+	bool negative = false;
+
+	if (position < end and (*position is '-' or *position is '+'))
+	{
+		negative = *position is '-';
+		++position;
+	}
+
+	if (position >= end or IsDigit(*position) is false)
+	{
+		return false;
+	}
+
+	// accumulated as a magnitude so the most negative value can be read as well
+	ulong value = 0;
+
+	for (; position < end and IsDigit(*position); ++position)
+	{
+		const ulong digit = (ulong)(*position - '0');
+
+		if (value > (0xFFFFFFFFFFFFFFFFull - digit) / 10)
+		{
+			return false;
+		}
+
+		value = (value * 10) + digit;
+	}
+
+	const ulong limit = negative ? 0x8000000000000000ull : 0x7FFFFFFFFFFFFFFFull;
+
+	if (value > limit)
+	{
+		return false;
+	}
+
+	*out_value = negative ? (long long)(0 - value) : (long long)value;
+	*cursor = position;
+
+	return true;
+}
+
+private int HexDigitValue(char c)
+{
+	if (IsDigit(c))
+	{
+		return c - '0';
+	}
+
+	const char lower = c | 0x20;
+
+	return lower >= 'a' and lower <= 'f' ? lower - 'a' + 10 : -1;
+}
+
+private bool TryScanHex(const char** cursor, const char* end, ulong* out_value)
+{
+	const char* position = SkipWhitespace(*cursor, end);
+
+	// the prefix is only skipped when digits follow it, "0x" on its own is the number 0
+	if (end - position > 2 and position[0] is '0' and (position[1] | 0x20) is 'x' and HexDigitValue(position[2]) >= 0)
+	{
+		position += 2;
+	}
+
+	if (position >= end or HexDigitValue(*position) < 0)
+	{
+		return false;
+	}
+
+	ulong value = 0;
+
+	for (int digit = HexDigitValue(*position); position < end and digit >= 0; digit = ++position < end ? HexDigitValue(*position) : -1)
+	{
+		if (value >> 60 isnt 0)
+		{
+			return false;
+		}
+
+		value = (value << 4) | (ulong)digit;
+	}
+
+	*out_value = value;
+	*cursor = position;
+
+	return true;
+}
+
+private bool ScanMatchesStrtof(const char* text)
+{
+	const char* end = text + strlen(text);
+	const char* cursor = text;
+
+	float actual;
+	if (TryScanFloat(&cursor, end, &actual) is false)
+	{
+		return false;
+	}
+
+	char* expectedEnd;
+	const float expected = strtof(text, &expectedEnd);
+
+	return memcmp(&expected, &actual, sizeof(float)) is 0 and cursor is expectedEnd;
+}
+
+// a float nearest to a random value spread across every exponent a float has
+private float RandomFloat(ulong* state)
+{
+	*state = (*state * 6364136223846793005ull) + 1442695040888963407ull;
+
+	unsigned int bits = (unsigned int)(*state >> 32);
+
+	// infinity and nan don't round trip through text
+	if (((bits >> FLOAT_MANTISSA_BITS) & FLOAT_INFINITE_POWER) is FLOAT_INFINITE_POWER)
+	{
+		bits ^= 1u << (FLOAT_MANTISSA_BITS + 1);
+	}
+
+	float value;
+	memcpy(&value, &bits, sizeof(float));
+
+	return value;
+}
+
+TEST(MatchesStrtof)
+{
+	const char* values[] = {
+		"0", "-0", "1", "-1", "0.5", "3.14159", "-2.718281", "1e10", "1E-10", "6.02214076e23",
+		"1.17549435e-38", "3.40282347e+38", "0.000001", "123456789012345678901234567890",
+		"0.1", "0.2", "0.3", "1.000001", "99999.99", "-0.000123", ".5", "5.", "7e", "2.5e+",
+		// the smallest subnormal, half of it and the largest float
+		"1.40129846e-45", "7.0064923e-46", "7.0064924e-46", "3.4028235e38", "3.4028236e38", "1e39", "1e-50",
+		// halfway between 1 and the next float, then just above it
+		"1.000000059604644775390625", "1.0000000596046447753906250000000000000000000000001",
+		// halfway between 16777216 and 16777218
+		"16777217", "16777217.000000000000000000000001", "16777219",
+		"0.000000000000000000000000000000000000011754943508222875079687365372222456778186655567720875215087517062784172594547271728515625",
+		"inf", "-Infinity", "nan"
+	};
+
+	for (ulong i = 0; i < sizeof(values) / sizeof(const char*); i++)
+	{
+		if (strcmp(values[i], "nan") is 0)
+		{
+			const char* cursor = values[i];
+			float value;
+			IsTrue(TryScanFloat(&cursor, cursor + 3, &value));
+			IsTrue(value != value);
+			continue;
+		}
+
+		IsTrue(ScanMatchesStrtof(values[i]));
+	}
+
+	const char* invalid = " -.e5";
+	const char* cursor = invalid;
+	float value;
+	IsFalse(TryScanFloat(&cursor, invalid + strlen(invalid), &value));
+	IsTrue(cursor is invalid);
+
+	// the span does not have to be terminated
+	const char* partial = "12.5e3";
+	cursor = partial;
+	IsTrue(TryScanFloat(&cursor, partial + 4, &value));
+	IsEqual(12.5f, value);
+	IsTrue(cursor is partial + 4);
+
+	return true;
+}
+
+TEST(RandomFloatsRoundTrip)
+{
+	ulong state = 0x9E3779B97F4A7C15ull;
+
+	char buffer[128];
+
+	for (ulong i = 0; i < 200000; i++)
+	{
+		const float expected = RandomFloat(&state);
+
+		// 9 significant digits are enough for every float to round trip exactly
+		int length = sprintf_s(buffer, sizeof(buffer), "%.9g", expected);
+
+		const char* cursor = buffer;
+		float actual;
+		IsTrue(TryScanFloat(&cursor, buffer + length, &actual));
+		IsTrue(memcmp(&expected, &actual, sizeof(float)) is 0);
+
+		// the shortest digits, the digits of the double in between floats and the full expansion all round like strtof
+		length = sprintf_s(buffer, sizeof(buffer), "%.7g", expected);
+		IsTrue(ScanMatchesStrtof(buffer));
+
+		length = sprintf_s(buffer, sizeof(buffer), "%.17g", (double)expected * (1.0 + (1.0 / 33554432.0)));
+		IsTrue(ScanMatchesStrtof(buffer));
+
+		length = sprintf_s(buffer, sizeof(buffer), "%.40e", (double)expected);
+		IsTrue(ScanMatchesStrtof(buffer));
+	}
+
+	return true;
+}
+
+TEST(ScanIntegers)
+{
+	const char* text = " 42 -7 +13 9223372036854775807 -9223372036854775808 9223372036854775808";
+	const char* end = text + strlen(text);
+	const char* cursor = text;
+
+	const long long expected[] = { 42, -7, 13, 0x7FFFFFFFFFFFFFFFll, (long long)0x8000000000000000ull };
+
+	for (ulong i = 0; i < sizeof(expected) / sizeof(long long); i++)
+	{
+		long long value;
+		IsTrue(TryScanInteger(&cursor, end, &value));
+		IsTrue(value == expected[i]);
+	}
+
+	// overflow is rejected without moving the cursor
+	const char* overflow = cursor;
+	long long value;
+	IsFalse(TryScanInteger(&cursor, end, &value));
+	IsTrue(cursor is overflow);
+
+	const char* hex = "0x1F ff U";
+	end = hex + strlen(hex);
+	cursor = hex;
+
+	ulong hexValue;
+	IsTrue(TryScanHex(&cursor, end, &hexValue));
+	IsEqual(0x1Full, hexValue);
+	IsTrue(TryScanHex(&cursor, end, &hexValue));
+	IsEqual(0xFFull, hexValue);
+	IsFalse(TryScanHex(&cursor, end, &hexValue));
+
+	return true;
+}
+
+TEST(IntsAcceptPrefixedValues)
+{
+	// Ints.TryDeserialize reads what %lli used to, decimal as well as 0x hex and 0 octal
+	const char* texts[] = { "42", " -7", "0x1F", "-0X10", "017", "-010", "0", "0x", "9223372036854775807" };
+	const ulong expected[] = { 42, (ulong)-7ll, 0x1F, (ulong)-16ll, 15, (ulong)-8ll, 0, 0, 0x7FFFFFFFFFFFFFFFull };
+
+	for (ulong i = 0; i < sizeof(texts) / sizeof(char*); i++)
+	{
+		ulong value;
+		IsTrue(Ints.TryDeserialize(texts[i], strlen(texts[i]), &value));
+		IsEqual(expected[i], value);
+	}
+
+	const char* invalid[] = { "", "x1", "0x8000000000000000", "02000000000000000000000" };
+
+	for (ulong i = 0; i < sizeof(invalid) / sizeof(char*); i++)
+	{
+		ulong value;
+		IsFalse(Ints.TryDeserialize(invalid[i], strlen(invalid[i]), &value));
+	}
+
+	return true;
+}
+
+TEST_SUITE(
+	RunUnitTests,
+	APPEND_TEST(MatchesStrtof)
+	APPEND_TEST(RandomFloatsRoundTrip)
+	APPEND_TEST(ScanIntegers)
+	APPEND_TEST(IntsAcceptPrefixedValues)
+);
+
+TEST(Benchmark)
+{
+	// the same kind of text the engine reads, separately terminated "x y z" triplets with six decimals like the
+	// values Vector3s.TryDeserialize is given, sscanf has to measure the whole string it's given on every call
+	const ulong count = 1000000;
+	const ulong size = count * 48;
+
+	char* text = malloc(size);
+
+	if (text is null)
+	{
+		return false;
+	}
+
+	ulong length = 0;
+	ulong state = 42;
+
+	for (ulong i = 0; i < count; i++)
+	{
+		for (ulong axis = 0; axis < 3; axis++)
+		{
+			state = (state * 6364136223846793005ull) + 1442695040888963407ull;
+
+			const double value = ((double)(state >> 11) / (double)(1ull << 53) - 0.5) * 200.0;
+
+			length += sprintf_s(text + length, size - length, axis is 2 ? "%.6f" : "%.6f ", value);
+		}
+
+		// keep the terminator
+		++length;
+	}
+
+	const char* end = text + length;
+	const double megabytes = (double)length / (1024.0 * 1024.0);
+
+	volatile float sink = 0;
+
+	clock_t start = clock();
+	for (const char* cursor = text; cursor < end; ++cursor)
+	{
+		float x, y, z;
+		if ((TryScanFloat(&cursor, end, &x) and TryScanFloat(&cursor, end, &y) and TryScanFloat(&cursor, end, &z)) is false)
+		{
+			break;
+		}
+
+		sink += x + y + z;
+	}
+	const double scanSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (char* cursor = text; cursor < end; ++cursor)
+	{
+		sink += strtof(cursor, &cursor);
+		sink += strtof(cursor, &cursor);
+		sink += strtof(cursor, &cursor);
+	}
+	const double strtofSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (const char* cursor = text; cursor < end; cursor += strlen(cursor) + 1)
+	{
+		float x, y, z;
+		if (sscanf_s(cursor, "%f %f %f", &x, &y, &z) isnt 3)
+		{
+			break;
+		}
+
+		sink += x + y + z;
+	}
+	const double sscanfSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	fprintf(__test_stream, "\t%.1lf MB of floats: Scanning %10.1lf MB/s strtof %10.1lf MB/s sscanf %10.1lf MB/s"NEWLINE,
+		megabytes,
+		megabytes / max(scanSeconds, 1e-6),
+		megabytes / max(strtofSeconds, 1e-6),
+		megabytes / max(sscanfSeconds, 1e-6));
+
+	free(text);
+
+	return true;
+}
+
+TEST_SUITE(
+	RunBenchmarks,
+	APPEND_TEST(Benchmark)
+);
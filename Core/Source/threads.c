@@ -0,0 +1,449 @@
+#include "core/threads.h"
+#include "core/memory.h"
+#include "core/atomics.h"
+
+#ifdef _WIN32
+// kept out of the headers, windows.h defines macros that clash with engine names
+#include "windows.h"
+#else
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#endif
+
+private Thread Start(void(*method)(void* state), void* state);
+private void Join(Thread);
+private ulong ProcessorCount(void);
+private void ParallelFor(ulong count, void* state, void(*method)(void* state, ulong index));
+
+const struct _threadMethods Threads = {
+	.Start = Start,
+	.Join = Join,
+	.ProcessorCount = ProcessorCount,
+	.ParallelFor = ParallelFor
+};
+
+private Semaphore CreateSemaphoreWithCount(ulong initialCount);
+private void ReleaseSemaphoreCount(Semaphore);
+private void WaitSemaphore(Semaphore);
+private void DisposeSemaphore(Semaphore);
+
+// windows.h defines CreateSemaphore and ReleaseSemaphore as macros so these can't share their names
+const struct _semaphoreMethods Semaphores = {
+	.Create = CreateSemaphoreWithCount,
+	.Release = ReleaseSemaphoreCount,
+	.Wait = WaitSemaphore,
+	.Dispose = DisposeSemaphore
+};
+
+DEFINE_TYPE_ID(Thread);
+DEFINE_TYPE_ID(Semaphore);
+
+#ifdef _WIN32
+
+private DWORD WINAPI ThreadEntryPoint(LPVOID parameter)
+{
+	Thread thread = parameter;
+
+	thread->Method(thread->State);
+
+	return 0;
+}
+
+#else
+
+private void* ThreadEntryPoint(void* parameter)
+{
+	Thread thread = parameter;
+
+	thread->Method(thread->State);
+
+	return null;
+}
+
+#endif
+
+private Thread Start(void(*method)(void* state), void* state)
+{
+	if (method is null)
+	{
+		throw(NullReferenceException);
+	}
+
+	REGISTER_TYPE(Thread);
+
+	Thread thread = Memory.Alloc(sizeof(struct _thread), ThreadTypeId);
+
+	thread->Method = method;
+	thread->State = state;
+
+#ifdef _WIN32
+	thread->Handle = CreateThread(null, 0, ThreadEntryPoint, thread, 0, null);
+
+	if (thread->Handle is null)
+	{
+		throw(InvalidLogicException);
+	}
+#else
+	pthread_t* handle = Memory.Alloc(sizeof(pthread_t), ThreadTypeId);
+
+	if (pthread_create(handle, null, ThreadEntryPoint, thread) isnt 0)
+	{
+		throw(InvalidLogicException);
+	}
+
+	thread->Handle = handle;
+#endif
+
+	return thread;
+}
+
+private void Join(Thread thread)
+{
+	if (thread is null)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	WaitForSingleObject(thread->Handle, INFINITE);
+	CloseHandle(thread->Handle);
+#else
+	pthread_join(*(pthread_t*)thread->Handle, null);
+	Memory.Free(thread->Handle, ThreadTypeId);
+#endif
+
+	Memory.Free(thread, ThreadTypeId);
+}
+
+private ulong ProcessorCount(void)
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+
+	return max(info.dwNumberOfProcessors, 1);
+#else
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return count > 0 ? (ulong)count : 1;
+#endif
+}
+
+// the most threads a single ParallelFor will use, including the calling thread
+#define MAX_PARALLEL_THREADS 64
+
+struct _parallelFor {
+	volatile ulong NextIndex;
+	ulong Count;
+	void* State;
+	void (*Method)(void* state, ulong index);
+	// the number of workers running indices of this job, only changed while holding the pool's lock
+	ulong Helpers;
+	// set when the calling thread has to wait for its helpers, released by the last helper to leave
+	Semaphore Finished;
+	// the next job that still has indices left
+	struct _parallelFor* Next;
+};
+
+// workers are started the first time ParallelFor is used and live for the lifetime of the program
+// so repeated calls don't pay to create threads
+static struct _threadPool {
+	volatile long Started;
+	// guards Jobs and the Helpers and Finished fields of every job, only held long enough to link or unlink a job
+	volatile long Lock;
+	ulong WorkerCount;
+	// every ParallelFor that is running from any thread, newest first so nested calls are helped first
+	struct _parallelFor* Jobs;
+#ifdef _WIN32
+	HANDLE WorkAvailable;
+#else
+	sem_t WorkAvailable;
+#endif
+} ThreadPool;
+
+private void LockThreadPool(void)
+{
+	while (AtomicCompareExchange32(ThreadPool.Lock, true, false) isnt false)
+	{
+		SpinWait();
+	}
+}
+
+private void UnlockThreadPool(void)
+{
+	AtomicExchange32(ThreadPool.Lock, false);
+}
+
+private void RunParallelFor(struct _parallelFor* parallelFor)
+{
+	// indices are handed out one at a time so uneven work still balances across threads
+	for (ulong index = AtomicAdd(parallelFor->NextIndex, 1); index < parallelFor->Count; index = AtomicAdd(parallelFor->NextIndex, 1))
+	{
+		parallelFor->Method(parallelFor->State, index);
+	}
+}
+
+// joins the newest job that still has indices left
+private struct _parallelFor* TryJoinJob(void)
+{
+	LockThreadPool();
+
+	struct _parallelFor* job = ThreadPool.Jobs;
+
+	while (job isnt null and job->NextIndex >= job->Count)
+	{
+		job = job->Next;
+	}
+
+	if (job isnt null)
+	{
+		++job->Helpers;
+	}
+
+	UnlockThreadPool();
+
+	return job;
+}
+
+private void LeaveJob(struct _parallelFor* job)
+{
+	LockThreadPool();
+
+	// the job lives on the stack of the calling thread, it's gone as soon as the last helper lets it know
+	const Semaphore finished = --job->Helpers is 0 ? job->Finished : null;
+
+	UnlockThreadPool();
+
+	if (finished isnt null)
+	{
+		Semaphores.Release(finished);
+	}
+}
+
+private void RunWorker(void* state)
+{
+	ignore_unused(state);
+
+	while (true)
+	{
+#ifdef _WIN32
+		WaitForSingleObject(ThreadPool.WorkAvailable, INFINITE);
+#else
+		while (sem_wait(&ThreadPool.WorkAvailable) isnt 0);
+#endif
+
+		// the job this wake up was meant for may have already been finished by its own thread
+		struct _parallelFor* job = TryJoinJob();
+
+		if (job is null)
+		{
+			continue;
+		}
+
+		RunParallelFor(job);
+
+		LeaveJob(job);
+	}
+}
+
+private void StartThreadPool(void)
+{
+	ThreadPool.WorkerCount = min(ProcessorCount(), MAX_PARALLEL_THREADS) - 1;
+
+#ifdef _WIN32
+	ThreadPool.WorkAvailable = CreateSemaphoreA(null, 0, LONG_MAX, null);
+
+	if (ThreadPool.WorkAvailable is null)
+	{
+		throw(InvalidLogicException);
+	}
+#else
+	if (sem_init(&ThreadPool.WorkAvailable, 0, 0) isnt 0)
+	{
+		throw(InvalidLogicException);
+	}
+#endif
+
+	for (ulong i = 0; i < ThreadPool.WorkerCount; i++)
+	{
+		Start(RunWorker, null);
+	}
+
+	AtomicExchange32(ThreadPool.Started, true);
+}
+
+// stops new helpers from joining the job and waits for the ones that already did to finish their last index
+private void FinishJob(struct _parallelFor* job)
+{
+	Semaphore finished = null;
+
+	while (true)
+	{
+		LockThreadPool();
+
+		const bool waiting = job->Helpers isnt 0;
+
+		// the semaphore is only created when a helper is still running so most calls never make one
+		if (waiting is false or finished isnt null)
+		{
+			struct _parallelFor** link = &ThreadPool.Jobs;
+
+			while (*link isnt job)
+			{
+				link = &(*link)->Next;
+			}
+
+			*link = job->Next;
+
+			job->Finished = finished;
+
+			UnlockThreadPool();
+
+			if (waiting)
+			{
+				Semaphores.Wait(finished);
+			}
+
+			Semaphores.Dispose(finished);
+
+			return;
+		}
+
+		UnlockThreadPool();
+
+		finished = Semaphores.Create(0);
+	}
+}
+
+private void ParallelFor(ulong count, void* state, void(*method)(void* state, ulong index))
+{
+	if (method is null)
+	{
+		throw(NullReferenceException);
+	}
+
+	struct _parallelFor parallelFor = {
+		.NextIndex = 0,
+		.Count = count,
+		.State = state,
+		.Method = method,
+		.Helpers = 0,
+		.Finished = null,
+		.Next = null
+	};
+
+	if (count <= 1)
+	{
+		RunParallelFor(&parallelFor);
+		return;
+	}
+
+	if (ThreadPool.Started is false)
+	{
+		LockThreadPool();
+
+		if (ThreadPool.Started is false)
+		{
+			StartThreadPool();
+		}
+
+		UnlockThreadPool();
+	}
+
+	const ulong workers = min(ThreadPool.WorkerCount, count - 1);
+
+	if (workers is 0)
+	{
+		RunParallelFor(&parallelFor);
+		return;
+	}
+
+	// calls from other threads, or from inside another ParallelFor, share the workers instead of waiting for them
+	LockThreadPool();
+
+	parallelFor.Next = ThreadPool.Jobs;
+	ThreadPool.Jobs = &parallelFor;
+
+	UnlockThreadPool();
+
+#ifdef _WIN32
+	ReleaseSemaphore(ThreadPool.WorkAvailable, (LONG)workers, null);
+#else
+	for (ulong i = 0; i < workers; i++)
+	{
+		sem_post(&ThreadPool.WorkAvailable);
+	}
+#endif
+
+	// the calling thread is one of the workers
+	RunParallelFor(&parallelFor);
+
+	FinishJob(&parallelFor);
+}
+
+struct _semaphore {
+#ifdef _WIN32
+	HANDLE Handle;
+#else
+	sem_t Handle;
+#endif
+};
+
+private Semaphore CreateSemaphoreWithCount(ulong initialCount)
+{
+	REGISTER_TYPE(Semaphore);
+
+	Semaphore semaphore = Memory.Alloc(sizeof(struct _semaphore), SemaphoreTypeId);
+
+#ifdef _WIN32
+	semaphore->Handle = CreateSemaphoreA(null, (LONG)initialCount, LONG_MAX, null);
+
+	if (semaphore->Handle is null)
+	{
+		throw(InvalidLogicException);
+	}
+#else
+	if (sem_init(&semaphore->Handle, 0, (unsigned int)initialCount) isnt 0)
+	{
+		throw(InvalidLogicException);
+	}
+#endif
+
+	return semaphore;
+}
+
+private void ReleaseSemaphoreCount(Semaphore semaphore)
+{
+#ifdef _WIN32
+	ReleaseSemaphore(semaphore->Handle, 1, null);
+#else
+	sem_post(&semaphore->Handle);
+#endif
+}
+
+private void WaitSemaphore(Semaphore semaphore)
+{
+#ifdef _WIN32
+	WaitForSingleObject(semaphore->Handle, INFINITE);
+#else
+	// interrupted waits are retried
+	while (sem_wait(&semaphore->Handle) isnt 0);
+#endif
+}
+
+private void DisposeSemaphore(Semaphore semaphore)
+{
+	if (semaphore is null)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	CloseHandle(semaphore->Handle);
+#else
+	sem_destroy(&semaphore->Handle);
+#endif
+
+	Memory.Free(semaphore, SemaphoreTypeId);
+}
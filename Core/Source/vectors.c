@@ -1,7 +1,9 @@
 #include "core/math/vectors.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include "core/file.h"
 #include "core/cunit.h"
+#include "core/scanning.h"
 #include "string.h"
 #include "cglm/cam.h"
 #include "cglm/mat3.h"
@@ -110,12 +112,11 @@ private bool TryParseVector3(const char* buffer, ulong length, vector3* out_vect
 		return false;
 	}
 
-	int count = sscanf_s(buffer, "%f %f %f",
-		&out_vector3->x,
-		&out_vector3->y,
-		&out_vector3->z);
+	const char* end = buffer + length;
 
-	return count == 3;
+	return Scanning.TryScanFloat(&buffer, end, &out_vector3->x)
+		and Scanning.TryScanFloat(&buffer, end, &out_vector3->y)
+		and Scanning.TryScanFloat(&buffer, end, &out_vector3->z);
 }
 
 private bool TryParseVector2(const char* buffer, ulong length, vector2* out_vector2)
@@ -125,11 +126,10 @@ private bool TryParseVector2(const char* buffer, ulong length, vector2* out_vect
 		return false;
 	}
 
-	int count = sscanf_s(buffer, "%f %f",
-		&out_vector2->x,
-		&out_vector2->y);
+	const char* end = buffer + length;
 
-	return count == 2;
+	return Scanning.TryScanFloat(&buffer, end, &out_vector2->x)
+		and Scanning.TryScanFloat(&buffer, end, &out_vector2->y);
 }
 
 private bool Equals(const vector3 left, const vector3 right)
@@ -259,12 +259,12 @@ private bool TryDeserializeVec4(const char* buffer, const ulong length, vector4*
 		return false;
 	}
 
-	int count = sscanf_s(buffer, Vector4SerializationFormat, &out_vector4->x,
-		&out_vector4->y,
-		&out_vector4->z,
-		&out_vector4->w);
+	const char* end = buffer + length;
 
-	return count == 4;
+	return Scanning.TryScanFloat(&buffer, end, &out_vector4->x)
+		and Scanning.TryScanFloat(&buffer, end, &out_vector4->y)
+		and Scanning.TryScanFloat(&buffer, end, &out_vector4->z)
+		and Scanning.TryScanFloat(&buffer, end, &out_vector4->w);
 }
 
 private bool TrySerializeVec4Stream(File stream, const vector4 vector)
@@ -355,10 +355,56 @@ TEST(Test_TryGetVector2)
 	return true;
 }
 
+TEST(Test_SerializedVectorsRoundTrip)
+{
+	ulong state = 0x9E3779B97F4A7C15ull;
+
+	char buffer[256];
+	char reserialized[256];
+
+	for (ulong i = 0; i < 10000; i++)
+	{
+		vector4 expected;
+		float* components = (float*)&expected;
+
+		for (ulong axis = 0; axis < 4; axis++)
+		{
+			state = (state * 6364136223846793005ull) + 1442695040888963407ull;
+			components[axis] = (float)(((double)(state >> 11) / (double)(1ull << 53) - 0.5) * 20000.0);
+		}
+
+		IsTrue(Vector4s.TrySerialize(buffer, sizeof(buffer), expected));
+
+		vector4 actual;
+		IsTrue(Vector4s.TryDeserialize(buffer, strlen(buffer), &actual));
+
+		// every component is the float nearest to the text that was written
+		char* cursor = buffer;
+		for (ulong axis = 0; axis < 4; axis++)
+		{
+			const float nearest = strtof(cursor, &cursor);
+			IsTrue(memcmp(&nearest, (float*)&actual + axis, sizeof(float)) is 0);
+		}
+
+		// and writing it again gives back the same text
+		IsTrue(Vector4s.TrySerialize(reserialized, sizeof(reserialized), actual));
+		IsEqual(0, strcmp(buffer, reserialized));
+
+		vector3 actual3;
+		IsTrue(Vector3s.TrySerialize(buffer, sizeof(buffer), *(vector3*)&expected));
+		IsTrue(Vector3s.TryDeserialize(buffer, strlen(buffer), &actual3));
+		IsTrue(Vector3s.TrySerialize(reserialized, sizeof(reserialized), actual3));
+		IsEqual(0, strcmp(buffer, reserialized));
+	}
+
+	return true;
+}
+
 TEST_SUITE(
 	RunVectorUnitTests,
 	APPEND_TEST(Test_TryGetVector3)
 	APPEND_TEST(Test_TryGetVector2)
+	APPEND_TEST(Test_SerializedVectorsRoundTrip)
 );
 
 private float Determinant(matrix3 matrix)
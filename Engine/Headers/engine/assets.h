@@ -0,0 +1,59 @@
+#pragma once
+
+#include "core/array.h"
+#include "engine/modeling/model.h"
+#include "engine/graphics/renderMesh.h"
+#include "engine/graphics/rawTexture.h"
+#include "engine/graphics/material.h"
+
+// the default number of seconds a frame spends uploading streamed assets to the graphics device
+#define ASSET_UPLOAD_BUDGET 0.002
+
+// A request to load an asset in the background, returned by Assets.LoadAsync
+typedef struct _assetHandle* AssetHandle;
+
+// Assets shared by the path they were loaded from, only the first load of a path reads and parses its file,
+// every later load returns an instance of the asset that was already loaded. Instances are released with the
+// Dispose method of their type, the cache holds its own instance of every asset until it is released.
+struct _assetMethods {
+	// Gets the model at the path, the model is imported on first use, dispose the result with Models.Dispose
+	Model(*LoadModel)(const string path);
+	// Gets a new array of render meshes for the model at the path, the meshes are bound on first use and every
+	// later load instances them so the buffers are only uploaded once, dispose each mesh with RenderMeshes.Dispose.
+	// Once they're bound the cache drops the model's mesh data unless something else holds an instance of the model,
+	// LoadModel reads it again when it's needed
+	bool (*TryLoadRenderMeshes)(const string path, RenderMesh** out_meshes, ulong* out_count);
+	// Gets the texture definition(.texture) at the path, dispose the result with RawTextures.Dispose
+	RawTexture(*LoadTexture)(const string path);
+	// Gets the material definition(.material) at the path, dispose the result with Materials.Dispose
+	Material(*LoadMaterial)(const string path);
+	// Releases the cache's instance of the asset at the path, instances that were already returned stay valid
+	void (*Release)(const string path);
+	// Releases the cache's instance of every asset
+	void (*Clear)(void);
+	// The number of models, textures and materials the cache holds an instance of
+	ulong (*Count)(void);
+	// The number of loads that haven't been uploaded yet plus the cached models that something other than the cache
+	// still holds an instance of, once everything that loaded an asset was disposed this is 0
+	ulong (*CountInUse)(void);
+	// Starts loading the model(.obj) or image at the path in the background, reading, parsing and decoding happens
+	// on loader threads and only the upload to the graphics device happens on the main thread in Update, returns
+	// a handle that is already ready when the asset was loaded before, a path that is still loading returns another
+	// instance of the same handle rather than decoding it again, dispose every handle with DisposeHandle
+	AssetHandle(*LoadAsync)(const string path);
+	// Whether the asset has finished loading, assets that failed to load are ready as well but Get returns null for them
+	bool (*IsReady)(const AssetHandle);
+	// Gets an instance of the model once the handle is ready, returns null when it isn't ready, failed or isn't a model,
+	// dispose the result with Models.Dispose, render meshes for the model can be loaded with TryLoadRenderMeshes without blocking
+	Model(*GetModel)(const AssetHandle);
+	// Gets an instance of the texture once the handle is ready, returns null when it isn't ready, failed or isn't an image,
+	// dispose the result with RawTextures.Dispose
+	RawTexture(*GetTexture)(const AssetHandle);
+	void (*DisposeHandle)(AssetHandle);
+	// Uploads assets that finished loading in the background, should be called once per frame on the main thread,
+	// at least one asset is uploaded every call and no more are started once budgetSeconds has elapsed
+	void (*Update)(double budgetSeconds);
+	void (*RunUnitTests)(void);
+};
+
+extern const struct _assetMethods Assets;
@@ -70,6 +70,10 @@ struct _gameObjectMethods {
 	void (*Destroy)(GameObject);
 	GameObject(*Load)(const string path);
 	bool (*Save)(GameObject, const string path);
+	/// <summary>
+	/// Renders each enabled light's shadow map, meshes are drawn at the level of detail selected from the scene's main camera so
+	/// shadows match the surfaces that receive them
+	/// </summary>
 	void (*GenerateShadowMaps)(GameObject* array, ulong count, Scene scene, Material shadowMaterial, Camera shadowCamera);
 };
 
@@ -32,6 +32,10 @@ struct cameraState {
 	/// The previous combined state of this camera, this is the combined matrices of the view and projection
 	/// </summary>
 	matrix4 State;
+	/// <summary>
+	/// The version of the transform's world matrix the view was calculated from
+	/// </summary>
+	ulong TransformVersion;
 };
 
 typedef struct _camera* Camera;
@@ -13,6 +13,29 @@ static unsigned int NormalShaderPosition = 2;
 
 typedef struct _renderMesh* RenderMesh;
 
+typedef enum _attributeFormat {
+	// 32 bit floats, read as they are
+	AttributeFormatFloat,
+	// 16 bit floats, read as they are
+	AttributeFormatHalf,
+	// 16 bit unsigned integers read as 0.0 to 1.0
+	AttributeFormatUnorm16,
+	// 16 bit signed integers read as -1.0 to 1.0, normals are stored this way as two octahedral components
+	AttributeFormatSnorm16
+} AttributeFormat;
+
+typedef struct _renderMeshLevel renderMeshLevel;
+
+// A range of the index buffer that draws the mesh at one level of detail
+struct _renderMeshLevel {
+	// The first index of the level within the IndexBuffer
+	ulong Offset;
+	// The number of indices to draw
+	ulong Count;
+	// Roughly how far the level strays from the full detail surface, in model space
+	float Error;
+};
+
 struct _renderMesh {
 	ulong Id;
 
@@ -21,11 +44,28 @@ struct _renderMesh {
 	SharedHandle VertexBuffer;
 	SharedHandle UVBuffer;
 	SharedHandle NormalBuffer;
+	// The element buffer for indexed meshes, null when the mesh is drawn without indices
+	SharedHandle IndexBuffer;
+
+	// How each attribute is stored within its buffer
+	AttributeFormat VertexFormat;
+	AttributeFormat UVFormat;
+	AttributeFormat NormalFormat;
+	// Maps positions stored as fixed point back to model space, folded into the model matrix when the mesh is drawn,
+	// the identity for meshes with float positions
+	matrix4 Dequantization;
 
 	// Whether or not the mesh should be rendered smooth
 	bool ShadeSmooth;
 
+	// The number of vertices to draw, or indices when the mesh has an IndexBuffer
 	ulong NumberOfTriangles;
+	// The number of levels in Levels, the first is always the full detail mesh, 0 when the mesh isn't indexed
+	ulong LevelCount;
+	// The levels of detail stored one after another in the IndexBuffer, ordered from the most to the least detailed
+	renderMeshLevel Levels[MAX_MESH_LEVELS + 1];
+	// The level Draw uses, chosen each time the mesh is drawn by whatever draws it
+	ulong Level;
 	Transform Transform;
 
 	bool CopyBuffersOnDraw;
@@ -40,10 +80,15 @@ struct _renderMeshMethods {
 	void(*Dispose)(RenderMesh);
 	// Attempts to register the mesh with the underlying graphics device
 	bool (*TryBindMesh)(Mesh mesh, RenderMesh* out_mesh);
+	// Registers the mesh like TryBindMesh but also stores its positions as 16 bit fixed point within its bounds, for
+	// meshes drawn with shaders that transform positions by the model matrix, the mesh can't use CopyBuffersOnDraw
+	bool (*TryBindQuantizedMesh)(Mesh mesh, RenderMesh* out_mesh);
 	/// <summary>
 	/// Attempts to register all meshes within the model
 	/// </summary>
 	bool (*TryBindModel)(Model model, RenderMesh** out_meshArray);
+	// Disposes the first count meshes of an array returned by TryBindModel and then the array itself
+	void (*DisposeModelMeshes)(RenderMesh* meshArray, ulong count);
 	// Creates a new instance of the provided rendermesh with it's own transform
 	RenderMesh(*Instance)(RenderMesh);
 	// Creates a new instance of the provided rendermesh with it's own transform that shares the same attributes as the provided rendermesh
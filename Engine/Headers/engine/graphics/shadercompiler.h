@@ -13,6 +13,8 @@ struct _shaderCompilerMethods {
 	Shader(*Load)(const string path);
 	// Saves the provided shader to the provided path
 	bool (*Save)(Shader shader, const string path);
+	// Forgets every shader that was compiled so far, call once at shutdown after the last shader is compiled
+	void (*Clear)(void);
 };
 
 extern const struct _shaderCompilerMethods ShaderCompilers;
\ No newline at end of file
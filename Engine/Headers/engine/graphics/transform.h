@@ -5,7 +5,7 @@
 #include "core/csharp.h"
 
 struct _directionStates {
-	// Represents whether the directions were accessed and lazily assigned this frame, this resets to 0 everytime the transform is modified
+	// Represents whether the directions were accessed and lazily assigned this frame, this resets to 0 everytime the rotation is modified
 	// the first time one of the directions is accessed after a transform has been updated it is flags in this int so we don't re-calculate it
 	// for this frame
 	unsigned int Accessed;
@@ -13,44 +13,6 @@ struct _directionStates {
 	vector3 Directions[6];
 };
 
-struct transformState {
-	/// <summary>
-	/// Modified state is an unsigned int used as a bit mas to identify if various elements of this
-	/// state have been modified
-	/// format: 0 : unmodified; != 0 : modified, all other values are implementation defined but are as follows:
-	/// 0x01 : position modified; 0x02 rotation modified; 0x04 scale modified; Any or all flags may be present
-	/// </summary>
-	unsigned int Modified;
-	/// <summary>
-	/// The previously calculated scale matrix for this transform, this is NOT initialized with a value
-	/// until the first time this transform is refreshed
-	/// </summary>
-	matrix4 ScaleMatrix;
-	/// <summary>
-	/// The previously calculated rotation matrix for this transform, this is NOT initialized with a value
-	/// until the first time this transform is refreshed
-	/// </summary>
-	matrix4 RotationMatrix;
-	/// <summary>
-	/// The previously calculated translation matrix for this transform
-	/// </summary>
-	matrix4 TranslationMatrix;
-	/// <summary>
-	/// The previously calculated trasform matrix for this transform NOT including the parent matrix, this is NOT initialized with a value
-	/// until the first time this transform is refreshed
-	/// </summary>
-	matrix4 LocalState;
-	/// <summary>
-	/// The previously calculated trasform matrix for this transform, INCLUDING the parent's matrix, this is NOT initialized with a value
-	/// until the first time this transform is refreshed
-	/// </summary>
-	matrix4 State;
-	/// <summary>
-	/// Stores the pre-calculated directions for this object during runtime
-	/// </summary>
-	struct _directionStates Directions;
-};
-
 typedef struct _transform* Transform;
 
 struct _transform {
@@ -69,22 +31,15 @@ struct _transform {
 	/// </summary>
 	ulong Count;
 	/// <summary>
-	/// The index of an open child spot within the children array, this is 0 when there is no known spot
-	/// </summary>
-	ulong FreeIndex;
-	// transform members
-	/// <summary>
-	/// The position of this transform in world space
-	/// </summary>
-	vector3 Position;
-	/// <summary>
-	/// The rotation of this transform
+	/// The position of this transform within its parent's children array, children are packed at the front of the array
+	/// so the last child is moved into the spot of a child that's detached
 	/// </summary>
-	quaternion Rotation;
+	ulong ChildIndex;
 	/// <summary>
-	/// The scale of this transform
+	/// The slot within the flattened hierarchy that holds the position, rotation, scale and matrices of this transform,
+	/// slots move whenever the hierarchy is sorted so this should never be stored
 	/// </summary>
-	vector3 Scale;
+	ulong Index;
 	/// <summary>
 	/// Whether rotations should be calculated from the world origin or the transforms position, think planet rotation around sun(origin) vs planet rotating by itself (around position)
 	/// </summary>
@@ -94,9 +49,9 @@ struct _transform {
 	/// </summary>
 	bool InvertTransform;
 	/// <summary>
-	/// The stored state of this transform
+	/// Stores the pre-calculated directions for this object during runtime
 	/// </summary>
-	struct transformState State;
+	struct _directionStates Directions;
 };
 
 struct _transformMethods {
@@ -107,7 +62,7 @@ struct _transformMethods {
 	Transform (*DuplicateTransform)(Transform);
 
 	/// <summary>
-	/// Recalulates the underlying state of the transform
+	/// Recalulates the underlying state of the transform and its parents, returns the world matrix
 	/// </summary>
 	/// <param name=""></param>
 	matrix4 (*Refresh)(Transform);
@@ -118,6 +73,26 @@ struct _transformMethods {
 	/// <param name=""></param>
 	matrix4 (*ForceRefresh)(Transform);
 
+	/// <summary>
+	/// Recalculates the world matrix of every transform that changed since the last call along with every transform
+	/// below them, transforms that didn't change and have no parent that changed are never visited. Large hierarchies
+	/// are split across the thread pool, the matrices are the same as updating them on one thread
+	/// </summary>
+	void (*UpdateAll)(void);
+
+	/// <summary>
+	/// Returns the world matrix calculated by the last UpdateAll or Refresh without checking whether it's out of date,
+	/// for drawing after UpdateAll ran this frame
+	/// </summary>
+	matrix4 (*GetWorldMatrix)(Transform);
+
+	// Refreshes the transform and returns a number that changes every time its world matrix changes
+	ulong (*Version)(Transform);
+
+	vector3 (*GetPosition)(Transform);
+	quaternion (*GetRotation)(Transform);
+	vector3 (*GetScale)(Transform);
+
 	void (*SetPosition)(Transform, vector3 position);
 	void (*SetPositions)(Transform transform, float x, float y, float z);
 	void (*SetRotation)(Transform, quaternion rotation);
@@ -160,6 +135,10 @@ struct _transformMethods {
 	/// Saves a transform by serializing it to the provided stream
 	/// </summary>
 	void (*Save)(Transform, File stream);
+
+	void (*RunUnitTests)(void);
+	// Measures refreshing large hierarchies in the flattened layout against separately allocated nodes
+	void (*RunBenchmarks)(void);
 };
 
 extern const struct _transformMethods Transforms;
\ No newline at end of file
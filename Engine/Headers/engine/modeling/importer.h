@@ -18,6 +18,10 @@ struct _modelImporterMethods {
 	bool (*TryImport)(string path, FileFormat format, Model* out_model);
 
 	Model(*Import)(string path, FileFormat format);
+
+	void (*RunUnitTests)(void);
+	// Runs the long running import benchmarks, these write a large temporary .obj to the working directory
+	void (*RunBenchmarks)(void);
 };
 
 extern const struct _modelImporterMethods Importers;
\ No newline at end of file
@@ -4,10 +4,24 @@
 #include "core/math/vectors.h"
 #include "core/array.h"
 
+// the most levels of detail a mesh stores besides its full detail triangles
+#define MAX_MESH_LEVELS 4
+
 // options
 typedef struct _mesh* Mesh;
 typedef struct _mesh mesh;
 
+typedef struct _meshLevel meshLevel;
+
+// A simplified version of an indexed mesh that draws fewer triangles with the same vertices
+struct _meshLevel {
+	// The number of indices in the Indices array
+	ulong IndexCount;
+	uint* Indices;
+	// Roughly how far the simplified surface strays from the full detail surface, in the same units as the vertices
+	float Error;
+};
+
 struct _mesh {
 	char* Name;
 	bool SmoothingEnabled;
@@ -20,12 +34,24 @@ struct _mesh {
 	// The number of vector3 in the NormalVertexData array
 	ulong NormalCount;
 	vector3* NormalVertices;
+	// The number of indices in the Indices array, 0 when the mesh isn't indexed and every three vertices form a triangle
+	ulong IndexCount;
+	// Every three indices form a triangle, each index selects the same element of Vertices, TextureVertices and NormalVertices
+	uint* Indices;
+	// The number of levels in the Levels array, 0 when the mesh is only drawn at full detail
+	ulong LevelCount;
+	// Progressively simplified versions of the indexed mesh, ordered from the most to the least detailed
+	meshLevel Levels[MAX_MESH_LEVELS];
 	char* MaterialName;
 };
 
 struct _meshMethods {
 	Mesh(*Create)(void);
 	void (*Dispose)(Mesh mesh);
+	// Converts a mesh where every three vertices form a triangle into an indexed mesh that stores every unique
+	// (position, uv, normal) combination once, TextureCount and NormalCount must be 0 or equal to VertexCount
+	void (*Index)(Mesh mesh);
+	void (*RunUnitTests)(void);
 };
 
 extern const struct _meshMethods Meshes;
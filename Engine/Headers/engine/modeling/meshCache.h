@@ -0,0 +1,21 @@
+#pragma once
+
+#include "engine/modeling/model.h"
+#include "core/array.h"
+
+// appended to the path of a model's source file to get the path of its baked cache
+#define MESH_CACHE_EXTENSION ".meshcache"
+
+// Baked binary copies of imported models, a cache stores every mesh's name, material, smoothing,
+// attribute streams and indices exactly as they are laid out in memory so loading them is only a copy
+// out of a memory mapped file. Caches are keyed by the size and last write time of their source file.
+struct _meshCacheMethods {
+	// Attempts to load the cache baked for the source file at the provided path, returns false when there is no cache
+	// or the cache was baked from a source file with a different size or write time
+	bool (*TryLoad)(const string sourcePath, ulong sourceSize, ulong sourceLastModified, Model* out_model);
+	// Bakes the model into a cache next to the source file at the provided path, returns false if the cache could not be written
+	bool (*TrySave)(const string sourcePath, ulong sourceSize, ulong sourceLastModified, const Model model);
+	void (*RunUnitTests)(void);
+};
+
+extern const struct _meshCacheMethods MeshCaches;
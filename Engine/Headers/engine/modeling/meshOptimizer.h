@@ -0,0 +1,29 @@
+#pragma once
+
+#include "engine/modeling/mesh.h"
+
+// the number of vertices the post transform cache of a graphics device is assumed to hold
+#define DEFAULT_VERTEX_CACHE_SIZE 16
+// how much the cache miss ratio is allowed to grow so triangles can be sorted to reduce overdraw
+#define DEFAULT_OVERDRAW_THRESHOLD 1.05f
+
+// Reorders the triangles and vertices of indexed meshes so they are cheaper to draw without changing what is drawn,
+// meshes that aren't indexed are left as they are
+struct _meshOptimizerMethods {
+	// Reorders the triangles with Tipsify so vertices are reused while they are still in a cache of cacheSize vertices
+	void (*OptimizeVertexCache)(Mesh mesh, ulong cacheSize);
+	// Splits the triangles into clusters that each keep their cache miss ratio within threshold times the ratio of the
+	// current order, then draws the clusters facing away from the center of the mesh first so the depth test can reject
+	// more of what is behind them, should be used after OptimizeVertexCache
+	void (*OptimizeOverdraw)(Mesh mesh, ulong cacheSize, float threshold);
+	// Reorders the vertices in the order the triangles first use them so they are fetched sequentially, unused vertices are removed
+	void (*OptimizeVertexFetch)(Mesh mesh);
+	// Runs OptimizeVertexCache, OptimizeOverdraw and OptimizeVertexFetch with the default settings
+	void (*Optimize)(Mesh mesh);
+	// Gets the average cache miss ratio(ACMR) of the mesh, the number of vertices that have to be transformed per triangle
+	// with a first in first out cache of cacheSize vertices, 3 is the worst possible and 0.5 is the best a large grid can get
+	float (*CacheMissRatio)(const Mesh mesh, ulong cacheSize);
+	void (*RunUnitTests)(void);
+};
+
+extern const struct _meshOptimizerMethods MeshOptimizers;
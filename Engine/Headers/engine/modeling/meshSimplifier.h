@@ -0,0 +1,29 @@
+#pragma once
+
+#include "engine/modeling/mesh.h"
+
+// every level of detail aims for this fraction of the triangles of the level before it
+#define LEVEL_OF_DETAIL_REDUCTION 0.5f
+// levels stop being generated once one keeps more than this fraction of the triangles of the level before it
+#define MIN_LEVEL_OF_DETAIL_REDUCTION 0.8f
+// the largest error a level of detail may have, as a fraction of the radius of the mesh
+#define MAX_LEVEL_OF_DETAIL_ERROR 0.05f
+// meshes with fewer triangles than this are cheap enough to always draw at full detail
+#define MIN_LEVEL_OF_DETAIL_TRIANGLES 64
+
+// Simplifies indexed meshes by collapsing edges in the order of their quadric error(Garland and Heckbert), the
+// simplified triangles reuse the vertices of the mesh so levels of detail can share its vertex buffers
+struct _meshSimplifierMethods {
+	// Collapses edges until at most targetIndexCount indices remain or the next collapse would stray further than maxError
+	// from the surface, destination must have room for IndexCount indices, returns the number of indices written and the
+	// error of the result in out_error. Vertices on open borders only slide along the border, vertices that are split
+	// between several uvs or normals never move
+	ulong (*Simplify)(const Mesh mesh, ulong targetIndexCount, float maxError, uint* destination, float* out_error);
+	// Replaces the levels of the mesh with a chain where every level has about half the triangles of the one before it
+	void (*GenerateLevels)(Mesh mesh);
+	void (*RunUnitTests)(void);
+	// Measures how fast meshes are simplified and how far the levels stray from the source surface
+	void (*RunBenchmarks)(void);
+};
+
+extern const struct _meshSimplifierMethods MeshSimplifiers;
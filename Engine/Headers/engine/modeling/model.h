@@ -11,11 +11,16 @@ struct _model {
 	/// </summary>
 	ulong Count;
 	Mesh* Meshes;
+	// The number of owners sharing this model, the model is only freed when the last one disposes it
+	ulong ActiveInstances;
 };
 
 struct _modelMethods {
+	// Releases the model, the meshes are only freed once every instance has been disposed
 	void (*Dispose)(Model);
 	Model(*Create)(void);
+	// Shares the provided model with another owner, the same model is returned and must be disposed once more
+	Model(*Instance)(Model);
 };
 
 extern const struct _modelMethods Models;
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "core/config.h"
 #include "core/parsing.h"
 #include "engine/modeling/importer.h"
+#include "engine/assets.h"
 #include "core/quickmask.h"
 #include "core/math/triangles.h"
 #include "engine/graphics/drawing.h"
@@ -155,7 +156,10 @@ static Collider Load(const string path)
 
 		strings.AppendCArray(modelPath, state.ModelPath, strlen(state.ModelPath ? state.ModelPath : ""));
 
-		if (Importers.TryImport(modelPath, FileFormats.Obj, &model) == false)
+		// colliders that share a model share its meshes
+		model = Assets.LoadModel(modelPath);
+
+		if (model is null)
 		{
 			return result;
 		}
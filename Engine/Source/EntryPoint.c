@@ -44,6 +44,7 @@
 #include "engine/graphics/framebuffers.h"
 #include "engine/defaults.h"
 #include "engine/graphics/drawing.h"
+#include "engine/assets.h"
 #include "engine/ai/neat.h"
 
 // scripts (not intrinsically part of the engine)
@@ -298,6 +299,12 @@ int main()
 		// ensure deltaTime is updated
 		Time.Update();
 
+		// release last frame's scratch allocations
+		Memory.ArenaReset();
+
+		// upload assets that finished loading in the background
+		Assets.Update(ASSET_UPLOAD_BUDGET);
+
 		float modifier = speed * (float)Time.DeltaTime();
 
 		rotateAmount += modifier;
@@ -328,7 +335,7 @@ int main()
 		//Transforms.RotateOnAxis(lightPivot, , Vector3.Up);
 
 		// make a copy of camera's position
-		position = camera->Transform->Position;
+		position = Transforms.GetPosition(camera->Transform);
 
 		if (GetKey(KeyCodes.A))
 		{
@@ -409,6 +416,9 @@ int main()
 		// before we draw anything we should update the physics system
 		Physics.Update(Time.DeltaTime());
 
+		// everything has moved for this frame, calculate the world matrices once before drawing
+		Transforms.UpdateAll();
+
 		GameObjects.GenerateShadowMaps(gameobjects, sizeof(gameobjects) / sizeof(GameObject), scene, shadowMapMaterial, shadowCamera);
 
 		// draw scene
@@ -472,6 +482,18 @@ int main()
 	Materials.Dispose(defaultMaterial);
 	Materials.Dispose(shadowMapMaterial);
 
+	// everything that loaded an asset was disposed above, a model still held or a load still in flight was leaked
+	if (Assets.CountInUse() isnt 0)
+	{
+		throw(MemoryLeakException);
+	}
+
+	// the cache holds its own instance of every model, mesh, material and texture that was loaded, they have to be
+	// released while the graphics device still exists
+	Assets.Clear();
+
+	ShaderCompilers.Clear();
+
 	Cameras.Dispose(camera);
 	Cameras.Dispose(shadowCamera);
 
@@ -496,7 +518,7 @@ int main()
 void DebugCameraPosition(Camera camera)
 {
 	fprintf(stdout, "Position: ");
-	Vector3s.TrySerializeStream(stdout, camera->Transform->Position);
+	Vector3s.TrySerializeStream(stdout, Transforms.GetPosition(camera->Transform));
 	fprintf(stdout, " Rotation: [ x: %0.2fpi, y: %0.2fpi ] Forward: ", FPSCamera.State.HorizontalAngle / GLM_PI, FPSCamera.State.VerticalAngle / GLM_PI);
 	vector3 forwardVector = Transforms.GetDirection(camera->Transform, Directions.Forward);
 	Vector3s.TrySerializeStream(stdout, forwardVector);
@@ -0,0 +1,1037 @@
+#include "engine/assets.h"
+#include "engine/modeling/importer.h"
+#include "engine/modeling/meshCache.h"
+#include "core/memory.h"
+#include "core/map.h"
+#include "core/strings.h"
+#include "core/cunit.h"
+#include "core/threads.h"
+#include "core/atomics.h"
+#include "engine/time.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+private Model LoadModel(const string path);
+private bool TryLoadRenderMeshes(const string path, RenderMesh** out_meshes, ulong* out_count);
+private RawTexture LoadTexture(const string path);
+private Material LoadMaterial(const string path);
+private void Release(const string path);
+private void Clear(void);
+private ulong Count(void);
+private ulong CountInUse(void);
+private AssetHandle LoadAsync(const string path);
+private bool IsReady(const AssetHandle);
+private Model GetModel(const AssetHandle);
+private RawTexture GetTexture(const AssetHandle);
+private void DisposeHandle(AssetHandle);
+private void Update(double budgetSeconds);
+private void RunUnitTests(void);
+
+const struct _assetMethods Assets = {
+	.LoadModel = &LoadModel,
+	.TryLoadRenderMeshes = &TryLoadRenderMeshes,
+	.LoadTexture = &LoadTexture,
+	.LoadMaterial = &LoadMaterial,
+	.Release = &Release,
+	.Clear = &Clear,
+	.Count = &Count,
+	.CountInUse = &CountInUse,
+	.LoadAsync = &LoadAsync,
+	.IsReady = &IsReady,
+	.GetModel = &GetModel,
+	.GetTexture = &GetTexture,
+	.DisposeHandle = &DisposeHandle,
+	.Update = &Update,
+	.RunUnitTests = &RunUnitTests
+};
+
+typedef struct _asset asset;
+
+struct _asset {
+	// the copy of the path the asset is keyed by, owned by the cache
+	string Path;
+	// null for a model whose CPU side mesh data was dropped once its render meshes were bound
+	void* Resource;
+	// the render meshes bound for a model the first time they were requested, null until then
+	RenderMesh* RenderMeshes;
+	ulong RenderMeshCount;
+};
+
+DEFINE_MAP(string, asset);
+
+DEFINE_TYPE_ID(AssetRenderMeshes);
+
+// created on first use
+static map(string, asset) LoadedModels;
+static map(string, asset) LoadedTextures;
+static map(string, asset) LoadedMaterials;
+
+DEFINE_MAP(string, AssetHandle);
+
+// handles that are still being read or decoded keyed by their path, later requests for the same path share them
+// instead of decoding the file again, only used on the main thread
+static map(string, AssetHandle) LoadingAssets;
+
+// gets the asset loaded from the path, loading it when this is the first time the path was requested
+private asset* GetAsset(map(string, asset)* assets, const string path, void* (*Load)(const string path))
+{
+	if (path is null or strings.Empty(path))
+	{
+		return null;
+	}
+
+	if (*assets is null)
+	{
+		*assets = maps(string, asset).Create(16);
+	}
+
+	asset* existing = maps(string, asset).At(*assets, path);
+
+	if (existing isnt null)
+	{
+		return existing;
+	}
+
+	void* resource = Load(path);
+
+	// failures aren't cached so a file that is fixed or created later can still be loaded
+	if (resource is null)
+	{
+		return null;
+	}
+
+	string key = strings.Clone(path);
+
+	maps(string, asset).TryAdd(*assets, key, (asset) { .Path = key, .Resource = resource, .RenderMeshes = null, .RenderMeshCount = 0 });
+
+	return maps(string, asset).At(*assets, path);
+}
+
+private void* ImportModel(const string path)
+{
+	return Importers.Import(path, FileFormats.Obj);
+}
+
+private void* ReadTexture(const string path)
+{
+	return RawTextures.Load(path);
+}
+
+private void* ReadMaterial(const string path)
+{
+	return Materials.Load(path);
+}
+
+// the cache only keeps the vertices, indices and levels of a model while something other than the cache holds an
+// instance of it, the render meshes don't need them once they're bound and a large scene would keep every mesh twice
+private void DropUnusedModel(asset* entry)
+{
+	const Model model = entry->Resource;
+
+	if (entry->RenderMeshes isnt null and model isnt null and model->ActiveInstances <= 1)
+	{
+		Models.Dispose(model);
+
+		entry->Resource = null;
+	}
+}
+
+private Model LoadModel(const string path)
+{
+	asset* entry = GetAsset(&LoadedModels, path, &ImportModel);
+
+	if (entry is null)
+	{
+		return null;
+	}
+
+	// the model was dropped after its render meshes were bound, read it again for whatever needs the mesh data
+	if (entry->Resource is null)
+	{
+		entry->Resource = ImportModel(path);
+	}
+
+	return Models.Instance(entry->Resource);
+}
+
+private bool TryLoadRenderMeshes(const string path, RenderMesh** out_meshes, ulong* out_count)
+{
+	*out_meshes = null;
+	*out_count = 0;
+
+	asset* entry = GetAsset(&LoadedModels, path, &ImportModel);
+
+	if (entry is null)
+	{
+		return false;
+	}
+
+	// the first render meshes bound for a model stay in the cache, every load after returns instances of them
+	if (entry->RenderMeshes is null)
+	{
+		const Model model = entry->Resource;
+
+		if (RenderMeshes.TryBindModel(model, &entry->RenderMeshes) is false)
+		{
+			entry->RenderMeshes = null;
+			return false;
+		}
+
+		entry->RenderMeshCount = model->Count;
+	}
+
+	REGISTER_TYPE(AssetRenderMeshes);
+
+	RenderMesh* meshes = Memory.Alloc(max(entry->RenderMeshCount, 1) * sizeof(RenderMesh), AssetRenderMeshesTypeId);
+
+	for (ulong i = 0; i < entry->RenderMeshCount; i++)
+	{
+		meshes[i] = RenderMeshes.Instance(entry->RenderMeshes[i]);
+	}
+
+	*out_meshes = meshes;
+	*out_count = entry->RenderMeshCount;
+
+	DropUnusedModel(entry);
+
+	return true;
+}
+
+private RawTexture LoadTexture(const string path)
+{
+	asset* entry = GetAsset(&LoadedTextures, path, &ReadTexture);
+
+	return entry isnt null ? RawTextures.Instance(entry->Resource) : null;
+}
+
+private Material LoadMaterial(const string path)
+{
+	asset* entry = GetAsset(&LoadedMaterials, path, &ReadMaterial);
+
+	return entry isnt null ? Materials.Instance(entry->Resource) : null;
+}
+
+private void DisposeModel(asset* entry)
+{
+	if (entry->RenderMeshes isnt null)
+	{
+		RenderMeshes.DisposeModelMeshes(entry->RenderMeshes, entry->RenderMeshCount);
+	}
+
+	Models.Dispose(entry->Resource);
+}
+
+private void DisposeTexture(asset* entry)
+{
+	RawTextures.Dispose(entry->Resource);
+}
+
+private void DisposeMaterial(asset* entry)
+{
+	Materials.Dispose(entry->Resource);
+}
+
+private void ReleaseAsset(map(string, asset) assets, const string path, void (*Dispose)(asset*))
+{
+	if (assets is null)
+	{
+		return;
+	}
+
+	asset* entry = maps(string, asset).At(assets, path);
+
+	if (entry isnt null)
+	{
+		// the key is owned by the entry so it has to outlive the removal
+		string key = entry->Path;
+
+		Dispose(entry);
+
+		maps(string, asset).Remove(assets, path);
+
+		strings.Dispose(key);
+	}
+}
+
+private void Release(const string path)
+{
+	ReleaseAsset(LoadedModels, path, &DisposeModel);
+	ReleaseAsset(LoadedTextures, path, &DisposeTexture);
+	ReleaseAsset(LoadedMaterials, path, &DisposeMaterial);
+}
+
+private void ClearAssets(map(string, asset)* assets, void (*Dispose)(asset*))
+{
+	if (*assets is null)
+	{
+		return;
+	}
+
+	ulong cursor = 0;
+	string* key;
+	asset* entry;
+
+	while (maps(string, asset).TryGetNext(*assets, &cursor, &key, &entry))
+	{
+		Dispose(entry);
+		strings.Dispose(entry->Path);
+	}
+
+	maps(string, asset).Dispose(*assets);
+
+	*assets = null;
+}
+
+private void Clear(void)
+{
+	ClearAssets(&LoadedModels, &DisposeModel);
+	ClearAssets(&LoadedTextures, &DisposeTexture);
+	ClearAssets(&LoadedMaterials, &DisposeMaterial);
+
+	// loads that are still in flight keep the map, they remove themselves from it once they're uploaded
+	if (LoadingAssets isnt null and LoadingAssets->Count is 0)
+	{
+		maps(string, AssetHandle).Dispose(LoadingAssets);
+
+		LoadingAssets = null;
+	}
+}
+
+private ulong CountAssets(map(string, asset) assets)
+{
+	return assets isnt null ? assets->Count : 0;
+}
+
+private ulong Count(void)
+{
+	return CountAssets(LoadedModels) + CountAssets(LoadedTextures) + CountAssets(LoadedMaterials);
+}
+
+private ulong CountInUse(void)
+{
+	ulong count = LoadingAssets isnt null ? LoadingAssets->Count : 0;
+
+	if (LoadedModels is null)
+	{
+		return count;
+	}
+
+	ulong cursor = 0;
+	string* key;
+	asset* entry;
+
+	while (maps(string, asset).TryGetNext(LoadedModels, &cursor, &key, &entry))
+	{
+		const Model model = entry->Resource;
+
+		// the cache's own instance doesn't count
+		count += model isnt null and model->ActiveInstances > 1;
+	}
+
+	return count;
+}
+
+// the most threads that read and decode assets in the background
+#define MAX_ASSET_LOADERS 4
+
+typedef enum _assetType {
+	AssetTypeModel,
+	AssetTypeTexture
+} AssetType;
+
+typedef enum _assetState {
+	// waiting for, or being decoded by, a loader thread
+	AssetStateLoading,
+	AssetStateReady,
+	AssetStateFailed
+} AssetState;
+
+struct _assetHandle {
+	// owned by the handle
+	string Path;
+	AssetType Type;
+	// only read and written on the main thread
+	AssetState State;
+	// the Model or Image produced by a loader thread, null when it could not be loaded
+	void* Decoded;
+	// the handle's instance of the cached Model or RawTexture once it's ready
+	void* Resource;
+	// one for the caller and one while the handle is queued, only changed on the main thread
+	ulong ActiveInstances;
+	// the next handle in the queue this handle is in
+	AssetHandle Next;
+};
+
+DEFINE_TYPE_ID(AssetHandle);
+
+// a first in first out list of handles shared between the main thread and the loader threads
+struct _assetQueue {
+	volatile long Lock;
+	volatile ulong Count;
+	AssetHandle First;
+	AssetHandle Last;
+};
+
+// handles waiting for a loader thread
+static struct _assetQueue PendingLoads;
+// handles waiting for the main thread to upload them
+static struct _assetQueue PendingUploads;
+
+static struct _assetLoaders {
+	bool Started;
+	// released once for every handle added to PendingLoads
+	Semaphore LoadsAvailable;
+} AssetLoaders;
+
+private void LockQueue(struct _assetQueue* queue)
+{
+	// the lock is only held long enough to link or unlink a single handle
+	while (AtomicCompareExchange32(queue->Lock, true, false) isnt false)
+	{
+		SpinWait();
+	}
+}
+
+private void UnlockQueue(struct _assetQueue* queue)
+{
+	AtomicExchange32(queue->Lock, false);
+}
+
+private void Enqueue(struct _assetQueue* queue, AssetHandle handle)
+{
+	handle->Next = null;
+
+	LockQueue(queue);
+
+	if (queue->Last is null)
+	{
+		queue->First = handle;
+	}
+	else
+	{
+		queue->Last->Next = handle;
+	}
+
+	queue->Last = handle;
+	++queue->Count;
+
+	UnlockQueue(queue);
+}
+
+private bool TryDequeue(struct _assetQueue* queue, AssetHandle* out_handle)
+{
+	LockQueue(queue);
+
+	AssetHandle handle = queue->First;
+
+	if (handle isnt null)
+	{
+		queue->First = handle->Next;
+
+		if (queue->First is null)
+		{
+			queue->Last = null;
+		}
+
+		--queue->Count;
+	}
+
+	UnlockQueue(queue);
+
+	*out_handle = handle;
+
+	return handle isnt null;
+}
+
+private void DecodeAsset(AssetHandle handle)
+{
+	if (handle->Type is AssetTypeModel)
+	{
+		Model model;
+		handle->Decoded = Importers.TryImport(handle->Path, FileFormats.Obj, &model) ? model : null;
+		return;
+	}
+
+	Image image;
+	handle->Decoded = Images.TryLoadImage(handle->Path->Values, &image) ? image : null;
+}
+
+private void RunLoader(void* state)
+{
+	ignore_unused(state);
+
+	while (true)
+	{
+		Semaphores.Wait(AssetLoaders.LoadsAvailable);
+
+		AssetHandle handle;
+		if (TryDequeue(&PendingLoads, &handle))
+		{
+			DecodeAsset(handle);
+
+			Enqueue(&PendingUploads, handle);
+		}
+	}
+}
+
+// loaders are started the first time an asset is loaded asynchronously and live for the lifetime of the program
+private void StartLoaders(void)
+{
+	AssetLoaders.LoadsAvailable = Semaphores.Create(0);
+
+	// one processor is left for the main thread, parsing a model already spreads across the thread pool
+	const ulong processors = Threads.ProcessorCount();
+	const ulong count = processors > 1 ? min(processors - 1, MAX_ASSET_LOADERS) : 1;
+
+	for (ulong i = 0; i < count; i++)
+	{
+		Threads.Start(&RunLoader, null);
+	}
+
+	AssetLoaders.Started = true;
+}
+
+private bool IsModelPath(const string path)
+{
+	const ulong length = sizeof(".obj") - 1;
+
+	return path->Count >= length and memcmp(path->Values + path->Count - length, ".obj", length) is 0;
+}
+
+private AssetHandle LoadAsync(const string path)
+{
+	if (path is null or strings.Empty(path))
+	{
+		return null;
+	}
+
+	// the path is already being loaded, every caller gets an instance of the same handle
+	AssetHandle* loading = LoadingAssets isnt null ? maps(string, AssetHandle).At(LoadingAssets, path) : null;
+
+	if (loading isnt null)
+	{
+		++(*loading)->ActiveInstances;
+
+		return *loading;
+	}
+
+	REGISTER_TYPE(AssetHandle);
+
+	AssetHandle handle = Memory.Alloc(sizeof(struct _assetHandle), AssetHandleTypeId);
+
+	handle->Path = strings.Clone(path);
+	handle->Type = IsModelPath(path) ? AssetTypeModel : AssetTypeTexture;
+	handle->ActiveInstances = 1;
+
+	// assets that were already loaded don't have to wait for the loaders
+	if (handle->Type is AssetTypeModel and LoadedModels isnt null)
+	{
+		asset* entry = maps(string, asset).At(LoadedModels, path);
+
+		// models that were dropped after their render meshes were bound have to be read again
+		if (entry isnt null and entry->Resource isnt null)
+		{
+			handle->Resource = Models.Instance(entry->Resource);
+			handle->State = AssetStateReady;
+			return handle;
+		}
+	}
+	else if (handle->Type is AssetTypeTexture and LoadedTextures isnt null)
+	{
+		asset* entry = maps(string, asset).At(LoadedTextures, path);
+
+		if (entry isnt null)
+		{
+			handle->Resource = RawTextures.Instance(entry->Resource);
+			handle->State = AssetStateReady;
+			return handle;
+		}
+	}
+
+	if (AssetLoaders.Started is false)
+	{
+		StartLoaders();
+	}
+
+	handle->State = AssetStateLoading;
+
+	// the queues hold their own instance so the handle outlives an early DisposeHandle
+	++handle->ActiveInstances;
+
+	if (LoadingAssets is null)
+	{
+		LoadingAssets = maps(string, AssetHandle).Create(16);
+	}
+
+	// keyed by the handle's own copy of the path, it's removed before the queue releases the handle
+	maps(string, AssetHandle).TryAdd(LoadingAssets, handle->Path, handle);
+
+	Enqueue(&PendingLoads, handle);
+
+	Semaphores.Release(AssetLoaders.LoadsAvailable);
+
+	return handle;
+}
+
+private bool IsReady(const AssetHandle handle)
+{
+	return handle isnt null and handle->State isnt AssetStateLoading;
+}
+
+private Model GetModel(const AssetHandle handle)
+{
+	if (handle is null or handle->Type isnt AssetTypeModel or handle->State isnt AssetStateReady)
+	{
+		return null;
+	}
+
+	return Models.Instance(handle->Resource);
+}
+
+private RawTexture GetTexture(const AssetHandle handle)
+{
+	if (handle is null or handle->Type isnt AssetTypeTexture or handle->State isnt AssetStateReady)
+	{
+		return null;
+	}
+
+	return RawTextures.Instance(handle->Resource);
+}
+
+private void DisposeHandle(AssetHandle handle)
+{
+	if (handle is null or --handle->ActiveInstances isnt 0)
+	{
+		return;
+	}
+
+	if (handle->Resource isnt null)
+	{
+		if (handle->Type is AssetTypeModel)
+		{
+			Models.Dispose(handle->Resource);
+
+			asset* entry = LoadedModels isnt null ? maps(string, asset).At(LoadedModels, handle->Path) : null;
+
+			if (entry isnt null)
+			{
+				DropUnusedModel(entry);
+			}
+		}
+		else
+		{
+			RawTextures.Dispose(handle->Resource);
+		}
+	}
+
+	strings.Dispose(handle->Path);
+
+	Memory.Free(handle, AssetHandleTypeId);
+}
+
+// creates the graphics device resources for a decoded asset and stores them in the entry, the upload is a parameter
+// so it can be replaced when there is no graphics device
+typedef bool (*AssetUploader)(AssetHandle handle, asset* out_entry);
+
+private bool TryUploadAsset(AssetHandle handle, asset* out_entry)
+{
+	if (handle->Type is AssetTypeModel)
+	{
+		const Model model = handle->Decoded;
+
+		out_entry->Resource = model;
+		out_entry->RenderMeshCount = model->Count;
+
+		if (RenderMeshes.TryBindModel(model, &out_entry->RenderMeshes) is false)
+		{
+			out_entry->RenderMeshes = null;
+
+			Models.Dispose(model);
+			return false;
+		}
+
+		return true;
+	}
+
+	Image image = handle->Decoded;
+
+	RawTexture texture;
+	const bool created = RawTextures.TryCreateTexture(image, &texture);
+
+	Images.Dispose(image);
+
+	out_entry->Resource = texture;
+
+	return created;
+}
+
+// a cached model that was dropped after its render meshes were bound takes the decoded model, the render meshes are
+// already on the graphics device so nothing is uploaded
+private bool TryRestoreModel(AssetHandle handle)
+{
+	if (handle->Type isnt AssetTypeModel or handle->Decoded is null or LoadedModels is null)
+	{
+		return false;
+	}
+
+	asset* entry = maps(string, asset).At(LoadedModels, handle->Path);
+
+	if (entry is null or entry->Resource isnt null)
+	{
+		return false;
+	}
+
+	entry->Resource = handle->Decoded;
+
+	handle->Decoded = null;
+	handle->Resource = Models.Instance(entry->Resource);
+	handle->State = AssetStateReady;
+
+	return true;
+}
+
+private void FinishUpload(AssetHandle handle, AssetUploader TryUpload)
+{
+	// requests made from here on find the uploaded asset in the cache
+	maps(string, AssetHandle).Remove(LoadingAssets, handle->Path);
+
+	if (TryRestoreModel(handle))
+	{
+		return;
+	}
+
+	asset uploaded = { .Path = null, .Resource = null, .RenderMeshes = null, .RenderMeshCount = 0 };
+
+	if (handle->Decoded is null or TryUpload(handle, &uploaded) is false)
+	{
+		handle->Decoded = null;
+		handle->State = AssetStateFailed;
+		return;
+	}
+
+	handle->Decoded = null;
+
+	const bool isModel = handle->Type is AssetTypeModel;
+	map(string, asset)* assets = isModel ? &LoadedModels : &LoadedTextures;
+
+	if (*assets is null)
+	{
+		*assets = maps(string, asset).Create(16);
+	}
+
+	asset* entry = maps(string, asset).At(*assets, handle->Path);
+
+	// the path may have been loaded synchronously while this was decoding, the first one loaded is the one every caller shares
+	if (entry isnt null)
+	{
+		if (isModel)
+		{
+			DisposeModel(&uploaded);
+		}
+		else
+		{
+			DisposeTexture(&uploaded);
+		}
+	}
+	else
+	{
+		uploaded.Path = strings.Clone(handle->Path);
+
+		maps(string, asset).TryAdd(*assets, uploaded.Path, uploaded);
+
+		entry = maps(string, asset).At(*assets, handle->Path);
+	}
+
+	handle->Resource = isModel ? (void*)Models.Instance(entry->Resource) : (void*)RawTextures.Instance(entry->Resource);
+	handle->State = AssetStateReady;
+}
+
+private void ProcessUploads(double budgetSeconds, double (*Now)(void), AssetUploader TryUpload)
+{
+	const double start = Now();
+
+	AssetHandle handle;
+	do
+	{
+		if (TryDequeue(&PendingUploads, &handle) is false)
+		{
+			return;
+		}
+
+		FinishUpload(handle, TryUpload);
+
+		// releases the queue's instance
+		DisposeHandle(handle);
+	} while (Now() - start < budgetSeconds);
+}
+
+private double FrameTime(void)
+{
+	return Time.Time();
+}
+
+private void Update(double budgetSeconds)
+{
+	ProcessUploads(budgetSeconds, &FrameTime, &TryUploadAsset);
+}
+
+private bool TryUploadWithoutDevice(AssetHandle handle, asset* out_entry)
+{
+	// models are cached without render meshes, those are bound the first time they're requested
+	if (handle->Type is AssetTypeModel)
+	{
+		out_entry->Resource = handle->Decoded;
+		return true;
+	}
+
+	Images.Dispose(handle->Decoded);
+
+	return false;
+}
+
+private double ProcessorTime(void)
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+private void RemoveTestModel(const string path)
+{
+	remove(path->Values);
+
+	string cachePath = empty_stack_array(byte, _MAX_PATH);
+	strings.AppendArray(cachePath, path);
+	strings.AppendCArray(cachePath, MESH_CACHE_EXTENSION, sizeof(MESH_CACHE_EXTENSION) - 1);
+	remove(cachePath->Values);
+}
+
+TEST(ModelsAreShared)
+{
+	string path = stack_string("asset_cache_test.obj");
+
+	File file = Files.Open(path, FileModes.Create);
+	fprintf(file, "o Triangle\nv 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n");
+	Files.Close(file);
+
+	Model first = Assets.LoadModel(path);
+	Model second = Assets.LoadModel(path);
+
+	IsTrue(first isnt null);
+	IsTrue(first is second);
+
+	// the cache holds an instance of its own
+	IsEqual(3ull, first->ActiveInstances);
+
+	IsEqual(1ull, Assets.CountInUse());
+
+	Models.Dispose(second);
+
+	// released models stay valid for anything that still holds an instance
+	Assets.Release(path);
+	IsEqual(1ull, first->ActiveInstances);
+	IsEqual(1ull, first->Count);
+
+	// the next load reads the file again
+	second = Assets.LoadModel(path);
+	IsFalse(first is second);
+
+	IsEqual(1ull, Assets.CountInUse());
+
+	Models.Dispose(first);
+	Models.Dispose(second);
+
+	IsEqual(1ull, Assets.Count());
+	IsEqual(0ull, Assets.CountInUse());
+
+	Assets.Clear();
+
+	IsEqual(0ull, Assets.Count());
+
+	RemoveTestModel(path);
+
+	// missing files aren't cached
+	IsNull(Assets.LoadModel(path));
+
+	return true;
+}
+
+TEST(LoadAsyncUploadsOnMainThread)
+{
+	string path = stack_string("asset_async_test.obj");
+	string otherPath = stack_string("asset_async_other_test.obj");
+	string missingPath = stack_string("asset_async_missing_test.png");
+
+	File file = Files.Open(path, FileModes.Create);
+	fprintf(file, "o Triangle\nv 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n");
+	Files.Close(file);
+
+	file = Files.Open(otherPath, FileModes.Create);
+	fprintf(file, "o Quad\nv 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nf 1 2 3\nf 3 2 4\n");
+	Files.Close(file);
+
+	AssetHandle handle = Assets.LoadAsync(path);
+	AssetHandle other = Assets.LoadAsync(otherPath);
+	AssetHandle missing = Assets.LoadAsync(missingPath);
+
+	// a path that is already loading isn't decoded twice, both callers and the queue share one handle
+	AssetHandle sameHandle = Assets.LoadAsync(path);
+	IsTrue(sameHandle is handle);
+	IsEqual(3ull, handle->ActiveInstances);
+
+	// loads that haven't been uploaded are still in use
+	IsEqual(3ull, Assets.CountInUse());
+
+	while (PendingUploads.Count < 3)
+	{
+		SpinWait();
+	}
+
+	// decoded assets wait for the main thread
+	IsFalse(Assets.IsReady(handle));
+	IsFalse(Assets.IsReady(other));
+	IsFalse(Assets.IsReady(missing));
+
+	// a spent budget still uploads one asset so loading always makes progress
+	ProcessUploads(0, &ProcessorTime, &TryUploadWithoutDevice);
+	IsEqual(2ull, (ulong)PendingUploads.Count);
+
+	ProcessUploads(1.0, &ProcessorTime, &TryUploadWithoutDevice);
+	IsEqual(0ull, (ulong)PendingUploads.Count);
+
+	IsTrue(Assets.IsReady(handle));
+	IsTrue(Assets.IsReady(other));
+	IsTrue(Assets.IsReady(missing));
+	IsEqual(0ull, LoadingAssets->Count);
+
+	Model model = Assets.GetModel(handle);
+	Model otherModel = Assets.GetModel(other);
+
+	IsTrue(model isnt null);
+	IsTrue(otherModel isnt null);
+	IsEqual(1ull, model->Count);
+	IsEqual(6ull, otherModel->Meshes[0]->IndexCount);
+
+	// failed loads are ready but have nothing to get
+	IsNull(Assets.GetTexture(missing));
+	IsNull(Assets.GetModel(missing));
+
+	// uploaded assets are shared with synchronous loads
+	Model loaded = Assets.LoadModel(path);
+	IsTrue(loaded is model);
+	Models.Dispose(loaded);
+
+	// later requests for a loaded asset are ready immediately
+	AssetHandle again = Assets.LoadAsync(path);
+	IsTrue(Assets.IsReady(again));
+
+	loaded = Assets.GetModel(again);
+	IsTrue(loaded is model);
+	Models.Dispose(loaded);
+
+	Assets.DisposeHandle(again);
+	Assets.DisposeHandle(sameHandle);
+	Assets.DisposeHandle(handle);
+	Assets.DisposeHandle(other);
+	Assets.DisposeHandle(missing);
+
+	// the cache's instance and the instances that were returned
+	IsEqual(2ull, model->ActiveInstances);
+
+	Models.Dispose(model);
+	Models.Dispose(otherModel);
+
+	IsEqual(0ull, Assets.CountInUse());
+
+	Assets.Clear();
+
+	RemoveTestModel(path);
+	RemoveTestModel(otherPath);
+
+	return true;
+}
+
+TEST(UnusedModelsAreDropped)
+{
+	string path = stack_string("asset_drop_test.obj");
+
+	File file = Files.Open(path, FileModes.Create);
+	fprintf(file, "o Triangle\nv 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n");
+	Files.Close(file);
+
+	Model model = Assets.LoadModel(path);
+
+	asset* entry = maps(string, asset).At(LoadedModels, path);
+
+	// stands in for render meshes bound on the graphics device, they're never drawn or disposed here
+	RenderMesh bound[1] = { null };
+	entry->RenderMeshes = bound;
+	entry->RenderMeshCount = 1;
+
+	// a model something else holds an instance of is kept
+	DropUnusedModel(entry);
+	IsTrue(entry->Resource is model);
+
+	Models.Dispose(model);
+
+	// only the cache's instance is left and the render meshes don't need it
+	DropUnusedModel(entry);
+	IsNull(entry->Resource);
+
+	// loading the model reads it again and keeps the bound render meshes
+	Model reloaded = Assets.LoadModel(path);
+	IsTrue(reloaded isnt null);
+	IsTrue(entry->Resource is reloaded);
+	IsTrue(entry->RenderMeshes is bound);
+
+	Models.Dispose(reloaded);
+	DropUnusedModel(entry);
+	IsNull(entry->Resource);
+
+	// loading a dropped model in the background restores it without uploading anything
+	AssetHandle handle = Assets.LoadAsync(path);
+	IsFalse(Assets.IsReady(handle));
+
+	while (PendingUploads.Count < 1)
+	{
+		SpinWait();
+	}
+
+	ProcessUploads(1.0, &ProcessorTime, &TryUploadWithoutDevice);
+
+	IsTrue(Assets.IsReady(handle));
+
+	Model restored = Assets.GetModel(handle);
+	IsTrue(restored isnt null);
+	IsTrue(entry->Resource is restored);
+	IsTrue(entry->RenderMeshes is bound);
+
+	// disposing the handle drops the model once nothing else holds it
+	Assets.DisposeHandle(handle);
+	IsTrue(entry->Resource is restored);
+
+	Models.Dispose(restored);
+
+	// the cache's instance alone isn't dropped until something releases the model through the cache
+	IsTrue(entry->Resource is restored);
+
+	handle = Assets.LoadAsync(path);
+	IsTrue(Assets.IsReady(handle));
+
+	Assets.DisposeHandle(handle);
+	IsNull(entry->Resource);
+
+	entry->RenderMeshes = null;
+
+	Assets.Clear();
+
+	RemoveTestModel(path);
+
+	return true;
+}
+
+TEST_SUITE(
+	RunUnitTests,
+	APPEND_TEST(ModelsAreShared)
+	APPEND_TEST(LoadAsyncUploadsOnMainThread)
+	APPEND_TEST(UnusedModelsAreDropped)
+);
@@ -91,7 +91,9 @@ static void RecalculateView(Camera camera)
 
 static void RecalculateViewProjection(Camera camera)
 {
-	camera->State.View = Matrix4s.Inverse(camera->Transform->State.State);
+	camera->State.View = Matrix4s.Inverse(Transforms.Refresh(camera->Transform));
+
+	camera->State.TransformVersion = Transforms.Version(camera->Transform);
 
 	camera->State.State = Matrix4s.Multiply(camera->State.Projection,
 		camera->State.View);
@@ -114,8 +116,8 @@ static matrix4 RefreshCamera(Camera camera)
 {
 	unsigned int mask = camera->State.Modified;
 
-	// check to see if our transform has changed
-	if (camera->Transform->State.Modified isnt 0)
+	// check to see if our transform has changed since the view was calculated
+	if (Transforms.Version(camera->Transform) isnt camera->State.TransformVersion)
 	{
 		SetFlag(mask, ViewModifiedFlag);
 	}
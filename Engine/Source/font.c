@@ -4,6 +4,7 @@
 #include <float.h>
 #include <ctype.h>
 #include "engine/modeling/importer.h"
+#include "core/scanning.h"
 
 static Font Create(Model);
 static void Dispose(Font);
@@ -224,20 +225,75 @@ static void SetMaterial(Font font, Material material)
 	font->Material = Materials.Instance(material);
 }
 
+// moves the cursor past any whitespace and the word after it
+static const char* SkipWord(const char* cursor, const char* end)
+{
+	while (cursor < end and isspace((unsigned char)*cursor))
+	{
+		++cursor;
+	}
+
+	while (cursor < end and isspace((unsigned char)*cursor) is false)
+	{
+		++cursor;
+	}
+
+	return cursor;
+}
+
+// moves the cursor past any whitespace and the keyword, returns false if the keyword isn't next
+static bool TryReadKeyword(const char** cursor, const char* end, const char* keyword)
+{
+	const char* position = *cursor;
+
+	while (position < end and isspace((unsigned char)*position))
+	{
+		++position;
+	}
+
+	const ulong length = strlen(keyword);
+
+	if ((ulong)(end - position) < length or memcmp(position, keyword, length) isnt 0)
+	{
+		return false;
+	}
+
+	*cursor = position + length;
+
+	return true;
+}
+
 static bool TryLoadCharacterSize(Mesh mesh, FontCharacter character)
 {
 	// example:
 	// o symbol U+0021 glyph 4 xadv 0.545 lsb 0.192 rsb 0.189  ymin -0.025 ymax 0.790
-	// %*s      U+%x   %*s %*i xadv %lf    lsb %lf    rsb %lf  ymin %f     ymax %f
-	ulong count = sscanf_s(mesh->Name, "%*s U+%hx %*s %*i xadv %f lsb %f rsb %f ymin %f ymax %f",
-		&character->Id,
-		&character->Advance,
-		&character->LeftBearing,
-		&character->RightBearing,
-		&character->MinY,
-		&character->MaxY);
-
-	return count == 6;
+	//   <word> U+<hex> <word> <int> xadv <float> lsb <float> rsb <float> ymin <float> ymax <float>
+	if (mesh->Name is null)
+	{
+		return false;
+	}
+
+	const char* end = mesh->Name + strlen(mesh->Name);
+	const char* cursor = SkipWord(mesh->Name, end);
+
+	ulong id;
+	if (TryReadKeyword(&cursor, end, "U+") is false or Scanning.TryScanHex(&cursor, end, &id) is false or id > 0xFFFF)
+	{
+		return false;
+	}
+
+	character->Id = (unsigned short)id;
+
+	cursor = SkipWord(cursor, end);
+
+	long long glyph;
+
+	return Scanning.TryScanInteger(&cursor, end, &glyph)
+		and TryReadKeyword(&cursor, end, "xadv") and Scanning.TryScanFloat(&cursor, end, &character->Advance)
+		and TryReadKeyword(&cursor, end, "lsb") and Scanning.TryScanFloat(&cursor, end, &character->LeftBearing)
+		and TryReadKeyword(&cursor, end, "rsb") and Scanning.TryScanFloat(&cursor, end, &character->RightBearing)
+		and TryReadKeyword(&cursor, end, "ymin") and Scanning.TryScanFloat(&cursor, end, &character->MinY)
+		and TryReadKeyword(&cursor, end, "ymax") and Scanning.TryScanFloat(&cursor, end, &character->MaxY);
 }
 
 static FontCharacter CreateCharacter(Mesh mesh)
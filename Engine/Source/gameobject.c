@@ -8,11 +8,18 @@
 #include "core/math/ints.h"
 #include "core/parsing.h"
 #include "engine/modeling/importer.h"
+#include "engine/assets.h"
 #include "cglm/quat.h"
+#include "cglm/util.h"
+#include <math.h>
 #include "engine/defaults.h"
 
 Material DefaultMaterial = null;
 
+// the largest a level of detail's error may look from the camera as a fraction of the height of the view, about a
+// pixel on a 1080p display
+#define LEVEL_OF_DETAIL_SCREEN_ERROR (1.0f / 1080.0f)
+
 static GameObject Duplicate(GameObject);
 static void SetName(GameObject, char* name);
 static void Dispose(GameObject);
@@ -80,7 +87,7 @@ static void Dispose(GameObject gameobject)
 
 	Materials.Dispose(gameobject->Material);
 
-	Memory.Free(gameobject, GameObjectTypeId);
+	Memory.PoolFree(gameobject, GameObjectTypeId);
 }
 
 static GameObject CreateGameObject()
@@ -92,7 +99,7 @@ static GameObject CreateWithMaterial(Material material)
 {
 	Memory.RegisterTypeName(nameof(GameObject), &GameObjectTypeId);
 
-	GameObject gameObject = Memory.Alloc(sizeof(struct _gameObject), GameObjectTypeId);
+	GameObject gameObject = Memory.PoolAlloc(sizeof(struct _gameObject), GameObjectTypeId);
 
 	gameObject->Transform = Transforms.Create();
 	gameObject->Material = Materials.Instance(material);
@@ -105,7 +112,7 @@ static GameObject CreateEmpty(ulong count)
 	Memory.RegisterTypeName(nameof(GameObject), &GameObjectTypeId);
 	Memory.RegisterTypeName(nameof(GameObjectMeshes), &GameObjectMeshesTypeId);
 
-	GameObject gameObject = Memory.Alloc(sizeof(struct _gameObject), GameObjectTypeId);
+	GameObject gameObject = Memory.PoolAlloc(sizeof(struct _gameObject), GameObjectTypeId);
 
 	gameObject->Transform = null;
 	gameObject->Material = null;
@@ -195,31 +202,67 @@ static void SetMaterial(GameObject gameobject, Material material)
 	gameobject->Material = Materials.Instance(material);
 }
 
-static void Draw(GameObject gameobject, Scene scene)
+private float GetLength(const vector4 column)
 {
-	// since it's more than  likely the gameobject itself is the parent to all of the transforms
-	// it controls we should refresh it's transform first
-	Transforms.Refresh(gameobject->Transform);
+	return sqrtf((column.x * column.x) + (column.y * column.y) + (column.z * column.z));
+}
+
+// picks the least detailed level of the mesh whose error is too small to notice from the camera
+private void SelectLevel(RenderMesh mesh, Camera camera)
+{
+	mesh->Level = 0;
+
+	if (mesh->LevelCount < 2 or camera is null)
+	{
+		return;
+	}
+
+	const matrix4 world = Transforms.GetWorldMatrix(mesh->Transform);
+
+	const vector3 cameraPosition = Transforms.GetPosition(camera->Transform);
+
+	const float dx = world.Column4.x - cameraPosition.x;
+	const float dy = world.Column4.y - cameraPosition.y;
+	const float dz = world.Column4.z - cameraPosition.z;
+
+	const float distance = sqrtf((dx * dx) + (dy * dy) + (dz * dz));
 
+	// errors are in model space, a scaled model scales them too
+	const float scale = max(GetLength(world.Column1), max(GetLength(world.Column2), GetLength(world.Column3)));
+
+	// how much of the world the view covers vertically at the distance of the mesh
+	const float viewHeight = camera->Orthographic ?
+		camera->TopDistance - camera->BottomDistance :
+		2.0f * distance * tanf(glm_rad(camera->FieldOfView) * 0.5f);
+
+	const float tolerance = viewHeight * LEVEL_OF_DETAIL_SCREEN_ERROR;
+
+	for (ulong level = mesh->LevelCount - 1; level > 0; level--)
+	{
+		if (mesh->Levels[level].Error * scale <= tolerance)
+		{
+			mesh->Level = level;
+			return;
+		}
+	}
+}
+
+private void SelectLevels(GameObject gameobject, Camera camera)
+{
 	for (ulong i = 0; i < gameobject->Count; i++)
 	{
 		RenderMesh mesh = gameobject->Meshes[i];
 
-		if (mesh is null)
+		if (mesh isnt null)
 		{
-			continue;
+			SelectLevel(mesh, camera);
 		}
-
-		Materials.Draw(gameobject->Material, mesh, scene);
 	}
 }
 
-static void DrawWithMaterial(GameObject gameobject, Scene scene, Material material)
+// draws each mesh at the level that was last selected for it
+private void DrawSelectedLevels(GameObject gameobject, Scene scene, Material material)
 {
-	// since it's more than  likely the gameobject itself is the parent to all of the transforms
-	// it controls we should refresh it's transform first
-	Transforms.Refresh(gameobject->Transform);
-
 	for (ulong i = 0; i < gameobject->Count; i++)
 	{
 		RenderMesh mesh = gameobject->Meshes[i];
@@ -233,6 +276,20 @@ static void DrawWithMaterial(GameObject gameobject, Scene scene, Material materi
 	}
 }
 
+static void Draw(GameObject gameobject, Scene scene)
+{
+	SelectLevels(gameobject, scene->MainCamera);
+
+	DrawSelectedLevels(gameobject, scene, gameobject->Material);
+}
+
+static void DrawWithMaterial(GameObject gameobject, Scene scene, Material material)
+{
+	SelectLevels(gameobject, scene->MainCamera);
+
+	DrawSelectedLevels(gameobject, scene, material);
+}
+
 static void DrawMany(GameObject* array, ulong count, Scene scene, Material override)
 {
 	if (override isnt null)
@@ -318,6 +375,13 @@ static void GenerateShadowMaps(GameObject* array, ulong count, Scene scene, Mate
 		return;
 	}
 
+	// shadows are cast by the same level the camera sees, a caster drawn at a different level than the surface that
+	// receives its shadow would shadow itself
+	for (ulong i = 0; i < count; i++)
+	{
+		SelectLevels(array[i], scene->MainCamera);
+	}
+
 	Camera previousCam = scene->MainCamera;
 	scene->MainCamera = shadowCamera;
 
@@ -340,10 +404,8 @@ static void GenerateShadowMaps(GameObject* array, ulong count, Scene scene, Mate
 
 		// first set up the "camera" that will be the light
 		// set the tranform
-		Transforms.Refresh(light->Transform);
-
-		Transforms.SetPosition(shadowCamera->Transform, light->Transform->Position);
-		Transforms.SetRotation(shadowCamera->Transform, light->Transform->Rotation);
+		Transforms.SetPosition(shadowCamera->Transform, Transforms.GetPosition(light->Transform));
+		Transforms.SetRotation(shadowCamera->Transform, Transforms.GetRotation(light->Transform));
 
 		Cameras.Refresh(shadowCamera);
 
@@ -364,7 +426,7 @@ static void GenerateShadowMaps(GameObject* array, ulong count, Scene scene, Mate
 		// for each light generate it's shadow map by rendering the scene with the provided material
 		for (ulong i = 0; i < count; i++)
 		{
-			DrawWithMaterial(array[i], scene, shadowMaterial);
+			DrawSelectedLevels(array[i], scene, shadowMaterial);
 		}
 
 		// now that the camera's transform should have been updated set it's property
@@ -463,33 +525,19 @@ static GameObject Load(const string path)
 			string modelPath = empty_stack_array(byte, _MAX_PATH);
 			strings.AppendCArray(modelPath, state.ModelPath, modelPathLength);
 
-			// load the model first so we can determine how many render meshes we will need
-			Model model;
-			if (Importers.TryImport(modelPath, FileFormats.Obj, &model) is false)
+			// every gameobject that uses the same model shares the buffers that were uploaded the first time it was loaded
+			if (Assets.TryLoadRenderMeshes(modelPath, &meshArray, &count) is false)
 			{
 				fprintf(stderr, "Failed to import the model at path: %s"NEWLINE, state.ModelPath);
 				throw(FailedToImportModelException);
 			}
-
-			count = model->Count;
-
-			// convert the model into a mesh array so we can use it on the gameobject
-
-			if (RenderMeshes.TryBindModel(model, &meshArray) is false)
-			{
-				Models.Dispose(model);
-				throw(FailedToBindMeshException);
-			}
-
-			// get rid of the model now that we have converted it
-			Models.Dispose(model);
 		}
 
 		// load the material
 		ulong materialPathLength = strlen(state.MaterialPath ? state.MaterialPath : "");
 		string materialPath = empty_stack_array(byte, _MAX_PATH);
 		strings.AppendCArray(materialPath, state.MaterialPath, materialPathLength);
-		Material material = Materials.Load(materialPath);
+		Material material = Assets.LoadMaterial(materialPath);
 
 		// if no material was listed use the default one
 		if (material is null)
@@ -6,10 +6,22 @@
 #include <ctype.h>
 #include <string.h>
 #include "engine/modeling/model.h"
+#include "engine/modeling/meshCache.h"
+#include "engine/modeling/meshOptimizer.h"
+#include "engine/modeling/meshSimplifier.h"
 #include "core/memory.h"
 #include "core/math/vectors.h"
 #include "core/parsing.h"
+#include "core/scanning.h"
 #include "core/strings.h"
+#include "core/cunit.h"
+#include "core/threads.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <time.h>
+
+DEFINE_ARRAY(vector2);
+DEFINE_ARRAY(vector3);
 
 typedef int Token;
 typedef const char* Sequence;
@@ -82,15 +94,18 @@ struct _fileBuffer {
 #define _TO_STRING(s) #s
 #define ToString(s) TO_STRING(s)
 
-#define BUFFER_SIZE 1024
 #define MAX_OBJECT_NAME_LENGTH 128
-#define MAX_FACES SHRT_MAX
 
 static bool TryImportModel(string path, FileFormat format, Model* out_model);
 static Model ImportModel(string path, FileFormat format);
+private void RunUnitTests(void);
+private void RunBenchmarks(void);
+
 const struct _modelImporterMethods Importers = {
 	.TryImport = &TryImportModel,
-	.Import = &ImportModel
+	.Import = &ImportModel,
+	.RunUnitTests = RunUnitTests,
+	.RunBenchmarks = RunBenchmarks
 };
 
 static void DisposeFileBuffer(FileBuffer buffer)
@@ -114,221 +129,328 @@ static bool VerifyFormat(FileFormat format)
 	return false;
 }
 
-/// <summary>
-/// contains count information for a object file
-/// </summary>
-struct _elementCounts {
-	/// <summary>
-	/// The number of vertices in the entire file
-	/// </summary>
-	ulong VertexCount;
-	/// <summary>
-	/// the number of normals in the entire file
-	/// </summary>
-	ulong NormalCount;
-	/// <summary>
-	/// the number of texture in the entire file
-	/// </summary>
-	ulong TextureCount;
-	/// <summary>
-	/// The number of objects within the file
-	/// </summary>
-	ulong ObjectCount;
-	/// <summary>
-	/// The number of materials in the entire file
-	/// </summary>
-	ulong MaterialCount;
-	/// <summary>
-	/// the number of faces in the entire file
-	/// </summary>
-	ulong FaceCount;
-	/// <summary>
-	/// An array of the number of faces for each object encountered, the number of faces for the nth object is FaceCounts[n]
-	/// </summary>
-	ulong* FaceCounts;
-};
+DEFINE_TYPE_ID(ModelMeshes);
 
 struct _bufferCollection {
 	/// <summary>
-	/// The array of meshes for the entire model
+	/// The array of meshes for the entire model, grows geometrically as objects are found
 	/// </summary>
 	Mesh* Meshes;
 	/// <summary>
-	/// The index of the next empty mesh within the Meshes array
+	/// The number of meshes stored in the Meshes array
 	/// </summary>
-	ulong MeshIndex;
+	ulong MeshCount;
 	/// <summary>
-	/// The vertex buffer that is shared for the entire model
+	/// The number of meshes the Meshes array can hold before it has to grow
 	/// </summary>
-	vector3* Vertices;
+	ulong MeshCapacity;
 	/// <summary>
-	/// The current index that  is empty within the vertices buffer
+	/// The number of face corners the current mesh's vertex, uv and normal arrays can hold before they have to grow
 	/// </summary>
-	ulong VertexIndex;
+	ulong CornerCapacity;
 	/// <summary>
-	/// The texture buffer that is shared for the entire model
+	/// The vertex buffer that is shared for the entire model
 	/// </summary>
-	vector2* Textures;
+	array(vector3) Vertices;
 	/// <summary>
-	/// The current index that  is empty within the texture buffer
+	/// The texture buffer that is shared for the entire model
 	/// </summary>
-	ulong TextureIndex;
+	array(vector2) Textures;
 	/// <summary>
 	/// The normals buffer that is shared for the entire model
 	/// </summary>
-	vector3* Normals;
-	/// <summary>
-	/// The current index that  is empty within the normals buffer
-	/// </summary>
-	ulong NormalIndex;
+	array(vector3) Normals;
 };
 
 static void DisposeBufferCollection(struct _bufferCollection* buffers)
 {
-	Memory.Free(buffers->Meshes, Memory.GenericMemoryBlock);
-	Memory.Free(buffers->Vertices, Memory.GenericMemoryBlock);
-	Memory.Free(buffers->Textures, Memory.GenericMemoryBlock);
-	Memory.Free(buffers->Normals, Memory.GenericMemoryBlock);
+	if (buffers->Meshes isnt null)
+	{
+		for (ulong i = 0; i < buffers->MeshCount; i++)
+		{
+			Meshes.Dispose(buffers->Meshes[i]);
+		}
+	}
+
+	Memory.Free(buffers->Meshes, ModelMeshesTypeId);
+	arrays(vector3).Dispose(buffers->Vertices);
+	arrays(vector2).Dispose(buffers->Textures);
+	arrays(vector3).Dispose(buffers->Normals);
+}
+
+private bool IsBlank(char c)
+{
+	return c is ' ' or c is '\t';
 }
 
-static bool TryCountElements(File stream, array(byte) buffer, struct _elementCounts* out_counts)
+// moves the cursor past any spaces or tabs, never moves past the end of the line
+private const char* SkipBlanks(const char* cursor, const char* end)
 {
-	if (out_counts is null || stream is null)
+	while (cursor < end and IsBlank(*cursor))
 	{
-		return false;
+		++cursor;
 	}
 
-	rewind(stream);
+	return cursor;
+}
+
+private bool TryScanVector3(const char* cursor, const char* end, vector3* out_vector)
+{
+	return Scanning.TryScanFloat(&cursor, end, &out_vector->x)
+		and Scanning.TryScanFloat(&cursor, end, &out_vector->y)
+		and Scanning.TryScanFloat(&cursor, end, &out_vector->z);
+}
 
-	// iterate through the file and count various element types so we can alloc the correct amount of space
-	// for when we actually process the file
-	ulong lineLength;
+private bool TryScanVector2(const char* cursor, const char* end, vector2* out_vector)
+{
+	return Scanning.TryScanFloat(&cursor, end, &out_vector->x)
+		and Scanning.TryScanFloat(&cursor, end, &out_vector->y);
+}
 
-	while (Files.TryReadLine(stream, buffer, 0, &lineLength))
+// converts a 1 based, or negative relative, .obj index into a 0 based index, omitted indices (0) point at the first element
+private bool TryResolveIndex(long long index, ulong count, ulong* out_index)
+{
+	if (index < 0)
 	{
-		// if for some reason the line is blank ignore it
-		if (lineLength < 1)
-		{
-			continue;
-		}
+		index += (long long)count;
+	}
+	else if (index > 0)
+	{
+		--index;
+	}
 
-		// get the first char so we don't compare entire strings
-		char c = buffer->Values[0];
+	*out_index = (ulong)index;
 
-		// !! these are ordered by frequency count, not in order of occurence !!
+	return index >= 0 and (ulong)index < count;
+}
+
+// reads a single face corner in the form v, v/vt, v/vt/vn, v//vn or v/vt/
+// attributes that are not present are left untouched
+private bool TryScanFaceCorner(const char** cursor, const char* end, long long* out_attributes)
+{
+	if (Scanning.TryScanInteger(cursor, end, &out_attributes[0]) is false)
+	{
+		return false;
+	}
 
-		if (c is Tokens.Vertex)
+	const char* position = *cursor;
+
+	if (position < end and *position is '/')
+	{
+		++position;
+
+		// the number has to follow the slash directly, "v/vt/ v" must not read the next corner as a normal
+		if (position < end and IsBlank(*position) is false)
 		{
-			// because multiple sequences share the same starting char do more here
-			c = buffer->Values[1];
+			// "v//vn" has no uv so nothing is read here
+			Scanning.TryScanInteger(&position, end, &out_attributes[1]);
+		}
 
-			if (c is 't')
-			{
-				++(out_counts->TextureCount);
-				continue;
-			}
+		if (position < end and *position is '/')
+		{
+			++position;
 
-			if (c is 'n')
+			// "v/vt/" allows a trailing slash with nothing after it
+			if (position < end and IsBlank(*position) is false)
 			{
-				++(out_counts->NormalCount);
-				continue;
+				Scanning.TryScanInteger(&position, end, &out_attributes[2]);
 			}
-
-			++(out_counts->VertexCount);
-			continue;
 		}
+	}
 
-		if (c is Tokens.Face)
-		{
-			++(out_counts->FaceCount);
+	*cursor = position;
 
-			// we should keep track of the number of faces in each object for our second pass, so we dont have to do a third pass
-			out_counts->FaceCounts[out_counts->ObjectCount - 1]++;
+	return true;
+}
 
-			continue;
+// reads the first 3 corners of a face line and resolves their indices against the number of vertices, uvs and normals read so far
+// uv and normal indices are only resolved when there are uvs or normals to point at
+private bool TryReadFace(const char* lineStart, const char* lineEnd, ulong vertexCount, ulong textureCount, ulong normalCount, ulong* out_indices)
+{
+	// a line with a face definition holds UP TO 9 entries
+	// 3 vertices(Garunteed), 3 textures (optional), 3 normals (optional)
+	// where each entry is the INDEX of the actual thing within their respective global array
+	// only the first 3 corners of a face are used
+	long long indices[9] = { 0 };
+
+	const char* position = lineStart + Sequences.FaceSize;
+
+	for (ulong i = 0; i < 3; i++)
+	{
+		if (TryScanFaceCorner(&position, lineEnd, indices + (i * 3)) is false)
+		{
+			return false;
 		}
+	}
 
-		if (c is Tokens.Object)
+	for (ulong i = 0; i < 9; i += 3)
+	{
+		if (TryResolveIndex(indices[i], vertexCount, &out_indices[i]) is false)
 		{
-			++(out_counts->ObjectCount);
-			continue;
+			return false;
 		}
 
-		if (c is Tokens.Smoothing)
+		if (textureCount isnt 0 and TryResolveIndex(indices[i + 1], textureCount, &out_indices[i + 1]) is false)
 		{
-			continue;
+			return false;
 		}
 
-		if (c is Tokens.Material)
+		if (normalCount isnt 0 and TryResolveIndex(indices[i + 2], normalCount, &out_indices[i + 2]) is false)
 		{
-			++(out_counts->MaterialCount);
-			continue;
+			return false;
 		}
 	}
 
-	rewind(stream);
+	return true;
+}
+
+// copies the rest of the line into a new NUL terminated string without any surrounding whitespace
+private char* DuplicateName(const char* start, const char* end, ulong maxLength)
+{
+	start = SkipBlanks(min(start, end), end);
+
+	while (end > start and isspace((unsigned char)end[-1]))
+	{
+		--end;
+	}
+
+	const ulong length = min((ulong)(end - start), maxLength);
+
+	char* result = Memory.Alloc(length + 1, Memory.String);
+
+	memcpy(result, start, length);
+
+	result[length] = '\0';
+
+	return result;
+}
+
+private void GrowMeshes(struct _bufferCollection* buffers)
+{
+	const ulong newCapacity = max(buffers->MeshCapacity << 1, 4);
+
+	Memory.ReallocOrCopy((void**)&buffers->Meshes, buffers->MeshCapacity * sizeof(Mesh), newCapacity * sizeof(Mesh), ModelMeshesTypeId);
+
+	buffers->MeshCapacity = newCapacity;
+}
+
+// grows every attribute array the mesh uses so it can hold at least one more face
+private void GrowMeshCorners(struct _bufferCollection* buffers, Mesh mesh, bool textures, bool normals)
+{
+	const ulong previousCapacity = buffers->CornerCapacity;
+	const ulong newCapacity = max(previousCapacity << 1, 3 * 32);
+
+	Memory.ReallocOrCopy((void**)&mesh->Vertices, previousCapacity * sizeof(vector3), newCapacity * sizeof(vector3), Memory.GenericMemoryBlock);
+
+	if (textures)
+	{
+		Memory.ReallocOrCopy((void**)&mesh->TextureVertices, previousCapacity * sizeof(vector2), newCapacity * sizeof(vector2), Memory.GenericMemoryBlock);
+	}
+
+	if (normals)
+	{
+		Memory.ReallocOrCopy((void**)&mesh->NormalVertices, previousCapacity * sizeof(vector3), newCapacity * sizeof(vector3), Memory.GenericMemoryBlock);
+	}
 
-	return ferror(stream) is 0;
+	buffers->CornerCapacity = newCapacity;
 }
 
-static bool TryParseFace(const char* buffer, ulong* out_attributes)
+// gives back the unused space the geometric growth left at the end of the mesh's arrays
+private void TrimMeshCorners(struct _bufferCollection* buffers, Mesh mesh)
 {
-	// base case assume the file includes normals, uv and vertices
-	int count = sscanf_s(buffer, "%lli/%lli/%lli %lli/%lli/%lli %lli/%lli/%lli",
-		&out_attributes[0], // vertex
-		&out_attributes[1], // uv
-		&out_attributes[2], // normal
-		&out_attributes[3], // vertex
-		&out_attributes[4], // uv
-		&out_attributes[5], // normal
-		&out_attributes[6], // vertex
-		&out_attributes[7], // uv
-		&out_attributes[8]); // normal
+	if (mesh is null or mesh->VertexCount is buffers->CornerCapacity)
+	{
+		return;
+	}
+
+	const ulong capacity = buffers->CornerCapacity;
 
-	if (count is 9)
+	if (mesh->Vertices isnt null)
 	{
-		return true;
+		Memory.ReallocOrCopy((void**)&mesh->Vertices, capacity * sizeof(vector3), max(mesh->VertexCount, 1) * sizeof(vector3), Memory.GenericMemoryBlock);
+	}
+
+	if (mesh->TextureVertices isnt null)
+	{
+		Memory.ReallocOrCopy((void**)&mesh->TextureVertices, capacity * sizeof(vector2), max(mesh->TextureCount, 1) * sizeof(vector2), Memory.GenericMemoryBlock);
 	}
 
-	// if there are no normals OR UV's then our count will be 1(the first number)
-	// format: "f 57 56 58"
-	if (count is 1)
+	if (mesh->NormalVertices isnt null)
+	{
+		Memory.ReallocOrCopy((void**)&mesh->NormalVertices, capacity * sizeof(vector3), max(mesh->NormalCount, 1) * sizeof(vector3), Memory.GenericMemoryBlock);
+	}
+}
+
+// gets the next non-blank line, the line excludes its '\n' but keeps any '\r', the scanners treat '\r' as a terminator
+private bool TryGetNextLine(const char** cursor, const char* end, const char** out_lineStart, const char** out_lineEnd)
+{
+	while (*cursor < end)
 	{
-		count = sscanf_s(buffer, "%lli %lli %lli",
-			&out_attributes[0],
-			&out_attributes[3],
-			&out_attributes[6]);
+		const char* lineStart = *cursor;
+		const char* lineEnd = memchr(lineStart, '\n', end - lineStart);
+
+		if (lineEnd is null)
+		{
+			lineEnd = end;
+		}
 
-		if (count is 3)
+		*cursor = lineEnd + 1;
+
+		if (lineStart isnt lineEnd)
 		{
+			*out_lineStart = lineStart;
+			*out_lineEnd = lineEnd;
+
 			return true;
 		}
 	}
 
-	// try to import it with vertices and normals but no uv
-	count = sscanf_s(buffer, "%lli//%lli %lli//%lli %lli//%lli",
-		&out_attributes[0], // vertex
-		&out_attributes[2], // normal
-		&out_attributes[3], // vertex
-		&out_attributes[5], // normal
-		&out_attributes[6], // vertex
-		&out_attributes[8]); // normal
+	return false;
+}
+
+// reads a smoothing or material line into the mesh
+private void ReadMeshProperty(Mesh mesh, const char* lineStart, const char* lineEnd)
+{
+	if (lineStart[0] is Tokens.Smoothing)
+	{
+		const char* position = SkipBlanks(lineStart + Sequences.SmoothingSize, lineEnd);
+
+		// smoothing is either "off", "0" or a smoothing group number
+		mesh->SmoothingEnabled = position < lineEnd
+			and *position isnt '0'
+			and *position isnt 'o'
+			and *position isnt 'O';
+
+		return;
+	}
+
+	if ((ulong)(lineEnd - lineStart) < Sequences.MaterialSize or memcmp(lineStart, Sequences.Material, Sequences.MaterialSize) isnt 0)
+	{
+		return;
+	}
+
+	// a mesh only has a single material, the last one wins
+	Memory.Free(mesh->MaterialName, Memory.String);
+
+	mesh->MaterialName = DuplicateName(lineStart + Sequences.MaterialSize, lineEnd, (ulong)(lineEnd - lineStart));
+}
 
-	if (count is 6)
+// adds a new mesh named after the object line to the buffers
+private Mesh AddMesh(struct _bufferCollection* buffers, const char* lineStart, const char* lineEnd)
+{
+	if (buffers->MeshCount is buffers->MeshCapacity)
 	{
-		return true;
+		GrowMeshes(buffers);
 	}
 
-	// try to import with uv but no normals
-	count = sscanf_s(buffer, "%lli/%lli/ %lli/%lli/ %lli/%lli/",
-		&out_attributes[0], // vertex
-		&out_attributes[1], // uv
-		&out_attributes[3], // vertex
-		&out_attributes[4], // uv
-		&out_attributes[6], // vertex
-		&out_attributes[7]); // uv
+	Mesh mesh = Meshes.Create();
+
+	buffers->Meshes[buffers->MeshCount++] = mesh;
+
+	// set the name of the current mesh with the name after the token
+	mesh->Name = DuplicateName(lineStart + Sequences.ObjectSize, lineEnd, MAX_OBJECT_NAME_LENGTH);
 
-	return count == 6;
+	return mesh;
 }
 
 // does not mutate the provided vector
@@ -339,9 +461,10 @@ static void VoidMutateVector3(vector3* vector) { /* no action */ }
 #pragma warning(default: 4100)
 
 // this is a monolith, i apologize, but the alternative with additional stack frames was significantly slower and was a bottle neck
-static bool TryParseObjects(File stream,
-	string buffer,
-	struct _elementCounts* counts,
+// parses the entire file in a single pass straight out of the given buffer, nothing is counted ahead of time
+// so every array grows geometrically as it's filled
+static bool TryParseObjects(const char* data,
+	const ulong length,
 	struct _bufferCollection* buffers,
 	void (*MutateVertex)(vector3* vertex),
 	void (*MutateTexture)(vector2* texture),
@@ -350,351 +473,666 @@ static bool TryParseObjects(File stream,
 {
 	Mesh currentMesh = null;
 
-	char* offset;
-	ulong size;
+	const char* cursor = data;
+	const char* fileEnd = data + length;
 
-	// create tmp variables to store the current meshes counts so when we start adding faces
-	// we can alloc the space for the final objects
-	ulong vertexCount = 0;
-	ulong textureCount = 0;
-	ulong normalCount = 0;
-
-	// create some variables to ensure we read the file correctly and encounter no errors
-	ulong materialCount = 0;
-	ulong objectCount = 0;
+	const char* lineStart;
+	const char* lineEnd;
 
-	// iterate the file line by line
-	ulong lineLength;
-	while (Files.TryReadLine(stream, buffer, 0, &lineLength))
+	while (TryGetNextLine(&cursor, fileEnd, &lineStart, &lineEnd))
 	{
-		char token = buffer->Values[0];
-
-		// ignore comments
-		if (token is Tokens.Comment)
-		{
-			continue;
-		}
-
-		// if we found an object, finish the last one and start over
-		if (token is Tokens.Object)
-		{
-			Mesh newMesh = Meshes.Create();
-
-			// set the name of the current mesh with the name after the token
-			offset = buffer->Values + Sequences.ObjectSize;
-			size = min(lineLength - Sequences.ObjectSize, lineLength);
-
-			char* name;
-			if (Parsing.TryGetLine(offset, size, MAX_OBJECT_NAME_LENGTH, &name) is false)
-			{
-				Meshes.Dispose(currentMesh);
-
-				return false;
-			}
-
-			newMesh->Name = name;
-
-			// increment the number of objects
-			buffers->Meshes[objectCount] = newMesh;
-
-			currentMesh = newMesh;
-
-			++(objectCount);
+		char token = lineStart[0];
 
-			// make sure we didn't find more objects than we expected
-			if (objectCount > counts->ObjectCount)
-			{
-				Meshes.Dispose(currentMesh);
-				return false;
-			}
-
-			// reset counts so we can use them for the next object
-			textureCount = 0;
-			vertexCount = 0;
-			textureCount = 0;
-
-			continue;
-		}
+		// !! these are ordered by frequency count, not in order of occurence !!
 
-		// if we found a vertex write it to the global array
 		// since every face references the same global array when we build the faces for any specific object
-		if (token is Tokens.Vertex)
+		// vertices are written to the shared buffers
+		if (token is Tokens.Vertex and (lineEnd - lineStart) > 1)
 		{
-			token = buffer->Values[1];
+			token = lineStart[1];
 
 			// texture vertex
 			if (token is 't')
 			{
-				// get a pointer to the current position of the texture buffer we are at
-				// texture vertice are vector 2s
-				vector2* vector = buffers->Textures + buffers->TextureIndex;
-				offset = buffer->Values + Sequences.TextureSize;
-				size = min(lineLength - Sequences.TextureSize, lineLength);
-
-				if (Vector2s.TryDeserialize(offset, size, vector) is false)
+				vector2 vector;
+				if (TryScanVector2(lineStart + Sequences.TextureSize, lineEnd, &vector) is false)
 				{
-					Meshes.Dispose(currentMesh);
 					return false;
 				}
 
-				MutateTexture(vector);
+				MutateTexture(&vector);
 
-				// move the index over by the number of floats we wrote
-				buffers->TextureIndex += 1;
-				textureCount += 1;
+				arrays(vector2).Append(buffers->Textures, vector);
 			}
 			// normals
 			else if (token is 'n')
 			{
-				// get a pointer to the current position of the normal buffer we are at
-				// normal vertices are vector 3s
-				vector3* vector = buffers->Normals + buffers->NormalIndex;
-				offset = buffer->Values + Sequences.NormalSize;
-				size = min(lineLength - Sequences.NormalSize, lineLength);
-
-				if (Vector3s.TryDeserialize(offset, size, vector) is false)
+				vector3 vector;
+				if (TryScanVector3(lineStart + Sequences.NormalSize, lineEnd, &vector) is false)
 				{
-					Meshes.Dispose(currentMesh);
 					return false;
 				}
 
-				MutateNormal(vector);
+				MutateNormal(&vector);
 
-				// move the index over by the number of floats we wrote
-				buffers->NormalIndex += 1;
-				normalCount += 1;
+				arrays(vector3).Append(buffers->Normals, vector);
 			}
 			// regular vertex
-			else
+			else if (IsBlank(token))
 			{
-				// get a pointer to the current position of the vertex buffer we are at
-				// vertices are vector 3s
-				vector3* vector = buffers->Vertices + buffers->VertexIndex;
-				offset = buffer->Values + Sequences.VertexSize;
-				size = min(lineLength - Sequences.VertexSize, lineLength);
-
-				if (Vector3s.TryDeserialize(offset, size, vector) is false)
+				vector3 vector;
+				if (TryScanVector3(lineStart + Sequences.VertexSize, lineEnd, &vector) is false)
 				{
-					Meshes.Dispose(currentMesh);
 					return false;
 				}
 
-				MutateVertex(vector);
+				MutateVertex(&vector);
 
-				// move the index over by the number of floats we wrote
-				buffers->VertexIndex += 1;
-				vertexCount += 1;
+				arrays(vector3).Append(buffers->Vertices, vector);
 			}
 
 			continue;
 		}
 
 		// when we find a face we have to use the already parsed vertices to add to the meshes actual buffers
-		if (token is Tokens.Face && currentMesh isnt null)
+		if (token is Tokens.Face and currentMesh isnt null)
 		{
-			// a line with a face definition holds UP TO 9 entries
-			// 3 vertices(Garunteed), 3 textures (optional), 3 normals (optional)
-			// where each entry is the INDEX of the actual thing within their respective global array
-			ulong indices[9];
-
-			// zero the array
-			Memory.ZeroArray(indices, sizeof(ulong) * 9);
+			const bool textures = buffers->Textures->Count > 0;
+			const bool normals = buffers->Normals->Count > 0;
 
-			offset = buffer->Values + Sequences.FaceSize;
+			ulong indices[9];
 
-			// read the indices
-			if (TryParseFace(offset, indices) is false)
+			if (TryReadFace(lineStart, lineEnd, buffers->Vertices->Count, buffers->Textures->Count, buffers->Normals->Count, indices) is false)
 			{
-				Meshes.Dispose(currentMesh);
 				return false;
 			}
 
-			ulong faceCount = counts->FaceCounts[objectCount - 1] * 3;
-
-			// make sure we have arrays to write values to
-			if (currentMesh->Vertices is null && vertexCount > 0)
+			if (currentMesh->VertexCount + 3 > buffers->CornerCapacity
+				or (textures and currentMesh->TextureVertices is null)
+				or (normals and currentMesh->NormalVertices is null))
 			{
-				currentMesh->Vertices = Memory.Alloc(sizeof(vector3) * faceCount, Memory.GenericMemoryBlock);
-			}
-			if (currentMesh->TextureVertices is null && textureCount > 0)
-			{
-				currentMesh->TextureVertices = Memory.Alloc(sizeof(vector2) * faceCount, Memory.GenericMemoryBlock);
-			}
-			if (currentMesh->NormalVertices is null && normalCount > 0)
-			{
-				currentMesh->NormalVertices = Memory.Alloc(sizeof(vector3) * faceCount, Memory.GenericMemoryBlock);
+				GrowMeshCorners(buffers, currentMesh, textures, normals);
 			}
 
-			// since there are 3 triplets loop
 			for (ulong i = 0; i < 3; i++)
 			{
 				const ulong* face = indices + (i * 3);
 
-				if (vertexCount > 0)
-				{
-					// .obj files are 1 indexed subtract one to get 0 indexed
-					ulong vertexIndex = safe_subtract(face[0], 1);
-
-					// there are 3 floats per vertex so the address of the nth vector3 is index * 3
-					const vector3 subVertices = buffers->Vertices[vertexIndex];
-
-					// copy the floats over to their final arrays
-					currentMesh->Vertices[currentMesh->VertexCount] = subVertices;
-					currentMesh->VertexCount++;
-				}
+				currentMesh->Vertices[currentMesh->VertexCount++] = buffers->Vertices->Values[face[0]];
 
-				// if we didnt count any textures we shouldn't try to write them to an array
-				if (textureCount > 0)
+				// if the file has no textures we shouldn't try to write them to an array
+				if (textures)
 				{
-					// .obj files are 1 indexed subtract one to get 0 indexed
-					ulong uvIndex = safe_subtract(face[1], 1);
-
-					// there are 2 floats per uv
-					const vector2 subUVs = buffers->Textures[uvIndex];
-
-					currentMesh->TextureVertices[currentMesh->TextureCount] = subUVs;
-					currentMesh->TextureCount++;
+					currentMesh->TextureVertices[currentMesh->TextureCount++] = buffers->Textures->Values[face[1]];
 				}
 
-				// if we didnt count any normals we shouldn't try to write them to an array
-				if (normalCount > 0)
+				// if the file has no normals we shouldn't try to write them to an array
+				if (normals)
 				{
-					// .obj files are 1 indexed subtract one to get 0 indexed
-					ulong normalIndex = safe_subtract(face[2], 1);
-
-					// there are 3 floats per normal
-					const vector3 subNormals = buffers->Normals[normalIndex];
-
-					currentMesh->NormalVertices[currentMesh->NormalCount] = subNormals;
-					currentMesh->NormalCount++;
+					currentMesh->NormalVertices[currentMesh->NormalCount++] = buffers->Normals->Values[face[2]];
 				}
 			}
+
 			continue;
 		}
 
-		if (token is Tokens.Smoothing && currentMesh isnt null)
+		// if we found an object, finish the last one and start over
+		if (token is Tokens.Object)
 		{
-			offset = buffer->Values + Sequences.SmoothingSize;
-			size = min(lineLength - Sequences.SmoothingSize, lineLength);
+			TrimMeshCorners(buffers, currentMesh);
+
+			currentMesh = AddMesh(buffers, lineStart, lineEnd);
+
+			buffers->CornerCapacity = 0;
 
-			bool smoothing;
-			if (Parsing.TryGetBool(offset, size, &smoothing) is false)
-			{
-				Meshes.Dispose(currentMesh);
-				return false;
-			}
-			currentMesh->SmoothingEnabled = smoothing;
 			continue;
 		}
 
-		if (token is Tokens.Material && currentMesh isnt null)
+		if (token is Tokens.Comment)
 		{
-			// copy the name of the material over to the current mesh
-			offset = buffer->Values + Sequences.MaterialSize;
-
-			// becuase we're not relying on nul terminated we should add 1 to inclde the nul terminator character
-			size = min(lineLength - Sequences.MaterialSize, lineLength) + 1;
-
-			char* material = Strings.Duplicate(offset, size);
-			currentMesh->MaterialName = material;
-
-			++(materialCount);
+			continue;
+		}
 
-			// make sure we didn't find more materials than we expected
-			if (materialCount > counts->MaterialCount)
-			{
-				Meshes.Dispose(currentMesh);
-				return false;
-			}
+		if ((token is Tokens.Smoothing or token is Tokens.Material) and currentMesh isnt null)
+		{
+			ReadMeshProperty(currentMesh, lineStart, lineEnd);
 			continue;
 		}
 	}
 
+	TrimMeshCorners(buffers, currentMesh);
+
 	return true;
 }
 
-// buffer to keep the face counts
-ulong FaceCounts[MAX_FACES];
+// files smaller than this are parsed serially, starting threads costs more than it saves
+#define PARALLEL_IMPORT_SIZE (4 * 1024 * 1024)
+// the smallest amount of the file a single chunk is given
+#define MIN_IMPORT_CHUNK_SIZE (1024 * 1024)
 
-DEFINE_TYPE_ID(Mesh);
+// a line aligned slice of the file that is parsed by a single thread
+struct _importChunk {
+	const char* Start;
+	const char* End;
+	// the number of vertices, uvs and normals in the chunk
+	ulong VertexCount;
+	ulong TextureCount;
+	ulong NormalCount;
+	// the faces in this chunk that come before its first uv or normal
+	ulong FacesBeforeTexture;
+	ulong FacesBeforeNormal;
+	// where this chunk's vertices, uvs and normals start within the shared buffers
+	ulong VertexOffset;
+	ulong TextureOffset;
+	ulong NormalOffset;
+	// the number of faces in each segment of the chunk, segment 0 continues the object that was open when
+	// the chunk started and segment n follows the nth object line, once merged these hold the first corner
+	// each segment writes to within its mesh
+	array(ulong) Segments;
+	// the offsets of the object, smoothing and material lines within the chunk in order
+	array(ulong) PropertyLines;
+	// the index of the mesh segment 0 writes to, or -1 when no object has been started yet
+	long long FirstMesh;
+	bool Failed;
+};
 
-static bool TryImportModelStream(File stream,
-	Model* out_model,
-	void (*MutateVertex)(vector3* vertex),
-	void (*MutateTexture)(vector2* texture),
-	void (*MutateNormal)(vector3* normal)
-)
-{
+struct _parallelImport {
+	struct _importChunk* Chunks;
+	struct _bufferCollection* Buffers;
+	void (*MutateVertex)(vector3* vertex);
+	void (*MutateTexture)(vector2* texture);
+	void (*MutateNormal)(vector3* normal);
+};
 
-	array(byte) streamBuffer = empty_stack_array(byte, BUFFER_SIZE);
+// first pass, counts everything in the chunk so the shared buffers and meshes can be sized exactly
+private void CountChunk(void* state, ulong index)
+{
+	struct _importChunk* chunk = &((struct _parallelImport*)state)->Chunks[index];
 
-	// create a place to put the counts of the file
-	struct _elementCounts elementCounts = {
-		.FaceCount = 0,
-		.MaterialCount = 0,
-		.NormalCount = 0,
-		.ObjectCount = 0,
-		.TextureCount = 0,
-		.VertexCount = 0,
-		.FaceCounts = FaceCounts
-	};
+	const char* cursor = chunk->Start;
+	const char* lineStart;
+	const char* lineEnd;
 
-	Memory.ZeroArray(FaceCounts, MAX_FACES * sizeof(ulong));
+	ulong faces = 0;
 
-	// count the occurences of the elements within the file
-	if (TryCountElements(stream,
-		streamBuffer,
-		&elementCounts) is false)
+	while (TryGetNextLine(&cursor, chunk->End, &lineStart, &lineEnd))
 	{
-		Files.TryClose(stream);
-		// if we were not able to count all the elements we should return false, something weird happened
-		return false;
-	}
+		const char token = lineStart[0];
 
-	REGISTER_TYPE(Mesh);
+		// this has to classify lines exactly the way TryParseObjects does
+		if (token is Tokens.Vertex and (lineEnd - lineStart) > 1)
+		{
+			const char type = lineStart[1];
 
-	Mesh* meshes = Memory.Alloc(sizeof(Mesh) * elementCounts.ObjectCount, MeshTypeId);
+			if (type is 't')
+			{
+				++chunk->TextureCount;
+			}
+			else if (type is 'n')
+			{
+				++chunk->NormalCount;
+			}
+			else if (IsBlank(type))
+			{
+				++chunk->VertexCount;
+			}
+		}
+		else if (token is Tokens.Face)
+		{
+			++faces;
 
-	// create a place to store all the vertices temporarily
-	struct _bufferCollection buffers = {
-		.Meshes = meshes,
-		.MeshIndex = 0,
-		.Vertices = Memory.Alloc(sizeof(vector3) * elementCounts.VertexCount, Memory.GenericMemoryBlock),
-		.VertexIndex = 0,
-		.Normals = Memory.Alloc(sizeof(vector3) * elementCounts.NormalCount, Memory.GenericMemoryBlock),
-		.NormalIndex = 0,
-		.Textures = Memory.Alloc(sizeof(vector2) * elementCounts.TextureCount, Memory.GenericMemoryBlock),
-		.TextureIndex = 0
-	};
+			chunk->FacesBeforeTexture += chunk->TextureCount is 0;
+			chunk->FacesBeforeNormal += chunk->NormalCount is 0;
+		}
+		else if (token is Tokens.Object or token is Tokens.Smoothing or token is Tokens.Material)
+		{
+			if (token is Tokens.Object)
+			{
+				arrays(ulong).Append(chunk->Segments, faces);
+				faces = 0;
+			}
 
-	if (TryParseObjects(stream, streamBuffer, &elementCounts, &buffers,
-		MutateVertex is null ? &VoidMutateVector3 : MutateVertex,
-		MutateTexture is null ? &VoidMutateVector2 : MutateTexture,
-		MutateNormal is null ? &VoidMutateVector3 : MutateNormal
-	) is false)
-	{
-		Memory.Free(meshes, MeshTypeId);
-		DisposeBufferCollection(&buffers);
-		Files.TryClose(stream);
-		return false;
+			arrays(ulong).Append(chunk->PropertyLines, (ulong)(lineStart - chunk->Start));
+		}
 	}
 
-	Model model = Models.Create();
+	arrays(ulong).Append(chunk->Segments, faces);
+}
 
-	model->Count = elementCounts.ObjectCount;
+// second pass, parses the chunk's vertices, uvs and normals into its slices of the shared buffers
+private void ParseChunkVertices(void* state, ulong index)
+{
+	struct _parallelImport* import = state;
+	struct _importChunk* chunk = &import->Chunks[index];
 
-	model->Meshes = meshes;
+	vector3* vertices = import->Buffers->Vertices->Values + chunk->VertexOffset;
+	vector2* textures = import->Buffers->Textures->Values + chunk->TextureOffset;
+	vector3* normals = import->Buffers->Normals->Values + chunk->NormalOffset;
 
-	buffers.Meshes = null;
+	const char* cursor = chunk->Start;
+	const char* lineStart;
+	const char* lineEnd;
 
-	// make sure to dispose the buffer collection when we are done
-	DisposeBufferCollection(&buffers);
+	while (TryGetNextLine(&cursor, chunk->End, &lineStart, &lineEnd))
+	{
+		if (lineStart[0] isnt Tokens.Vertex or (lineEnd - lineStart) <= 1)
+		{
+			continue;
+		}
+
+		const char type = lineStart[1];
+
+		if (type is 't')
+		{
+			if (TryScanVector2(lineStart + Sequences.TextureSize, lineEnd, textures) is false)
+			{
+				chunk->Failed = true;
+				return;
+			}
+
+			import->MutateTexture(textures++);
+		}
+		else if (type is 'n')
+		{
+			if (TryScanVector3(lineStart + Sequences.NormalSize, lineEnd, normals) is false)
+			{
+				chunk->Failed = true;
+				return;
+			}
+
+			import->MutateNormal(normals++);
+		}
+		else if (IsBlank(type))
+		{
+			if (TryScanVector3(lineStart + Sequences.VertexSize, lineEnd, vertices) is false)
+			{
+				chunk->Failed = true;
+				return;
+			}
+
+			import->MutateVertex(vertices++);
+		}
+	}
+}
+
+// third pass, resolves the chunk's faces into their meshes at the corners the merge reserved for them
+private void ParseChunkFaces(void* state, ulong index)
+{
+	struct _parallelImport* import = state;
+	struct _importChunk* chunk = &import->Chunks[index];
+	struct _bufferCollection* buffers = import->Buffers;
+
+	const bool textures = buffers->Textures->Count > 0;
+	const bool normals = buffers->Normals->Count > 0;
+
+	// negative indices are relative to what has been read before the face, not the whole file
+	ulong vertexCount = chunk->VertexOffset;
+	ulong textureCount = chunk->TextureOffset;
+	ulong normalCount = chunk->NormalOffset;
+
+	ulong segment = 0;
+	long long meshIndex = chunk->FirstMesh;
+	ulong corner = chunk->Segments->Values[0];
+
+	const char* cursor = chunk->Start;
+	const char* lineStart;
+	const char* lineEnd;
+
+	while (TryGetNextLine(&cursor, chunk->End, &lineStart, &lineEnd))
+	{
+		const char token = lineStart[0];
+
+		if (token is Tokens.Vertex and (lineEnd - lineStart) > 1)
+		{
+			const char type = lineStart[1];
+
+			textureCount += type is 't';
+			normalCount += type is 'n';
+			vertexCount += IsBlank(type);
+
+			continue;
+		}
+
+		if (token is Tokens.Object)
+		{
+			++meshIndex;
+			corner = chunk->Segments->Values[++segment];
+			continue;
+		}
+
+		// faces before the first object have no mesh and are ignored
+		if (token isnt Tokens.Face or meshIndex < 0)
+		{
+			continue;
+		}
+
+		ulong indices[9];
+
+		if (TryReadFace(lineStart, lineEnd, vertexCount, textures ? textureCount : 0, normals ? normalCount : 0, indices) is false)
+		{
+			chunk->Failed = true;
+			return;
+		}
+
+		Mesh mesh = buffers->Meshes[meshIndex];
+
+		for (ulong i = 0; i < 3; i++, corner++)
+		{
+			const ulong* face = indices + (i * 3);
+
+			mesh->Vertices[corner] = buffers->Vertices->Values[face[0]];
+
+			if (textures)
+			{
+				mesh->TextureVertices[corner] = buffers->Textures->Values[face[1]];
+			}
+
+			if (normals)
+			{
+				mesh->NormalVertices[corner] = buffers->Normals->Values[face[2]];
+			}
+		}
+	}
+}
+
+private bool AnyChunkFailed(struct _importChunk* chunks, ulong count)
+{
+	for (ulong i = 0; i < count; i++)
+	{
+		if (chunks[i].Failed)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// parses the file across chunkCount threads, the result is identical to TryParseObjects
+// sets out_parsed to false when the file can't be split and should be parsed serially instead
+static bool TryParseObjectsParallel(const char* data,
+	const ulong length,
+	const ulong chunkCount,
+	struct _bufferCollection* buffers,
+	void (*MutateVertex)(vector3* vertex),
+	void (*MutateTexture)(vector2* texture),
+	void (*MutateNormal)(vector3* normal),
+	bool* out_parsed
+)
+{
+	*out_parsed = false;
+
+	struct _importChunk* chunks = Memory.Alloc(sizeof(struct _importChunk) * chunkCount, Memory.GenericMemoryBlock);
+
+	// split the file at line boundaries
+	const char* fileEnd = data + length;
+	const char* chunkStart = data;
+
+	for (ulong i = 0; i < chunkCount; i++)
+	{
+		const char* chunkEnd = i + 1 is chunkCount ? fileEnd : max(data + ((length / chunkCount) * (i + 1)), chunkStart);
+
+		if (chunkEnd < fileEnd)
+		{
+			const char* newLine = memchr(chunkEnd, '\n', fileEnd - chunkEnd);
+			chunkEnd = newLine ? newLine + 1 : fileEnd;
+		}
+
+		chunks[i].Start = chunkStart;
+		chunks[i].End = chunkEnd;
+		chunks[i].Segments = dynamic_array(ulong, 1);
+		chunks[i].PropertyLines = dynamic_array(ulong, 0);
+
+		chunkStart = chunkEnd;
+	}
+
+	struct _parallelImport import = {
+		.Chunks = chunks,
+		.Buffers = buffers,
+		.MutateVertex = MutateVertex,
+		.MutateTexture = MutateTexture,
+		.MutateNormal = MutateNormal
+	};
+
+	Threads.ParallelFor(chunkCount, &import, CountChunk);
+
+	// merge the counts in file order so every chunk knows where it writes
+	ulong vertexCount = 0;
+	ulong textureCount = 0;
+	ulong normalCount = 0;
+	ulong facesBeforeTexture = 0;
+	ulong facesBeforeNormal = 0;
+
+	array(ulong) meshFaces = dynamic_array(ulong, 0);
+
+	Mesh currentMesh = null;
+
+	for (ulong i = 0; i < chunkCount; i++)
+	{
+		struct _importChunk* chunk = &chunks[i];
+
+		// faces that come before the first uv or normal can't be mixed with faces after it, since the
+		// serial path only writes uvs and normals once it has seen one, leave those files to it
+		facesBeforeTexture += textureCount is 0 ? chunk->FacesBeforeTexture : 0;
+		facesBeforeNormal += normalCount is 0 ? chunk->FacesBeforeNormal : 0;
+
+		chunk->VertexOffset = vertexCount;
+		chunk->TextureOffset = textureCount;
+		chunk->NormalOffset = normalCount;
+
+		vertexCount += chunk->VertexCount;
+		textureCount += chunk->TextureCount;
+		normalCount += chunk->NormalCount;
+
+		chunk->FirstMesh = (long long)buffers->MeshCount - 1;
+
+		// create the meshes and read their properties in the order they appear in the file
+		ulong segment = 0;
+
+		for (ulong line = 0; line < chunk->PropertyLines->Count; line++)
+		{
+			const char* lineStart = chunk->Start + chunk->PropertyLines->Values[line];
+			const char* lineEnd = memchr(lineStart, '\n', chunk->End - lineStart);
+
+			lineEnd = lineEnd ? lineEnd : chunk->End;
+
+			if (lineStart[0] is Tokens.Object)
+			{
+				// turn the segment's face count into the first corner it writes to
+				ulong* faces = &chunk->Segments->Values[segment++];
+
+				if (currentMesh isnt null)
+				{
+					const ulong previousFaces = meshFaces->Values[meshFaces->Count - 1];
+					meshFaces->Values[meshFaces->Count - 1] += *faces;
+					*faces = previousFaces * 3;
+				}
+
+				currentMesh = AddMesh(buffers, lineStart, lineEnd);
+
+				arrays(ulong).Append(meshFaces, 0);
+			}
+			else if (currentMesh isnt null)
+			{
+				ReadMeshProperty(currentMesh, lineStart, lineEnd);
+			}
+		}
+
+		ulong* faces = &chunk->Segments->Values[segment];
+
+		if (currentMesh isnt null)
+		{
+			const ulong previousFaces = meshFaces->Values[meshFaces->Count - 1];
+			meshFaces->Values[meshFaces->Count - 1] += *faces;
+			*faces = previousFaces * 3;
+		}
+	}
+
+	const bool textures = textureCount > 0;
+	const bool normals = normalCount > 0;
+
+	const bool splittable = (textures is false or facesBeforeTexture is 0) and (normals is false or facesBeforeNormal is 0);
+
+	bool result = true;
+
+	if (splittable)
+	{
+		// every face writes the same attributes so the meshes can be sized exactly up front
+		for (ulong i = 0; i < buffers->MeshCount; i++)
+		{
+			const ulong corners = meshFaces->Values[i] * 3;
+
+			if (corners is 0)
+			{
+				continue;
+			}
+
+			Mesh mesh = buffers->Meshes[i];
+
+			mesh->Vertices = Memory.Alloc(corners * sizeof(vector3), Memory.GenericMemoryBlock);
+			mesh->VertexCount = corners;
+
+			if (textures)
+			{
+				mesh->TextureVertices = Memory.Alloc(corners * sizeof(vector2), Memory.GenericMemoryBlock);
+				mesh->TextureCount = corners;
+			}
+
+			if (normals)
+			{
+				mesh->NormalVertices = Memory.Alloc(corners * sizeof(vector3), Memory.GenericMemoryBlock);
+				mesh->NormalCount = corners;
+			}
+		}
+
+		arrays(vector3).Resize(buffers->Vertices, vertexCount);
+		arrays(vector2).Resize(buffers->Textures, textureCount);
+		arrays(vector3).Resize(buffers->Normals, normalCount);
+
+		Threads.ParallelFor(chunkCount, &import, ParseChunkVertices);
+
+		result = AnyChunkFailed(chunks, chunkCount) is false;
+
+		if (result)
+		{
+			Threads.ParallelFor(chunkCount, &import, ParseChunkFaces);
+
+			result = AnyChunkFailed(chunks, chunkCount) is false;
+		}
+
+		*out_parsed = true;
+	}
+	else
+	{
+		// throw away the meshes so the serial path starts from scratch
+		for (ulong i = 0; i < buffers->MeshCount; i++)
+		{
+			Meshes.Dispose(buffers->Meshes[i]);
+		}
+
+		buffers->MeshCount = 0;
+	}
+
+	for (ulong i = 0; i < chunkCount; i++)
+	{
+		arrays(ulong).Dispose(chunks[i].Segments);
+		arrays(ulong).Dispose(chunks[i].PropertyLines);
+	}
+
+	arrays(ulong).Dispose(meshFaces);
+	Memory.Free(chunks, Memory.GenericMemoryBlock);
+
+	return result;
+}
+
+// picks how many threads to parse the file with, 1 means it should be parsed serially
+private ulong GetImportChunkCount(ulong length)
+{
+	if (length < PARALLEL_IMPORT_SIZE)
+	{
+		return 1;
+	}
+
+	return max(min(Threads.ProcessorCount(), length / MIN_IMPORT_CHUNK_SIZE), 1);
+}
+
+// parses the file across chunkCount threads, when chunkCount is 1 the file is parsed on the calling thread
+// the mutate methods may be invoked from multiple threads at once when parsing in parallel
+static bool TryImportModelBuffer(const char* data,
+	const ulong length,
+	const ulong chunkCount,
+	Model* out_model,
+	void (*MutateVertex)(vector3* vertex),
+	void (*MutateTexture)(vector2* texture),
+	void (*MutateNormal)(vector3* normal)
+)
+{
+	REGISTER_TYPE(ModelMeshes);
+
+	// create a place to store all the vertices temporarily
+	struct _bufferCollection buffers = {
+		.Meshes = null,
+		.MeshCount = 0,
+		.MeshCapacity = 0,
+		.CornerCapacity = 0,
+		.Vertices = dynamic_array(vector3, 0),
+		.Normals = dynamic_array(vector3, 0),
+		.Textures = dynamic_array(vector2, 0)
+	};
+
+	MutateVertex = MutateVertex is null ? &VoidMutateVector3 : MutateVertex;
+	MutateTexture = MutateTexture is null ? &VoidMutateVector2 : MutateTexture;
+	MutateNormal = MutateNormal is null ? &VoidMutateVector3 : MutateNormal;
+
+	bool parsed = false;
+	bool result = true;
+
+	if (chunkCount > 1)
+	{
+		result = TryParseObjectsParallel(data, length, chunkCount, &buffers, MutateVertex, MutateTexture, MutateNormal, &parsed);
+	}
+
+	if (parsed is false)
+	{
+		result = TryParseObjects(data, length, &buffers, MutateVertex, MutateTexture, MutateNormal);
+	}
+
+	if (result is false)
+	{
+		DisposeBufferCollection(&buffers);
+		return false;
+	}
+
+	Model model = Models.Create();
+
+	model->Count = buffers.MeshCount;
+
+	model->Meshes = buffers.Meshes;
+
+	// the model owns the meshes now
+	buffers.Meshes = null;
+	buffers.MeshCount = 0;
+
+	// make sure to dispose the buffer collection when we are done
+	DisposeBufferCollection(&buffers);
 
 	*out_model = model;
 
 	return true;
 }
 
+private void IndexImportedMesh(void* state, ulong index)
+{
+	const Model model = state;
+
+	Meshes.Index(model->Meshes[index]);
+
+	// the cache stores the optimized order and the levels of detail so they are only paid for once per import
+	MeshOptimizers.Optimize(model->Meshes[index]);
+
+	MeshSimplifiers.GenerateLevels(model->Meshes[index]);
+}
+
 static bool TryImportModel(string path, FileFormat format, Model* out_model)
 {
 	// make sure the format is supported
@@ -703,32 +1141,50 @@ static bool TryImportModel(string path, FileFormat format, Model* out_model)
 		return false;
 	}
 
-	// open the path
-	File stream;
-	if (Files.TryOpen(path, FileModes.ReadBinary, &stream) is false)
+	// models that were imported before are loaded from their baked cache without parsing any text
+	ulong sourceSize;
+	ulong sourceLastModified;
+	const bool cacheable = Files.TryGetInfo(path, &sourceSize, &sourceLastModified);
+
+	Model model;
+	if (cacheable and MeshCaches.TryLoad(path, sourceSize, sourceLastModified, &model))
+	{
+		model->Name = Strings.Duplicate(path->Values, path->Count);
+
+		*out_model = model;
+
+		return true;
+	}
+
+	// map the file so we can parse straight out of the page cache
+	string data;
+	if (Files.TryMap(path, &data) is false)
 	{
 		return false;
 	}
 
-	Model model;
-	if (TryImportModelStream(stream, &model, null, null, null) is false)
+	if (TryImportModelBuffer(data->Values, data->Count, GetImportChunkCount(data->Count), &model, null, null, null) is false)
 	{
-		Files.Close(stream);
+		Files.Unmap(data);
 		return false;
 	}
 
-	// set the name of the model as the path that was used to load it
-	model->Name = Strings.Duplicate(path->Values, path->Count);
+	Files.Unmap(data);
 
-	*out_model = model;
+	// faces repeat the corners they share with their neighbours, store every unique corner once
+	Threads.ParallelFor(model->Count, model, &IndexImportedMesh);
 
-	if (Files.TryClose(stream) is false)
+	// a cache that can't be written only costs the next load a re-import
+	if (cacheable)
 	{
-		Models.Dispose(model);
-
-		return false;
+		MeshCaches.TrySave(path, sourceSize, sourceLastModified, model);
 	}
 
+	// set the name of the model as the path that was used to load it
+	model->Name = Strings.Duplicate(path->Values, path->Count);
+
+	*out_model = model;
+
 	return true;
 }
 
@@ -741,4 +1197,447 @@ static Model ImportModel(string path, FileFormat format)
 	}
 
 	return model;
-}
\ No newline at end of file
+}
+
+TEST(ScanFaceCorners)
+{
+	const char* face = "1/2/3 4//5 -1/6/ 7";
+	const char* end = face + strlen(face);
+	const char* cursor = face;
+
+	long long attributes[12] = { 0 };
+
+	for (ulong i = 0; i < 4; i++)
+	{
+		IsTrue(TryScanFaceCorner(&cursor, end, attributes + (i * 3)));
+	}
+
+	IsEqual(1ll, attributes[0]);
+	IsEqual(2ll, attributes[1]);
+	IsEqual(3ll, attributes[2]);
+	IsEqual(4ll, attributes[3]);
+	IsEqual(0ll, attributes[4]);
+	IsEqual(5ll, attributes[5]);
+	IsEqual(-1ll, attributes[6]);
+	IsEqual(6ll, attributes[7]);
+	IsEqual(0ll, attributes[8]);
+	IsEqual(7ll, attributes[9]);
+
+	IsFalse(TryScanFaceCorner(&cursor, end, attributes));
+
+	return true;
+}
+
+TEST(ImportsBuffer)
+{
+	const char* obj =
+		"# comment\r\n"
+		"o First\r\n"
+		"v 0 0 0\r\n"
+		"v 1 0 0\r\n"
+		"v 0 1 0\r\n"
+		"vt 0 0\r\n"
+		"vt 1 0\r\n"
+		"vt 0 1\r\n"
+		"vn 0 0 1\r\n"
+		"usemtl Skin\r\n"
+		"s off\r\n"
+		"f 1/1/1 2/2/1 3/3/1\r\n"
+		"\r\n"
+		"o Second\n"
+		"v 2 2 2\n"
+		"s 1\n"
+		"f -1//1 -2//1 -3//1\n"
+		"f 4/1/1 1/2/1 2/3/1";
+
+	Model model;
+	IsTrue(TryImportModelBuffer(obj, strlen(obj), 1, &model, null, null, null));
+
+	IsEqual(2ull, model->Count);
+
+	Mesh first = model->Meshes[0];
+	Mesh second = model->Meshes[1];
+
+	IsTrue(strcmp(first->Name, "First") is 0);
+	IsTrue(strcmp(first->MaterialName, "Skin") is 0);
+	IsFalse(first->SmoothingEnabled);
+	IsEqual(3ull, first->VertexCount);
+	IsEqual(3ull, first->TextureCount);
+	IsEqual(3ull, first->NormalCount);
+	IsEqual(1.0f, first->Vertices[1].x);
+	IsEqual(1.0f, first->TextureVertices[2].y);
+	IsEqual(1.0f, first->NormalVertices[0].z);
+
+	IsTrue(strcmp(second->Name, "Second") is 0);
+	IsTrue(second->SmoothingEnabled);
+	IsEqual(6ull, second->VertexCount);
+	// negative indices are relative to the end of the vertices read so far
+	IsEqual(2.0f, second->Vertices[0].x);
+	IsEqual(1.0f, second->Vertices[1].y);
+	IsEqual(2.0f, second->Vertices[3].z);
+
+	Models.Dispose(model);
+
+	// out of range indices should fail instead of reading past the buffers
+	const char* broken = "o Broken\nv 0 0 0\nf 1 2 3\n";
+	IsFalse(TryImportModelBuffer(broken, strlen(broken), 1, &model, null, null, null));
+
+	return true;
+}
+
+private bool MeshesEqual(Mesh left, Mesh right)
+{
+	return strcmp(left->Name, right->Name) is 0
+		and ((left->MaterialName is null and right->MaterialName is null)
+			or (left->MaterialName isnt null and right->MaterialName isnt null and strcmp(left->MaterialName, right->MaterialName) is 0))
+		and left->SmoothingEnabled is right->SmoothingEnabled
+		and left->VertexCount is right->VertexCount
+		and left->TextureCount is right->TextureCount
+		and left->NormalCount is right->NormalCount
+		and memcmp(left->Vertices, right->Vertices, left->VertexCount * sizeof(vector3)) is 0
+		and memcmp(left->TextureVertices, right->TextureVertices, left->TextureCount * sizeof(vector2)) is 0
+		and memcmp(left->NormalVertices, right->NormalVertices, left->NormalCount * sizeof(vector3)) is 0;
+}
+
+private void AppendLine(string obj, const char* format, ...)
+{
+	char buffer[256];
+
+	va_list arguments;
+	va_start(arguments, format);
+	const int length = vsnprintf(buffer, sizeof(buffer), format, arguments);
+	va_end(arguments);
+
+	strings.AppendCArray(obj, buffer, length);
+}
+
+// builds a file with several objects of varying size that interleave their vertices with their faces
+private string CreateTestModel(ulong seed, bool facesBeforeTextures)
+{
+	string obj = strings.Create(1024);
+
+	ulong vertices = 0;
+	ulong textures = 0;
+	ulong normals = 0;
+
+	if (facesBeforeTextures)
+	{
+		AppendLine(obj, "o Untextured\nv 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n");
+		vertices = 3;
+	}
+
+	for (ulong object = 0; object < 9; object++)
+	{
+		AppendLine(obj, "o Object%lli\r\n", object);
+
+		if (object % 3 is 0)
+		{
+			AppendLine(obj, "usemtl Material%lli\ns %s\n", object, object % 2 ? "off" : "1");
+		}
+
+		seed = (seed * 6364136223846793005ull) + 1442695040888963407ull;
+
+		const ulong count = 3 + ((seed >> 33) % 200);
+
+		for (ulong i = 0; i < count; i++)
+		{
+			seed = (seed * 6364136223846793005ull) + 1442695040888963407ull;
+
+			AppendLine(obj, "v %.6f %.6f %.6f\n", (double)(seed >> 40) / 1024.0, -(double)((seed >> 20) & 0xFFFFF) / 1e5, (double)(seed & 0xFFFF) * 1e-3);
+			AppendLine(obj, "vt %.5f %.5f\n", (double)(seed & 0xFF) / 256.0, (double)((seed >> 8) & 0xFF) / 256.0);
+			AppendLine(obj, "vn %.4f %.4f %.4f\n", (double)((seed >> 16) & 0xFF) / 255.0, 0.5, -0.25);
+		}
+
+		vertices += count;
+		textures += count;
+		normals += count;
+
+		for (ulong i = 0; i < count * 2; i++)
+		{
+			seed = (seed * 6364136223846793005ull) + 1442695040888963407ull;
+
+			const ulong a = 1 + (seed % vertices);
+			const ulong b = 1 + ((seed >> 16) % textures);
+
+			// mix absolute and relative indices along with the different corner forms
+			switch ((seed >> 32) % 3)
+			{
+			case 0:
+				AppendLine(obj, "f %lli/%lli/%lli %lli/%lli/%lli -1/-1/-1\n", a, b, b, vertices, textures, normals);
+				break;
+			case 1:
+				AppendLine(obj, "f -2/-2/-2 %lli/%lli/%lli %lli/%lli/%lli 4\n", a, b, a % normals + 1, b % vertices + 1, b, b);
+				break;
+			default:
+				AppendLine(obj, "f %lli/%lli/%lli %lli/%lli/%lli %lli/%lli/%lli\r\n", a, a % textures + 1, b, b % vertices + 1, b, a % normals + 1, a, b, b);
+				break;
+			}
+		}
+	}
+
+	return obj;
+}
+
+TEST(ParallelMatchesSerial)
+{
+	for (ulong variant = 0; variant < 2; variant++)
+	{
+		string obj = CreateTestModel(variant + 1, variant is 1);
+
+		Model serial;
+		IsTrue(TryImportModelBuffer(obj->Values, obj->Count, 1, &serial, null, null, null));
+
+		for (ulong chunks = 2; chunks <= 16; chunks += 7)
+		{
+			Model parallel;
+			IsTrue(TryImportModelBuffer(obj->Values, obj->Count, chunks, &parallel, null, null, null));
+
+			IsEqual(serial->Count, parallel->Count);
+
+			for (ulong i = 0; i < serial->Count; i++)
+			{
+				IsTrue(MeshesEqual(serial->Meshes[i], parallel->Meshes[i]));
+			}
+
+			Models.Dispose(parallel);
+		}
+
+		Models.Dispose(serial);
+		strings.Dispose(obj);
+	}
+
+	// errors anywhere in the file should fail every chunk count
+	const char* broken = "o A\nv 0 0 0\nf 1 1 1\no B\nv 1 1 1\nf 1 2 9\n";
+	Model model;
+	IsFalse(TryImportModelBuffer(broken, strlen(broken), 1, &model, null, null, null));
+	IsFalse(TryImportModelBuffer(broken, strlen(broken), 3, &model, null, null, null));
+
+	return true;
+}
+
+TEST_SUITE(
+	RunUnitTests,
+	APPEND_TEST(ScanFaceCorners)
+	APPEND_TEST(ImportsBuffer)
+	APPEND_TEST(ParallelMatchesSerial)
+);
+
+// writes a grid of side * side vertices with uvs and normals and 2 * (side - 1)^2 triangles
+private void WriteBenchmarkModel(const string path, ulong side)
+{
+	File file = Files.Open(path, FileModes.Create);
+
+	fprintf(file, "o Benchmark"NEWLINE);
+
+	ulong state = 1;
+
+	for (ulong y = 0; y < side; y++)
+	{
+		for (ulong x = 0; x < side; x++)
+		{
+			state = (state * 6364136223846793005ull) + 1442695040888963407ull;
+			fprintf(file, "v %.6f %.6f %.6f"NEWLINE, x * 0.01 - 3.5, (double)(state >> 40) / (1 << 23) - 1.0, y * -0.01 + 1e-3);
+		}
+	}
+
+	for (ulong y = 0; y < side; y++)
+	{
+		for (ulong x = 0; x < side; x++)
+		{
+			fprintf(file, "vt %.6f %.6f"NEWLINE, (double)x / side, (double)y / side);
+		}
+	}
+
+	for (ulong y = 0; y < side; y++)
+	{
+		for (ulong x = 0; x < side; x++)
+		{
+			state = (state * 6364136223846793005ull) + 1442695040888963407ull;
+			fprintf(file, "vn %.4f %.4f %.4f"NEWLINE, (double)(state >> 40) / (1 << 23) - 1.0, (double)((state >> 20) & 0xFFFFF) / (1 << 19) - 1.0, 0.5);
+		}
+	}
+
+	fprintf(file, "usemtl Benchmark"NEWLINE"s off"NEWLINE);
+
+	for (ulong y = 0; y < side - 1; y++)
+	{
+		for (ulong x = 0; x < side - 1; x++)
+		{
+			const ulong a = y * side + x + 1;
+			const ulong b = a + 1;
+			const ulong c = a + side;
+			const ulong d = c + 1;
+
+			fprintf(file, "f %lli/%lli/%lli %lli/%lli/%lli %lli/%lli/%lli"NEWLINE, a, a, a, b, b, b, d, d, d);
+			fprintf(file, "f %lli/%lli/%lli %lli/%lli/%lli %lli/%lli/%lli"NEWLINE, a, a, a, d, d, d, c, c, c);
+		}
+	}
+
+	Files.Close(file);
+}
+
+// reproduces how the importer used to read files, a counting pass then a second pass parsing every line with sscanf
+private ulong LegacyParse(const string path)
+{
+	File file = Files.Open(path, FileModes.ReadBinary);
+
+	string buffer = empty_stack_array(byte, 1024);
+
+	ulong lineLength;
+	ulong lines = 0;
+
+	while (Files.TryReadLine(file, buffer, 0, &lineLength))
+	{
+		lines += buffer->Values[0] is 'v' or buffer->Values[0] is 'f';
+	}
+
+	rewind(file);
+
+	ulong parsed = 0;
+
+	while (Files.TryReadLine(file, buffer, 0, &lineLength))
+	{
+		const char* line = buffer->Values;
+
+		if (line[0] is 'v')
+		{
+			vector3 vector;
+			if (line[1] is 't')
+			{
+				vector2 uv;
+				parsed += Vector2s.TryDeserialize(line + 3, lineLength - 3, &uv);
+			}
+			else if (line[1] is 'n')
+			{
+				parsed += Vector3s.TryDeserialize(line + 3, lineLength - 3, &vector);
+			}
+			else
+			{
+				parsed += Vector3s.TryDeserialize(line + 2, lineLength - 2, &vector);
+			}
+		}
+		else if (line[0] is 'f')
+		{
+			ulong face[9];
+			parsed += sscanf_s(line + 2, "%lli/%lli/%lli %lli/%lli/%lli %lli/%lli/%lli",
+				&face[0], &face[1], &face[2], &face[3], &face[4], &face[5], &face[6], &face[7], &face[8]) is 9;
+		}
+	}
+
+	Files.Close(file);
+
+	return parsed is lines ? parsed : 0;
+}
+
+TEST(ImportBenchmark)
+{
+	string path = stack_string("importer_benchmark.obj");
+
+	// ~2 million faces
+	WriteBenchmarkModel(path, 1001);
+
+	File file = Files.Open(path, FileModes.ReadBinary);
+	const double megabytes = (double)Files.GetFileSize(file) / (1024.0 * 1024.0);
+	Files.Close(file);
+
+	clock_t start = clock();
+
+	IsNotZero(LegacyParse(path));
+
+	const double legacySeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	// each stage of TryImportModel is timed on its own so the parse figure stays comparable with the legacy one
+	start = clock();
+
+	string data;
+	IsTrue(Files.TryMap(path, &data));
+
+	Model model;
+	IsTrue(TryImportModelBuffer(data->Values, data->Count, GetImportChunkCount(data->Count), &model, null, null, null));
+
+	Files.Unmap(data);
+
+	const double parseSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	// every corner of every face until the mesh is indexed
+	IsEqual(2ull * 1000 * 1000 * 3, model->Meshes[0]->VertexCount);
+
+	start = clock();
+
+	for (ulong i = 0; i < model->Count; i++)
+	{
+		Meshes.Index(model->Meshes[i]);
+	}
+
+	const double indexSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	IsEqual(2ull * 1000 * 1000 * 3, model->Meshes[0]->IndexCount);
+
+	start = clock();
+
+	for (ulong i = 0; i < model->Count; i++)
+	{
+		MeshOptimizers.Optimize(model->Meshes[i]);
+	}
+
+	const double optimizeSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+
+	for (ulong i = 0; i < model->Count; i++)
+	{
+		MeshSimplifiers.GenerateLevels(model->Meshes[i]);
+	}
+
+	const double levelSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	ulong sourceSize;
+	ulong sourceLastModified;
+	IsTrue(Files.TryGetInfo(path, &sourceSize, &sourceLastModified));
+
+	start = clock();
+
+	IsTrue(MeshCaches.TrySave(path, sourceSize, sourceLastModified, model));
+
+	const double cacheWriteSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	Models.Dispose(model);
+
+	// the cache written above is what the second import loads
+	start = clock();
+
+	IsTrue(TryImportModel(path, FileFormats.Obj, &model));
+
+	const double cachedSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	IsEqual(2ull * 1000 * 1000 * 3, model->Meshes[0]->IndexCount);
+
+	Models.Dispose(model);
+
+	remove(path->Values);
+
+	string cachePath = empty_stack_array(byte, _MAX_PATH);
+	strings.AppendArray(cachePath, path);
+	strings.AppendCArray(cachePath, MESH_CACHE_EXTENSION, sizeof(MESH_CACHE_EXTENSION) - 1);
+
+	remove(cachePath->Values);
+
+	fprintf(__test_stream, "\t%.1lf MB: sscanf two pass %10.1lf MB/s single pass %10.1lf MB/s"NEWLINE,
+		megabytes,
+		megabytes / max(legacySeconds, 1e-9),
+		megabytes / max(parseSeconds, 1e-9));
+
+	fprintf(__test_stream, "\tindex %.3lfs optimize %.3lfs levels %.3lfs cache write %.3lfs cached load %.3lfs"NEWLINE,
+		indexSeconds,
+		optimizeSeconds,
+		levelSeconds,
+		cacheWriteSeconds,
+		cachedSeconds);
+
+	return true;
+}
+
+TEST_SUITE(
+	RunBenchmarks,
+	APPEND_TEST(ImportBenchmark)
+);
@@ -1,4 +1,5 @@
 #include "engine/graphics/material.h"
+#include "engine/assets.h"
 #include "core/memory.h"
 #include "GL/glew.h"
 #include "core/guards.h"
@@ -198,10 +199,10 @@ static Material InstanceMaterial(Material material)
 		newMaterial->Name = strings.Clone(material->Name);
 	}
 
-	material->Color = newMaterial->Color;
-	material->DiffuseColor = newMaterial->DiffuseColor;
-	material->SpecularColor = newMaterial->SpecularColor;
-	material->AmbientColor = newMaterial->AmbientColor;
+	newMaterial->Color = material->Color;
+	newMaterial->DiffuseColor = material->DiffuseColor;
+	newMaterial->SpecularColor = material->SpecularColor;
+	newMaterial->AmbientColor = material->AmbientColor;
 
 	newMaterial->Shininess = material->Shininess;
 	newMaterial->Reflectivity = material->Reflectivity;
@@ -340,7 +341,7 @@ static bool TrySetLightUniforms(Shader shader, Light light, ulong index)
 	if (Shaders.TryGetUniformArrayField(shader, Uniforms.Lights, index, Uniforms.Light.Position, &handle))
 	{
 		// update the position of the light to include it's parent's transform and any rotation
-		vector3 pos = Matrix4s.MultiplyVector3(Transforms.Refresh(light->Transform), light->Transform->Position, 1.0f);
+		vector3 pos = Matrix4s.MultiplyVector3(Transforms.GetWorldMatrix(light->Transform), Transforms.GetPosition(light->Transform), 1.0f);
 
 		glUniform3fv(handle, 1, (float*)&pos);
 	}
@@ -393,7 +394,9 @@ static void SetLightUniforms(Shader shader, Scene scene)
 
 static void Draw(Material material, RenderMesh mesh, Scene scene)
 {
-	matrix4 modelMatrix = Transforms.Refresh(mesh->Transform);
+	// world matrices were calculated by Transforms.UpdateAll before anything was drawn this frame, meshes with fixed
+	// point positions are mapped back into model space along with the rest of the transform
+	matrix4 modelMatrix = Matrix4s.Multiply(Transforms.GetWorldMatrix(mesh->Transform), mesh->Dequantization);
 
 	Cameras.Refresh(scene->MainCamera);
 
@@ -419,7 +422,7 @@ static void Draw(Material material, RenderMesh mesh, Scene scene)
 			Shaders.SetMatrix(shader, Uniforms.ProjectionMatrix, scene->MainCamera->State.Projection);
 
 			// set various commmonly used uniforms in shaders
-			Shaders.SetVector3(shader, Uniforms.CameraPosition, scene->MainCamera->Transform->Position);
+			Shaders.SetVector3(shader, Uniforms.CameraPosition, Transforms.GetPosition(scene->MainCamera->Transform));
 
 			// set material if it's used 
 			Shaders.SetColor(shader, Uniforms.Material.Color, material->Color);
@@ -787,7 +790,7 @@ static Material Load(const string path)
 			{
 				string mainTexturePath = empty_stack_array(byte, _MAX_PATH);
 				strings.AppendCArray(mainTexturePath, state.MainTexturePath, Strings.Length(state.MainTexturePath));
-				RawTexture texture = RawTextures.Load(mainTexturePath);
+				RawTexture texture = Assets.LoadTexture(mainTexturePath);
 
 				if (texture is null)
 				{
@@ -804,7 +807,7 @@ static Material Load(const string path)
 				string specularTexturePath = empty_stack_array(byte, _MAX_PATH);
 				strings.AppendCArray(specularTexturePath, state.SpecularTexturePath, Strings.Length(state.SpecularTexturePath));
 
-				RawTexture texture = RawTextures.Load(specularTexturePath);
+				RawTexture texture = Assets.LoadTexture(specularTexturePath);
 
 				if (texture is null)
 				{
@@ -820,7 +823,7 @@ static Material Load(const string path)
 			{
 				string reflectionTexturePath = empty_stack_array(byte, _MAX_PATH);
 				strings.AppendCArray(reflectionTexturePath, state.ReflectionTexturePath, Strings.Length(state.ReflectionTexturePath));
-				RawTexture texture = RawTextures.Load(reflectionTexturePath);
+				RawTexture texture = Assets.LoadTexture(reflectionTexturePath);
 
 				if (texture is null)
 				{
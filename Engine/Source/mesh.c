@@ -1,21 +1,52 @@
 #include "engine/modeling/mesh.h"
 #include "core/memory.h"
+#include "core/map.h"
+#include "core/hashing.h"
+#include <string.h>
+#include "core/guards.h"
+#include "core/cunit.h"
+#include <limits.h>
 
 static Mesh CreateMesh(void);
 static void Dispose(Mesh);
+private void IndexMesh(Mesh mesh);
+private void RunUnitTests(void);
 
 const struct _meshMethods Meshes = {
 	.Create = &CreateMesh,
-	.Dispose = &Dispose
+	.Dispose = &Dispose,
+	.Index = &IndexMesh,
+	.RunUnitTests = &RunUnitTests
 };
 
 DEFINE_TYPE_ID(Mesh);
 
+// a single corner of a triangle, corners that are identical in every attribute are merged when indexing
+typedef struct _meshVertex meshVertex;
+
+struct _meshVertex {
+	vector3 Position;
+	vector2 UV;
+	vector3 Normal;
+};
+
+DEFINE_MAP(ulong, uint);
+
+// the seed used to pick a different key when two unique vertices hash to the same value
+#define VERTEX_REHASH_SEED 0x9E3779B97F4A7C15ull
+
 static void Dispose(Mesh mesh)
 {
 	Memory.Free(mesh->Vertices, Memory.GenericMemoryBlock);
 	Memory.Free(mesh->NormalVertices, Memory.GenericMemoryBlock);
 	Memory.Free(mesh->TextureVertices, Memory.GenericMemoryBlock);
+	Memory.Free(mesh->Indices, Memory.GenericMemoryBlock);
+
+	for (ulong i = 0; i < mesh->LevelCount; i++)
+	{
+		Memory.Free(mesh->Levels[i].Indices, Memory.GenericMemoryBlock);
+	}
+
 	Memory.Free(mesh->Name, Memory.String);
 	Memory.Free(mesh->MaterialName, Memory.String);
 	Memory.Free(mesh, MeshTypeId);
@@ -28,4 +59,184 @@ static Mesh CreateMesh(void)
 	Mesh mesh = Memory.Alloc(sizeof(struct _mesh), MeshTypeId);
 
 	return mesh;
-}
\ No newline at end of file
+}
+
+// the keys are already hashes of the vertices
+private ulong HashVertexKey(const ulong* key)
+{
+	return *key;
+}
+
+// compares the vertex with a unique vertex that was already compacted to the given index
+private bool MeshVertexEquals(const Mesh mesh, const uint index, const meshVertex* vertex)
+{
+	return memcmp(&mesh->Vertices[index], &vertex->Position, sizeof(vector3)) is 0
+		and (mesh->TextureCount is 0 or memcmp(&mesh->TextureVertices[index], &vertex->UV, sizeof(vector2)) is 0)
+		and (mesh->NormalCount is 0 or memcmp(&mesh->NormalVertices[index], &vertex->Normal, sizeof(vector3)) is 0);
+}
+
+private void IndexMesh(Mesh mesh)
+{
+	// already indexed, or too many vertices to address with 32 bit indices
+	if (mesh->Indices isnt null or mesh->VertexCount is 0 or mesh->VertexCount >= UINT_MAX)
+	{
+		return;
+	}
+
+	const ulong count = mesh->VertexCount;
+
+	Guard(mesh->TextureCount is 0 or mesh->TextureCount is count);
+	Guard(mesh->NormalCount is 0 or mesh->NormalCount is count);
+
+	vector3* vertices = mesh->Vertices;
+	vector2* textures = mesh->TextureCount isnt 0 ? mesh->TextureVertices : null;
+	vector3* normals = mesh->NormalCount isnt 0 ? mesh->NormalVertices : null;
+
+	uint* indices = Memory.Alloc(count * sizeof(uint), Memory.GenericMemoryBlock);
+
+	// vertices are keyed by their hash instead of their contents which keeps the entries small, most meshes
+	// share every vertex between several faces so start smaller than the corner count and grow as needed
+	map(ulong, uint) uniqueVertices = maps(ulong, uint).CreateWith(max(count / 4, 1), &HashVertexKey, null);
+
+	uint uniqueCount = 0;
+
+	for (ulong i = 0; i < count; i++)
+	{
+		// unused attributes are left zeroed so they never split a vertex
+		meshVertex vertex = { .Position = vertices[i] };
+
+		if (textures isnt null)
+		{
+			vertex.UV = textures[i];
+		}
+
+		if (normals isnt null)
+		{
+			vertex.Normal = normals[i];
+		}
+
+		ulong key = Hashing.HashSafe((const char*)&vertex, sizeof(meshVertex));
+
+		const uint* existing = maps(ulong, uint).At(uniqueVertices, key);
+
+		// on the rare collision between different vertices keep picking new keys until either
+		// the matching vertex or an unused key is found
+		while (existing isnt null and MeshVertexEquals(mesh, *existing, &vertex) is false)
+		{
+			key = (key ^ VERTEX_REHASH_SEED) * VERTEX_REHASH_SEED;
+
+			existing = maps(ulong, uint).At(uniqueVertices, key);
+		}
+
+		if (existing isnt null)
+		{
+			indices[i] = *existing;
+			continue;
+		}
+
+		// unique vertices are compacted in place, the write position never passes the read position
+		vertices[uniqueCount] = vertex.Position;
+
+		if (textures isnt null)
+		{
+			textures[uniqueCount] = vertex.UV;
+		}
+
+		if (normals isnt null)
+		{
+			normals[uniqueCount] = vertex.Normal;
+		}
+
+		maps(ulong, uint).TryAdd(uniqueVertices, key, uniqueCount);
+
+		indices[i] = uniqueCount++;
+	}
+
+	maps(ulong, uint).Dispose(uniqueVertices);
+
+	Memory.ReallocOrCopy((void**)&mesh->Vertices, count * sizeof(vector3), uniqueCount * sizeof(vector3), Memory.GenericMemoryBlock);
+
+	if (textures isnt null)
+	{
+		Memory.ReallocOrCopy((void**)&mesh->TextureVertices, count * sizeof(vector2), uniqueCount * sizeof(vector2), Memory.GenericMemoryBlock);
+		mesh->TextureCount = uniqueCount;
+	}
+
+	if (normals isnt null)
+	{
+		Memory.ReallocOrCopy((void**)&mesh->NormalVertices, count * sizeof(vector3), uniqueCount * sizeof(vector3), Memory.GenericMemoryBlock);
+		mesh->NormalCount = uniqueCount;
+	}
+
+	mesh->VertexCount = uniqueCount;
+	mesh->Indices = indices;
+	mesh->IndexCount = count;
+}
+
+private vector3* DuplicateVectors(const vector3* vectors, ulong count)
+{
+	return Memory.DuplicateAddress(vectors, count * sizeof(vector3), count * sizeof(vector3), Memory.GenericMemoryBlock);
+}
+
+TEST(IndexMergesSharedCorners)
+{
+	// two triangles forming a quad, the shared edge is listed twice
+	const vector3 quad[] = {
+		{ 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 },
+		{ 0, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 }
+	};
+
+	// the second triangle has a different normal so none of its corners can be shared
+	const vector3 normals[] = {
+		{ 0, 0, 1 }, { 0, 0, 1 }, { 0, 0, 1 },
+		{ 0, 0, -1 }, { 0, 0, -1 }, { 0, 0, -1 }
+	};
+
+	Mesh mesh = Meshes.Create();
+	mesh->Vertices = DuplicateVectors(quad, 6);
+	mesh->VertexCount = 6;
+
+	Meshes.Index(mesh);
+
+	IsEqual(4ull, mesh->VertexCount);
+	IsEqual(6ull, mesh->IndexCount);
+	IsEqual(0ull, mesh->NormalCount);
+
+	// every corner should still resolve to the same position
+	for (ulong i = 0; i < 6; i++)
+	{
+		IsTrue(memcmp(&mesh->Vertices[mesh->Indices[i]], &quad[i], sizeof(vector3)) is 0);
+	}
+
+	// indexing twice does nothing
+	Meshes.Index(mesh);
+	IsEqual(4ull, mesh->VertexCount);
+
+	Meshes.Dispose(mesh);
+
+	mesh = Meshes.Create();
+	mesh->Vertices = DuplicateVectors(quad, 6);
+	mesh->VertexCount = 6;
+	mesh->NormalVertices = DuplicateVectors(normals, 6);
+	mesh->NormalCount = 6;
+
+	Meshes.Index(mesh);
+
+	IsEqual(6ull, mesh->VertexCount);
+	IsEqual(6ull, mesh->NormalCount);
+
+	for (ulong i = 0; i < 6; i++)
+	{
+		IsTrue(memcmp(&mesh->Vertices[mesh->Indices[i]], &quad[i], sizeof(vector3)) is 0);
+		IsTrue(memcmp(&mesh->NormalVertices[mesh->Indices[i]], &normals[i], sizeof(vector3)) is 0);
+	}
+
+	Meshes.Dispose(mesh);
+
+	return true;
+}
+
+TEST_SUITE(
+	RunUnitTests,
+	APPEND_TEST(IndexMergesSharedCorners)
+);
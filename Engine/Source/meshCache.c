@@ -0,0 +1,534 @@
+#include "engine/modeling/meshCache.h"
+#include "core/memory.h"
+#include "core/file.h"
+#include "core/strings.h"
+#include "core/cunit.h"
+#include <string.h>
+#include <stdio.h>
+
+private bool TryLoad(const string sourcePath, ulong sourceSize, ulong sourceLastModified, Model* out_model);
+private bool TrySave(const string sourcePath, ulong sourceSize, ulong sourceLastModified, const Model model);
+private void RunUnitTests(void);
+
+const struct _meshCacheMethods MeshCaches = {
+	.TryLoad = &TryLoad,
+	.TrySave = &TrySave,
+	.RunUnitTests = &RunUnitTests
+};
+
+DEFINE_TYPE_ID(ModelMeshes);
+
+// "SMSH" when read as bytes
+#define MESH_CACHE_MAGIC 0x48534D53
+// increment whenever the layout of the cache or of the meshes stored in it changes
+#define MESH_CACHE_VERSION 3
+// every stream starts on this boundary so it can be copied with aligned loads
+#define MESH_CACHE_ALIGNMENT 16
+
+struct _meshCacheHeader {
+	uint Magic;
+	uint Version;
+	ulong SourceSize;
+	ulong SourceLastModified;
+	ulong MeshCount;
+};
+
+struct _meshCacheLevel {
+	ulong IndexCount;
+	ulong IndicesOffset;
+	float Error;
+	// keeps the levels 8 byte aligned
+	uint Padding;
+};
+
+// every offset is from the start of the file, an offset of 0 means the mesh has no such data
+struct _meshCacheEntry {
+	// names include their nul terminator
+	ulong NameOffset;
+	ulong NameLength;
+	ulong MaterialNameOffset;
+	ulong MaterialNameLength;
+	ulong SmoothingEnabled;
+	ulong VertexCount;
+	ulong VerticesOffset;
+	ulong TextureCount;
+	ulong TexturesOffset;
+	ulong NormalCount;
+	ulong NormalsOffset;
+	ulong IndexCount;
+	ulong IndicesOffset;
+	ulong LevelCount;
+	struct _meshCacheLevel Levels[MAX_MESH_LEVELS];
+};
+
+private string GetCachePath(const string sourcePath, string buffer)
+{
+	strings.AppendArray(buffer, sourcePath);
+	strings.AppendCArray(buffer, MESH_CACHE_EXTENSION, sizeof(MESH_CACHE_EXTENSION) - 1);
+
+	return buffer;
+}
+
+// gets the data at offset within the view, returns false if any of it lies outside of the view
+private bool TryGetRange(const string view, ulong offset, ulong length, const byte** out_data)
+{
+	if (offset > view->Count or length > view->Count - offset)
+	{
+		return false;
+	}
+
+	*out_data = view->Values + offset;
+
+	return true;
+}
+
+private bool TryCopyRange(const string view, ulong offset, ulong count, ulong elementSize, ulong typeId, void** out_data)
+{
+	*out_data = null;
+
+	if (count is 0)
+	{
+		return true;
+	}
+
+	// guard against counts large enough to overflow the size in bytes
+	if (count > view->Count / elementSize)
+	{
+		return false;
+	}
+
+	const byte* data;
+	if (TryGetRange(view, offset, count * elementSize, &data) is false)
+	{
+		return false;
+	}
+
+	*out_data = Memory.DuplicateAddress(data, count * elementSize, count * elementSize, typeId);
+
+	return true;
+}
+
+private bool TryCopyName(const string view, ulong offset, ulong length, char** out_name)
+{
+	*out_name = null;
+
+	if (offset is 0)
+	{
+		return true;
+	}
+
+	const byte* data;
+	if (length is 0 or TryGetRange(view, offset, length, &data) is false or data[length - 1] isnt '\0')
+	{
+		return false;
+	}
+
+	*out_name = Memory.DuplicateAddress(data, length, length, Memory.String);
+
+	return true;
+}
+
+private bool TryLoadMesh(const string view, const struct _meshCacheEntry* entry, Mesh mesh)
+{
+	mesh->SmoothingEnabled = entry->SmoothingEnabled isnt 0;
+
+	mesh->VertexCount = entry->VertexCount;
+	mesh->TextureCount = entry->TextureCount;
+	mesh->NormalCount = entry->NormalCount;
+	mesh->IndexCount = entry->IndexCount;
+
+	if (entry->LevelCount > MAX_MESH_LEVELS)
+	{
+		return false;
+	}
+
+	// every member is left valid for Meshes.Dispose even when a copy fails part of the way through
+	for (ulong i = 0; i < entry->LevelCount; i++)
+	{
+		const struct _meshCacheLevel* level = &entry->Levels[i];
+
+		mesh->LevelCount = i + 1;
+		mesh->Levels[i].IndexCount = level->IndexCount;
+		mesh->Levels[i].Error = level->Error;
+
+		if (TryCopyRange(view, level->IndicesOffset, level->IndexCount, sizeof(uint), Memory.GenericMemoryBlock, (void**)&mesh->Levels[i].Indices) is false)
+		{
+			return false;
+		}
+	}
+
+	return TryCopyName(view, entry->NameOffset, entry->NameLength, &mesh->Name)
+		and TryCopyName(view, entry->MaterialNameOffset, entry->MaterialNameLength, &mesh->MaterialName)
+		and TryCopyRange(view, entry->VerticesOffset, entry->VertexCount, sizeof(vector3), Memory.GenericMemoryBlock, (void**)&mesh->Vertices)
+		and TryCopyRange(view, entry->TexturesOffset, entry->TextureCount, sizeof(vector2), Memory.GenericMemoryBlock, (void**)&mesh->TextureVertices)
+		and TryCopyRange(view, entry->NormalsOffset, entry->NormalCount, sizeof(vector3), Memory.GenericMemoryBlock, (void**)&mesh->NormalVertices)
+		and TryCopyRange(view, entry->IndicesOffset, entry->IndexCount, sizeof(uint), Memory.GenericMemoryBlock, (void**)&mesh->Indices);
+}
+
+private bool TryLoadView(const string view, ulong sourceSize, ulong sourceLastModified, Model* out_model)
+{
+	const struct _meshCacheHeader* header;
+	if (TryGetRange(view, 0, sizeof(struct _meshCacheHeader), (const byte**)&header) is false)
+	{
+		return false;
+	}
+
+	if (header->Magic isnt MESH_CACHE_MAGIC or header->Version isnt MESH_CACHE_VERSION)
+	{
+		return false;
+	}
+
+	// the source was modified after the cache was baked
+	if (header->SourceSize isnt sourceSize or header->SourceLastModified isnt sourceLastModified)
+	{
+		return false;
+	}
+
+	const ulong meshCount = header->MeshCount;
+
+	const struct _meshCacheEntry* entries;
+	if (meshCount > view->Count / sizeof(struct _meshCacheEntry) or
+		TryGetRange(view, sizeof(struct _meshCacheHeader), meshCount * sizeof(struct _meshCacheEntry), (const byte**)&entries) is false)
+	{
+		return false;
+	}
+
+	REGISTER_TYPE(ModelMeshes);
+
+	Model model = Models.Create();
+
+	model->Meshes = Memory.Alloc(max(meshCount, 1) * sizeof(Mesh), ModelMeshesTypeId);
+
+	for (ulong i = 0; i < meshCount; i++)
+	{
+		Mesh mesh = Meshes.Create();
+
+		model->Meshes[i] = mesh;
+		model->Count = i + 1;
+
+		if (TryLoadMesh(view, &entries[i], mesh) is false)
+		{
+			Models.Dispose(model);
+			return false;
+		}
+	}
+
+	*out_model = model;
+
+	return true;
+}
+
+private bool TryLoad(const string sourcePath, ulong sourceSize, ulong sourceLastModified, Model* out_model)
+{
+	*out_model = null;
+
+	string path = GetCachePath(sourcePath, empty_stack_array(byte, _MAX_PATH));
+
+	string view;
+	if (Files.TryMap(path, &view) is false)
+	{
+		return false;
+	}
+
+	const bool result = TryLoadView(view, sourceSize, sourceLastModified, out_model);
+
+	Files.Unmap(view);
+
+	return result;
+}
+
+private ulong AlignOffset(ulong offset)
+{
+	return (offset + (MESH_CACHE_ALIGNMENT - 1)) & ~((ulong)MESH_CACHE_ALIGNMENT - 1);
+}
+
+// reserves room for the data at the end of the file and returns where it starts, 0 when there is no data
+private ulong ReserveRange(ulong* fileSize, ulong length)
+{
+	if (length is 0)
+	{
+		return 0;
+	}
+
+	const ulong offset = AlignOffset(*fileSize);
+
+	*fileSize = offset + length;
+
+	return offset;
+}
+
+private ulong GetNameLength(const char* name)
+{
+	return name is null ? 0 : strlen(name) + 1;
+}
+
+// writes the data at offset, the gap between the current position and offset is filled with zeros
+private bool TryWriteRange(File file, ulong* position, ulong offset, const void* data, ulong length)
+{
+	if (length is 0)
+	{
+		return true;
+	}
+
+	static const byte padding[MESH_CACHE_ALIGNMENT] = { 0 };
+
+	const ulong paddingLength = offset - *position;
+
+	if (fwrite(padding, 1, paddingLength, file) isnt paddingLength or fwrite(data, 1, length, file) isnt length)
+	{
+		return false;
+	}
+
+	*position = offset + length;
+
+	return true;
+}
+
+private bool TrySave(const string sourcePath, ulong sourceSize, ulong sourceLastModified, const Model model)
+{
+	const ulong meshCount = model->Count;
+
+	struct _meshCacheHeader header = {
+		.Magic = MESH_CACHE_MAGIC,
+		.Version = MESH_CACHE_VERSION,
+		.SourceSize = sourceSize,
+		.SourceLastModified = sourceLastModified,
+		.MeshCount = meshCount
+	};
+
+	struct _meshCacheEntry* entries = Memory.Alloc(max(meshCount, 1) * sizeof(struct _meshCacheEntry), Memory.GenericMemoryBlock);
+
+	// lay out the file before writing any of it so the table can be written first
+	ulong fileSize = sizeof(struct _meshCacheHeader) + (meshCount * sizeof(struct _meshCacheEntry));
+
+	for (ulong i = 0; i < meshCount; i++)
+	{
+		const Mesh mesh = model->Meshes[i];
+		struct _meshCacheEntry* entry = &entries[i];
+
+		entry->SmoothingEnabled = mesh->SmoothingEnabled;
+
+		entry->NameLength = GetNameLength(mesh->Name);
+		entry->NameOffset = ReserveRange(&fileSize, entry->NameLength);
+
+		entry->MaterialNameLength = GetNameLength(mesh->MaterialName);
+		entry->MaterialNameOffset = ReserveRange(&fileSize, entry->MaterialNameLength);
+
+		entry->VertexCount = mesh->VertexCount;
+		entry->VerticesOffset = ReserveRange(&fileSize, mesh->VertexCount * sizeof(vector3));
+
+		entry->TextureCount = mesh->TextureCount;
+		entry->TexturesOffset = ReserveRange(&fileSize, mesh->TextureCount * sizeof(vector2));
+
+		entry->NormalCount = mesh->NormalCount;
+		entry->NormalsOffset = ReserveRange(&fileSize, mesh->NormalCount * sizeof(vector3));
+
+		entry->IndexCount = mesh->Indices isnt null ? mesh->IndexCount : 0;
+		entry->IndicesOffset = ReserveRange(&fileSize, entry->IndexCount * sizeof(uint));
+
+		entry->LevelCount = mesh->LevelCount;
+
+		for (ulong level = 0; level < mesh->LevelCount; level++)
+		{
+			entry->Levels[level].IndexCount = mesh->Levels[level].IndexCount;
+			entry->Levels[level].IndicesOffset = ReserveRange(&fileSize, mesh->Levels[level].IndexCount * sizeof(uint));
+			entry->Levels[level].Error = mesh->Levels[level].Error;
+		}
+	}
+
+	string path = GetCachePath(sourcePath, empty_stack_array(byte, _MAX_PATH));
+
+	File file;
+	if (Files.TryOpen(path, FileModes.Create, &file) is false)
+	{
+		Memory.Free(entries, Memory.GenericMemoryBlock);
+		return false;
+	}
+
+	ulong position = 0;
+
+	bool result = TryWriteRange(file, &position, 0, &header, sizeof(struct _meshCacheHeader))
+		and TryWriteRange(file, &position, sizeof(struct _meshCacheHeader), entries, meshCount * sizeof(struct _meshCacheEntry));
+
+	for (ulong i = 0; i < meshCount and result; i++)
+	{
+		const Mesh mesh = model->Meshes[i];
+		const struct _meshCacheEntry* entry = &entries[i];
+
+		result = TryWriteRange(file, &position, entry->NameOffset, mesh->Name, entry->NameLength)
+			and TryWriteRange(file, &position, entry->MaterialNameOffset, mesh->MaterialName, entry->MaterialNameLength)
+			and TryWriteRange(file, &position, entry->VerticesOffset, mesh->Vertices, entry->VertexCount * sizeof(vector3))
+			and TryWriteRange(file, &position, entry->TexturesOffset, mesh->TextureVertices, entry->TextureCount * sizeof(vector2))
+			and TryWriteRange(file, &position, entry->NormalsOffset, mesh->NormalVertices, entry->NormalCount * sizeof(vector3))
+			and TryWriteRange(file, &position, entry->IndicesOffset, mesh->Indices, entry->IndexCount * sizeof(uint));
+
+		for (ulong level = 0; level < entry->LevelCount and result; level++)
+		{
+			result = TryWriteRange(file, &position, entry->Levels[level].IndicesOffset, mesh->Levels[level].Indices, entry->Levels[level].IndexCount * sizeof(uint));
+		}
+	}
+
+	Files.Close(file);
+
+	Memory.Free(entries, Memory.GenericMemoryBlock);
+
+	// a partially written cache would fail to load anyway, don't leave it around
+	if (result is false)
+	{
+		remove(path->Values);
+	}
+
+	return result;
+}
+
+private Mesh CreateTestMesh(const char* name, const char* materialName, ulong vertexCount, bool textured, ulong indexCount)
+{
+	Mesh mesh = Meshes.Create();
+
+	mesh->Name = Strings.DuplicateTerminated(name);
+	mesh->MaterialName = Strings.DuplicateTerminated(materialName);
+	mesh->SmoothingEnabled = materialName isnt null;
+
+	mesh->VertexCount = vertexCount;
+	mesh->Vertices = Memory.Alloc(vertexCount * sizeof(vector3), Memory.GenericMemoryBlock);
+
+	mesh->NormalCount = vertexCount;
+	mesh->NormalVertices = Memory.Alloc(vertexCount * sizeof(vector3), Memory.GenericMemoryBlock);
+
+	if (textured)
+	{
+		mesh->TextureCount = vertexCount;
+		mesh->TextureVertices = Memory.Alloc(vertexCount * sizeof(vector2), Memory.GenericMemoryBlock);
+	}
+
+	for (ulong i = 0; i < vertexCount; i++)
+	{
+		mesh->Vertices[i] = (vector3){ (float)i, -(float)i, 0.5f * i };
+		mesh->NormalVertices[i] = (vector3){ 0, 1.0f / (i + 1), 0 };
+
+		if (textured)
+		{
+			mesh->TextureVertices[i] = (vector2){ 0.25f * i, 1.0f };
+		}
+	}
+
+	if (indexCount isnt 0)
+	{
+		mesh->IndexCount = indexCount;
+		mesh->Indices = Memory.Alloc(indexCount * sizeof(uint), Memory.GenericMemoryBlock);
+
+		for (ulong i = 0; i < indexCount; i++)
+		{
+			mesh->Indices[i] = (uint)((i * 7) % vertexCount);
+		}
+
+		// a level for every other triangle until only one is left
+		for (ulong count = ((indexCount / 2) / 3) * 3; count isnt 0 and mesh->LevelCount < MAX_MESH_LEVELS; count = ((count / 2) / 3) * 3)
+		{
+			meshLevel* level = &mesh->Levels[mesh->LevelCount++];
+
+			level->IndexCount = count;
+			level->Indices = Memory.DuplicateAddress(mesh->Indices, count * sizeof(uint), count * sizeof(uint), Memory.GenericMemoryBlock);
+			level->Error = 0.125f * mesh->LevelCount;
+		}
+	}
+
+	return mesh;
+}
+
+private bool LevelsEqual(const Mesh left, const Mesh right)
+{
+	if (left->LevelCount isnt right->LevelCount)
+	{
+		return false;
+	}
+
+	for (ulong i = 0; i < left->LevelCount; i++)
+	{
+		const meshLevel* a = &left->Levels[i];
+		const meshLevel* b = &right->Levels[i];
+
+		if (a->IndexCount isnt b->IndexCount or a->Error isnt b->Error or memcmp(a->Indices, b->Indices, a->IndexCount * sizeof(uint)) isnt 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+private bool MeshesEqual(const Mesh left, const Mesh right)
+{
+	return LevelsEqual(left, right)
+		and strcmp(left->Name, right->Name) is 0
+		and ((left->MaterialName is null and right->MaterialName is null)
+			or (left->MaterialName isnt null and right->MaterialName isnt null and strcmp(left->MaterialName, right->MaterialName) is 0))
+		and left->SmoothingEnabled is right->SmoothingEnabled
+		and left->VertexCount is right->VertexCount
+		and left->TextureCount is right->TextureCount
+		and left->NormalCount is right->NormalCount
+		and left->IndexCount is right->IndexCount
+		and memcmp(left->Vertices, right->Vertices, left->VertexCount * sizeof(vector3)) is 0
+		and (left->TextureCount is 0 or memcmp(left->TextureVertices, right->TextureVertices, left->TextureCount * sizeof(vector2)) is 0)
+		and memcmp(left->NormalVertices, right->NormalVertices, left->NormalCount * sizeof(vector3)) is 0
+		and (left->IndexCount is 0 or memcmp(left->Indices, right->Indices, left->IndexCount * sizeof(uint)) is 0);
+}
+
+TEST(RoundTrip)
+{
+	REGISTER_TYPE(ModelMeshes);
+
+	Model model = Models.Create();
+	model->Count = 3;
+	model->Meshes = Memory.Alloc(3 * sizeof(Mesh), ModelMeshesTypeId);
+	model->Meshes[0] = CreateTestMesh("Cube", "Stone", 24, true, 36);
+	model->Meshes[1] = CreateTestMesh("Flat", null, 9, false, 0);
+	model->Meshes[2] = CreateTestMesh("Single", "Grass", 1, true, 3);
+
+	string source = stack_string("mesh_cache_test.obj");
+	string path = GetCachePath(source, empty_stack_array(byte, _MAX_PATH));
+
+	IsTrue(TrySave(source, 1234, 5678, model));
+
+	Model loaded;
+	IsTrue(TryLoad(source, 1234, 5678, &loaded));
+	IsEqual(model->Count, loaded->Count);
+
+	for (ulong i = 0; i < model->Count; i++)
+	{
+		IsTrue(MeshesEqual(model->Meshes[i], loaded->Meshes[i]));
+	}
+
+	Models.Dispose(loaded);
+
+	// any change to the source invalidates the cache
+	IsFalse(TryLoad(source, 1235, 5678, &loaded));
+	IsFalse(TryLoad(source, 1234, 5679, &loaded));
+	IsNull(loaded);
+
+	// truncated caches are rejected instead of read past their end
+	string view = Files.Map(path);
+
+	for (ulong length = 0; length < view->Count; length += 37)
+	{
+		partial_string truncated = *view;
+		truncated.Count = length;
+
+		IsFalse(TryLoadView(&truncated, 1234, 5678, &loaded));
+	}
+
+	Files.Unmap(view);
+
+	remove(path->Values);
+
+	IsFalse(TryLoad(source, 1234, 5678, &loaded));
+
+	Models.Dispose(model);
+
+	return true;
+}
+
+TEST_SUITE(
+	RunUnitTests,
+	APPEND_TEST(RoundTrip)
+);
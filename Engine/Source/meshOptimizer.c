@@ -0,0 +1,793 @@
+#include "engine/modeling/meshOptimizer.h"
+#include "core/memory.h"
+#include "core/cunit.h"
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <limits.h>
+
+// Vertex cache ordering is Tipsify (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and
+// Reduced Overdraw"), it fans around one vertex at a time and picks the next vertex to fan around from the ones that
+// were just emitted, preferring the oldest vertex that will still be in the cache once its remaining triangles are drawn.
+// Overdraw ordering splits that order into clusters wherever the cache was cold anyway, or wherever a cluster already
+// reached a good enough miss ratio, then sorts the clusters so the ones facing outwards are drawn first.
+
+private void OptimizeVertexCache(Mesh mesh, ulong cacheSize);
+private void OptimizeOverdraw(Mesh mesh, ulong cacheSize, float threshold);
+private void OptimizeVertexFetch(Mesh mesh);
+private void Optimize(Mesh mesh);
+private float CacheMissRatio(const Mesh mesh, ulong cacheSize);
+private void RunUnitTests(void);
+
+const struct _meshOptimizerMethods MeshOptimizers = {
+	.OptimizeVertexCache = &OptimizeVertexCache,
+	.OptimizeOverdraw = &OptimizeOverdraw,
+	.OptimizeVertexFetch = &OptimizeVertexFetch,
+	.Optimize = &Optimize,
+	.CacheMissRatio = &CacheMissRatio,
+	.RunUnitTests = &RunUnitTests
+};
+
+#define NO_VERTEX UINT_MAX
+
+// whether the mesh has whole triangles of indices that can be reordered
+private bool IsOptimizable(const Mesh mesh)
+{
+	return mesh isnt null and mesh->Indices isnt null and mesh->IndexCount >= 3 and (mesh->IndexCount % 3) is 0 and mesh->VertexCount < NO_VERTEX;
+}
+
+// A first in first out cache that is emptied by moving time forward instead of clearing it, a vertex is cached
+// while fewer than Size vertices have been added after it
+typedef struct _vertexCache vertexCache;
+
+struct _vertexCache {
+	uint* Timestamps;
+	ulong Time;
+	ulong Size;
+};
+
+private vertexCache CreateVertexCache(ulong vertexCount, ulong size)
+{
+	return (vertexCache) {
+		.Timestamps = Memory.Alloc(max(vertexCount, 1) * sizeof(uint), Memory.GenericMemoryBlock),
+		.Time = size + 1,
+		.Size = size
+	};
+}
+
+private void ClearVertexCache(vertexCache* cache)
+{
+	cache->Time += cache->Size + 1;
+}
+
+// returns 1 when the vertex had to be transformed
+private ulong UseVertex(vertexCache* cache, uint vertex)
+{
+	if (cache->Time - cache->Timestamps[vertex] > cache->Size)
+	{
+		cache->Timestamps[vertex] = (uint)cache->Time++;
+		return 1;
+	}
+
+	return 0;
+}
+
+private ulong UseTriangle(vertexCache* cache, const uint* triangle)
+{
+	return UseVertex(cache, triangle[0]) + UseVertex(cache, triangle[1]) + UseVertex(cache, triangle[2]);
+}
+
+private void DisposeVertexCache(vertexCache* cache)
+{
+	Memory.Free(cache->Timestamps, Memory.GenericMemoryBlock);
+}
+
+private ulong CountCacheMisses(const uint* indices, ulong indexCount, ulong vertexCount, ulong cacheSize)
+{
+	vertexCache cache = CreateVertexCache(vertexCount, cacheSize);
+
+	ulong misses = 0;
+
+	for (ulong i = 0; i < indexCount; i += 3)
+	{
+		misses += UseTriangle(&cache, indices + i);
+	}
+
+	DisposeVertexCache(&cache);
+
+	return misses;
+}
+
+private float CacheMissRatio(const Mesh mesh, ulong cacheSize)
+{
+	if (IsOptimizable(mesh) is false)
+	{
+		return 0.0f;
+	}
+
+	const ulong misses = CountCacheMisses(mesh->Indices, mesh->IndexCount, mesh->VertexCount, cacheSize);
+
+	return (float)misses / (float)(mesh->IndexCount / 3);
+}
+
+typedef struct _tipsify tipsify;
+
+struct _tipsify {
+	const uint* Indices;
+	ulong VertexCount;
+	ulong CacheSize;
+	// the triangles that use each vertex, a vertex's triangles are Adjacency[Offsets[v]] to Adjacency[Offsets[v + 1]]
+	uint* Offsets;
+	uint* Adjacency;
+	// the number of triangles that use each vertex and haven't been emitted yet
+	uint* LiveTriangles;
+	// the time each vertex last entered the cache
+	uint* CacheTimes;
+	ulong Time;
+	// every emitted vertex, popped to find somewhere to continue when the vertices around the fan are used up
+	uint* DeadEnds;
+	ulong DeadEndCount;
+	// the vertices of the triangles emitted around the current fan
+	uint* Candidates;
+	ulong CandidateCount;
+	// the next vertex to check once there are no dead ends left
+	ulong Cursor;
+	bool* Emitted;
+};
+
+private uint SkipDeadEnd(tipsify* state)
+{
+	while (state->DeadEndCount isnt 0)
+	{
+		const uint vertex = state->DeadEnds[--state->DeadEndCount];
+
+		if (state->LiveTriangles[vertex] isnt 0)
+		{
+			return vertex;
+		}
+	}
+
+	for (; state->Cursor < state->VertexCount; ++state->Cursor)
+	{
+		if (state->LiveTriangles[state->Cursor] isnt 0)
+		{
+			return (uint)state->Cursor;
+		}
+	}
+
+	return NO_VERTEX;
+}
+
+private uint NextFanningVertex(tipsify* state)
+{
+	uint best = NO_VERTEX;
+	long long bestPriority = -1;
+
+	for (ulong i = 0; i < state->CandidateCount; i++)
+	{
+		const uint vertex = state->Candidates[i];
+
+		if (state->LiveTriangles[vertex] is 0)
+		{
+			continue;
+		}
+
+		const ulong age = state->Time - state->CacheTimes[vertex];
+
+		// vertices that would fall out of the cache before their remaining triangles are drawn aren't worth fanning around
+		const long long priority = age + (2 * state->LiveTriangles[vertex]) <= state->CacheSize ? (long long)age : 0;
+
+		if (priority > bestPriority)
+		{
+			best = vertex;
+			bestPriority = priority;
+		}
+	}
+
+	return best isnt NO_VERTEX ? best : SkipDeadEnd(state);
+}
+
+// writes the triangles of indices into destination in Tipsify order
+private void TipsifyTriangles(const uint* indices, ulong indexCount, ulong vertexCount, ulong cacheSize, uint* destination)
+{
+	const ulong triangleCount = indexCount / 3;
+
+	tipsify state = {
+		.Indices = indices,
+		.VertexCount = vertexCount,
+		.CacheSize = cacheSize,
+		.Offsets = Memory.Alloc((vertexCount + 1) * sizeof(uint), Memory.GenericMemoryBlock),
+		.Adjacency = Memory.Alloc(indexCount * sizeof(uint), Memory.GenericMemoryBlock),
+		.LiveTriangles = Memory.Alloc(vertexCount * sizeof(uint), Memory.GenericMemoryBlock),
+		.CacheTimes = Memory.Alloc(vertexCount * sizeof(uint), Memory.GenericMemoryBlock),
+		.Time = cacheSize + 1,
+		.DeadEnds = Memory.Alloc(indexCount * sizeof(uint), Memory.GenericMemoryBlock),
+		.DeadEndCount = 0,
+		.Candidates = Memory.Alloc(indexCount * sizeof(uint), Memory.GenericMemoryBlock),
+		.CandidateCount = 0,
+		.Cursor = 1,
+		.Emitted = Memory.Alloc(triangleCount * sizeof(bool), Memory.GenericMemoryBlock)
+	};
+
+	for (ulong i = 0; i < indexCount; i++)
+	{
+		++state.LiveTriangles[indices[i]];
+	}
+
+	for (ulong vertex = 0; vertex < vertexCount; vertex++)
+	{
+		state.Offsets[vertex + 1] = state.Offsets[vertex] + state.LiveTriangles[vertex];
+	}
+
+	// the cache times are still zero so they can count how many triangles were added to each vertex so far
+	for (ulong i = 0; i < indexCount; i++)
+	{
+		const uint vertex = indices[i];
+
+		state.Adjacency[state.Offsets[vertex] + state.CacheTimes[vertex]++] = (uint)(i / 3);
+	}
+
+	memset(state.CacheTimes, 0, vertexCount * sizeof(uint));
+
+	ulong written = 0;
+	uint fan = 0;
+
+	while (fan isnt NO_VERTEX)
+	{
+		state.CandidateCount = 0;
+
+		for (uint i = state.Offsets[fan]; i < state.Offsets[fan + 1]; i++)
+		{
+			const uint triangle = state.Adjacency[i];
+
+			if (state.Emitted[triangle])
+			{
+				continue;
+			}
+
+			state.Emitted[triangle] = true;
+
+			for (ulong corner = 0; corner < 3; corner++)
+			{
+				const uint vertex = indices[(triangle * 3) + corner];
+
+				destination[written++] = vertex;
+
+				state.DeadEnds[state.DeadEndCount++] = vertex;
+				state.Candidates[state.CandidateCount++] = vertex;
+
+				--state.LiveTriangles[vertex];
+
+				if (state.Time - state.CacheTimes[vertex] > cacheSize)
+				{
+					state.CacheTimes[vertex] = (uint)state.Time++;
+				}
+			}
+		}
+
+		fan = NextFanningVertex(&state);
+	}
+
+	Memory.Free(state.Offsets, Memory.GenericMemoryBlock);
+	Memory.Free(state.Adjacency, Memory.GenericMemoryBlock);
+	Memory.Free(state.LiveTriangles, Memory.GenericMemoryBlock);
+	Memory.Free(state.CacheTimes, Memory.GenericMemoryBlock);
+	Memory.Free(state.DeadEnds, Memory.GenericMemoryBlock);
+	Memory.Free(state.Candidates, Memory.GenericMemoryBlock);
+	Memory.Free(state.Emitted, Memory.GenericMemoryBlock);
+}
+
+private void OptimizeVertexCache(Mesh mesh, ulong cacheSize)
+{
+	if (IsOptimizable(mesh) is false)
+	{
+		return;
+	}
+
+	uint* indices = Memory.Alloc(mesh->IndexCount * sizeof(uint), Memory.GenericMemoryBlock);
+
+	TipsifyTriangles(mesh->Indices, mesh->IndexCount, mesh->VertexCount, max(cacheSize, 3), indices);
+
+	Memory.Free(mesh->Indices, Memory.GenericMemoryBlock);
+
+	mesh->Indices = indices;
+}
+
+// writes the first triangle of every cluster to out_starts and returns the number of clusters
+private ulong FindClusters(const uint* indices, ulong triangleCount, ulong vertexCount, ulong cacheSize, float threshold, uint* out_starts)
+{
+	vertexCache cache = CreateVertexCache(vertexCount, cacheSize);
+
+	// a triangle with none of its vertices in the cache would start cold in any order, those are the hard boundaries
+	uint* hardStarts = Memory.Alloc(triangleCount * sizeof(uint), Memory.GenericMemoryBlock);
+	ulong hardCount = 0;
+
+	for (ulong triangle = 0; triangle < triangleCount; triangle++)
+	{
+		if (UseTriangle(&cache, indices + (triangle * 3)) is 3)
+		{
+			hardStarts[hardCount++] = (uint)triangle;
+		}
+	}
+
+	// the first triangle always misses every vertex
+	ulong count = 0;
+
+	for (ulong cluster = 0; cluster < hardCount; cluster++)
+	{
+		const ulong start = hardStarts[cluster];
+		const ulong end = cluster + 1 < hardCount ? hardStarts[cluster + 1] : triangleCount;
+
+		ClearVertexCache(&cache);
+
+		ulong clusterMisses = 0;
+
+		for (ulong triangle = start; triangle < end; triangle++)
+		{
+			clusterMisses += UseTriangle(&cache, indices + (triangle * 3));
+		}
+
+		const float clusterThreshold = threshold * ((float)clusterMisses / (float)(end - start));
+
+		out_starts[count++] = (uint)start;
+
+		// every time the triangles since the last split are already as good as the cluster is allowed to be, split
+		// again so the pieces can be sorted separately
+		ClearVertexCache(&cache);
+
+		ulong misses = 0;
+		ulong triangles = 0;
+
+		for (ulong triangle = start; triangle < end; triangle++)
+		{
+			misses += UseTriangle(&cache, indices + (triangle * 3));
+			++triangles;
+
+			if (triangle + 1 < end and (float)misses / (float)triangles <= clusterThreshold)
+			{
+				out_starts[count++] = (uint)(triangle + 1);
+
+				ClearVertexCache(&cache);
+
+				misses = 0;
+				triangles = 0;
+			}
+		}
+	}
+
+	Memory.Free(hardStarts, Memory.GenericMemoryBlock);
+	DisposeVertexCache(&cache);
+
+	return count;
+}
+
+typedef struct _clusterKey clusterKey;
+
+struct _clusterKey {
+	float SortKey;
+	uint Cluster;
+};
+
+// the clusters that face furthest outwards come first, ties keep their order
+private int CompareClusterKeys(const void* left, const void* right)
+{
+	const clusterKey* a = left;
+	const clusterKey* b = right;
+
+	if (a->SortKey isnt b->SortKey)
+	{
+		return a->SortKey > b->SortKey ? -1 : 1;
+	}
+
+	return a->Cluster < b->Cluster ? -1 : (a->Cluster > b->Cluster ? 1 : 0);
+}
+
+private vector3 SubtractVectors(const vector3 left, const vector3 right)
+{
+	return (vector3) { left.x - right.x, left.y - right.y, left.z - right.z };
+}
+
+private vector3 CrossVectors(const vector3 left, const vector3 right)
+{
+	return (vector3) {
+		(left.y * right.z) - (left.z * right.y),
+		(left.z * right.x) - (left.x * right.z),
+		(left.x * right.y) - (left.y * right.x)
+	};
+}
+
+private float DotVectors(const vector3 left, const vector3 right)
+{
+	return (left.x * right.x) + (left.y * right.y) + (left.z * right.z);
+}
+
+// how far the cluster is in front of the center of the mesh along its own normal, clusters on the outside of a
+// convex area have the largest keys and are the least likely to be hidden by anything else
+private float GetClusterSortKey(const Mesh mesh, ulong start, ulong end, const vector3 meshCenter)
+{
+	const uint* indices = mesh->Indices;
+
+	vector3 center = { 0, 0, 0 };
+	vector3 normal = { 0, 0, 0 };
+	float area = 0.0f;
+
+	for (ulong triangle = start; triangle < end; triangle++)
+	{
+		const vector3 a = mesh->Vertices[indices[(triangle * 3) + 0]];
+		const vector3 b = mesh->Vertices[indices[(triangle * 3) + 1]];
+		const vector3 c = mesh->Vertices[indices[(triangle * 3) + 2]];
+
+		// the cross product is twice the area of the triangle, only the ratios between triangles matter
+		const vector3 triangleNormal = CrossVectors(SubtractVectors(b, a), SubtractVectors(c, a));
+		const float triangleArea = sqrtf(DotVectors(triangleNormal, triangleNormal));
+
+		center.x += (a.x + b.x + c.x) * (triangleArea / 3.0f);
+		center.y += (a.y + b.y + c.y) * (triangleArea / 3.0f);
+		center.z += (a.z + b.z + c.z) * (triangleArea / 3.0f);
+
+		normal.x += triangleNormal.x;
+		normal.y += triangleNormal.y;
+		normal.z += triangleNormal.z;
+
+		area += triangleArea;
+	}
+
+	const float inverseArea = area is 0.0f ? 0.0f : 1.0f / area;
+
+	center = (vector3) { center.x * inverseArea, center.y * inverseArea, center.z * inverseArea };
+
+	const float normalLength = sqrtf(DotVectors(normal, normal));
+	const float inverseLength = normalLength is 0.0f ? 0.0f : 1.0f / normalLength;
+
+	normal = (vector3) { normal.x * inverseLength, normal.y * inverseLength, normal.z * inverseLength };
+
+	return DotVectors(SubtractVectors(center, meshCenter), normal);
+}
+
+private void OptimizeOverdraw(Mesh mesh, ulong cacheSize, float threshold)
+{
+	if (IsOptimizable(mesh) is false)
+	{
+		return;
+	}
+
+	const ulong triangleCount = mesh->IndexCount / 3;
+
+	uint* starts = Memory.Alloc(triangleCount * sizeof(uint), Memory.GenericMemoryBlock);
+
+	const ulong clusterCount = FindClusters(mesh->Indices, triangleCount, mesh->VertexCount, max(cacheSize, 3), threshold, starts);
+
+	vector3 meshCenter = { 0, 0, 0 };
+
+	for (ulong i = 0; i < mesh->IndexCount; i++)
+	{
+		const vector3 position = mesh->Vertices[mesh->Indices[i]];
+
+		meshCenter.x += position.x;
+		meshCenter.y += position.y;
+		meshCenter.z += position.z;
+	}
+
+	const float inverseCount = 1.0f / (float)mesh->IndexCount;
+
+	meshCenter = (vector3) { meshCenter.x * inverseCount, meshCenter.y * inverseCount, meshCenter.z * inverseCount };
+
+	clusterKey* keys = Memory.Alloc(clusterCount * sizeof(clusterKey), Memory.GenericMemoryBlock);
+
+	for (ulong cluster = 0; cluster < clusterCount; cluster++)
+	{
+		const ulong end = cluster + 1 < clusterCount ? starts[cluster + 1] : triangleCount;
+
+		keys[cluster] = (clusterKey) {
+			.SortKey = GetClusterSortKey(mesh, starts[cluster], end, meshCenter),
+			.Cluster = (uint)cluster
+		};
+	}
+
+	qsort(keys, clusterCount, sizeof(clusterKey), &CompareClusterKeys);
+
+	uint* indices = Memory.Alloc(mesh->IndexCount * sizeof(uint), Memory.GenericMemoryBlock);
+
+	ulong written = 0;
+
+	for (ulong i = 0; i < clusterCount; i++)
+	{
+		const ulong cluster = keys[i].Cluster;
+		const ulong start = starts[cluster];
+		const ulong end = cluster + 1 < clusterCount ? starts[cluster + 1] : triangleCount;
+
+		memcpy(indices + written, mesh->Indices + (start * 3), (end - start) * 3 * sizeof(uint));
+
+		written += (end - start) * 3;
+	}
+
+	Memory.Free(keys, Memory.GenericMemoryBlock);
+	Memory.Free(starts, Memory.GenericMemoryBlock);
+	Memory.Free(mesh->Indices, Memory.GenericMemoryBlock);
+
+	mesh->Indices = indices;
+}
+
+// moves every used element of the attribute to the position the remap gives it
+private void* RemapAttribute(void* values, ulong elementSize, ulong count, const uint* remap, ulong usedCount)
+{
+	byte* remapped = Memory.Alloc(max(usedCount, 1) * elementSize, Memory.GenericMemoryBlock);
+
+	for (ulong i = 0; i < count; i++)
+	{
+		if (remap[i] isnt NO_VERTEX)
+		{
+			memcpy(remapped + (remap[i] * elementSize), (byte*)values + (i * elementSize), elementSize);
+		}
+	}
+
+	Memory.Free(values, Memory.GenericMemoryBlock);
+
+	return remapped;
+}
+
+private void OptimizeVertexFetch(Mesh mesh)
+{
+	if (IsOptimizable(mesh) is false)
+	{
+		return;
+	}
+
+	const ulong vertexCount = mesh->VertexCount;
+
+	uint* remap = Memory.Alloc(vertexCount * sizeof(uint), Memory.GenericMemoryBlock);
+
+	memset(remap, 0xFF, vertexCount * sizeof(uint));
+
+	uint usedCount = 0;
+
+	for (ulong i = 0; i < mesh->IndexCount; i++)
+	{
+		uint* vertex = &remap[mesh->Indices[i]];
+
+		if (*vertex is NO_VERTEX)
+		{
+			*vertex = usedCount++;
+		}
+
+		mesh->Indices[i] = *vertex;
+	}
+
+	// levels only use vertices the full detail triangles use
+	for (ulong level = 0; level < mesh->LevelCount; level++)
+	{
+		for (ulong i = 0; i < mesh->Levels[level].IndexCount; i++)
+		{
+			mesh->Levels[level].Indices[i] = remap[mesh->Levels[level].Indices[i]];
+		}
+	}
+
+	mesh->Vertices = RemapAttribute(mesh->Vertices, sizeof(vector3), vertexCount, remap, usedCount);
+	mesh->VertexCount = usedCount;
+
+	if (mesh->TextureCount is vertexCount)
+	{
+		mesh->TextureVertices = RemapAttribute(mesh->TextureVertices, sizeof(vector2), vertexCount, remap, usedCount);
+		mesh->TextureCount = usedCount;
+	}
+
+	if (mesh->NormalCount is vertexCount)
+	{
+		mesh->NormalVertices = RemapAttribute(mesh->NormalVertices, sizeof(vector3), vertexCount, remap, usedCount);
+		mesh->NormalCount = usedCount;
+	}
+
+	Memory.Free(remap, Memory.GenericMemoryBlock);
+}
+
+private void Optimize(Mesh mesh)
+{
+	OptimizeVertexCache(mesh, DEFAULT_VERTEX_CACHE_SIZE);
+	OptimizeOverdraw(mesh, DEFAULT_VERTEX_CACHE_SIZE, DEFAULT_OVERDRAW_THRESHOLD);
+	OptimizeVertexFetch(mesh);
+}
+
+// a triangle by the positions of its corners, rotated so the smallest corner is first without changing the winding
+typedef struct _triangleKey triangleKey;
+
+struct _triangleKey {
+	vector3 Corners[3];
+};
+
+private int CompareTriangleKeys(const void* left, const void* right)
+{
+	return memcmp(left, right, sizeof(triangleKey));
+}
+
+private triangleKey* GetSortedTriangles(const Mesh mesh)
+{
+	const ulong triangleCount = mesh->IndexCount / 3;
+
+	triangleKey* keys = Memory.Alloc(triangleCount * sizeof(triangleKey), Memory.GenericMemoryBlock);
+
+	for (ulong triangle = 0; triangle < triangleCount; triangle++)
+	{
+		ulong first = 0;
+
+		for (ulong corner = 1; corner < 3; corner++)
+		{
+			const vector3* candidate = &mesh->Vertices[mesh->Indices[(triangle * 3) + corner]];
+			const vector3* smallest = &mesh->Vertices[mesh->Indices[(triangle * 3) + first]];
+
+			if (memcmp(candidate, smallest, sizeof(vector3)) < 0)
+			{
+				first = corner;
+			}
+		}
+
+		for (ulong corner = 0; corner < 3; corner++)
+		{
+			keys[triangle].Corners[corner] = mesh->Vertices[mesh->Indices[(triangle * 3) + ((first + corner) % 3)]];
+		}
+	}
+
+	qsort(keys, triangleCount, sizeof(triangleKey), &CompareTriangleKeys);
+
+	return keys;
+}
+
+// a grid of size by size quads with the triangles in a random order, a worst case for the vertex cache
+private Mesh CreateShuffledGrid(ulong size)
+{
+	Mesh mesh = Meshes.Create();
+
+	const ulong vertexCount = (size + 1) * (size + 1);
+
+	mesh->VertexCount = vertexCount;
+	mesh->Vertices = Memory.Alloc(vertexCount * sizeof(vector3), Memory.GenericMemoryBlock);
+
+	for (ulong y = 0; y <= size; y++)
+	{
+		for (ulong x = 0; x <= size; x++)
+		{
+			// a slight bulge so the clusters face different directions
+			const float dx = (float)x - (size / 2.0f);
+			const float dy = (float)y - (size / 2.0f);
+
+			mesh->Vertices[(y * (size + 1)) + x] = (vector3) { (float)x, (float)y, -((dx * dx) + (dy * dy)) / (float)size };
+		}
+	}
+
+	mesh->IndexCount = size * size * 6;
+	mesh->Indices = Memory.Alloc(mesh->IndexCount * sizeof(uint), Memory.GenericMemoryBlock);
+
+	ulong triangle = 0;
+
+	for (ulong y = 0; y < size; y++)
+	{
+		for (ulong x = 0; x < size; x++)
+		{
+			const uint corner = (uint)((y * (size + 1)) + x);
+			const uint above = corner + (uint)(size + 1);
+
+			const uint quad[6] = { corner, corner + 1, above + 1, corner, above + 1, above };
+
+			memcpy(mesh->Indices + (triangle * 3), quad, sizeof(quad));
+
+			triangle += 2;
+		}
+	}
+
+	ulong state = 0x9E3779B97F4A7C15ull;
+
+	for (ulong i = triangle - 1; i > 0; i--)
+	{
+		state = (state * 6364136223846793005ull) + 1442695040888963407ull;
+
+		const ulong other = (state >> 33) % (i + 1);
+
+		uint swap[3];
+		memcpy(swap, mesh->Indices + (i * 3), sizeof(swap));
+		memcpy(mesh->Indices + (i * 3), mesh->Indices + (other * 3), sizeof(swap));
+		memcpy(mesh->Indices + (other * 3), swap, sizeof(swap));
+	}
+
+	return mesh;
+}
+
+TEST(ReducesCacheMissRatio)
+{
+	Mesh mesh = CreateShuffledGrid(64);
+
+	triangleKey* expected = GetSortedTriangles(mesh);
+
+	const float shuffled = MeshOptimizers.CacheMissRatio(mesh, DEFAULT_VERTEX_CACHE_SIZE);
+
+	MeshOptimizers.OptimizeVertexCache(mesh, DEFAULT_VERTEX_CACHE_SIZE);
+
+	const float tipsified = MeshOptimizers.CacheMissRatio(mesh, DEFAULT_VERTEX_CACHE_SIZE);
+
+	MeshOptimizers.OptimizeOverdraw(mesh, DEFAULT_VERTEX_CACHE_SIZE, DEFAULT_OVERDRAW_THRESHOLD);
+
+	const float sorted = MeshOptimizers.CacheMissRatio(mesh, DEFAULT_VERTEX_CACHE_SIZE);
+
+	fprintf(__test_stream, "\tACMR shuffled %.3f vertex cache %.3f overdraw %.3f"NEWLINE, shuffled, tipsified, sorted);
+
+	// a shuffled grid misses nearly every vertex, a well ordered one transforms less than one vertex per triangle
+	IsTrue(shuffled > 2.5f);
+	IsTrue(tipsified < 0.8f);
+
+	// sorting for overdraw may only cost a little of what was gained
+	IsTrue(sorted <= tipsified * DEFAULT_OVERDRAW_THRESHOLD * 1.05f);
+
+	// reordering never adds, removes or rewinds a triangle
+	triangleKey* actual = GetSortedTriangles(mesh);
+
+	IsTrue(memcmp(expected, actual, (mesh->IndexCount / 3) * sizeof(triangleKey)) is 0);
+
+	Memory.Free(actual, Memory.GenericMemoryBlock);
+	Memory.Free(expected, Memory.GenericMemoryBlock);
+	Meshes.Dispose(mesh);
+
+	return true;
+}
+
+TEST(FetchOrderFollowsTriangles)
+{
+	Mesh mesh = CreateShuffledGrid(8);
+
+	// an attribute that identifies each vertex so it can be followed through the remap
+	mesh->NormalCount = mesh->VertexCount;
+	mesh->NormalVertices = Memory.Alloc(mesh->NormalCount * sizeof(vector3), Memory.GenericMemoryBlock);
+
+	for (ulong i = 0; i < mesh->VertexCount; i++)
+	{
+		mesh->NormalVertices[i] = mesh->Vertices[i];
+	}
+
+	// vertex 0 is only used by the first quad, unused vertices are dropped
+	const ulong vertexCount = mesh->VertexCount;
+
+	for (ulong i = 0; i < mesh->IndexCount; i++)
+	{
+		if (mesh->Indices[i] is 0)
+		{
+			mesh->Indices[i] = 1;
+		}
+	}
+
+	triangleKey* expected = GetSortedTriangles(mesh);
+
+	MeshOptimizers.OptimizeVertexFetch(mesh);
+
+	IsEqual(vertexCount - 1, mesh->VertexCount);
+	IsEqual(vertexCount - 1, mesh->NormalCount);
+
+	// every vertex is first used right after the one before it
+	uint next = 0;
+
+	for (ulong i = 0; i < mesh->IndexCount; i++)
+	{
+		IsTrue(mesh->Indices[i] <= next);
+
+		if (mesh->Indices[i] is next)
+		{
+			++next;
+		}
+
+		IsTrue(memcmp(&mesh->Vertices[mesh->Indices[i]], &mesh->NormalVertices[mesh->Indices[i]], sizeof(vector3)) is 0);
+	}
+
+	IsEqual((ulong)next, mesh->VertexCount);
+
+	triangleKey* actual = GetSortedTriangles(mesh);
+
+	IsTrue(memcmp(expected, actual, (mesh->IndexCount / 3) * sizeof(triangleKey)) is 0);
+
+	Memory.Free(actual, Memory.GenericMemoryBlock);
+	Memory.Free(expected, Memory.GenericMemoryBlock);
+	Meshes.Dispose(mesh);
+
+	return true;
+}
+
+TEST_SUITE(
+	RunUnitTests,
+	APPEND_TEST(ReducesCacheMissRatio)
+	APPEND_TEST(FetchOrderFollowsTriangles)
+);
@@ -0,0 +1,1147 @@
+#include "engine/modeling/meshSimplifier.h"
+#include "engine/modeling/meshOptimizer.h"
+#include "core/memory.h"
+#include "core/cunit.h"
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+#include <limits.h>
+#include <time.h>
+
+private ulong Simplify(const Mesh mesh, ulong targetIndexCount, float maxError, uint* destination, float* out_error);
+private void GenerateLevels(Mesh mesh);
+private void RunUnitTests(void);
+private void RunBenchmarks(void);
+
+const struct _meshSimplifierMethods MeshSimplifiers = {
+	.Simplify = &Simplify,
+	.GenerateLevels = &GenerateLevels,
+	.RunUnitTests = &RunUnitTests,
+	.RunBenchmarks = &RunBenchmarks
+};
+
+// Edges are collapsed in passes, each pass finds the cheapest way to collapse every edge onto one of its two vertices,
+// sorts them and collapses as many as it can while using every vertex in at most one collapse per pass.
+// Quadrics are only merged, never rebuilt from the simplified triangles, so the error of a collapse is always measured
+// against the planes of the original surface.
+
+// the planes along open borders count this many times more than the triangles beside them so borders keep their shape
+#define BORDER_WEIGHT 10.0f
+// a pass stops once the error of a collapse is this many times the error the pass needed to reach the target
+#define PASS_ERROR_BOUND 1.5f
+
+#define NO_VERTEX UINT_MAX
+
+typedef enum _vertexKind {
+	// every edge around the vertex is shared by two triangles, it can collapse onto any neighbor
+	VertexKindManifold,
+	// the vertex is on a single open border, it can only slide along that border
+	VertexKindBorder,
+	// the vertex is split between several uvs or normals, or the surface around it is too complex to move it safely
+	VertexKindLocked
+} VertexKind;
+
+typedef struct _quadric quadric;
+
+// the sum of the squared distances to a set of weighted planes, p'Ap + 2b'p + c, A is symmetric so only half is stored
+struct _quadric {
+	float A00, A11, A22;
+	float A10, A20, A21;
+	float B0, B1, B2;
+	float C;
+	float Weight;
+};
+
+typedef struct _collapse collapse;
+
+struct _collapse {
+	uint From;
+	uint To;
+	float Error;
+};
+
+typedef struct _simplifier simplifier;
+
+struct _simplifier {
+	const vector3* Positions;
+	ulong VertexCount;
+	// the first vertex with the same position as each vertex, vertices are classified and collapsed by position
+	uint* Canonical;
+	byte* Kinds;
+	// the neighbors of border vertices along their border, in the winding order of the triangles
+	uint* BorderNext;
+	uint* BorderPrevious;
+	quadric* Quadrics;
+	// the triangles around each canonical vertex are Adjacency[Offsets[v]] to Adjacency[Offsets[v + 1]]
+	uint* Offsets;
+	uint* Adjacency;
+};
+
+private vector3 Subtract(const vector3 left, const vector3 right)
+{
+	return (vector3) { left.x - right.x, left.y - right.y, left.z - right.z };
+}
+
+private vector3 Cross(const vector3 left, const vector3 right)
+{
+	return (vector3) {
+		(left.y * right.z) - (left.z * right.y),
+		(left.z * right.x) - (left.x * right.z),
+		(left.x * right.y) - (left.y * right.x)
+	};
+}
+
+private float Dot(const vector3 left, const vector3 right)
+{
+	return (left.x * right.x) + (left.y * right.y) + (left.z * right.z);
+}
+
+private quadric CreatePlaneQuadric(const vector3 normal, float distance, float weight)
+{
+	return (quadric) {
+		.A00 = weight * normal.x * normal.x,
+		.A11 = weight * normal.y * normal.y,
+		.A22 = weight * normal.z * normal.z,
+		.A10 = weight * normal.y * normal.x,
+		.A20 = weight * normal.z * normal.x,
+		.A21 = weight * normal.z * normal.y,
+		.B0 = weight * distance * normal.x,
+		.B1 = weight * distance * normal.y,
+		.B2 = weight * distance * normal.z,
+		.C = weight * distance * distance,
+		.Weight = weight
+	};
+}
+
+private void AddQuadric(quadric* destination, const quadric* source)
+{
+	destination->A00 += source->A00;
+	destination->A11 += source->A11;
+	destination->A22 += source->A22;
+	destination->A10 += source->A10;
+	destination->A20 += source->A20;
+	destination->A21 += source->A21;
+	destination->B0 += source->B0;
+	destination->B1 += source->B1;
+	destination->B2 += source->B2;
+	destination->C += source->C;
+	destination->Weight += source->Weight;
+}
+
+// the weighted mean of the squared distances from the point to the planes of the quadric
+private float GetQuadricError(const quadric* planes, const vector3 point)
+{
+	const float rx = (planes->A00 * point.x) + (planes->A10 * point.y) + (planes->A20 * point.z);
+	const float ry = (planes->A10 * point.x) + (planes->A11 * point.y) + (planes->A21 * point.z);
+	const float rz = (planes->A20 * point.x) + (planes->A21 * point.y) + (planes->A22 * point.z);
+
+	const float error = (rx * point.x) + (ry * point.y) + (rz * point.z)
+		+ (2.0f * ((planes->B0 * point.x) + (planes->B1 * point.y) + (planes->B2 * point.z)))
+		+ planes->C;
+
+	return planes->Weight is 0.0f ? 0.0f : fabsf(error) / planes->Weight;
+}
+
+typedef struct _positionKey positionKey;
+
+struct _positionKey {
+	vector3 Position;
+	uint Vertex;
+};
+
+private int ComparePositionKeys(const void* left, const void* right)
+{
+	const positionKey* a = left;
+	const positionKey* b = right;
+
+	const int order = memcmp(&a->Position, &b->Position, sizeof(vector3));
+
+	if (order isnt 0)
+	{
+		return order;
+	}
+
+	return a->Vertex < b->Vertex ? -1 : (a->Vertex > b->Vertex ? 1 : 0);
+}
+
+// points every vertex at the first vertex with the same position, positions that are shared by several vertices are locked
+private void FindCanonicalVertices(simplifier* state)
+{
+	const ulong count = state->VertexCount;
+
+	positionKey* keys = Memory.Alloc(count * sizeof(positionKey), Memory.GenericMemoryBlock);
+
+	for (ulong i = 0; i < count; i++)
+	{
+		keys[i] = (positionKey){ .Position = state->Positions[i], .Vertex = (uint)i };
+	}
+
+	qsort(keys, count, sizeof(positionKey), &ComparePositionKeys);
+
+	for (ulong start = 0; start < count;)
+	{
+		ulong end = start + 1;
+
+		while (end < count and memcmp(&keys[start].Position, &keys[end].Position, sizeof(vector3)) is 0)
+		{
+			++end;
+		}
+
+		for (ulong i = start; i < end; i++)
+		{
+			state->Canonical[keys[i].Vertex] = keys[start].Vertex;
+		}
+
+		state->Kinds[keys[start].Vertex] = end - start > 1 ? VertexKindLocked : VertexKindManifold;
+
+		start = end;
+	}
+
+	Memory.Free(keys, Memory.GenericMemoryBlock);
+}
+
+private uint GetCorner(const simplifier* state, const uint* indices, ulong triangle, ulong corner)
+{
+	return state->Canonical[indices[(triangle * 3) + (corner % 3)]];
+}
+
+private void BuildAdjacency(simplifier* state, const uint* indices, ulong indexCount)
+{
+	uint* offsets = state->Offsets;
+
+	memset(offsets, 0, (state->VertexCount + 1) * sizeof(uint));
+
+	for (ulong i = 0; i < indexCount; i++)
+	{
+		++offsets[state->Canonical[indices[i]] + 1];
+	}
+
+	for (ulong vertex = 0; vertex < state->VertexCount; vertex++)
+	{
+		offsets[vertex + 1] += offsets[vertex];
+	}
+
+	// fill each list by moving its start forward, then shift the starts back into place
+	for (ulong i = 0; i < indexCount; i++)
+	{
+		state->Adjacency[offsets[state->Canonical[indices[i]]]++] = (uint)(i / 3);
+	}
+
+	for (ulong vertex = state->VertexCount; vertex > 0; vertex--)
+	{
+		offsets[vertex] = offsets[vertex - 1];
+	}
+
+	offsets[0] = 0;
+}
+
+// the number of triangles with the edge from one vertex to the other in their winding order
+private ulong CountEdges(const simplifier* state, const uint* indices, uint from, uint to)
+{
+	ulong count = 0;
+
+	for (uint i = state->Offsets[from]; i < state->Offsets[from + 1]; i++)
+	{
+		const ulong triangle = state->Adjacency[i];
+
+		for (ulong corner = 0; corner < 3; corner++)
+		{
+			if (GetCorner(state, indices, triangle, corner) is from and GetCorner(state, indices, triangle, corner + 1) is to)
+			{
+				++count;
+			}
+		}
+	}
+
+	return count;
+}
+
+private VertexKind ClassifyVertex(simplifier* state, const uint* indices, uint vertex)
+{
+	ulong openEdgesOut = 0;
+	ulong openEdgesIn = 0;
+
+	for (uint i = state->Offsets[vertex]; i < state->Offsets[vertex + 1]; i++)
+	{
+		const ulong triangle = state->Adjacency[i];
+
+		ulong corner = 0;
+
+		while (GetCorner(state, indices, triangle, corner) isnt vertex)
+		{
+			++corner;
+		}
+
+		const uint next = GetCorner(state, indices, triangle, corner + 1);
+		const uint previous = GetCorner(state, indices, triangle, corner + 2);
+
+		// degenerate triangles and edges shared by more than two triangles
+		if (next is vertex or previous is vertex or next is previous or CountEdges(state, indices, vertex, next) isnt 1)
+		{
+			return VertexKindLocked;
+		}
+
+		const ulong reverse = CountEdges(state, indices, next, vertex);
+
+		if (reverse > 1)
+		{
+			return VertexKindLocked;
+		}
+
+		if (reverse is 0)
+		{
+			++openEdgesOut;
+			state->BorderNext[vertex] = next;
+		}
+
+		if (CountEdges(state, indices, vertex, previous) is 0)
+		{
+			++openEdgesIn;
+			state->BorderPrevious[vertex] = previous;
+		}
+	}
+
+	if (openEdgesOut is 0 and openEdgesIn is 0)
+	{
+		return VertexKindManifold;
+	}
+
+	// a single border passing through the vertex, several would meet at a vertex that can't be moved without tearing
+	return openEdgesOut is 1 and openEdgesIn is 1 ? VertexKindBorder : VertexKindLocked;
+}
+
+private void ClassifyVertices(simplifier* state, const uint* indices)
+{
+	for (ulong vertex = 0; vertex < state->VertexCount; vertex++)
+	{
+		state->BorderNext[vertex] = NO_VERTEX;
+		state->BorderPrevious[vertex] = NO_VERTEX;
+	}
+
+	for (uint vertex = 0; vertex < state->VertexCount; vertex++)
+	{
+		if (state->Canonical[vertex] is vertex and state->Kinds[vertex] isnt VertexKindLocked)
+		{
+			state->Kinds[vertex] = ClassifyVertex(state, indices, vertex);
+		}
+	}
+}
+
+private void AccumulateQuadrics(simplifier* state, const uint* indices, ulong indexCount)
+{
+	for (ulong triangle = 0; triangle < indexCount / 3; triangle++)
+	{
+		const uint a = GetCorner(state, indices, triangle, 0);
+		const uint b = GetCorner(state, indices, triangle, 1);
+		const uint c = GetCorner(state, indices, triangle, 2);
+
+		const vector3 normal = Cross(Subtract(state->Positions[b], state->Positions[a]), Subtract(state->Positions[c], state->Positions[a]));
+		const float length = sqrtf(Dot(normal, normal));
+
+		if (length is 0.0f)
+		{
+			continue;
+		}
+
+		const vector3 unit = { normal.x / length, normal.y / length, normal.z / length };
+
+		// weighted by area so small triangles don't pull the surface as much as large ones
+		const quadric plane = CreatePlaneQuadric(unit, -Dot(unit, state->Positions[a]), length * 0.5f);
+
+		AddQuadric(&state->Quadrics[a], &plane);
+		AddQuadric(&state->Quadrics[b], &plane);
+		AddQuadric(&state->Quadrics[c], &plane);
+	}
+
+	// a plane through every open edge that is perpendicular to its triangle keeps border vertices from moving inwards
+	for (uint vertex = 0; vertex < state->VertexCount; vertex++)
+	{
+		if (state->Canonical[vertex] isnt vertex or state->Kinds[vertex] isnt VertexKindBorder)
+		{
+			continue;
+		}
+
+		const uint next = state->BorderNext[vertex];
+
+		for (uint i = state->Offsets[vertex]; i < state->Offsets[vertex + 1]; i++)
+		{
+			const ulong triangle = state->Adjacency[i];
+
+			for (ulong corner = 0; corner < 3; corner++)
+			{
+				if (GetCorner(state, indices, triangle, corner) isnt vertex or GetCorner(state, indices, triangle, corner + 1) isnt next)
+				{
+					continue;
+				}
+
+				const vector3 opposite = state->Positions[GetCorner(state, indices, triangle, corner + 2)];
+				const vector3 edge = Subtract(state->Positions[next], state->Positions[vertex]);
+				const vector3 faceNormal = Cross(edge, Subtract(opposite, state->Positions[vertex]));
+				const vector3 normal = Cross(edge, faceNormal);
+				const float length = sqrtf(Dot(normal, normal));
+
+				if (length is 0.0f)
+				{
+					continue;
+				}
+
+				const vector3 unit = { normal.x / length, normal.y / length, normal.z / length };
+
+				const quadric plane = CreatePlaneQuadric(unit, -Dot(unit, state->Positions[vertex]), Dot(edge, edge) * BORDER_WEIGHT);
+
+				AddQuadric(&state->Quadrics[vertex], &plane);
+				AddQuadric(&state->Quadrics[next], &plane);
+			}
+		}
+	}
+}
+
+private bool CanCollapse(const simplifier* state, uint from, uint to)
+{
+	switch (state->Kinds[from])
+	{
+	case VertexKindManifold:
+		return true;
+	case VertexKindBorder:
+		return to is state->BorderNext[from] or to is state->BorderPrevious[from];
+	default:
+		return false;
+	}
+}
+
+private float GetCollapseError(const simplifier* state, uint from, uint to)
+{
+	quadric merged = state->Quadrics[from];
+
+	AddQuadric(&merged, &state->Quadrics[to]);
+
+	return GetQuadricError(&merged, state->Positions[to]);
+}
+
+// whether the edge from one vertex to the other only belongs to a single triangle, edges between locked vertices are
+// never collapsed so they don't need to be told apart
+private bool IsOpenEdge(const simplifier* state, uint from, uint to)
+{
+	return (state->Kinds[from] is VertexKindBorder and state->BorderNext[from] is to)
+		or (state->Kinds[to] is VertexKindBorder and state->BorderPrevious[to] is from);
+}
+
+// finds the cheapest direction to collapse every edge
+private ulong FindCollapses(const simplifier* state, const uint* indices, ulong indexCount, collapse* out_collapses)
+{
+	ulong count = 0;
+
+	for (ulong triangle = 0; triangle < indexCount / 3; triangle++)
+	{
+		for (ulong corner = 0; corner < 3; corner++)
+		{
+			const uint a = GetCorner(state, indices, triangle, corner);
+			const uint b = GetCorner(state, indices, triangle, corner + 1);
+
+			// edges shared by two triangles are found from both sides, only keep one of them
+			if (a > b and IsOpenEdge(state, a, b) is false)
+			{
+				continue;
+			}
+
+			// collapsing vertices are never split so the canonical vertex is the only vertex with its position
+			const float forward = CanCollapse(state, a, b) ? GetCollapseError(state, a, b) : FLT_MAX;
+			const float backward = CanCollapse(state, b, a) ? GetCollapseError(state, b, a) : FLT_MAX;
+
+			if (forward is FLT_MAX and backward is FLT_MAX)
+			{
+				continue;
+			}
+
+			// the vertex that is kept keeps whichever of its split vertices this triangle used
+			const uint keptA = indices[(triangle * 3) + corner];
+			const uint keptB = indices[(triangle * 3) + ((corner + 1) % 3)];
+
+			out_collapses[count++] = forward <= backward ?
+				(collapse) { .From = a, .To = keptB, .Error = forward } :
+				(collapse) { .From = b, .To = keptA, .Error = backward };
+		}
+	}
+
+	return count;
+}
+
+private int CompareCollapses(const void* left, const void* right)
+{
+	const collapse* a = left;
+	const collapse* b = right;
+
+	if (a->Error isnt b->Error)
+	{
+		return a->Error < b->Error ? -1 : 1;
+	}
+
+	// ties are broken by the vertices so the result doesn't depend on how qsort orders equal elements
+	if (a->From isnt b->From)
+	{
+		return a->From < b->From ? -1 : 1;
+	}
+
+	return a->To < b->To ? -1 : (a->To > b->To ? 1 : 0);
+}
+
+// the canonical vertex at the corner of the triangle after the collapses of the current pass
+private uint GetCollapsedCorner(const simplifier* state, const uint* indices, const uint* remap, ulong triangle, ulong corner)
+{
+	return state->Canonical[remap[indices[(triangle * 3) + (corner % 3)]]];
+}
+
+// whether moving the vertex onto the other would turn any of the triangles that remain around it over
+private bool FlipsTriangles(const simplifier* state, const uint* indices, const uint* remap, uint from, uint to)
+{
+	const vector3 origin = state->Positions[from];
+	const vector3 target = state->Positions[to];
+
+	for (uint i = state->Offsets[from]; i < state->Offsets[from + 1]; i++)
+	{
+		const ulong triangle = state->Adjacency[i];
+
+		ulong corner = 0;
+
+		while (GetCollapsedCorner(state, indices, remap, triangle, corner) isnt from)
+		{
+			++corner;
+		}
+
+		const uint next = GetCollapsedCorner(state, indices, remap, triangle, corner + 1);
+		const uint previous = GetCollapsedCorner(state, indices, remap, triangle, corner + 2);
+
+		// the triangles on the collapsed edge disappear, as did any that an earlier collapse of the pass removed
+		if (next is to or previous is to or next is previous)
+		{
+			continue;
+		}
+
+		const vector3 nextPosition = state->Positions[next];
+		const vector3 previousPosition = state->Positions[previous];
+
+		const vector3 before = Cross(Subtract(nextPosition, origin), Subtract(previousPosition, origin));
+		const vector3 after = Cross(Subtract(nextPosition, target), Subtract(previousPosition, target));
+
+		if (Dot(before, after) <= 0.0f)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// keeps the border links of the vertex the border vertex collapsed onto pointing past it
+private void MergeBorder(simplifier* state, uint from, uint to)
+{
+	if (state->Kinds[from] isnt VertexKindBorder)
+	{
+		return;
+	}
+
+	if (to is state->BorderNext[from])
+	{
+		const uint previous = state->BorderPrevious[from];
+
+		state->BorderPrevious[to] = previous;
+		state->BorderNext[previous] = to;
+	}
+	else
+	{
+		const uint next = state->BorderNext[from];
+
+		state->BorderNext[to] = next;
+		state->BorderPrevious[next] = to;
+	}
+}
+
+// rewrites the triangles through the remap and removes the ones that collapsed, returns the new number of indices
+private ulong RemapTriangles(const simplifier* state, uint* indices, ulong indexCount, const uint* remap)
+{
+	ulong written = 0;
+
+	for (ulong i = 0; i < indexCount; i += 3)
+	{
+		const uint a = remap[indices[i + 0]];
+		const uint b = remap[indices[i + 1]];
+		const uint c = remap[indices[i + 2]];
+
+		const uint canonicalA = state->Canonical[a];
+		const uint canonicalB = state->Canonical[b];
+		const uint canonicalC = state->Canonical[c];
+
+		if (canonicalA is canonicalB or canonicalB is canonicalC or canonicalA is canonicalC)
+		{
+			continue;
+		}
+
+		indices[written + 0] = a;
+		indices[written + 1] = b;
+		indices[written + 2] = c;
+
+		written += 3;
+	}
+
+	return written;
+}
+
+private ulong Simplify(const Mesh mesh, ulong targetIndexCount, float maxError, uint* destination, float* out_error)
+{
+	*out_error = 0.0f;
+
+	if (mesh->Indices is null or mesh->IndexCount < 3 or (mesh->IndexCount % 3) isnt 0 or mesh->VertexCount >= NO_VERTEX)
+	{
+		return 0;
+	}
+
+	const ulong vertexCount = mesh->VertexCount;
+
+	ulong indexCount = mesh->IndexCount;
+
+	memcpy(destination, mesh->Indices, indexCount * sizeof(uint));
+
+	simplifier state = {
+		.Positions = mesh->Vertices,
+		.VertexCount = vertexCount,
+		.Canonical = Memory.Alloc(vertexCount * sizeof(uint), Memory.GenericMemoryBlock),
+		.Kinds = Memory.Alloc(vertexCount * sizeof(byte), Memory.GenericMemoryBlock),
+		.BorderNext = Memory.Alloc(vertexCount * sizeof(uint), Memory.GenericMemoryBlock),
+		.BorderPrevious = Memory.Alloc(vertexCount * sizeof(uint), Memory.GenericMemoryBlock),
+		.Quadrics = Memory.Alloc(vertexCount * sizeof(quadric), Memory.GenericMemoryBlock),
+		.Offsets = Memory.Alloc((vertexCount + 1) * sizeof(uint), Memory.GenericMemoryBlock),
+		.Adjacency = Memory.Alloc(indexCount * sizeof(uint), Memory.GenericMemoryBlock)
+	};
+
+	FindCanonicalVertices(&state);
+	BuildAdjacency(&state, destination, indexCount);
+	ClassifyVertices(&state, destination);
+	AccumulateQuadrics(&state, destination, indexCount);
+
+	collapse* collapses = Memory.Alloc(indexCount * sizeof(collapse), Memory.GenericMemoryBlock);
+	uint* remap = Memory.Alloc(vertexCount * sizeof(uint), Memory.GenericMemoryBlock);
+	bool* locked = Memory.Alloc(vertexCount * sizeof(bool), Memory.GenericMemoryBlock);
+
+	for (ulong vertex = 0; vertex < vertexCount; vertex++)
+	{
+		remap[vertex] = (uint)vertex;
+	}
+
+	// errors are compared squared
+	const float errorLimit = maxError >= sqrtf(FLT_MAX) ? FLT_MAX : maxError * maxError;
+	const ulong targetTriangles = targetIndexCount / 3;
+
+	float resultError = 0.0f;
+
+	while (indexCount > targetIndexCount)
+	{
+		const ulong collapseCount = FindCollapses(&state, destination, indexCount, collapses);
+
+		if (collapseCount is 0)
+		{
+			break;
+		}
+
+		qsort(collapses, collapseCount, sizeof(collapse), &CompareCollapses);
+
+		ulong triangles = indexCount / 3;
+
+		// most collapses remove two triangles, this is about where the target would be reached
+		const ulong goal = min((triangles - targetTriangles) / 2, collapseCount - 1);
+		const float passLimit = collapses[goal].Error * PASS_ERROR_BOUND;
+
+		memset(locked, 0, vertexCount * sizeof(bool));
+
+		ulong collapsed = 0;
+
+		for (ulong i = 0; i < collapseCount and triangles > targetTriangles; i++)
+		{
+			const collapse edge = collapses[i];
+
+			// a pass that couldn't collapse anything cheap enough still collapses the next cheapest edge it can
+			if (edge.Error > errorLimit or (edge.Error > passLimit and collapsed isnt 0))
+			{
+				break;
+			}
+
+			const uint from = edge.From;
+			const uint to = state.Canonical[edge.To];
+
+			// the quadrics of both vertices have to be the ones the error was measured with
+			if (locked[from] or locked[to] or FlipsTriangles(&state, destination, remap, from, to))
+			{
+				continue;
+			}
+
+			locked[from] = true;
+			locked[to] = true;
+
+			remap[from] = edge.To;
+
+			AddQuadric(&state.Quadrics[to], &state.Quadrics[from]);
+
+			MergeBorder(&state, from, to);
+
+			triangles -= state.Kinds[from] is VertexKindBorder ? 1 : 2;
+
+			resultError = max(resultError, edge.Error);
+
+			++collapsed;
+		}
+
+		if (collapsed is 0)
+		{
+			break;
+		}
+
+		indexCount = RemapTriangles(&state, destination, indexCount, remap);
+
+		BuildAdjacency(&state, destination, indexCount);
+	}
+
+	Memory.Free(locked, Memory.GenericMemoryBlock);
+	Memory.Free(remap, Memory.GenericMemoryBlock);
+	Memory.Free(collapses, Memory.GenericMemoryBlock);
+	Memory.Free(state.Canonical, Memory.GenericMemoryBlock);
+	Memory.Free(state.Kinds, Memory.GenericMemoryBlock);
+	Memory.Free(state.BorderNext, Memory.GenericMemoryBlock);
+	Memory.Free(state.BorderPrevious, Memory.GenericMemoryBlock);
+	Memory.Free(state.Quadrics, Memory.GenericMemoryBlock);
+	Memory.Free(state.Offsets, Memory.GenericMemoryBlock);
+	Memory.Free(state.Adjacency, Memory.GenericMemoryBlock);
+
+	*out_error = sqrtf(resultError);
+
+	return indexCount;
+}
+
+private void ClearLevels(Mesh mesh)
+{
+	for (ulong i = 0; i < mesh->LevelCount; i++)
+	{
+		Memory.Free(mesh->Levels[i].Indices, Memory.GenericMemoryBlock);
+
+		mesh->Levels[i] = (meshLevel){ 0 };
+	}
+
+	mesh->LevelCount = 0;
+}
+
+// half the diagonal of the bounds of the mesh
+private float GetRadius(const Mesh mesh)
+{
+	vector3 lower = mesh->Vertices[0];
+	vector3 upper = mesh->Vertices[0];
+
+	for (ulong i = 1; i < mesh->VertexCount; i++)
+	{
+		const vector3 position = mesh->Vertices[i];
+
+		lower = (vector3){ min(lower.x, position.x), min(lower.y, position.y), min(lower.z, position.z) };
+		upper = (vector3){ max(upper.x, position.x), max(upper.y, position.y), max(upper.z, position.z) };
+	}
+
+	const vector3 size = Subtract(upper, lower);
+
+	return sqrtf(Dot(size, size)) * 0.5f;
+}
+
+private void OptimizeLevel(const Mesh mesh, meshLevel* level)
+{
+	// the optimizer works on whole meshes, give it a copy of the mesh that draws the level instead
+	struct _mesh view = *mesh;
+
+	view.IndexCount = level->IndexCount;
+	view.Indices = level->Indices;
+
+	MeshOptimizers.OptimizeVertexCache(&view, DEFAULT_VERTEX_CACHE_SIZE);
+
+	level->Indices = view.Indices;
+}
+
+private void GenerateLevels(Mesh mesh)
+{
+	ClearLevels(mesh);
+
+	if (mesh->Indices is null or mesh->IndexCount < MIN_LEVEL_OF_DETAIL_TRIANGLES * 3)
+	{
+		return;
+	}
+
+	const float maxError = GetRadius(mesh) * MAX_LEVEL_OF_DETAIL_ERROR;
+
+	uint* indices = Memory.Alloc(mesh->IndexCount * sizeof(uint), Memory.GenericMemoryBlock);
+
+	ulong previousCount = mesh->IndexCount;
+	float previousError = 0.0f;
+
+	while (mesh->LevelCount < MAX_MESH_LEVELS and previousCount >= MIN_LEVEL_OF_DETAIL_TRIANGLES * 3)
+	{
+		const ulong target = ((ulong)(previousCount * LEVEL_OF_DETAIL_REDUCTION) / 3) * 3;
+
+		// every level starts from the full detail mesh so its error is measured against the original surface
+		float error;
+		const ulong count = Simplify(mesh, target, maxError, indices, &error);
+
+		if (count is 0 or count > previousCount * MIN_LEVEL_OF_DETAIL_REDUCTION)
+		{
+			break;
+		}
+
+		meshLevel* level = &mesh->Levels[mesh->LevelCount++];
+
+		level->IndexCount = count;
+		level->Indices = Memory.DuplicateAddress(indices, count * sizeof(uint), count * sizeof(uint), Memory.GenericMemoryBlock);
+		// coarser levels never claim to be more accurate than finer ones so they are picked in order
+		level->Error = max(error, previousError);
+
+		OptimizeLevel(mesh, level);
+
+		previousCount = count;
+		previousError = level->Error;
+	}
+
+	Memory.Free(indices, Memory.GenericMemoryBlock);
+}
+
+// a unit sphere without seams, both poles are single vertices
+private Mesh CreateSphere(ulong segments, ulong rings)
+{
+	Mesh mesh = Meshes.Create();
+
+	mesh->VertexCount = ((rings - 1) * segments) + 2;
+	mesh->Vertices = Memory.Alloc(mesh->VertexCount * sizeof(vector3), Memory.GenericMemoryBlock);
+
+	const float pi = 3.14159265358979f;
+
+	mesh->Vertices[0] = (vector3){ 0, 1, 0 };
+	mesh->Vertices[mesh->VertexCount - 1] = (vector3){ 0, -1, 0 };
+
+	for (ulong ring = 1; ring < rings; ring++)
+	{
+		const float polar = pi * (float)ring / (float)rings;
+
+		for (ulong segment = 0; segment < segments; segment++)
+		{
+			const float azimuth = 2.0f * pi * (float)segment / (float)segments;
+
+			mesh->Vertices[1 + ((ring - 1) * segments) + segment] = (vector3){
+				sinf(polar) * cosf(azimuth),
+				cosf(polar),
+				-sinf(polar) * sinf(azimuth)
+			};
+		}
+	}
+
+	mesh->IndexCount = segments * (rings - 1) * 6;
+	mesh->Indices = Memory.Alloc(mesh->IndexCount * sizeof(uint), Memory.GenericMemoryBlock);
+
+	const uint south = (uint)(mesh->VertexCount - 1);
+
+	ulong written = 0;
+
+	for (ulong segment = 0; segment < segments; segment++)
+	{
+		const uint current = (uint)segment;
+		const uint next = (uint)((segment + 1) % segments);
+
+		// the caps fan around the poles
+		const uint top[3] = { 0, 1 + current, 1 + next };
+		const uint bottom[3] = { south, 1 + (uint)((rings - 2) * segments) + next, 1 + (uint)((rings - 2) * segments) + current };
+
+		memcpy(mesh->Indices + written, top, sizeof(top));
+		memcpy(mesh->Indices + written + 3, bottom, sizeof(bottom));
+
+		written += 6;
+
+		for (ulong ring = 1; ring < rings - 1; ring++)
+		{
+			const uint upper = 1 + (uint)((ring - 1) * segments);
+			const uint lower = upper + (uint)segments;
+
+			const uint quad[6] = { upper + current, lower + current, lower + next, upper + current, lower + next, upper + next };
+
+			memcpy(mesh->Indices + written, quad, sizeof(quad));
+
+			written += 6;
+		}
+	}
+
+	return mesh;
+}
+
+// a flat size by size grid facing +z, when seam is true the vertices of the middle column are split in two like a uv seam
+private Mesh CreateGrid(ulong size, bool seam)
+{
+	Mesh mesh = Meshes.Create();
+
+	const ulong columns = size + 1;
+	const ulong middle = size / 2;
+
+	mesh->VertexCount = (columns * columns) + (seam ? columns : 0);
+	mesh->Vertices = Memory.Alloc(mesh->VertexCount * sizeof(vector3), Memory.GenericMemoryBlock);
+
+	for (ulong y = 0; y < columns; y++)
+	{
+		for (ulong x = 0; x < columns; x++)
+		{
+			mesh->Vertices[(y * columns) + x] = (vector3){ (float)x, (float)y, 0 };
+		}
+
+		if (seam)
+		{
+			mesh->Vertices[(columns * columns) + y] = (vector3){ (float)middle, (float)y, 0 };
+		}
+	}
+
+	mesh->IndexCount = size * size * 6;
+	mesh->Indices = Memory.Alloc(mesh->IndexCount * sizeof(uint), Memory.GenericMemoryBlock);
+
+	for (ulong y = 0; y < size; y++)
+	{
+		for (ulong x = 0; x < size; x++)
+		{
+			uint corners[4] = {
+				(uint)((y * columns) + x),
+				(uint)((y * columns) + x + 1),
+				(uint)(((y + 1) * columns) + x + 1),
+				(uint)(((y + 1) * columns) + x)
+			};
+
+			// the quads right of the seam use the split copies of the middle column
+			if (seam and x is middle)
+			{
+				corners[0] = (uint)((columns * columns) + y);
+				corners[3] = (uint)((columns * columns) + y + 1);
+			}
+
+			const uint quad[6] = { corners[0], corners[1], corners[2], corners[0], corners[2], corners[3] };
+
+			memcpy(mesh->Indices + (((y * size) + x) * 6), quad, sizeof(quad));
+		}
+	}
+
+	return mesh;
+}
+
+private vector3 GetTriangleNormal(const Mesh mesh, const uint* triangle)
+{
+	const vector3 a = mesh->Vertices[triangle[0]];
+
+	return Cross(Subtract(mesh->Vertices[triangle[1]], a), Subtract(mesh->Vertices[triangle[2]], a));
+}
+
+// the furthest the center of any triangle is from the surface of the unit sphere
+private float GetSphereDeviation(const Mesh mesh, const uint* indices, ulong indexCount)
+{
+	float deviation = 0.0f;
+
+	for (ulong i = 0; i < indexCount; i += 3)
+	{
+		const vector3 a = mesh->Vertices[indices[i + 0]];
+		const vector3 b = mesh->Vertices[indices[i + 1]];
+		const vector3 c = mesh->Vertices[indices[i + 2]];
+
+		const vector3 center = { (a.x + b.x + c.x) / 3.0f, (a.y + b.y + c.y) / 3.0f, (a.z + b.z + c.z) / 3.0f };
+
+		deviation = max(deviation, 1.0f - sqrtf(Dot(center, center)));
+	}
+
+	return deviation;
+}
+
+TEST(SimplifiesSphere)
+{
+	Mesh mesh = CreateSphere(64, 32);
+
+	uint* indices = Memory.Alloc(mesh->IndexCount * sizeof(uint), Memory.GenericMemoryBlock);
+
+	const ulong target = ((mesh->IndexCount / 4) / 3) * 3;
+
+	float error;
+	const ulong count = MeshSimplifiers.Simplify(mesh, target, FLT_MAX, indices, &error);
+
+	fprintf(__test_stream, "\t%llu triangles to %llu, error %f deviation %f"NEWLINE,
+		mesh->IndexCount / 3, count / 3, error, GetSphereDeviation(mesh, indices, count));
+
+	IsTrue(count <= target);
+	IsTrue(count >= target - 12);
+	IsTrue(error > 0.0f);
+	IsTrue(error < 0.05f);
+	IsTrue(GetSphereDeviation(mesh, indices, count) < 0.05f);
+
+	// every triangle still faces outwards
+	for (ulong i = 0; i < count; i += 3)
+	{
+		IsTrue(Dot(GetTriangleNormal(mesh, indices + i), mesh->Vertices[indices[i]]) > 0.0f);
+	}
+
+	// the full detail mesh is never modified
+	IsEqual(64ull * 31 * 6, mesh->IndexCount);
+
+	Memory.Free(indices, Memory.GenericMemoryBlock);
+	Meshes.Dispose(mesh);
+
+	return true;
+}
+
+private void PreservesFlatGrid(FILE* __test_stream, bool seam)
+{
+	Mesh mesh = CreateGrid(16, seam);
+
+	uint* indices = Memory.Alloc(mesh->IndexCount * sizeof(uint), Memory.GenericMemoryBlock);
+
+	float error;
+	const ulong count = MeshSimplifiers.Simplify(mesh, 0, 1e-3f, indices, &error);
+
+	IsTrue(count < mesh->IndexCount / 8);
+	IsEqual(0.0f, error);
+
+	// any collapse that moved the border or overlapped triangles would change the area
+	float area = 0.0f;
+
+	for (ulong i = 0; i < count; i += 3)
+	{
+		const vector3 normal = GetTriangleNormal(mesh, indices + i);
+
+		IsTrue(normal.z > 0.0f);
+
+		area += normal.z * 0.5f;
+	}
+
+	IsEqual(256.0f, area);
+
+	// split vertices never move, both sides of the seam still meet at every one of them
+	if (seam)
+	{
+		for (ulong y = 0; y <= 16; y++)
+		{
+			const uint left = (uint)((y * 17) + 8);
+			const uint right = (uint)((17 * 17) + y);
+
+			bool leftUsed = false;
+			bool rightUsed = false;
+
+			for (ulong i = 0; i < count; i++)
+			{
+				leftUsed |= indices[i] is left;
+				rightUsed |= indices[i] is right;
+			}
+
+			IsTrue(leftUsed and rightUsed);
+		}
+	}
+
+	Memory.Free(indices, Memory.GenericMemoryBlock);
+	Meshes.Dispose(mesh);
+}
+
+TEST(PreservesBorders)
+{
+	PreservesFlatGrid(__test_stream, false);
+
+	return true;
+}
+
+TEST(PreservesSeams)
+{
+	PreservesFlatGrid(__test_stream, true);
+
+	return true;
+}
+
+TEST(GeneratesLevelChain)
+{
+	Mesh mesh = CreateSphere(64, 32);
+
+	MeshSimplifiers.GenerateLevels(mesh);
+
+	IsTrue(mesh->LevelCount >= 3);
+
+	ulong previousCount = mesh->IndexCount;
+	float previousError = 0.0f;
+
+	for (ulong i = 0; i < mesh->LevelCount; i++)
+	{
+		const meshLevel level = mesh->Levels[i];
+
+		fprintf(__test_stream, "\tlevel %llu: %llu triangles error %f"NEWLINE, i + 1, level.IndexCount / 3, level.Error);
+
+		IsTrue(level.IndexCount <= previousCount * MIN_LEVEL_OF_DETAIL_REDUCTION);
+		IsTrue(level.Error >= previousError);
+		IsTrue(level.Error <= MAX_LEVEL_OF_DETAIL_ERROR);
+
+		for (ulong index = 0; index < level.IndexCount; index++)
+		{
+			IsTrue(level.Indices[index] < mesh->VertexCount);
+		}
+
+		previousCount = level.IndexCount;
+		previousError = level.Error;
+	}
+
+	// generating again replaces the chain instead of adding to it
+	const ulong levelCount = mesh->LevelCount;
+
+	MeshSimplifiers.GenerateLevels(mesh);
+
+	IsEqual(levelCount, mesh->LevelCount);
+
+	Meshes.Dispose(mesh);
+
+	return true;
+}
+
+TEST_SUITE(
+	RunUnitTests,
+	APPEND_TEST(SimplifiesSphere)
+	APPEND_TEST(PreservesBorders)
+	APPEND_TEST(PreservesSeams)
+	APPEND_TEST(GeneratesLevelChain)
+);
+
+TEST(Benchmark)
+{
+	Mesh mesh = CreateSphere(512, 256);
+
+	uint* indices = Memory.Alloc(mesh->IndexCount * sizeof(uint), Memory.GenericMemoryBlock);
+
+	const ulong triangles = mesh->IndexCount / 3;
+	const float fractions[] = { 0.5f, 0.1f, 0.01f };
+
+	for (ulong i = 0; i < sizeof(fractions) / sizeof(float); i++)
+	{
+		const ulong target = ((ulong)(mesh->IndexCount * fractions[i]) / 3) * 3;
+
+		float error;
+
+		clock_t start = clock();
+		const ulong count = Simplify(mesh, target, FLT_MAX, indices, &error);
+		const double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		fprintf(__test_stream, "\t%llu triangles to %7llu in %7.1lf ms (%6.2lf M triangles/s) error %f deviation %f"NEWLINE,
+			triangles,
+			count / 3,
+			seconds * 1000.0,
+			(double)triangles / max(seconds, 1e-6) / 1e6,
+			error,
+			GetSphereDeviation(mesh, indices, count));
+	}
+
+	clock_t start = clock();
+	GenerateLevels(mesh);
+	const double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	fprintf(__test_stream, "\t%llu levels generated in %.1lf ms"NEWLINE, mesh->LevelCount, seconds * 1000.0);
+
+	Memory.Free(indices, Memory.GenericMemoryBlock);
+	Meshes.Dispose(mesh);
+
+	return true;
+}
+
+TEST_SUITE(
+	RunBenchmarks,
+	APPEND_TEST(Benchmark)
+);
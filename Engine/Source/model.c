@@ -3,10 +3,12 @@
 
 static Model CreateModel(void);
 static void DisposeModel(Model model);
+static Model InstanceModel(Model model);
 
 const struct _modelMethods Models = {
 	.Create = &CreateModel,
-	.Dispose = &DisposeModel
+	.Dispose = &DisposeModel,
+	.Instance = &InstanceModel
 };
 
 DEFINE_TYPE_ID(ModelMeshes);
@@ -14,20 +16,29 @@ DEFINE_TYPE_ID(Model);
 
 static void DisposeModel(Model model)
 {
-	if (model isnt null)
+	if (model is null)
 	{
-		for (ulong i = 0; i < model->Count; i++)
-		{
-			Mesh tmp = model->Meshes[i];
+		return;
+	}
 
-			Meshes.Dispose(tmp);
-		}
+	// other owners are still using the model
+	if (model->ActiveInstances > 1)
+	{
+		--(model->ActiveInstances);
+		return;
+	}
 
-		Memory.Free(model->Meshes, ModelMeshesTypeId);
+	for (ulong i = 0; i < model->Count; i++)
+	{
+		Mesh tmp = model->Meshes[i];
 
-		Memory.Free(model->Name, Memory.String);
+		Meshes.Dispose(tmp);
 	}
 
+	Memory.Free(model->Meshes, ModelMeshesTypeId);
+
+	Memory.Free(model->Name, Memory.String);
+
 	Memory.Free(model, ModelTypeId);
 }
 
@@ -36,5 +47,19 @@ static Model CreateModel()
 	Memory.RegisterTypeName(nameof(Model), &ModelTypeId);
 	Memory.RegisterTypeName("ModelMeshes", &ModelMeshesTypeId);
 
-	return Memory.Alloc(sizeof(struct _model), ModelTypeId);
+	Model model = Memory.Alloc(sizeof(struct _model), ModelTypeId);
+
+	model->ActiveInstances = 1;
+
+	return model;
+}
+
+static Model InstanceModel(Model model)
+{
+	if (model isnt null)
+	{
+		++(model->ActiveInstances);
+	}
+
+	return model;
 }
@@ -755,8 +755,8 @@ private void AssignReferenceOrganism(Species species)
 // were removed
 private ulong RemovePoorFitnessOrganisms(Population population, Species species)
 {
-	// sort by fitness
-	arrays(Organism).InsertionSort(species->Organisms, OrganismFitnessComparator);
+	// sort by fitness, stable so the earliest of the organisms with equal fitness survive culling
+	arrays(Organism).StableSort(species->Organisms, OrganismFitnessComparator);
 
 	// determine how many to remove
 	const ulong count = (ulong)((ai_number)species->Organisms->Count * population->OrganismCullingRate);
@@ -1251,6 +1251,14 @@ array(ai_number_array) GetXORTestData()
 	result->Values[4]->Values[2] = true;
 	result->Values[4]->Values[3] = true;
 
+	// the values were written directly so the counts need to be set to match
+	result->Count = 5;
+
+	for (ulong i = 0; i < result->Count; i++)
+	{
+		result->Values[i]->Count = result->Values[i]->Capacity;
+	}
+
 	return result;
 }
 
@@ -1265,6 +1273,11 @@ TEST(XOR_Works)
 {
 	Random.Seed = 42;
 
+	// track how many allocations the run costs, most of the arrays here are tiny
+	// so this is the number to watch when changing array storage
+	const ulong previousAllocCount = Memory.AllocCount();
+	const ulong start = clock();
+
 	// XOR (opposite) problem
 	// ^ 
 	// false ^ false = false
@@ -1306,12 +1319,53 @@ TEST(XOR_Works)
 	Neat.Dispose(ai);
 	arrays(ai_number_array).Dispose(inputDataArrays);
 
+	fprintf(__test_stream, "\t[XOR] %lli allocations in %lli ticks"NEWLINE, Memory.AllocCount() - previousAllocCount, clock() - start);
+
 	Memory.PrintAlloc(stdout);
 	Memory.PrintFree(stdout);
 
 	return true;
 }
 
+TEST(CullingKeepsEarliestOfEqualFitness)
+{
+	Random.Seed = 42;
+
+	Population population = CreatePopulation(40, 2, 1);
+
+	Species species = CreateSpecies(population, 40);
+
+	arrays(Species).Append(population->Species, species);
+
+	// only four distinct fitnesses so most organisms tie with another
+	for (ulong i = 0; i < 40; i++)
+	{
+		Organism organism = CreateOrganism(population->InputNodeCount, population->OutputNodeCount);
+
+		organism->Id = i;
+		organism->Fitness = (ai_number)(i % 4);
+		organism->Parent = species;
+
+		arrays(Organism).Append(species->Organisms, organism);
+	}
+
+	IsEqual(20ull, RemovePoorFitnessOrganisms(population, species));
+
+	IsEqual(20ull, species->Organisms->Count);
+
+	// fittest first, organisms with equal fitness stay in the order they were created
+	for (ulong i = 0; i < species->Organisms->Count; i++)
+	{
+		const ulong expectedId = i < 10 ? (i * 4) + 3 : ((i - 10) * 4) + 2;
+
+		IsEqual(expectedId, species->Organisms->Values[i]->Id);
+	}
+
+	DisposePopulation(population);
+
+	return true;
+}
+
 TEST_SUITE(
 	RunUnitTests,
 	APPEND_TEST(ArrayWorks)
@@ -1321,4 +1375,5 @@ TEST_SUITE(
 	APPEND_TEST(GetAverageDifferenceBetweenWeights)
 	APPEND_TEST(GetSimilarity)
 	APPEND_TEST(BreedOrganisms)
+	APPEND_TEST(CullingKeepsEarliestOfEqualFitness)
 )
\ No newline at end of file
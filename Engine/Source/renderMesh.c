@@ -3,21 +3,27 @@
 #include "GL/glew.h"
 #include "core/macros.h"
 #include "core/strings.h"
+#include "core/math/quantization.h"
+#include <string.h>
 
 private RenderMesh InstanceMesh(RenderMesh mesh);
 private void Draw(RenderMesh model);
 private void Dispose(RenderMesh mesh);
 private bool TryBindMesh(const Mesh mesh, RenderMesh* out_model);
+private bool TryBindQuantizedMesh(const Mesh mesh, RenderMesh* out_model);
 private RenderMesh Duplicate(RenderMesh mesh);
 private RenderMesh CreateRenderMesh(void);
 private bool TryBindModel(Model model, RenderMesh** out_meshArray);
+private void DisposeModelMeshes(RenderMesh* meshArray, ulong count);
 private void Save(File, RenderMesh mesh);
 
 const struct _renderMeshMethods RenderMeshes = {
 	.Dispose = &Dispose,
 	.Draw = &Draw,
 	.TryBindMesh = &TryBindMesh,
+	.TryBindQuantizedMesh = &TryBindQuantizedMesh,
 	.TryBindModel = &TryBindModel,
+	.DisposeModelMeshes = &DisposeModelMeshes,
 	.Instance = &InstanceMesh,
 	.Duplicate = &Duplicate,
 	.Create = &CreateRenderMesh,
@@ -55,13 +61,29 @@ private void Dispose(RenderMesh mesh)
 	SharedHandles.Dispose(mesh->VertexBuffer, mesh->VertexBuffer, &OnBufferDispose);
 	SharedHandles.Dispose(mesh->UVBuffer, mesh->UVBuffer, &OnBufferDispose);
 	SharedHandles.Dispose(mesh->NormalBuffer, mesh->NormalBuffer, &OnBufferDispose);
+	SharedHandles.Dispose(mesh->IndexBuffer, mesh->IndexBuffer, &OnBufferDispose);
 
 	Transforms.Dispose(mesh->Transform);
 
-	Memory.Free(mesh, RenderMeshTypeId);
+	Memory.PoolFree(mesh, RenderMeshTypeId);
 }
 
-private void LoadAttributeBuffer(unsigned int Position, unsigned int Handle, unsigned int dimensions)
+private GLenum GetAttributeType(AttributeFormat format)
+{
+	switch (format)
+	{
+	case AttributeFormatHalf:
+		return GL_HALF_FLOAT;
+	case AttributeFormatUnorm16:
+		return GL_UNSIGNED_SHORT;
+	case AttributeFormatSnorm16:
+		return GL_SHORT;
+	default:
+		return GL_FLOAT;
+	}
+}
+
+private void LoadAttributeBuffer(unsigned int Position, unsigned int Handle, unsigned int dimensions, AttributeFormat format, unsigned int stride)
 {
 	glEnableVertexAttribArray(Position);
 
@@ -70,9 +92,9 @@ private void LoadAttributeBuffer(unsigned int Position, unsigned int Handle, uns
 	glVertexAttribPointer(
 		Position,
 		dimensions,
-		GL_FLOAT,
-		false,
-		0,
+		GetAttributeType(format),
+		format is AttributeFormatUnorm16 or format is AttributeFormatSnorm16,
+		stride,
 		null
 	);
 }
@@ -82,26 +104,31 @@ private void Draw(RenderMesh mesh)
 	if (mesh->VertexBuffer isnt null)
 	{
 
-		LoadAttributeBuffer(VertexShaderPosition, mesh->VertexBuffer->Handle, 3);
+		// fixed point positions are padded to 4 components so every vertex starts on an aligned boundary
+		const unsigned int stride = mesh->VertexFormat is AttributeFormatUnorm16 ? 4 * sizeof(ushort) : 0;
+
+		LoadAttributeBuffer(VertexShaderPosition, mesh->VertexBuffer->Handle, 3, mesh->VertexFormat, stride);
 
 		if (mesh->CopyBuffersOnDraw)
 		{
+			const Mesh source = mesh->Mesh->Resource;
+
 			glBufferSubData(GL_ARRAY_BUFFER,
 				0,
-				mesh->NumberOfTriangles * 3 * sizeof(float),
-				((Mesh)mesh->Mesh->Resource)->Vertices
+				source->VertexCount * sizeof(vector3),
+				source->Vertices
 			);
 		}
 	}
 
 	if (mesh->UVBuffer isnt null)
 	{
-		LoadAttributeBuffer(UVShaderPosition, mesh->UVBuffer->Handle, 2);
+		LoadAttributeBuffer(UVShaderPosition, mesh->UVBuffer->Handle, 2, mesh->UVFormat, 0);
 	}
 
 	if (mesh->NormalBuffer isnt null)
 	{
-		LoadAttributeBuffer(NormalShaderPosition, mesh->NormalBuffer->Handle, 3);
+		LoadAttributeBuffer(NormalShaderPosition, mesh->NormalBuffer->Handle, 2, mesh->NormalFormat, 0);
 	}
 
 	if (mesh->ShadeSmooth)
@@ -117,7 +144,20 @@ private void Draw(RenderMesh mesh)
 	// the entire mesh pipling ive written handles up to ulong
 	// its casted down to int here for DrawArrays
 	// this may cause issues at this line for models with > 32767 triangles
-	glDrawArrays(GL_TRIANGLES, 0, (GLsizei)mesh->NumberOfTriangles);
+	if (mesh->IndexBuffer isnt null)
+	{
+		const renderMeshLevel level = mesh->Levels[min(mesh->Level, mesh->LevelCount - 1)];
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->IndexBuffer->Handle);
+
+		glDrawElements(GL_TRIANGLES, (GLsizei)level.Count, GL_UNSIGNED_INT, (const void*)(level.Offset * sizeof(uint)));
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+	else
+	{
+		glDrawArrays(GL_TRIANGLES, 0, (GLsizei)mesh->NumberOfTriangles);
+	}
 
 	glDisableVertexAttribArray(VertexShaderPosition);
 	glDisableVertexAttribArray(UVShaderPosition);
@@ -128,16 +168,18 @@ private RenderMesh CreateRenderMesh()
 {
 	Memory.RegisterTypeName(nameof(RenderMesh), &RenderMeshTypeId);
 
-	RenderMesh mesh = Memory.Alloc(sizeof(struct _renderMesh), RenderMeshTypeId);
+	RenderMesh mesh = Memory.PoolAlloc(sizeof(struct _renderMesh), RenderMeshTypeId);
 
 	mesh->Transform = Transforms.Create();
 
 	mesh->CopyBuffersOnDraw = false;
 
+	mesh->Dequantization = Matrix4.Identity;
+
 	return mesh;
 }
 
-private bool TryBindBuffer(float* buffer, ulong sizeInBytes, SharedHandle destinationBuffer)
+private bool TryBindBuffer(const void* buffer, ulong sizeInBytes, SharedHandle destinationBuffer)
 {
 	destinationBuffer->Handle = 0;
 
@@ -161,7 +203,155 @@ private bool TryBindBuffer(float* buffer, ulong sizeInBytes, SharedHandle destin
 	return true;
 }
 
-private bool TryBindMesh(const Mesh mesh, RenderMesh* out_renderMesh)
+private ulong GetLevelIndexCount(const RenderMesh mesh)
+{
+	const renderMeshLevel last = mesh->Levels[mesh->LevelCount - 1];
+
+	return last.Offset + last.Count;
+}
+
+// lays the full detail indices and every level of detail after one another, returns the mesh's own indices when
+// it has no levels
+private uint* GetLevelIndices(const Mesh mesh, RenderMesh renderMesh)
+{
+	renderMesh->LevelCount = mesh->LevelCount + 1;
+	renderMesh->Levels[0] = (renderMeshLevel){ .Offset = 0, .Count = mesh->IndexCount, .Error = 0.0f };
+
+	for (ulong i = 0; i < mesh->LevelCount; i++)
+	{
+		const renderMeshLevel previous = renderMesh->Levels[i];
+
+		renderMesh->Levels[i + 1] = (renderMeshLevel){
+			.Offset = previous.Offset + previous.Count,
+			.Count = mesh->Levels[i].IndexCount,
+			.Error = mesh->Levels[i].Error
+		};
+	}
+
+	if (mesh->LevelCount is 0)
+	{
+		return mesh->Indices;
+	}
+
+	const ulong count = GetLevelIndexCount(renderMesh);
+
+	uint* indices = Memory.Alloc(count * sizeof(uint), Memory.GenericMemoryBlock);
+
+	memcpy(indices, mesh->Indices, mesh->IndexCount * sizeof(uint));
+
+	for (ulong i = 0; i < mesh->LevelCount; i++)
+	{
+		memcpy(indices + renderMesh->Levels[i + 1].Offset, mesh->Levels[i].Indices, mesh->Levels[i].IndexCount * sizeof(uint));
+	}
+
+	return indices;
+}
+
+// stores positions as fixed point within the bounds of the mesh, one scale for every axis keeps the dequantization
+// uniform so the normal matrix shaders derive from the model matrix stays correct
+private ushort* EncodePositions(const Mesh mesh, matrix4* out_dequantization)
+{
+	vector3 lower = mesh->Vertices[0];
+	vector3 upper = lower;
+
+	for (ulong i = 1; i < mesh->VertexCount; i++)
+	{
+		const vector3 vertex = mesh->Vertices[i];
+
+		lower = (vector3){ min(lower.x, vertex.x), min(lower.y, vertex.y), min(lower.z, vertex.z) };
+		upper = (vector3){ max(upper.x, vertex.x), max(upper.y, vertex.y), max(upper.z, vertex.z) };
+	}
+
+	float extent = max(max(upper.x - lower.x, upper.y - lower.y), upper.z - lower.z);
+
+	// a mesh that is a single point still needs an invertible model matrix
+	if (extent <= 0.0f)
+	{
+		extent = 1.0f;
+	}
+
+	ushort* encoded = Memory.Alloc(mesh->VertexCount * 4 * sizeof(ushort), Memory.GenericMemoryBlock);
+
+	for (ulong i = 0; i < mesh->VertexCount; i++)
+	{
+		const vector3 vertex = mesh->Vertices[i];
+
+		encoded[(i * 4) + 0] = Quantization.EncodeUnorm16((vertex.x - lower.x) / extent);
+		encoded[(i * 4) + 1] = Quantization.EncodeUnorm16((vertex.y - lower.y) / extent);
+		encoded[(i * 4) + 2] = Quantization.EncodeUnorm16((vertex.z - lower.z) / extent);
+	}
+
+	*out_dequantization = Matrix4s.Scale(Matrix4s.Translate(Matrix4.Identity, lower), (vector3) { extent, extent, extent });
+
+	return encoded;
+}
+
+// uvs outside of 0.0 to 1.0 repeat or mirror the texture and need the range of half floats
+private ushort* EncodeUVs(const Mesh mesh, AttributeFormat* out_format)
+{
+	bool normalized = true;
+
+	for (ulong i = 0; i < mesh->TextureCount; i++)
+	{
+		const vector2 uv = mesh->TextureVertices[i];
+
+		if (uv.x < 0.0f or uv.x > 1.0f or uv.y < 0.0f or uv.y > 1.0f)
+		{
+			normalized = false;
+			break;
+		}
+	}
+
+	ushort* encoded = Memory.Alloc(mesh->TextureCount * 2 * sizeof(ushort), Memory.GenericMemoryBlock);
+
+	for (ulong i = 0; i < mesh->TextureCount; i++)
+	{
+		const vector2 uv = mesh->TextureVertices[i];
+
+		encoded[(i * 2) + 0] = normalized ? Quantization.EncodeUnorm16(uv.x) : Quantization.FloatToHalf(uv.x);
+		encoded[(i * 2) + 1] = normalized ? Quantization.EncodeUnorm16(uv.y) : Quantization.FloatToHalf(uv.y);
+	}
+
+	*out_format = normalized ? AttributeFormatUnorm16 : AttributeFormatHalf;
+
+	return encoded;
+}
+
+private octahedral* EncodeNormals(const Mesh mesh)
+{
+	octahedral* encoded = Memory.Alloc(mesh->NormalCount * sizeof(octahedral), Memory.GenericMemoryBlock);
+
+	for (ulong i = 0; i < mesh->NormalCount; i++)
+	{
+		encoded[i] = Quantization.EncodeOctahedral(mesh->NormalVertices[i]);
+	}
+
+	return encoded;
+}
+
+private bool TryBindVertices(const Mesh mesh, bool quantizePositions, RenderMesh model)
+{
+	model->VertexBuffer = SharedHandles.Create();
+
+	if (quantizePositions is false)
+	{
+		model->VertexFormat = AttributeFormatFloat;
+
+		return TryBindBuffer((float*)mesh->Vertices, mesh->VertexCount * sizeof(vector3), model->VertexBuffer);
+	}
+
+	ushort* positions = EncodePositions(mesh, &model->Dequantization);
+
+	model->VertexFormat = AttributeFormatUnorm16;
+
+	const bool bound = TryBindBuffer(positions, mesh->VertexCount * 4 * sizeof(ushort), model->VertexBuffer);
+
+	Memory.Free(positions, Memory.GenericMemoryBlock);
+
+	return bound;
+}
+
+private bool TryBind(const Mesh mesh, bool quantizePositions, RenderMesh* out_renderMesh)
 {
 	*out_renderMesh = null;
 
@@ -169,9 +359,7 @@ private bool TryBindMesh(const Mesh mesh, RenderMesh* out_renderMesh)
 
 	// since this is a new mesh we should create new buffers from scratch
 
-	model->VertexBuffer = SharedHandles.Create();
-
-	if (TryBindBuffer((float*)mesh->Vertices, mesh->VertexCount * sizeof(vector3), model->VertexBuffer) is false)
+	if (TryBindVertices(mesh, quantizePositions and mesh->VertexCount isnt 0, model) is false)
 	{
 		RenderMeshes.Dispose(model);
 		return false;
@@ -181,7 +369,13 @@ private bool TryBindMesh(const Mesh mesh, RenderMesh* out_renderMesh)
 	{
 		model->UVBuffer = SharedHandles.Create();
 
-		if (TryBindBuffer((float*)mesh->TextureVertices, mesh->TextureCount * sizeof(vector2), model->UVBuffer) is false)
+		ushort* uvs = EncodeUVs(mesh, &model->UVFormat);
+
+		const bool bound = TryBindBuffer(uvs, mesh->TextureCount * 2 * sizeof(ushort), model->UVBuffer);
+
+		Memory.Free(uvs, Memory.GenericMemoryBlock);
+
+		if (bound is false)
 		{
 			RenderMeshes.Dispose(model);
 			return false;
@@ -193,14 +387,44 @@ private bool TryBindMesh(const Mesh mesh, RenderMesh* out_renderMesh)
 	{
 		model->NormalBuffer = SharedHandles.Create();
 
-		if (TryBindBuffer((float*)mesh->NormalVertices, mesh->NormalCount * sizeof(vector3), model->NormalBuffer) is false)
+		model->NormalFormat = AttributeFormatSnorm16;
+
+		octahedral* normals = EncodeNormals(mesh);
+
+		const bool bound = TryBindBuffer(normals, mesh->NormalCount * sizeof(octahedral), model->NormalBuffer);
+
+		Memory.Free(normals, Memory.GenericMemoryBlock);
+
+		if (bound is false)
 		{
 			RenderMeshes.Dispose(model);
 			return false;
 		}
 	}
 
-	model->NumberOfTriangles = mesh->VertexCount;
+	if (mesh->Indices isnt null)
+	{
+		model->IndexBuffer = SharedHandles.Create();
+
+		uint* indices = GetLevelIndices(mesh, model);
+
+		// buffers are untyped so the index buffer can be filled through the array buffer binding like the others
+		const bool bound = TryBindBuffer(indices, GetLevelIndexCount(model) * sizeof(uint), model->IndexBuffer);
+
+		if (indices isnt mesh->Indices)
+		{
+			Memory.Free(indices, Memory.GenericMemoryBlock);
+		}
+
+		if (bound is false)
+		{
+			RenderMeshes.Dispose(model);
+			return false;
+		}
+	}
+
+	// indexed meshes draw one element per index, otherwise one per vertex
+	model->NumberOfTriangles = mesh->Indices isnt null ? mesh->IndexCount : mesh->VertexCount;
 
 	model->ShadeSmooth = mesh->SmoothingEnabled;
 
@@ -211,6 +435,16 @@ private bool TryBindMesh(const Mesh mesh, RenderMesh* out_renderMesh)
 	return true;
 }
 
+private bool TryBindMesh(const Mesh mesh, RenderMesh* out_renderMesh)
+{
+	return TryBind(mesh, false, out_renderMesh);
+}
+
+private bool TryBindQuantizedMesh(const Mesh mesh, RenderMesh* out_renderMesh)
+{
+	return TryBind(mesh, true, out_renderMesh);
+}
+
 private void RenderMeshCopyTo(RenderMesh source, RenderMesh destination)
 {
 	CopyMember(source, destination, VertexBuffer);
@@ -234,8 +468,24 @@ private void RenderMeshCopyTo(RenderMesh source, RenderMesh destination)
 		++source->NormalBuffer->ActiveInstances;
 	}
 
+	CopyMember(source, destination, IndexBuffer);
+
+	if (source->IndexBuffer isnt null)
+	{
+		++source->IndexBuffer->ActiveInstances;
+	}
+
 	CopyMember(source, destination, NumberOfTriangles);
 
+	CopyMember(source, destination, VertexFormat);
+	CopyMember(source, destination, UVFormat);
+	CopyMember(source, destination, NormalFormat);
+	CopyMember(source, destination, Dequantization);
+
+	CopyMember(source, destination, LevelCount);
+
+	memcpy(destination->Levels, source->Levels, sizeof(source->Levels));
+
 	if (source->Name isnt null)
 	{
 		destination->Name = Pointers(byte).Instance(source->Name);
@@ -267,6 +517,22 @@ private RenderMesh Duplicate(RenderMesh mesh)
 	return result;
 }
 
+// the array is allocated with this file's type id so it has to be freed here as well
+private void DisposeModelMeshes(RenderMesh* meshArray, ulong count)
+{
+	if (meshArray is null)
+	{
+		return;
+	}
+
+	for (ulong i = 0; i < count; i++)
+	{
+		Dispose(meshArray[i]);
+	}
+
+	Memory.Free(meshArray, RenderMeshTypeId);
+}
+
 private bool TryBindModel(Model model, RenderMesh** out_meshArray)
 {
 	RenderMesh* meshesArray = Memory.Alloc(sizeof(RenderMesh) * model->Count, RenderMeshTypeId);
@@ -287,12 +553,7 @@ private bool TryBindModel(Model model, RenderMesh** out_meshArray)
 			Pointers(byte).Dispose(name, null, null);
 
 			// dispose of any children before this index where we failed
-			for (int childIndex = 0; childIndex < i; ++childIndex)
-			{
-				RenderMeshes.Dispose(meshesArray[childIndex]);
-			}
-
-			Memory.Free(meshesArray, RenderMeshTypeId);
+			DisposeModelMeshes(meshesArray, i);
 
 			return false;
 		}
@@ -10,17 +10,20 @@
 #include "core/quickmask.h"
 #include "core/parsing.h"
 #include "core/hashing.h"
+#include "core/map.h"
 #include <string.h>
 #include "core/strings.h"
 
 static Shader CompileShader(const StringArray vertexPaths, const StringArray fragmentPaths, const StringArray geometryPaths);
 static Shader Load(const string path);
 static bool Save(Shader shader, const string path);
+static void Clear(void);
 
 const struct _shaderCompilerMethods ShaderCompilers = {
 	.CompileShader = &CompileShader,
 	.Load = &Load,
-	.Save = &Save
+	.Save = &Save,
+	.Clear = &Clear
 };
 
 #define LOG_BUFFER_SIZE 1024
@@ -52,14 +55,10 @@ static struct _shaderTypes
 	GL_GEOMETRY_SHADER
 };
 
-#define CompiledHandleDictionarySize 1024
+DEFINE_MAP(ulong, Shader);
 
-Shader CompiledShaders[CompiledHandleDictionarySize];
-/// <summary>
-/// The number of handles within the compiled handles dict
-/// </summary>
-ulong HandleDictionaryCount = 0;
-ulong HandleDictionaryLength = CompiledHandleDictionarySize;
+// compiled shaders keyed by the hash of all of their source paths, created on first use
+map(ulong, Shader) CompiledShaders;
 
 static ulong HashShaderPaths(const StringArray vertexPaths, const StringArray fragmentPaths, const StringArray geometryPaths)
 {
@@ -107,17 +106,17 @@ static bool TryGetStoredShader(const StringArray vertexPaths, const StringArray
 		return false;
 	}
 
-	// hash the two paths
-	ulong hash = HashShaderPaths(vertexPaths, fragmentPaths, geometryPaths);
-
-	// mod the hash with the array size
-	ulong index = hash % CompiledHandleDictionarySize;
+	*out_shader = null;
 
-	Shader storedShader = CompiledShaders[index];
+	if (CompiledShaders is null)
+	{
+		return false;
+	}
 
-	*out_shader = storedShader;
+	// hash the two paths
+	ulong hash = HashShaderPaths(vertexPaths, fragmentPaths, geometryPaths);
 
-	return storedShader isnt null;
+	return maps(ulong, Shader).TryGet(CompiledShaders, hash, out_shader) and *out_shader isnt null;
 }
 
 // stored the given handle within the compiled handle dictionary, returns true when no collision occurs
@@ -133,23 +132,24 @@ static bool TryStoreShader(const StringArray vertexPaths, const StringArray frag
 		return false;
 	}
 
+	if (CompiledShaders is null)
+	{
+		CompiledShaders = maps(ulong, Shader).Create(16);
+	}
+
 	// hash the two paths
 	ulong hash = HashShaderPaths(vertexPaths, fragmentPaths, geometryPaths);
 
-	// mod the hash with the array size
-	ulong index = hash % CompiledHandleDictionarySize;
-
-	Shader* position = &CompiledShaders[index];
-
 	// this may cause issues with disposed handles, we'll see
-	if (*position is null)
-	{
-		*position = shader;
+	return maps(ulong, Shader).TryAdd(CompiledShaders, hash, shader);
+}
 
-		return true;
-	}
+static void Clear(void)
+{
+	// the shaders themselves belong to whoever compiled them, only the lookup is released
+	maps(ulong, Shader).Dispose(CompiledShaders);
 
-	return false;
+	CompiledShaders = null;
 }
 
 static bool VerifyHandle(unsigned int handle)
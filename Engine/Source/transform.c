@@ -8,17 +8,49 @@
 #include "core/quickmask.h"
 #include "core/guards.h"
 #include "core/math/vectors.h"
+#include "core/math/matrixKernels.h"
+#include "core/threads.h"
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
 #include "core/config.h"
 #include "core/parsing.h"
+#include "core/cunit.h"
 
 #define PositionModifiedFlag FLAG_0
 #define RotationModifiedFlag FLAG_1
 #define ScaleModifiedFlag FLAG_2
+// the world matrix is out of date but the local matrix isn't, when the parent changed or the local matrix was
+// composed ahead of the world matrix
 #define ParentModifiedFlag FLAG_3
 
+// set while the slot waits in the dirty list for the next UpdateAll, it stays set when the slot is refreshed early
+#define QueuedFlag FLAG_4
+
 #define AllModifiedFlag (PositionModifiedFlag | RotationModifiedFlag | ScaleModifiedFlag)
 
+// the parent of roots, and the child or sibling of slots that have none
+#define NoSlot ((ulong)-1)
+
+// the fewest slots the hierarchy grows by
+#define MIN_HIERARCHY_CAPACITY 64
+
+// once more than one in this many slots are dirty sorting the dirty list costs more than refreshing every slot in order
+#define DIRTY_SWEEP_DIVISOR 8
+
+// hierarchies and batches of local matrices smaller than this are updated on the calling thread, waking the workers
+// costs more than the update
+#define MIN_PARALLEL_SLOTS 4096
+
+// how many independent subtrees a parallel update looks for per thread, and how many groups of them it hands out per
+// thread so threads that finish early can take another group
+#define PARALLEL_SUBTREES_PER_THREAD 32
+#define PARALLEL_CHUNKS_PER_THREAD 4
+
+// how many ancestors Refresh walks up at once before it refreshes the rest of the chain first
+#define MAX_REFRESH_CHAIN 32
+
 private void Dispose(Transform transform);
 private Transform CreateTransform(void);
 private void TransformCopyTo(Transform source, Transform destination);
@@ -40,6 +72,12 @@ private void AddScale(Transform transform, vector3 amount);
 private vector3 GetDirection(Transform transform, Direction direction);
 private matrix4 RefreshTransform(Transform transform);
 private matrix4 ForceRefreshTransform(Transform transform);
+private void UpdateAll(void);
+private matrix4 GetWorldMatrix(Transform transform);
+private ulong Version(Transform transform);
+private vector3 GetPosition(Transform transform);
+private quaternion GetRotation(Transform transform);
+private vector3 GetScale(Transform transform);
 private void ScaleAll(Transform, float scaler);
 private void ClearChildren(Transform);
 private Transform Load(File);
@@ -48,6 +86,8 @@ private void SetChildCapacity(Transform, ulong count);
 private void LookAt(Transform, vector3 target);
 private void LookAtPositions(Transform, float x, float y, float z);
 private vector3 TransformPoint(Transform, vector3 point);
+private void RunUnitTests(void);
+private void RunBenchmarks(void);
 
 const struct _transformMethods Transforms = {
 	.Dispose = &Dispose,
@@ -68,6 +108,12 @@ const struct _transformMethods Transforms = {
 	.GetDirection = &GetDirection,
 	.Refresh = &RefreshTransform,
 	.ForceRefresh = &ForceRefreshTransform,
+	.UpdateAll = &UpdateAll,
+	.GetWorldMatrix = &GetWorldMatrix,
+	.Version = &Version,
+	.GetPosition = &GetPosition,
+	.GetRotation = &GetRotation,
+	.GetScale = &GetScale,
 	.Translate = &Translate,
 	.TranslateX = &TranslateX,
 	.TranslateY = &TranslateY,
@@ -78,526 +124,1003 @@ const struct _transformMethods Transforms = {
 	.SetChildCapacity = &SetChildCapacity,
 	.LookAt = LookAt,
 	.LookAtPositions = LookAtPositions,
-	.TransformPoint = TransformPoint
+	.TransformPoint = TransformPoint,
+	.RunUnitTests = &RunUnitTests,
+	.RunBenchmarks = &RunBenchmarks
 };
 
 DEFINE_TYPE_ID(Transform);
+DEFINE_TYPE_ID(TransformHierarchy);
+
+// Every transform owns one slot of each of these arrays, handles only hold the index of their slot. Slots are kept
+// sorted depth first so parents always come before their children. Slots that change are put in a dirty list once and
+// UpdateAll only walks the subtrees below them, everything else keeps the world matrix it had
+static struct _transformHierarchy {
+	// The number of slots in use, including released slots that are removed the next time the hierarchy is sorted
+	ulong Count;
+	ulong Capacity;
+	// The number of released slots that have not been removed yet, released slots don't break the order so they are
+	// only removed once they take up half of the hierarchy
+	ulong Released;
+	// Whether every slot comes after its parent
+	bool Sorted;
+	// The handle that owns each slot, null for released slots
+	Transform* Handles;
+	// The slot of each parent, NoSlot for roots
+	ulong* Parents;
+	// The children of each slot are linked through their siblings so a subtree can be walked without the handles
+	ulong* FirstChildren;
+	ulong* NextSiblings;
+	ulong* PreviousSiblings;
+	unsigned int* Modified;
+	// Changes every time the world matrix of a slot changes
+	ulong* Versions;
+	// The version of the parent's world matrix the slot's world matrix was last calculated from
+	ulong* ParentVersions;
+	vector3* Positions;
+	quaternion* Rotations;
+	vector3* Scales;
+	matrix4* LocalMatrices;
+	matrix4* WorldMatrices;
+	// The slots that changed since the last UpdateAll, every slot is in the list at most once so it never holds more
+	// than Capacity slots
+	ulong* Dirty;
+	ulong DirtyCount;
+	// Scratch space for the subtrees a parallel update splits the hierarchy into, never more than Capacity
+	ulong* Tasks;
+	ulong* NextTasks;
+	// Whether each slot is in the dirty list or below a slot that is, as (AncestorStamp << 1) | answer, answers from
+	// an older stamp are out of date so nothing has to be cleared between updates
+	ulong* DirtyAncestors;
+	ulong AncestorStamp;
+} Hierarchy;
+
+struct _hierarchyArray {
+	void** Address;
+	ulong Size;
+};
 
-private void Dispose(Transform transform)
+// every array of the hierarchy, they are grown and sorted together
+static const struct _hierarchyArray HierarchyArrays[] = {
+	{ (void**)&Hierarchy.Handles, sizeof(Transform) },
+	{ (void**)&Hierarchy.Parents, sizeof(ulong) },
+	{ (void**)&Hierarchy.FirstChildren, sizeof(ulong) },
+	{ (void**)&Hierarchy.NextSiblings, sizeof(ulong) },
+	{ (void**)&Hierarchy.PreviousSiblings, sizeof(ulong) },
+	{ (void**)&Hierarchy.Modified, sizeof(unsigned int) },
+	{ (void**)&Hierarchy.Versions, sizeof(ulong) },
+	{ (void**)&Hierarchy.ParentVersions, sizeof(ulong) },
+	{ (void**)&Hierarchy.Positions, sizeof(vector3) },
+	{ (void**)&Hierarchy.Rotations, sizeof(quaternion) },
+	{ (void**)&Hierarchy.Scales, sizeof(vector3) },
+	{ (void**)&Hierarchy.LocalMatrices, sizeof(matrix4) },
+	{ (void**)&Hierarchy.WorldMatrices, sizeof(matrix4) }
+};
+
+#define HIERARCHY_ARRAY_COUNT (sizeof(HierarchyArrays) / sizeof(struct _hierarchyArray))
+
+private void ReserveSlots(ulong count)
 {
-	if (transform is null)
+	if (count <= Hierarchy.Capacity)
 	{
 		return;
 	}
 
-	if (transform->Count isnt 0)
-	{
-		ClearChildren(transform);
-	}
+	Memory.RegisterTypeName("TransformHierarchy", &TransformHierarchyTypeId);
 
-	if (transform->Parent isnt null)
+	const ulong capacity = max(count, max(Hierarchy.Capacity * 2, MIN_HIERARCHY_CAPACITY));
+
+	for (ulong i = 0; i < HIERARCHY_ARRAY_COUNT; i++)
 	{
-		SetParent(transform, null);
+		const struct _hierarchyArray array = HierarchyArrays[i];
+
+		Memory.ReallocOrCopy(array.Address, Hierarchy.Capacity * array.Size, capacity * array.Size, TransformHierarchyTypeId);
 	}
 
-	Memory.Free(transform, TransformTypeId);
-}
+	// the dirty list holds slots rather than belonging to them so it's never sorted with the other arrays
+	Memory.ReallocOrCopy((void**)&Hierarchy.Dirty, Hierarchy.Capacity * sizeof(ulong), capacity * sizeof(ulong), TransformHierarchyTypeId);
 
-private Transform CreateTransform()
-{
-	Memory.RegisterTypeName(nameof(Transform), &TransformTypeId);
+	// the scratch space doesn't hold anything between updates so it's not copied
+	Memory.Free(Hierarchy.Tasks, TransformHierarchyTypeId);
+	Memory.Free(Hierarchy.NextTasks, TransformHierarchyTypeId);
+	Memory.Free(Hierarchy.DirtyAncestors, TransformHierarchyTypeId);
 
-	Transform transform = Memory.Alloc(sizeof(struct _transform), TransformTypeId);
+	Hierarchy.Tasks = Memory.Alloc(capacity * sizeof(ulong), TransformHierarchyTypeId);
+	Hierarchy.NextTasks = Memory.Alloc(capacity * sizeof(ulong), TransformHierarchyTypeId);
+	Hierarchy.DirtyAncestors = Memory.Alloc(capacity * sizeof(ulong), TransformHierarchyTypeId);
 
-	transform->Children = null;
-	transform->Parent = null;
-	transform->Length = 0;
-	transform->Count = 0;
-	transform->FreeIndex = 0;
-	transform->RotateAroundCenter = false;
-	transform->InvertTransform = false;
+	Hierarchy.Capacity = capacity;
+}
 
-	transform->Position = Vector3.Zero;
-	transform->Scale = (vector3){ 1, 1, 1 };
-	transform->Rotation = (quaternion){ 0, 0, 0, 1 };
+// moves every array of the hierarchy into the order given, order holds the previous slot of each new slot
+private void PermuteHierarchy(const ulong* order, ulong count)
+{
+	for (ulong i = 0; i < HIERARCHY_ARRAY_COUNT; i++)
+	{
+		const struct _hierarchyArray array = HierarchyArrays[i];
 
-	transform->State.State = Matrix4.Zero;
+		const byte* previous = *array.Address;
+		byte* sorted = Memory.Alloc(Hierarchy.Capacity * array.Size, TransformHierarchyTypeId);
 
-	// set the all modified flag so we do a full refresh of the transform on first draw
-	transform->State.Modified = AllModifiedFlag;
-	ResetFlags(transform->State.Directions.Accessed);
+		for (ulong slot = 0; slot < count; slot++)
+		{
+			memcpy(sorted + (slot * array.Size), previous + (order[slot] * array.Size), array.Size);
+		}
 
-	// no need to init the transform states since they will be populated before first draw by RecalculateTransform
+		Memory.Free(*array.Address, TransformHierarchyTypeId);
 
-	return transform;
+		*array.Address = sorted;
+	}
 }
 
-private void DirectionStatesCopyTo(struct _directionStates* source, struct _directionStates* destination)
+// the slot after the given one when the subtree below root is walked depth first, NoSlot once the subtree is done
+private ulong NextInSubtree(ulong slot, ulong root)
 {
-	CopyMember(source, destination, Accessed);
+	if (Hierarchy.FirstChildren[slot] isnt NoSlot)
+	{
+		return Hierarchy.FirstChildren[slot];
+	}
 
-	for (ulong i = 0; i < 6; i++)
+	// climb until there is a sibling that wasn't walked yet
+	while (slot isnt root and Hierarchy.NextSiblings[slot] is NoSlot)
 	{
-		destination->Directions[i] = source->Directions[i];
+		slot = Hierarchy.Parents[slot];
 	}
+
+	return slot is root ? NoSlot : Hierarchy.NextSiblings[slot];
 }
 
-private void StateCopyTo(struct transformState* source, struct transformState* destination)
+private ulong RemapSlot(const ulong* remap, ulong slot)
 {
-	CopyMember(source, destination, Modified);
-
-	destination->ScaleMatrix = source->ScaleMatrix;
-	destination->RotationMatrix = source->RotationMatrix;
-	destination->LocalState = source->LocalState;
-	destination->State = source->State;
-
-	DirectionStatesCopyTo(&source->Directions, &destination->Directions);
+	return slot is NoSlot ? NoSlot : remap[slot];
 }
 
-private void TransformCopyTo(Transform source, Transform destination)
+// sorts the slots depth first and removes released slots, siblings keep the order they had so sorting twice changes
+// nothing
+private void SortHierarchy(void)
 {
-	CopyMember(source, destination, RotateAroundCenter);
-	CopyMember(source, destination, InvertTransform);
+	const ulong count = Hierarchy.Count;
 
-	destination->Scale = source->Scale;
-	destination->Position = source->Position;
-	destination->Rotation = source->Rotation;
+	if (count is 0)
+	{
+		Hierarchy.Sorted = true;
+		return;
+	}
 
-	StateCopyTo(&source->State, &destination->State);
-}
+	// only needed until the slots are moved, the hierarchy is main thread only so the frame arena can hold them
+	ulong* remap = Memory.ArenaAlloc(count * sizeof(ulong), TransformHierarchyTypeId);
+	ulong* order = Memory.ArenaAlloc(count * sizeof(ulong), TransformHierarchyTypeId);
 
-private Transform DuplicateTransform(Transform transform)
-{
-	Transform newTransform = CreateTransform();
+	ulong sortedCount = 0;
 
-	TransformCopyTo(transform, newTransform);
+	for (ulong root = 0; root < count; root++)
+	{
+		if (Hierarchy.Handles[root] is null or Hierarchy.Parents[root] isnt NoSlot)
+		{
+			continue;
+		}
 
-	return newTransform;
-}
+		for (ulong slot = root; slot isnt NoSlot; slot = NextInSubtree(slot, root))
+		{
+			remap[slot] = sortedCount;
+			order[sortedCount++] = slot;
+		}
+	}
 
-/// <summary>
-/// notifies all children of this transform that the transform was modified
-/// </summary>
-/// <param name="transform"></param>
-private void NotifyChildren(Transform transform)
-{
-	for (ulong i = 0; i < transform->Count; i++)
+	// released slots drop out of the dirty list with the rest of their slot
+	ulong dirtyCount = 0;
+
+	for (ulong i = 0; i < Hierarchy.DirtyCount; i++)
 	{
-		Transform child = transform->Children[i];
+		const ulong slot = Hierarchy.Dirty[i];
 
-		if (child isnt null)
+		if (Hierarchy.Handles[slot] isnt null)
 		{
-			SetFlag(child->State.Modified, ParentModifiedFlag);
+			Hierarchy.Dirty[dirtyCount++] = remap[slot];
 		}
 	}
-}
 
-private vector3 GetPosition(Transform transform)
-{
-	if (transform->InvertTransform)
+	Hierarchy.DirtyCount = dirtyCount;
+
+	PermuteHierarchy(order, sortedCount);
+
+	for (ulong i = 0; i < sortedCount; i++)
 	{
-		return (vector3)
-		{
-			-transform->Position.x,
-				-transform->Position.y,
-				-transform->Position.z
-		};
+		Hierarchy.Parents[i] = RemapSlot(remap, Hierarchy.Parents[i]);
+		Hierarchy.FirstChildren[i] = RemapSlot(remap, Hierarchy.FirstChildren[i]);
+		Hierarchy.NextSiblings[i] = RemapSlot(remap, Hierarchy.NextSiblings[i]);
+		Hierarchy.PreviousSiblings[i] = RemapSlot(remap, Hierarchy.PreviousSiblings[i]);
+
+		Hierarchy.Handles[i]->Index = i;
 	}
 
-	return transform->Position;
+	Hierarchy.Count = sortedCount;
+	Hierarchy.Released = 0;
+	Hierarchy.Sorted = true;
 }
 
-private quaternion GetRotation(Transform transform)
+// flags the slot as modified and puts it in the dirty list the first time it changes since the last UpdateAll
+private void MarkModified(ulong index, unsigned int flags)
 {
-	if (transform->InvertTransform)
+	if ((Hierarchy.Modified[index] & QueuedFlag) is 0)
 	{
-		return Quaternions.Invert(transform->Rotation);
+		Hierarchy.Dirty[Hierarchy.DirtyCount++] = index;
 	}
 
-	return transform->Rotation;
+	SetFlag(Hierarchy.Modified[index], flags | QueuedFlag);
 }
 
-private matrix4 RefreshTransform(Transform transform)
+// links the child slot in front of the other children of the parent slot
+private void LinkSlot(ulong parent, ulong child)
 {
-	unsigned int mask = transform->State.Modified;
+	const ulong first = Hierarchy.FirstChildren[parent];
+
+	Hierarchy.Parents[child] = parent;
+	Hierarchy.PreviousSiblings[child] = NoSlot;
+	Hierarchy.NextSiblings[child] = first;
 
-	// if nothing changed return
-	if (mask is 0)
+	if (first isnt NoSlot)
 	{
-		return transform->State.State;
+		Hierarchy.PreviousSiblings[first] = child;
 	}
 
-	// since ANYthing changed force recalculation of direction vectors
-	ResetFlags(transform->State.Directions.Accessed);
+	Hierarchy.FirstChildren[parent] = child;
+}
 
-	// check to see if only my parent has changed
-	if (mask is ParentModifiedFlag && transform->Parent != null)
-	{
-		transform->State.State = Matrix4s.Multiply(transform->Parent->State.State, transform->State.LocalState);
+// makes the slot a root, its own children stay linked to it
+private void UnlinkSlot(ulong child)
+{
+	const ulong parent = Hierarchy.Parents[child];
 
-		ResetFlags(transform->State.Modified);
+	if (parent is NoSlot)
+	{
+		return;
+	}
 
-		NotifyChildren(transform);
+	const ulong previous = Hierarchy.PreviousSiblings[child];
+	const ulong next = Hierarchy.NextSiblings[child];
 
-		return transform->State.State;
+	if (previous isnt NoSlot)
+	{
+		Hierarchy.NextSiblings[previous] = next;
+	}
+	else
+	{
+		Hierarchy.FirstChildren[parent] = next;
 	}
 
-	// check to see if we should perform a whole refresh
-	// since the transform starts with position a change to it requires a whole refresh by default
-	if (HasFlag(mask, AllModifiedFlag) || HasFlag(mask, PositionModifiedFlag))
+	if (next isnt NoSlot)
 	{
-		return Transforms.ForceRefresh(transform);
+		Hierarchy.PreviousSiblings[next] = previous;
 	}
 
-	// becuase the transform may be inverted grab either the regular or inverted transforms
-	quaternion rotation = GetRotation(transform);
+	Hierarchy.Parents[child] = NoSlot;
+	Hierarchy.PreviousSiblings[child] = NoSlot;
+	Hierarchy.NextSiblings[child] = NoSlot;
+}
 
-	// since we dont need to do a full refresh, do only the calcs needed to save cpu time
-	// this engine was orignally designed to be single threaded
-	if (HasFlag(mask, RotationModifiedFlag))
+private ulong AllocateSlot(Transform transform)
+{
+	// reuse the space of released slots before growing
+	if (Hierarchy.Count is Hierarchy.Capacity and Hierarchy.Released isnt 0)
 	{
-		transform->State.RotationMatrix = Quaternions.RotateMatrix(rotation, transform->State.TranslationMatrix);
+		SortHierarchy();
 	}
 
-	// scale the matrix
-	transform->State.LocalState = Matrix4s.Scale(transform->State.RotationMatrix, transform->Scale);
+	ReserveSlots(Hierarchy.Count + 1);
+
+	// a new root at the end of the hierarchy keeps it sorted
+	const ulong index = Hierarchy.Count++;
+
+	Hierarchy.Handles[index] = transform;
+	Hierarchy.Parents[index] = NoSlot;
+	Hierarchy.FirstChildren[index] = NoSlot;
+	Hierarchy.NextSiblings[index] = NoSlot;
+	Hierarchy.PreviousSiblings[index] = NoSlot;
+	Hierarchy.Versions[index] = 0;
+	Hierarchy.ParentVersions[index] = 0;
+	Hierarchy.Positions[index] = Vector3.Zero;
+	Hierarchy.Rotations[index] = (quaternion){ 0, 0, 0, 1 };
+	Hierarchy.Scales[index] = (vector3){ 1, 1, 1 };
+	Hierarchy.WorldMatrices[index] = Matrix4.Zero;
+
+	// set the all modified flag so we do a full refresh of the transform on first draw
+	Hierarchy.Modified[index] = 0;
+	MarkModified(index, AllModifiedFlag);
+
+	return index;
+}
+
+// the slot must already be unlinked from its parent and children
+private void ReleaseSlot(ulong index)
+{
+	Hierarchy.Handles[index] = null;
+
+	++Hierarchy.Released;
+}
 
-	if (transform->Parent != null)
+private void Dispose(Transform transform)
+{
+	if (transform is null)
 	{
-		transform->State.State = Matrix4s.Multiply(transform->Parent->State.State, transform->State.LocalState);
+		return;
 	}
-	else
+
+	if (transform->Count isnt 0)
+	{
+		ClearChildren(transform);
+	}
+
+	if (transform->Parent isnt null)
 	{
-		transform->State.State = transform->State.LocalState;
+		SetParent(transform, null);
 	}
 
-	ResetFlags(transform->State.Modified);
+	Memory.Free(transform->Children, TransformTypeId);
 
-	NotifyChildren(transform);
+	ReleaseSlot(transform->Index);
 
-	return transform->State.State;
+	Memory.PoolFree(transform, TransformTypeId);
 }
 
-private matrix4 ForceRefreshTransform(Transform transform)
+private Transform CreateTransform()
 {
-	// becuase this engine is single threaded we perform some extra calculations here to save them in non-forced refresh
+	Memory.RegisterTypeName(nameof(Transform), &TransformTypeId);
 
-	// calc and store scale, rotation, and translation in their own matrices so we can selectively update them later
+	// transforms are created and destroyed constantly (text, instancing) so they come from the type's pool
+	Transform transform = Memory.PoolAlloc(sizeof(struct _transform), TransformTypeId);
 
-	// becuase the transform may be inverted grab either the regular or inverted transforms
-	quaternion rotation = GetRotation(transform);
+	transform->Children = null;
+	transform->Parent = null;
+	transform->Length = 0;
+	transform->Count = 0;
+	transform->ChildIndex = 0;
+	transform->RotateAroundCenter = false;
+	transform->InvertTransform = false;
 
-	vector3 position = GetPosition(transform);
+	transform->Index = AllocateSlot(transform);
 
-	// create and store a translation matrix
-	transform->State.TranslationMatrix = Matrix4s.Translate(Matrix4.Identity, position);
+	ResetFlags(transform->Directions.Accessed);
 
-	// create and store a rotation matrix
-	transform->State.RotationMatrix = Quaternions.RotateMatrix(rotation, transform->State.TranslationMatrix);
+	// no need to init the matrices since they will be populated before first draw by RefreshTransform
 
-	// calc and store scale matrix
-	transform->State.LocalState = Matrix4s.Scale(transform->State.RotationMatrix, transform->Scale);
+	return transform;
+}
 
-	// multiply them in reverse order
-	// order should be scale -> rotate -> translate
-	/*glm_matrix4_mulN((matrix4 * []) {
-		&transform->State.TranslationMatrix, & transform->State.RotationMatrix, & transform->State.ScaleMatrix
-	}, 3, transform->State.LocalState);*/
+private void DirectionStatesCopyTo(struct _directionStates* source, struct _directionStates* destination)
+{
+	CopyMember(source, destination, Accessed);
 
-	// if we have a parent we should grab their matrices and multiply it with our local one
-	if (transform->Parent != null)
-	{
-		transform->State.State = Matrix4s.Multiply(transform->Parent->State.State, transform->State.LocalState);
-	}
-	else
+	for (ulong i = 0; i < 6; i++)
 	{
-		// since we don't have a parent copy the local transform to the state
-		transform->State.State = transform->State.LocalState;
+		destination->Directions[i] = source->Directions[i];
 	}
+}
+
+private void TransformCopyTo(Transform source, Transform destination)
+{
+	CopyMember(source, destination, RotateAroundCenter);
+	CopyMember(source, destination, InvertTransform);
 
-	// make sure to reset the dirty flag
-	ResetFlags(transform->State.Modified);
+	const ulong from = source->Index;
+	const ulong to = destination->Index;
 
-	// make sure our cardinal directions are forced to recalculate if they are used
-	ResetFlags(transform->State.Directions.Accessed);
+	Hierarchy.Scales[to] = Hierarchy.Scales[from];
+	Hierarchy.Positions[to] = Hierarchy.Positions[from];
+	Hierarchy.Rotations[to] = Hierarchy.Rotations[from];
 
-	// notify the children that they should recalculate their transforms to use our
-	// new state
-	NotifyChildren(transform);
+	// the destination may have another parent, so its matrices are calculated again rather than copied
+	MarkModified(to, AllModifiedFlag);
 
-	return transform->State.State;
+	DirectionStatesCopyTo(&source->Directions, &destination->Directions);
 }
 
-// Detaches the provided child from the given transform
-// peforms an O(n) search by reference
-private void DetachChild(Transform transform, Transform child)
+private Transform DuplicateTransform(Transform transform)
 {
-	GuardNotNull(transform);
+	Transform newTransform = CreateTransform();
 
-	if (child is null)
-	{
-		return;
-	}
+	TransformCopyTo(transform, newTransform);
 
-	// while it doesnt make sense to call this with a null child
-	// the expected result of removing nothing, is nothing.. so just return
-	if (child is null)
+	return newTransform;
+}
+
+private void ComposeLocalMatrix(ulong index)
+{
+	// only slots that were modified are composed again so reading the handle here is rare
+	if (Hierarchy.Handles[index]->InvertTransform)
 	{
+		const vector3 position = Hierarchy.Positions[index];
+		const vector3 inverted = { -position.x, -position.y, -position.z };
+		const quaternion rotation = Quaternions.Invert(Hierarchy.Rotations[index]);
+
+		MatrixKernels.Compose(&inverted, &rotation, &Hierarchy.Scales[index], &Hierarchy.LocalMatrices[index]);
+
 		return;
 	}
 
-	for (ulong i = 0; i < transform->Count; i++)
-	{
-		Transform current = transform->Children[i];
-
-		if (current is child)
-		{
-			// detach the child
-			transform->Children[i] = null;
-			current->Parent = null;
+	// order should be scale -> rotate -> translate
+	MatrixKernels.Compose(&Hierarchy.Positions[index], &Hierarchy.Rotations[index], &Hierarchy.Scales[index], &Hierarchy.LocalMatrices[index]);
+}
 
-			// mark the child so it's next refresh removes the parents transform
-			SetFlag(current->State.Modified, ParentModifiedFlag);
+// a list of slots split into groups that are handed out to the thread pool
+struct _parallelSlots {
+	const ulong* Slots;
+	ulong Count;
+	ulong ChunkCount;
+};
 
-			// decrement the count
-			--(transform->Count);
+private ulong ChunkStart(const struct _parallelSlots* state, ulong chunk)
+{
+	return (chunk * state->Count) / state->ChunkCount;
+}
 
-			break;
-		}
-	}
+// composing groups of four slots can round differently than composing one, compose chunks start on a multiple of four
+// so every slot is composed the same way no matter how many threads there are
+private ulong ComposeChunkStart(const struct _parallelSlots* state, ulong chunk)
+{
+	return chunk is state->ChunkCount ? state->Count : ChunkStart(state, chunk) & ~(ulong)3;
 }
 
-private void AttachChildAtIndex(Transform transform, Transform child, ulong index)
+private void ComposeChunk(void* parallelState, ulong chunk)
 {
-	transform->Children[index] = child;
+	const struct _parallelSlots* state = parallelState;
 
-	// check to see if there is an open spot that we can place the next child
-	++(index);
+	const ulong start = ComposeChunkStart(state, chunk);
 
-	if (index < transform->Length && transform->Children[index] is null)
-	{
-		transform->FreeIndex = index;
-	}
-	else
-	{
-		transform->FreeIndex = 0;
-	}
+	MatrixKernels.ComposeSlots(Hierarchy.Positions, Hierarchy.Rotations, Hierarchy.Scales, state->Slots + start, ComposeChunkStart(state, chunk + 1) - start, Hierarchy.LocalMatrices);
 }
 
-private void ReallocChildren(Transform transform, ulong newCount)
+// composes the local matrix of every dirty slot whose position, rotation or scale changed in one batch, their world
+// matrices are still out of date afterwards
+private void ComposeDirtySlots(ulong threadCount)
 {
-	// try to realloc the space otherwise manually move it, alloc 25% more space, or + 1
-	ulong previousLength = transform->Length * sizeof(Transform);
-	ulong newLength = newCount * sizeof(Transform);
+	ulong count = 0;
 
-	// if we fail to realloc the array make a new one =(
-	if (Memory.TryRealloc(transform->Children, previousLength, newLength, (void**)&transform->Children) is false)
+	for (ulong i = 0; i < Hierarchy.DirtyCount; i++)
 	{
-		Transform* newArray = Memory.Alloc(newLength, TransformTypeId);
+		const ulong slot = Hierarchy.Dirty[i];
+		const Transform handle = Hierarchy.Handles[slot];
 
-		for (ulong i = 0; i < transform->Length; i++)
+		if (handle is null or (Hierarchy.Modified[slot] & AllModifiedFlag) is 0)
 		{
-			newArray[i] = transform->Children[i];
+			continue;
 		}
 
-		Memory.Free(transform->Children, TransformTypeId);
+		// inverted transforms, mostly cameras, are composed from negated values on their own
+		if (handle->InvertTransform)
+		{
+			ComposeLocalMatrix(slot);
+		}
+		else
+		{
+			// the slots that are composed together are moved to the front of the list
+			Hierarchy.Dirty[i] = Hierarchy.Dirty[count];
+			Hierarchy.Dirty[count++] = slot;
+		}
 
-		transform->Children = newArray;
+		Hierarchy.Modified[slot] = (Hierarchy.Modified[slot] & ~AllModifiedFlag) | ParentModifiedFlag;
 	}
 
-	// since we know the first index of the extended portion is null we can set the lastchild index
-	// to that value so we dont have to search for it later
-	transform->FreeIndex = transform->Length;
+	// every slot is composed on its own so which thread composes it doesn't matter
+	struct _parallelSlots state = {
+		.Slots = Hierarchy.Dirty,
+		.Count = count,
+		.ChunkCount = threadCount > 1 and count >= MIN_PARALLEL_SLOTS ? threadCount * PARALLEL_CHUNKS_PER_THREAD : 1
+	};
 
-	// update the length
-	transform->Length = newCount;
+	Threads.ParallelFor(state.ChunkCount, &state, &ComposeChunk);
 }
 
-private void SetChildCapacity(Transform transform, ulong count)
+// recalculates the world matrix of the slot if it or its parent changed, the parent must already be up to date
+private void UpdateSlot(ulong index)
 {
-	GuardNotNull(transform);
-	GuardNotZero(count);
+	const unsigned int mask = Hierarchy.Modified[index] & ~QueuedFlag;
+	const ulong parent = Hierarchy.Parents[index];
 
-	if (transform->Length is 0)
-	{
-		transform->Children = Memory.Alloc(sizeof(Transform) * count, TransformTypeId);
-		transform->Length = count;
-		transform->FreeIndex = 0;
+	const bool parentChanged = parent isnt NoSlot and Hierarchy.ParentVersions[index] isnt Hierarchy.Versions[parent];
 
+	if (mask is 0 and parentChanged is false)
+	{
 		return;
 	}
 
-	if (transform->Length < count)
+	if ((mask & AllModifiedFlag) isnt 0)
 	{
-		ReallocChildren(transform, count);
+		ComposeLocalMatrix(index);
 	}
-}
 
-private void AttachChild(Transform transform, Transform child)
-{
-	if (transform is null or child is null)
+	if (parent isnt NoSlot)
 	{
-		return;
+		MatrixKernels.Multiply(&Hierarchy.WorldMatrices[parent], &Hierarchy.LocalMatrices[index], &Hierarchy.WorldMatrices[index]);
+		Hierarchy.ParentVersions[index] = Hierarchy.Versions[parent];
 	}
-
-	// make sure there is enough room, if there isn't move the array
-	if ((transform->Count) + 1 > transform->Length)
+	else
 	{
-		// try to realloc the array if not make a new one and copy the children over
+		Hierarchy.WorldMatrices[index] = Hierarchy.LocalMatrices[index];
+	}
 
-		// make it 25% larger to allow for future attachments
-		ulong newCount = max((ulong)((transform->Length * 125) / 100), transform->Length + 1);
+	++Hierarchy.Versions[index];
 
-		ReallocChildren(transform, newCount);
+	// slots refreshed before UpdateAll stay in the dirty list, their children may still be out of date
+	Hierarchy.Modified[index] &= QueuedFlag;
+}
+
+// refreshes the slot along with every ancestor above it, from the root down
+private void RefreshSlot(ulong index)
+{
+	ulong chain[MAX_REFRESH_CHAIN];
+	ulong depth = 0;
+
+	ulong current = index;
+
+	while (current isnt NoSlot and depth < MAX_REFRESH_CHAIN)
+	{
+		chain[depth++] = current;
+		current = Hierarchy.Parents[current];
 	}
 
-	// if we extended the array lastchild will now be non-zero
-	if (transform->Children[transform->FreeIndex] is null)
+	// hierarchies deeper than the chain refresh the rest of their ancestors first
+	if (current isnt NoSlot)
 	{
-		AttachChildAtIndex(transform, child, transform->FreeIndex);
+		RefreshSlot(current);
 	}
-	else
+
+	while (depth isnt 0)
 	{
-		// linearly search for open spot
-		for (ulong i = 0; i < transform->Length; i++)
-		{
-			if (transform->Children[i] is null)
-			{
-				// attach the child and check to see if we can save some time
-				// next call by checking for null spot next to the index
-				AttachChildAtIndex(transform, child, i);
-				break;
-			}
-		}
+		UpdateSlot(chain[--depth]);
 	}
+}
 
-	//attach the parent to the child
-	child->Parent = transform;
+private matrix4 RefreshTransform(Transform transform)
+{
+	RefreshSlot(transform->Index);
 
-	++(transform->Count);
+	return Hierarchy.WorldMatrices[transform->Index];
 }
 
-private void SetParent(Transform transform, Transform parent)
+private matrix4 ForceRefreshTransform(Transform transform)
 {
-	// make sure to detach the previous parent if there is one
-	if (transform->Parent isnt null)
-	{
-		DetachChild(transform->Parent, transform);
-	}
+	MarkModified(transform->Index, AllModifiedFlag);
 
-	// attach the child to the new parent
-	AttachChild(parent, transform);
+	return RefreshTransform(transform);
+}
 
-	// mark the child transform as modified since there is a new parent that
-	// will affect it's transform
-	SetFlag(transform->State.Modified, ParentModifiedFlag);
+private int CompareSlots(const void* left, const void* right)
+{
+	const ulong leftSlot = *(const ulong*)left;
+	const ulong rightSlot = *(const ulong*)right;
+
+	return leftSlot < rightSlot ? -1 : leftSlot > rightSlot;
 }
 
-private void ClearChildren(Transform transform)
+// refreshes the slot and every slot below it, every slot that is reached leaves the dirty list
+private void UpdateSubtree(ulong root)
 {
-	for (ulong i = 0; i < transform->Count; i++)
+	for (ulong slot = root; slot isnt NoSlot; slot = NextInSubtree(slot, root))
 	{
-		Transform child = transform->Children[i];
+		UpdateSlot(slot);
 
-		if (child isnt null)
-		{
-			child->Parent = null;
-			SetFlag(child->State.Modified, ParentModifiedFlag);
-		}
+		Hierarchy.Modified[slot] &= ~QueuedFlag;
+	}
+}
+
+// refreshes every slot from front to back, parents come before their children so every parent is up to date by the
+// time its children are reached
+private void SweepHierarchy(void)
+{
+	for (ulong i = 0; i < Hierarchy.Count; i++)
+	{
+		if (Hierarchy.Handles[i] isnt null)
+		{
+			UpdateSlot(i);
+		}
+
+		Hierarchy.Modified[i] &= ~QueuedFlag;
+	}
+}
+
+private void UpdateDirtySubtrees(void)
+{
+	// in slot order every dirty slot below another dirty slot was already refreshed with its subtree by the time it's
+	// reached
+	qsort(Hierarchy.Dirty, Hierarchy.DirtyCount, sizeof(ulong), &CompareSlots);
+
+	for (ulong i = 0; i < Hierarchy.DirtyCount; i++)
+	{
+		const ulong slot = Hierarchy.Dirty[i];
+
+		if (Hierarchy.Handles[slot] isnt null and (Hierarchy.Modified[slot] & QueuedFlag) isnt 0)
+		{
+			UpdateSubtree(slot);
+		}
+	}
+}
+
+// whether the slot is below another slot that is waiting in the dirty list, the answer for every ancestor that is
+// walked is kept until the stamp changes so long chains like text glyphs are only walked once per update
+private bool HasDirtyAncestor(ulong slot)
+{
+	const ulong stamp = Hierarchy.AncestorStamp << 1;
+
+	// walk up until an ancestor is dirty or was already answered for this update
+	ulong parent = Hierarchy.Parents[slot];
+
+	while (parent isnt NoSlot
+		and (Hierarchy.Modified[parent] & QueuedFlag) is 0
+		and (Hierarchy.DirtyAncestors[parent] & ~(ulong)1) isnt stamp)
+	{
+		parent = Hierarchy.Parents[parent];
+	}
+
+	const bool dirty = parent isnt NoSlot
+		and ((Hierarchy.Modified[parent] & QueuedFlag) isnt 0 or (Hierarchy.DirtyAncestors[parent] & 1) isnt 0);
+
+	// every slot walked past has the same answer
+	for (ulong walked = Hierarchy.Parents[slot]; walked isnt parent; walked = Hierarchy.Parents[walked])
+	{
+		Hierarchy.DirtyAncestors[walked] = stamp | (ulong)dirty;
+	}
+
+	return dirty;
+}
+
+private void UpdateSubtreeChunk(void* parallelState, ulong chunk)
+{
+	const struct _parallelSlots* state = parallelState;
+
+	const ulong start = ChunkStart(state, chunk);
+	const ulong end = ChunkStart(state, chunk + 1);
+
+	for (ulong i = start; i < end; i++)
+	{
+		UpdateSubtree(state->Slots[i]);
+	}
+}
+
+// Splits the dirty part of the hierarchy into subtrees that don't share a slot and updates them across the thread pool.
+// Every slot is still updated exactly once from the same parent and local matrix as the serial update, so the results
+// are identical no matter which thread gets which subtree
+private void UpdateDirtySubtreesInParallel(ulong threadCount)
+{
+	ulong* roots = Hierarchy.Tasks;
+	ulong* children = Hierarchy.NextTasks;
+	ulong rootCount = 0;
+
+	// answers from earlier updates are stale
+	++Hierarchy.AncestorStamp;
+
+	// the parent of each of these is up to date and none of them is below another one
+	for (ulong i = 0; i < Hierarchy.DirtyCount; i++)
+	{
+		const ulong slot = Hierarchy.Dirty[i];
+
+		if (Hierarchy.Handles[slot] isnt null and HasDirtyAncestor(slot) is false)
+		{
+			roots[rootCount++] = slot;
+		}
+	}
+
+	// neighbors in the list are neighbors in memory
+	qsort(roots, rootCount, sizeof(ulong), &CompareSlots);
+
+	// scenes tend to have a few roots with most of the hierarchy below them, the top of those trees is updated on this
+	// thread until there are enough subtrees below it to keep every thread busy
+	const ulong wanted = threadCount * PARALLEL_SUBTREES_PER_THREAD;
+
+	while (rootCount isnt 0 and rootCount < wanted)
+	{
+		ulong childCount = 0;
+
+		for (ulong i = 0; i < rootCount; i++)
+		{
+			const ulong root = roots[i];
+
+			UpdateSlot(root);
+
+			Hierarchy.Modified[root] &= ~QueuedFlag;
+
+			for (ulong child = Hierarchy.FirstChildren[root]; child isnt NoSlot; child = Hierarchy.NextSiblings[child])
+			{
+				children[childCount++] = child;
+			}
+		}
+
+		ulong* swap = roots;
+		roots = children;
+		children = swap;
+
+		rootCount = childCount;
+	}
+
+	struct _parallelSlots state = {
+		.Slots = roots,
+		.Count = rootCount,
+		.ChunkCount = min(rootCount, threadCount * PARALLEL_CHUNKS_PER_THREAD)
+	};
+
+	Threads.ParallelFor(state.ChunkCount, &state, &UpdateSubtreeChunk);
+}
+
+private void UpdateHierarchy(ulong threadCount)
+{
+	if (Hierarchy.Sorted is false or Hierarchy.Released > (Hierarchy.Count / 2))
+	{
+		SortHierarchy();
+	}
+
+	ComposeDirtySlots(threadCount);
+
+	if (threadCount > 1)
+	{
+		UpdateDirtySubtreesInParallel(threadCount);
+	}
+	else if (Hierarchy.DirtyCount > Hierarchy.Count / DIRTY_SWEEP_DIVISOR)
+	{
+		SweepHierarchy();
+	}
+	else
+	{
+		UpdateDirtySubtrees();
+	}
+
+	Hierarchy.DirtyCount = 0;
+}
+
+private void UpdateAll(void)
+{
+	// a few dirty roots can still have most of a large hierarchy below them, dirty subtrees that turn out to be small are
+	// finished on the calling thread before any worker is woken
+	UpdateHierarchy(Hierarchy.Count >= MIN_PARALLEL_SLOTS and Hierarchy.DirtyCount isnt 0 ? Threads.ProcessorCount() : 1);
+}
+
+private matrix4 GetWorldMatrix(Transform transform)
+{
+	return Hierarchy.WorldMatrices[transform->Index];
+}
+
+private ulong Version(Transform transform)
+{
+	RefreshSlot(transform->Index);
+
+	return Hierarchy.Versions[transform->Index];
+}
+
+private vector3 GetPosition(Transform transform)
+{
+	return Hierarchy.Positions[transform->Index];
+}
+
+private quaternion GetRotation(Transform transform)
+{
+	return Hierarchy.Rotations[transform->Index];
+}
+
+private vector3 GetScale(Transform transform)
+{
+	return Hierarchy.Scales[transform->Index];
+}
+
+// Detaches the provided child from the given transform, the last child is moved into its spot so the children stay
+// packed at the front of the array
+private void DetachChild(Transform transform, Transform child)
+{
+	GuardNotNull(transform);
+
+	// while it doesnt make sense to call this with a null child
+	// the expected result of removing nothing, is nothing.. so just return
+	if (child is null or child->Parent isnt transform)
+	{
+		return;
+	}
+
+	// decrement the count
+	--(transform->Count);
+
+	Transform last = transform->Children[transform->Count];
+
+	transform->Children[child->ChildIndex] = last;
+	last->ChildIndex = child->ChildIndex;
+
+	transform->Children[transform->Count] = null;
+
+	// detach the child
+	child->Parent = null;
+	child->ChildIndex = 0;
+
+	UnlinkSlot(child->Index);
+
+	// mark the child so it's next refresh removes the parents transform
+	MarkModified(child->Index, ParentModifiedFlag);
+}
+
+private void ReallocChildren(Transform transform, ulong newCount)
+{
+	// try to realloc the space otherwise manually move it, alloc 25% more space, or + 1
+	ulong previousLength = transform->Length * sizeof(Transform);
+	ulong newLength = newCount * sizeof(Transform);
+
+	// a transform without children has no array yet, ReallocOrCopy allocates it so Dispose frees a tracked block
+	Memory.ReallocOrCopy((void**)&transform->Children, previousLength, newLength, TransformTypeId);
+
+	// update the length
+	transform->Length = newCount;
+}
+
+private void SetChildCapacity(Transform transform, ulong count)
+{
+	GuardNotNull(transform);
+	GuardNotZero(count);
+
+	if (transform->Length is 0)
+	{
+		transform->Children = Memory.Alloc(sizeof(Transform) * count, TransformTypeId);
+		transform->Length = count;
+
+		return;
+	}
+
+	if (transform->Length < count)
+	{
+		ReallocChildren(transform, count);
+	}
+}
+
+private void AttachChild(Transform transform, Transform child)
+{
+	if (transform is null or child is null)
+	{
+		return;
+	}
+
+	// make sure there is enough room, if there isn't move the array
+	if ((transform->Count) + 1 > transform->Length)
+	{
+		// try to realloc the array if not make a new one and copy the children over
+
+		// make it 25% larger to allow for future attachments
+		ulong newCount = max((ulong)((transform->Length * 125) / 100), transform->Length + 1);
+
+		ReallocChildren(transform, newCount);
+	}
+
+	// children are packed at the front of the array so the first open spot is always right after the last child
+	transform->Children[transform->Count] = child;
+
+	//attach the parent to the child
+	child->Parent = transform;
+	child->ChildIndex = transform->Count;
+
+	LinkSlot(transform->Index, child->Index);
+
+	// children created after their parent, like most are, keep the hierarchy sorted
+	if (child->Index < transform->Index)
+	{
+		Hierarchy.Sorted = false;
+	}
+
+	++(transform->Count);
+}
+
+private void SetParent(Transform transform, Transform parent)
+{
+	// make sure to detach the previous parent if there is one
+	if (transform->Parent isnt null)
+	{
+		DetachChild(transform->Parent, transform);
+	}
+
+	// attach the child to the new parent
+	AttachChild(parent, transform);
+
+	// mark the child transform as modified since there is a new parent that
+	// will affect it's transform
+	MarkModified(transform->Index, ParentModifiedFlag);
+}
+
+private void ClearChildren(Transform transform)
+{
+	for (ulong i = 0; i < transform->Count; i++)
+	{
+		Transform child = transform->Children[i];
+
+		child->Parent = null;
+		child->ChildIndex = 0;
+
+		UnlinkSlot(child->Index);
+
+		MarkModified(child->Index, ParentModifiedFlag);
 
 		transform->Children[i] = null;
 
 		//Transforms.Dispose( child );
 	}
 
-	transform->FreeIndex = 0;
 	transform->Count = 0;
 }
 
 private void SetPosition(Transform transform, vector3 position)
 {
-	if (Vector3s.Equals(position, transform->Position))
+	vector3* current = &Hierarchy.Positions[transform->Index];
+
+	if (Vector3s.Equals(position, *current))
 	{
 		return;
 	}
 
-	transform->Position = position;
-	SetFlag(transform->State.Modified, PositionModifiedFlag);
+	*current = position;
+	MarkModified(transform->Index, PositionModifiedFlag);
 }
 
 private void SetPositions(Transform transform, float x, float y, float z)
 {
 	vector3 newPos = { x, y, z };
 
-	if (Vector3s.Equals(transform->Position, newPos))
-	{
-		return;
-	}
-
-	transform->Position = newPos;
-
-	SetFlag(transform->State.Modified, PositionModifiedFlag);
+	SetPosition(transform, newPos);
 }
 
 private void SetRotation(Transform transform, quaternion rotation)
 {
-	if (Quaternions.Equals(rotation, transform->Rotation))
+	quaternion* current = &Hierarchy.Rotations[transform->Index];
+
+	if (Quaternions.Equals(rotation, *current))
 	{
 		return;
 	}
 
-	transform->Rotation = rotation;
+	*current = rotation;
 
-	SetFlag(transform->State.Modified, RotationModifiedFlag);
+	MarkModified(transform->Index, RotationModifiedFlag);
+
+	// directions only depend on the rotation
+	ResetFlags(transform->Directions.Accessed);
 }
 
 private void LookAt(Transform transform, vector3 target)
 {
-	transform->Rotation = Quaternions.LookAt(transform->Position, target, Vector3.Up);
+	const ulong index = transform->Index;
+
+	Hierarchy.Rotations[index] = Quaternions.LookAt(Hierarchy.Positions[index], target, Vector3.Up);
 
-	SetFlag(transform->State.Modified, RotationModifiedFlag);
+	MarkModified(index, RotationModifiedFlag);
+
+	ResetFlags(transform->Directions.Accessed);
 }
 
 private void LookAtPositions(Transform transform, float x, float y, float z)
 {
 	vector3 target = { x, y, z };
 
-	transform->Rotation = Quaternions.LookAt(transform->Position, target, Vector3.Up);
-
-	SetFlag(transform->State.Modified, RotationModifiedFlag);
+	LookAt(transform, target);
 }
 
 private void ScaleAll(Transform transform, float scalar)
 {
-	transform->Scale = Vector3s.Scale(transform->Scale, scalar);
+	const ulong index = transform->Index;
 
-	SetFlag(transform->State.Modified, ScaleModifiedFlag);
+	Hierarchy.Scales[index] = Vector3s.Scale(Hierarchy.Scales[index], scalar);
+
+	MarkModified(index, ScaleModifiedFlag);
 }
 
 private void SetScale(Transform transform, vector3 scale)
 {
-	if (Vector3s.Equals(scale, transform->Scale))
+	vector3* current = &Hierarchy.Scales[transform->Index];
+
+	if (Vector3s.Equals(scale, *current))
 	{
 		return;
 	}
 
-	transform->Scale = scale;
+	*current = scale;
 
-	SetFlag(transform->State.Modified, ScaleModifiedFlag);
+	MarkModified(transform->Index, ScaleModifiedFlag);
 }
 
 private void SetScales(Transform transform, float x, float y, float z)
 {
-	vector3 newPos = { x, y, z };
-
-	if (Vector3s.Equals(transform->Scale, newPos))
-	{
-		return;
-	}
-
-	transform->Scale = newPos;
+	vector3 newScale = { x, y, z };
 
-	SetFlag(transform->State.Modified, ScaleModifiedFlag);
+	SetScale(transform, newScale);
 }
 
 private void AddPosition(Transform transform, vector3 amount)
@@ -607,9 +1130,11 @@ private void AddPosition(Transform transform, vector3 amount)
 		return;
 	}
 
-	transform->Position = Vector3s.Add(transform->Position, amount);
+	const ulong index = transform->Index;
 
-	SetFlag(transform->State.Modified, PositionModifiedFlag);
+	Hierarchy.Positions[index] = Vector3s.Add(Hierarchy.Positions[index], amount);
+
+	MarkModified(index, PositionModifiedFlag);
 }
 
 private void Translate(Transform transform, float x, float y, float z)
@@ -621,46 +1146,56 @@ private void Translate(Transform transform, float x, float y, float z)
 
 private void TranslateX(Transform transform, float x)
 {
-	if (x is transform->Position.x)
+	const ulong index = transform->Index;
+
+	if (x is Hierarchy.Positions[index].x)
 	{
 		return;
 	}
 
-	transform->Position.x += x;
+	Hierarchy.Positions[index].x += x;
 
-	SetFlag(transform->State.Modified, PositionModifiedFlag);
+	MarkModified(index, PositionModifiedFlag);
 }
 
 private void TranslateY(Transform transform, float y)
 {
-	if (y is transform->Position.y)
+	const ulong index = transform->Index;
+
+	if (y is Hierarchy.Positions[index].y)
 	{
 		return;
 	}
 
-	transform->Position.y += y;
+	Hierarchy.Positions[index].y += y;
 
-	SetFlag(transform->State.Modified, PositionModifiedFlag);
+	MarkModified(index, PositionModifiedFlag);
 }
 
 private void TranslateZ(Transform transform, float z)
 {
-	if (z is transform->Position.z)
+	const ulong index = transform->Index;
+
+	if (z is Hierarchy.Positions[index].z)
 	{
 		return;
 	}
 
-	transform->Position.z += z;
+	Hierarchy.Positions[index].z += z;
 
-	SetFlag(transform->State.Modified, PositionModifiedFlag);
+	MarkModified(index, PositionModifiedFlag);
 }
 
 private void Rotate(Transform transform, quaternion amount)
 {
+	const ulong index = transform->Index;
+
 	// to add a rotation to a quaterion we multiply, gotta love imaginary number magic
-	transform->Rotation = Quaternions.Add(transform->Rotation, amount);
+	Hierarchy.Rotations[index] = Quaternions.Add(Hierarchy.Rotations[index], amount);
+
+	MarkModified(index, RotationModifiedFlag);
 
-	SetFlag(transform->State.Modified, RotationModifiedFlag);
+	ResetFlags(transform->Directions.Accessed);
 }
 
 private void RotateOnAxis(Transform transform, float angleInRads, vector3 axis)
@@ -681,9 +1216,11 @@ private void SetRotationOnAxis(Transform transform, float angleInRads, vector3 a
 
 private void AddScale(Transform transform, vector3 amount)
 {
-	transform->Scale = Vector3s.Add(transform->Scale, amount);
+	const ulong index = transform->Index;
 
-	SetFlag(transform->State.Modified, ScaleModifiedFlag);
+	Hierarchy.Scales[index] = Vector3s.Add(Hierarchy.Scales[index], amount);
+
+	MarkModified(index, ScaleModifiedFlag);
 }
 
 private vector3 GetDirection(Transform transform, Direction direction)
@@ -712,23 +1249,21 @@ private vector3 GetDirection(Transform transform, Direction direction)
 
 	// first check to see if we have already calc'ed the vector this frame
 	// if we have we should just return the pre-calculated one and not re-multiply the rotation
-	if (HasFlag(transform->State.Directions.Accessed, FlagN(direction)))
+	if (HasFlag(transform->Directions.Accessed, FlagN(direction)))
 	{
-		return transform->State.Directions.Directions[direction];
+		return transform->Directions.Directions[direction];
 	}
 
-	transform->State.Directions.Directions[direction] = Quaternions.RotateVector(transform->Rotation, directions[direction]);
+	transform->Directions.Directions[direction] = Quaternions.RotateVector(Hierarchy.Rotations[transform->Index], directions[direction]);
 
-	SetFlag(transform->State.Directions.Accessed, FlagN(direction));
+	SetFlag(transform->Directions.Accessed, FlagN(direction));
 
-	return transform->State.Directions.Directions[direction];
+	return transform->Directions.Directions[direction];
 }
 
 private vector3 TransformPoint(Transform transform, vector3 point)
 {
-	RefreshTransform(transform);
-
-	return Matrix4s.MultiplyVector3(transform->State.State, point, 1.0);
+	return Matrix4s.MultiplyVector3(RefreshTransform(transform), point, 1.0);
 }
 
 struct _transformInfo {
@@ -746,7 +1281,7 @@ TOKEN_LOAD(position, struct _transformInfo*)
 
 TOKEN_SAVE(position, Transform)
 {
-	Vector3s.TrySerializeStream(stream, state->Position);
+	Vector3s.TrySerializeStream(stream, GetPosition(state));
 }
 
 TOKEN_LOAD(rotation, struct _transformInfo*)
@@ -756,7 +1291,7 @@ TOKEN_LOAD(rotation, struct _transformInfo*)
 
 TOKEN_SAVE(rotation, Transform)
 {
-	Quaternions.TrySerializeStream(stream, state->Rotation);
+	Quaternions.TrySerializeStream(stream, GetRotation(state));
 }
 
 TOKEN_LOAD(scale, struct _transformInfo*)
@@ -766,7 +1301,7 @@ TOKEN_LOAD(scale, struct _transformInfo*)
 
 TOKEN_SAVE(scale, Transform)
 {
-	Vector3s.TrySerializeStream(stream, state->Scale);
+	Vector3s.TrySerializeStream(stream, GetScale(state));
 }
 
 TOKEN_LOAD(invertTransform, struct _transformInfo*)
@@ -823,9 +1358,9 @@ private Transform Load(File stream)
 		transform->InvertTransform = state.InvertTransform;
 		transform->RotateAroundCenter = state.InvertTransform;
 
-		transform->Scale = state.Scale;
-		transform->Position = state.Position;
-		transform->Rotation = state.Rotation;
+		SetScale(transform, state.Scale);
+		SetPosition(transform, state.Position);
+		SetRotation(transform, state.Rotation);
 	}
 
 	return transform;
@@ -837,4 +1372,994 @@ private void Save(Transform transform, File stream)
 	GuardNotNull(stream);
 
 	Configs.SaveConfigStream(stream, &TransformConfigDefinition, transform);
-}
\ No newline at end of file
+}
+// the local matrix of a transform worked out with cglm one step at a time
+private matrix4 ExpectedLocalMatrix(Transform transform)
+{
+	vector3 position = GetPosition(transform);
+	quaternion rotation = GetRotation(transform);
+
+	if (transform->InvertTransform)
+	{
+		position = (vector3){ -position.x, -position.y, -position.z };
+		rotation = Quaternions.Invert(rotation);
+	}
+
+	return Matrix4s.Scale(Quaternions.RotateMatrix(rotation, Matrix4s.Translate(Matrix4.Identity, position)), GetScale(transform));
+}
+
+// the world matrix of a transform worked out from the local matrix of each of its ancestors
+private matrix4 ExpectedWorldMatrix(Transform transform)
+{
+	matrix4 world = ExpectedLocalMatrix(transform);
+
+	for (Transform parent = transform->Parent; parent isnt null; parent = parent->Parent)
+	{
+		world = Matrix4s.Multiply(ExpectedLocalMatrix(parent), world);
+	}
+
+	return world;
+}
+
+private bool MatricesClose(const matrix4 left, const matrix4 right, float epsilon)
+{
+	const float* leftValues = (const float*)&left;
+	const float* rightValues = (const float*)&right;
+
+	for (ulong i = 0; i < 16; i++)
+	{
+		if (fabsf(leftValues[i] - rightValues[i]) > epsilon)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// every slot is owned by a transform that knows its slot, comes after its parent and is linked to it
+private bool HierarchyIsSorted(void)
+{
+	for (ulong i = 0; i < Hierarchy.Count; i++)
+	{
+		if (Hierarchy.Handles[i] is null)
+		{
+			continue;
+		}
+
+		if (Hierarchy.Handles[i]->Index isnt i)
+		{
+			return false;
+		}
+
+		if (Hierarchy.Parents[i] isnt NoSlot and Hierarchy.Parents[i] >= i)
+		{
+			return false;
+		}
+
+		// every child is linked to the parent it points to
+		for (ulong child = Hierarchy.FirstChildren[i]; child isnt NoSlot; child = Hierarchy.NextSiblings[child])
+		{
+			if (Hierarchy.Parents[child] isnt i)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+private ulong NextRandom(ulong* state)
+{
+	*state = (*state * 6364136223846793005ull) + 1442695040888963407ull;
+
+	return *state >> 33;
+}
+
+private void MoveTestTransform(Transform transform, float seed)
+{
+	SetPositions(transform, seed, seed * 0.5f, -seed);
+	SetRotationOnAxis(transform, seed * 0.3f, (vector3) { 0.0f, 1.0f, 0.0f });
+	SetScales(transform, 1.0f + (seed * 0.1f), 1.0f, 1.0f + (seed * 0.05f));
+}
+
+TEST(WorldMatricesFollowParents)
+{
+	// children are created before their parents so the hierarchy has to be sorted
+	Transform transforms[6];
+
+	for (ulong i = 0; i < 6; i++)
+	{
+		transforms[i] = CreateTransform();
+
+		MoveTestTransform(transforms[i], (float)(i + 1));
+	}
+
+	SetParent(transforms[0], transforms[2]);
+	SetParent(transforms[1], transforms[0]);
+	SetParent(transforms[3], transforms[2]);
+	SetParent(transforms[4], transforms[1]);
+
+	// inverted transforms, like cameras, are composed on their own
+	transforms[3]->InvertTransform = true;
+
+	UpdateAll();
+
+	IsTrue(HierarchyIsSorted());
+	IsTrue(transforms[2]->Index < transforms[0]->Index);
+	IsTrue(transforms[0]->Index < transforms[1]->Index);
+	IsTrue(transforms[1]->Index < transforms[4]->Index);
+
+	for (ulong i = 0; i < 6; i++)
+	{
+		IsTrue(MatricesClose(ExpectedWorldMatrix(transforms[i]), Hierarchy.WorldMatrices[transforms[i]->Index], 1e-4f));
+	}
+
+	// moving the root moves everything below it
+	const ulong version = Hierarchy.Versions[transforms[4]->Index];
+
+	SetPositions(transforms[2], -3.0f, 2.0f, 7.0f);
+
+	UpdateAll();
+
+	IsTrue(Hierarchy.Versions[transforms[4]->Index] isnt version);
+
+	for (ulong i = 0; i < 6; i++)
+	{
+		IsTrue(MatricesClose(ExpectedWorldMatrix(transforms[i]), RefreshTransform(transforms[i]), 1e-4f));
+	}
+
+	// moving a child back to the root keeps its own transform
+	SetParent(transforms[1], null);
+
+	IsTrue(MatricesClose(ExpectedLocalMatrix(transforms[1]), RefreshTransform(transforms[1]), 1e-6f));
+	IsTrue(MatricesClose(ExpectedWorldMatrix(transforms[4]), RefreshTransform(transforms[4]), 1e-4f));
+
+	for (ulong i = 0; i < 6; i++)
+	{
+		Dispose(transforms[i]);
+	}
+
+	return true;
+}
+
+TEST(RefreshFollowsDeepHierarchies)
+{
+	// deeper than the chain Refresh walks at once
+	const ulong depth = (MAX_REFRESH_CHAIN * 3) + 5;
+
+	Transform* chain = Memory.Alloc(depth * sizeof(Transform), Memory.GenericMemoryBlock);
+
+	for (ulong i = 0; i < depth; i++)
+	{
+		chain[i] = CreateTransform();
+
+		SetPositions(chain[i], 0.0f, 0.0f, 1.0f);
+		SetRotationOnAxis(chain[i], 0.01f, (vector3) { 1.0f, 0.0f, 0.0f });
+
+		if (i isnt 0)
+		{
+			SetParent(chain[i], chain[i - 1]);
+		}
+	}
+
+	const Transform leaf = chain[depth - 1];
+
+	IsTrue(MatricesClose(ExpectedWorldMatrix(leaf), RefreshTransform(leaf), 1e-3f));
+
+	// nothing changed so the leaf keeps its version
+	const ulong version = Version(leaf);
+
+	UpdateAll();
+
+	IsEqual(version, Version(leaf));
+
+	SetScales(chain[0], 2.0f, 2.0f, 2.0f);
+
+	IsTrue(Version(leaf) isnt version);
+	IsTrue(MatricesClose(ExpectedWorldMatrix(leaf), RefreshTransform(leaf), 1e-2f));
+
+	for (ulong i = depth; i > 0; i--)
+	{
+		Dispose(chain[i - 1]);
+	}
+
+	Memory.Free(chain, Memory.GenericMemoryBlock);
+
+	return true;
+}
+
+TEST(DisposedSlotsAreRemoved)
+{
+	Transform transforms[32];
+
+	for (ulong i = 0; i < 32; i++)
+	{
+		transforms[i] = CreateTransform();
+
+		if (i isnt 0)
+		{
+			SetParent(transforms[i], transforms[i / 2]);
+		}
+	}
+
+	// every other transform, the children of the disposed ones become roots
+	for (ulong i = 1; i < 32; i += 2)
+	{
+		Dispose(transforms[i]);
+		transforms[i] = null;
+	}
+
+	IsTrue(Hierarchy.Released isnt 0);
+
+	SortHierarchy();
+
+	IsEqual(0ull, Hierarchy.Released);
+	IsTrue(HierarchyIsSorted());
+
+	UpdateAll();
+
+	for (ulong i = 0; i < 32; i += 2)
+	{
+		IsTrue(Hierarchy.Handles[transforms[i]->Index] is transforms[i]);
+		IsTrue(MatricesClose(ExpectedWorldMatrix(transforms[i]), Hierarchy.WorldMatrices[transforms[i]->Index], 1e-4f));
+
+		Dispose(transforms[i]);
+	}
+
+	return true;
+}
+
+// every child of the transform is in the front Count spots of its children array and knows where it is
+private bool ChildrenArePacked(Transform transform)
+{
+	for (ulong i = 0; i < transform->Length; i++)
+	{
+		Transform child = transform->Children[i];
+
+		if (i < transform->Count ? (child is null or child->Parent isnt transform or child->ChildIndex isnt i) : child isnt null)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+TEST(DetachedChildrenLeaveNoHoles)
+{
+	Transform parent = CreateTransform();
+	Transform other = CreateTransform();
+	Transform children[16];
+
+	for (ulong i = 0; i < 16; i++)
+	{
+		children[i] = CreateTransform();
+
+		SetParent(children[i], parent);
+	}
+
+	IsEqual(16ull, parent->Count);
+	IsTrue(ChildrenArePacked(parent));
+
+	// the first, the last and a few from the middle
+	const ulong detached[] = { 0, 15, 7, 3, 8 };
+
+	for (ulong i = 0; i < sizeof(detached) / sizeof(ulong); i++)
+	{
+		SetParent(children[detached[i]], other);
+
+		IsTrue(ChildrenArePacked(parent));
+		IsTrue(ChildrenArePacked(other));
+	}
+
+	IsEqual(11ull, parent->Count);
+	IsEqual(5ull, other->Count);
+
+	// detaching a transform from something that isn't its parent does nothing
+	DetachChild(parent, children[0]);
+
+	IsEqual(11ull, parent->Count);
+	IsTrue(children[0]->Parent is other);
+
+	// every child moves back and the spots left behind are filled again
+	for (ulong i = 0; i < sizeof(detached) / sizeof(ulong); i++)
+	{
+		SetParent(children[detached[i]], parent);
+	}
+
+	IsEqual(16ull, parent->Count);
+	IsEqual(0ull, other->Count);
+	IsTrue(ChildrenArePacked(parent));
+	IsTrue(ChildrenArePacked(other));
+
+	// disposing a child removes it from its parent's array
+	Dispose(children[5]);
+
+	IsEqual(15ull, parent->Count);
+	IsTrue(ChildrenArePacked(parent));
+
+	ClearChildren(parent);
+
+	IsEqual(0ull, parent->Count);
+	IsTrue(ChildrenArePacked(parent));
+
+	for (ulong i = 0; i < 16; i++)
+	{
+		if (i isnt 5)
+		{
+			IsTrue(children[i]->Parent is null);
+
+			Dispose(children[i]);
+		}
+	}
+
+	Dispose(parent);
+	Dispose(other);
+
+	return true;
+}
+
+TEST(ChildArraysAreTracked)
+{
+	// make room in the hierarchy first so only the child arrays are counted
+	Transform warmup[4];
+
+	for (ulong i = 0; i < 4; i++)
+	{
+		warmup[i] = CreateTransform();
+	}
+
+	for (ulong i = 0; i < 4; i++)
+	{
+		Dispose(warmup[i]);
+	}
+
+	const ulong allocCount = Memory.AllocCount();
+	const ulong freeCount = Memory.FreeCount();
+
+	// the parent grows its child array from nothing one attachment at a time
+	Transform parent = CreateTransform();
+	Transform children[3];
+
+	for (ulong i = 0; i < 3; i++)
+	{
+		children[i] = CreateTransform();
+
+		SetParent(children[i], parent);
+	}
+
+	IsEqual(3ull, parent->Count);
+
+	for (ulong i = 0; i < 3; i++)
+	{
+		Dispose(children[i]);
+	}
+
+	Dispose(parent);
+
+	IsEqual(Memory.AllocCount() - allocCount, Memory.FreeCount() - freeCount);
+
+	return true;
+}
+
+TEST(UpdateAllWalksOnlyDirtySubtrees)
+{
+	// two roots with a chain of children each, plus more transforms nobody touches so the dirty list is used rather
+	// than a sweep over every slot
+	Transform transforms[8];
+	Transform idle[64];
+
+	for (ulong i = 0; i < 8; i++)
+	{
+		transforms[i] = CreateTransform();
+
+		MoveTestTransform(transforms[i], (float)(i + 1));
+
+		if (i % 4 isnt 0)
+		{
+			SetParent(transforms[i], transforms[i - 1]);
+		}
+	}
+
+	for (ulong i = 0; i < 64; i++)
+	{
+		idle[i] = CreateTransform();
+	}
+
+	UpdateAll();
+
+	IsEqual(0ull, Hierarchy.DirtyCount);
+
+	ulong versions[8];
+
+	for (ulong i = 0; i < 8; i++)
+	{
+		versions[i] = Hierarchy.Versions[transforms[i]->Index];
+	}
+
+	// moving the middle of the first chain only changes the slots below it
+	SetPositions(transforms[1], 4.0f, -2.0f, 1.0f);
+
+	IsEqual(1ull, Hierarchy.DirtyCount);
+
+	UpdateAll();
+
+	for (ulong i = 0; i < 8; i++)
+	{
+		const bool moved = i >= 1 and i < 4;
+
+		IsTrue((Hierarchy.Versions[transforms[i]->Index] isnt versions[i]) is moved);
+		IsTrue(MatricesClose(ExpectedWorldMatrix(transforms[i]), GetWorldMatrix(transforms[i]), 1e-4f));
+	}
+
+	// a slot refreshed early still brings its children up to date in the next pass
+	SetScales(transforms[4], 2.0f, 2.0f, 2.0f);
+
+	RefreshTransform(transforms[4]);
+
+	UpdateAll();
+
+	for (ulong i = 4; i < 8; i++)
+	{
+		IsTrue(MatricesClose(ExpectedWorldMatrix(transforms[i]), GetWorldMatrix(transforms[i]), 1e-4f));
+	}
+
+	// moving a subtree to the other root takes it out of the first root's walk
+	SetParent(transforms[2], transforms[7]);
+	SetPositions(transforms[0], -1.0f, 0.0f, 0.0f);
+
+	const ulong version = Hierarchy.Versions[transforms[2]->Index];
+
+	UpdateAll();
+
+	IsTrue(HierarchyIsSorted());
+	IsTrue(Hierarchy.Versions[transforms[2]->Index] isnt version);
+
+	for (ulong i = 0; i < 8; i++)
+	{
+		IsTrue(MatricesClose(ExpectedWorldMatrix(transforms[i]), GetWorldMatrix(transforms[i]), 1e-4f));
+	}
+
+	for (ulong i = 8; i > 0; i--)
+	{
+		Dispose(transforms[i - 1]);
+	}
+
+	for (ulong i = 0; i < 64; i++)
+	{
+		Dispose(idle[i]);
+	}
+
+	return true;
+}
+
+// a copy of every array of the hierarchy and its dirty list
+struct _hierarchySnapshot {
+	void* Arrays[HIERARCHY_ARRAY_COUNT];
+	ulong* Dirty;
+	ulong DirtyCount;
+};
+
+private void SaveHierarchy(struct _hierarchySnapshot* snapshot)
+{
+	for (ulong i = 0; i < HIERARCHY_ARRAY_COUNT; i++)
+	{
+		const struct _hierarchyArray array = HierarchyArrays[i];
+
+		snapshot->Arrays[i] = Memory.Alloc(Hierarchy.Count * array.Size, Memory.GenericMemoryBlock);
+
+		memcpy(snapshot->Arrays[i], *array.Address, Hierarchy.Count * array.Size);
+	}
+
+	// the dirty list is empty once it's been updated, it still needs somewhere to be copied to and from
+	snapshot->Dirty = Memory.Alloc(max(Hierarchy.DirtyCount, 1) * sizeof(ulong), Memory.GenericMemoryBlock);
+	snapshot->DirtyCount = Hierarchy.DirtyCount;
+
+	memcpy(snapshot->Dirty, Hierarchy.Dirty, Hierarchy.DirtyCount * sizeof(ulong));
+}
+
+private void RestoreHierarchy(const struct _hierarchySnapshot* snapshot)
+{
+	for (ulong i = 0; i < HIERARCHY_ARRAY_COUNT; i++)
+	{
+		const struct _hierarchyArray array = HierarchyArrays[i];
+
+		memcpy(*array.Address, snapshot->Arrays[i], Hierarchy.Count * array.Size);
+	}
+
+	memcpy(Hierarchy.Dirty, snapshot->Dirty, snapshot->DirtyCount * sizeof(ulong));
+
+	Hierarchy.DirtyCount = snapshot->DirtyCount;
+}
+
+private void DisposeSnapshot(struct _hierarchySnapshot* snapshot)
+{
+	for (ulong i = 0; i < HIERARCHY_ARRAY_COUNT; i++)
+	{
+		Memory.Free(snapshot->Arrays[i], Memory.GenericMemoryBlock);
+	}
+
+	Memory.Free(snapshot->Dirty, Memory.GenericMemoryBlock);
+}
+
+// updates the dirty transforms on one thread and then again from the same state split across threads, whether every
+// matrix, flag and version is bit for bit the same
+private bool ParallelUpdateMatches(void)
+{
+	struct _hierarchySnapshot before;
+	SaveHierarchy(&before);
+
+	UpdateHierarchy(1);
+
+	struct _hierarchySnapshot serial;
+	SaveHierarchy(&serial);
+
+	RestoreHierarchy(&before);
+
+	// more threads than most machines have so the subtrees are split finely
+	UpdateHierarchy(16);
+
+	bool matches = Hierarchy.DirtyCount is 0;
+
+	for (ulong i = 0; i < HIERARCHY_ARRAY_COUNT; i++)
+	{
+		matches = matches and memcmp(serial.Arrays[i], *HierarchyArrays[i].Address, Hierarchy.Count * HierarchyArrays[i].Size) is 0;
+	}
+
+	DisposeSnapshot(&before);
+	DisposeSnapshot(&serial);
+
+	return matches;
+}
+
+TEST(ParallelUpdateMatchesSerial)
+{
+	// a handful of roots with large random trees below them
+	const ulong count = MIN_PARALLEL_SLOTS * 4;
+
+	Transform* transforms = Memory.Alloc(count * sizeof(Transform), Memory.GenericMemoryBlock);
+
+	ulong random = 17;
+
+	for (ulong i = 0; i < count; i++)
+	{
+		transforms[i] = CreateTransform();
+
+		MoveTestTransform(transforms[i], (float)(i % 97) * 0.1f);
+
+		if (i >= 4)
+		{
+			SetParent(transforms[i], transforms[NextRandom(&random) % i]);
+		}
+	}
+
+	UpdateAll();
+
+	// every root with some of the rest, then a few transforms deep in the trees, then a single leaf
+	const ulong movingCounts[] = { count / 3, 40, 1 };
+
+	for (ulong pass = 0; pass < 3; pass++)
+	{
+		for (ulong i = 0; i < movingCounts[pass]; i++)
+		{
+			const ulong moved = pass is 0 and i < 4 ? i : NextRandom(&random) % count;
+
+			MoveTestTransform(transforms[moved], (float)(NextRandom(&random) % 1000) * 0.01f);
+		}
+
+		IsTrue(ParallelUpdateMatches());
+	}
+
+	for (ulong i = 0; i < count; i += 101)
+	{
+		IsTrue(MatricesClose(ExpectedWorldMatrix(transforms[i]), GetWorldMatrix(transforms[i]), 1e-2f));
+	}
+
+	for (ulong i = count; i > 0; i--)
+	{
+		Dispose(transforms[i - 1]);
+	}
+
+	Memory.Free(transforms, Memory.GenericMemoryBlock);
+
+	return true;
+}
+
+TEST(DeepChainsUpdateInParallel)
+{
+	// text parents every glyph to the one before it
+	const ulong count = MIN_PARALLEL_SLOTS * 2;
+
+	Transform* transforms = Memory.Alloc(count * sizeof(Transform), Memory.GenericMemoryBlock);
+
+	for (ulong i = 0; i < count; i++)
+	{
+		transforms[i] = CreateTransform();
+
+		if (i isnt 0)
+		{
+			SetParent(transforms[i], transforms[i - 1]);
+		}
+	}
+
+	UpdateAll();
+
+	// every glyph moves when text is generated again, then a few glyphs along the chain move
+	const ulong strides[] = { 1, 997 };
+
+	for (ulong pass = 0; pass < 2; pass++)
+	{
+		for (ulong i = 0; i < count; i += strides[pass])
+		{
+			MoveTestTransform(transforms[i], (float)(pass + 1) * 0.001f);
+		}
+
+		const clock_t start = clock();
+
+		IsTrue(ParallelUpdateMatches());
+
+		fprintf(__test_stream, "\tchain of %llu, every %llu moving: %.3lf ms"NEWLINE, count, strides[pass], (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC);
+	}
+
+	IsTrue(MatricesClose(ExpectedWorldMatrix(transforms[count - 1]), GetWorldMatrix(transforms[count - 1]), 1e-1f));
+
+	for (ulong i = count; i > 0; i--)
+	{
+		Dispose(transforms[i - 1]);
+	}
+
+	Memory.Free(transforms, Memory.GenericMemoryBlock);
+
+	return true;
+}
+
+TEST_SUITE(
+	RunUnitTests,
+	APPEND_TEST(WorldMatricesFollowParents)
+	APPEND_TEST(RefreshFollowsDeepHierarchies)
+	APPEND_TEST(DisposedSlotsAreRemoved)
+	APPEND_TEST(DetachedChildrenLeaveNoHoles)
+	APPEND_TEST(ChildArraysAreTracked)
+	APPEND_TEST(UpdateAllWalksOnlyDirtySubtrees)
+	APPEND_TEST(ParallelUpdateMatchesSerial)
+	APPEND_TEST(DeepChainsUpdateInParallel)
+);
+
+// the layout transforms had before they were flattened, every node is allocated on its own and holds its own cached
+// matrices, children are marked through their pointers whenever their parent is refreshed
+struct _pointerTransform {
+	struct _pointerTransform* Parent;
+	struct _pointerTransform** Children;
+	ulong Count;
+	vector3 Position;
+	quaternion Rotation;
+	vector3 Scale;
+	unsigned int Modified;
+	matrix4 ScaleMatrix;
+	matrix4 RotationMatrix;
+	matrix4 TranslationMatrix;
+	matrix4 LocalState;
+	matrix4 State;
+	struct _directionStates Directions;
+};
+
+private void RefreshPointerTransform(struct _pointerTransform* node)
+{
+	if (node->Modified is 0)
+	{
+		return;
+	}
+
+	if (node->Modified isnt ParentModifiedFlag)
+	{
+		node->TranslationMatrix = Matrix4s.Translate(Matrix4.Identity, node->Position);
+		node->RotationMatrix = Quaternions.RotateMatrix(node->Rotation, node->TranslationMatrix);
+		node->LocalState = Matrix4s.Scale(node->RotationMatrix, node->Scale);
+	}
+
+	node->State = node->Parent isnt null ? Matrix4s.Multiply(node->Parent->State, node->LocalState) : node->LocalState;
+
+	ResetFlags(node->Modified);
+
+	for (ulong i = 0; i < node->Count; i++)
+	{
+		SetFlag(node->Children[i]->Modified, ParentModifiedFlag);
+	}
+}
+
+private void BenchmarkHierarchy(FILE* __test_stream, const char* name, const ulong* parents, ulong count, ulong rootCount)
+{
+	const ulong frames = 20;
+
+	// the pointer nodes are allocated in a shuffled order so neighbors in the tree are scattered over the heap like
+	// transforms that were created over the life of a scene
+	struct _pointerTransform** nodes = Memory.Alloc(count * sizeof(struct _pointerTransform*), Memory.GenericMemoryBlock);
+	ulong* shuffled = Memory.Alloc(count * sizeof(ulong), Memory.GenericMemoryBlock);
+	ulong* childCounts = Memory.Alloc(count * sizeof(ulong), Memory.GenericMemoryBlock);
+
+	ulong random = 13;
+
+	for (ulong i = 0; i < count; i++)
+	{
+		shuffled[i] = i;
+	}
+
+	for (ulong i = count - 1; i > 0; i--)
+	{
+		const ulong other = NextRandom(&random) % (i + 1);
+		const ulong swap = shuffled[i];
+
+		shuffled[i] = shuffled[other];
+		shuffled[other] = swap;
+	}
+
+	for (ulong i = 0; i < count; i++)
+	{
+		nodes[shuffled[i]] = Memory.Alloc(sizeof(struct _pointerTransform), Memory.GenericMemoryBlock);
+	}
+
+	for (ulong i = 0; i < count; i++)
+	{
+		if (parents[i] isnt NoSlot)
+		{
+			++childCounts[parents[i]];
+		}
+	}
+
+	for (ulong i = 0; i < count; i++)
+	{
+		struct _pointerTransform* node = nodes[i];
+
+		node->Parent = parents[i] isnt NoSlot ? nodes[parents[i]] : null;
+		node->Children = childCounts[i] isnt 0 ? Memory.Alloc(childCounts[i] * sizeof(struct _pointerTransform*), Memory.GenericMemoryBlock) : null;
+		node->Position = (vector3){ (float)(i % 7), (float)(i % 5), (float)(i % 3) };
+		node->Rotation = Quaternions.Create((float)i * 0.001f, Vector3.Up);
+		node->Scale = (vector3){ 1, 1, 1 };
+		node->Modified = AllModifiedFlag;
+
+		if (node->Parent isnt null)
+		{
+			node->Parent->Children[node->Parent->Count++] = node;
+		}
+	}
+
+	Transform* transforms = Memory.Alloc(count * sizeof(Transform), Memory.GenericMemoryBlock);
+
+	for (ulong i = 0; i < count; i++)
+	{
+		transforms[i] = CreateTransform();
+
+		SetPosition(transforms[i], nodes[i]->Position);
+		SetRotation(transforms[i], nodes[i]->Rotation);
+
+		if (parents[i] isnt NoSlot)
+		{
+			SetParent(transforms[i], transforms[parents[i]]);
+		}
+	}
+
+	// structural changes that put a child before its parent sort every slot again
+	clock_t start = clock();
+	SortHierarchy();
+	const double sortSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	UpdateAll();
+
+	for (ulong i = 0; i < count; i++)
+	{
+		RefreshPointerTransform(nodes[i]);
+	}
+
+	// every transform moves, then only the roots move and their children follow, then a single root moves and every
+	// other subtree stays where it is
+	const ulong movingCounts[] = { count, rootCount, 1 };
+	const char* passNames[] = { "all moving  ", "roots moving", "one moving  " };
+
+	for (ulong pass = 0; pass < 3; pass++)
+	{
+		const ulong moving = movingCounts[pass];
+
+		start = clock();
+
+		for (ulong frame = 0; frame < frames; frame++)
+		{
+			for (ulong i = 0; i < moving; i++)
+			{
+				SetFlag(nodes[i]->Modified, PositionModifiedFlag);
+				nodes[i]->Position.y = (float)((pass * frames) + frame) + 0.5f;
+			}
+
+			for (ulong i = 0; i < count; i++)
+			{
+				RefreshPointerTransform(nodes[i]);
+			}
+		}
+
+		const double pointerSeconds = (double)(clock() - start) / CLOCKS_PER_SEC / frames;
+
+		// the same frames on the calling thread alone and then spread over the thread pool the way UpdateAll does
+		double flattenedSeconds[2];
+
+		for (ulong threaded = 0; threaded < 2; threaded++)
+		{
+			start = clock();
+
+			for (ulong frame = 0; frame < frames; frame++)
+			{
+				for (ulong i = 0; i < moving; i++)
+				{
+					vector3 position = GetPosition(transforms[i]);
+
+					position.y = (float)((((pass * 2) + threaded) * frames) + frame) + 0.5f;
+
+					SetPosition(transforms[i], position);
+				}
+
+				if (threaded)
+				{
+					UpdateAll();
+				}
+				else
+				{
+					UpdateHierarchy(1);
+				}
+			}
+
+			flattenedSeconds[threaded] = (double)(clock() - start) / CLOCKS_PER_SEC / frames;
+		}
+
+		fprintf(__test_stream, "\t%s, %s: pointers %7.3lf ms flattened %7.3lf ms (%.2lfx) threaded %7.3lf ms (%.2lfx)"NEWLINE,
+			name,
+			passNames[pass],
+			pointerSeconds * 1000.0,
+			flattenedSeconds[0] * 1000.0,
+			pointerSeconds / max(flattenedSeconds[0], 1e-9),
+			flattenedSeconds[1] * 1000.0,
+			pointerSeconds / max(flattenedSeconds[1], 1e-9));
+	}
+
+	fprintf(__test_stream, "\t%s: sorting %llu transforms %.3lf ms"NEWLINE, name, count, sortSeconds * 1000.0);
+
+	for (ulong i = count; i > 0; i--)
+	{
+		Dispose(transforms[i - 1]);
+
+		Memory.Free(nodes[i - 1]->Children, Memory.GenericMemoryBlock);
+		Memory.Free(nodes[i - 1], Memory.GenericMemoryBlock);
+	}
+
+	UpdateAll();
+
+	Memory.Free(transforms, Memory.GenericMemoryBlock);
+	Memory.Free(nodes, Memory.GenericMemoryBlock);
+	Memory.Free(shuffled, Memory.GenericMemoryBlock);
+	Memory.Free(childCounts, Memory.GenericMemoryBlock);
+}
+
+TEST(Benchmark)
+{
+	const ulong count = 100000;
+
+	ulong* parents = Memory.Alloc(count * sizeof(ulong), Memory.GenericMemoryBlock);
+
+	// a few roots with a thousand props each
+	for (ulong i = 0; i < count; i++)
+	{
+		parents[i] = i < 100 ? NoSlot : i % 100;
+	}
+
+	BenchmarkHierarchy(__test_stream, "100 roots, 1000 children each", parents, count, 100);
+
+	// every transform hangs off a random earlier one, the tree is about a dozen levels deep
+	ulong random = 7;
+
+	for (ulong i = 0; i < count; i++)
+	{
+		parents[i] = i < 10 ? NoSlot : NextRandom(&random) % i;
+	}
+
+	BenchmarkHierarchy(__test_stream, "random tree", parents, count, 10);
+
+	Memory.Free(parents, Memory.GenericMemoryBlock);
+
+	return true;
+}
+
+TEST(ReparentBenchmark)
+{
+	const ulong count = 100000;
+
+	Transform first = CreateTransform();
+	Transform second = CreateTransform();
+
+	Transform* children = Memory.Alloc(count * sizeof(Transform), Memory.GenericMemoryBlock);
+	ulong* order = Memory.Alloc(count * sizeof(ulong), Memory.GenericMemoryBlock);
+
+	ulong random = 11;
+
+	for (ulong i = 0; i < count; i++)
+	{
+		children[i] = CreateTransform();
+		order[i] = i;
+	}
+
+	for (ulong i = count - 1; i > 0; i--)
+	{
+		const ulong other = NextRandom(&random) % (i + 1);
+		const ulong swap = order[i];
+
+		order[i] = order[other];
+		order[other] = swap;
+	}
+
+	// attaching, moving in the order they were attached like text does when it's rebuilt, moving in a random order,
+	// then detaching them all in a random order
+	clock_t start = clock();
+
+	for (ulong i = 0; i < count; i++)
+	{
+		SetParent(children[i], first);
+	}
+
+	const double attachSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+
+	for (ulong i = 0; i < count; i++)
+	{
+		SetParent(children[i], second);
+	}
+
+	const double inOrderSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+
+	for (ulong i = 0; i < count; i++)
+	{
+		SetParent(children[order[i]], first);
+	}
+
+	const double randomSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+
+	for (ulong i = 0; i < count; i++)
+	{
+		SetParent(children[order[count - 1 - i]], null);
+	}
+
+	const double detachSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	IsEqual(0ull, first->Count);
+	IsEqual(0ull, second->Count);
+
+	fprintf(__test_stream, "\t%llu children: attach %.3lf ms, reparent in order %.3lf ms, reparent randomly %.3lf ms, detach randomly %.3lf ms"NEWLINE,
+		count,
+		attachSeconds * 1000.0,
+		inOrderSeconds * 1000.0,
+		randomSeconds * 1000.0,
+		detachSeconds * 1000.0);
+
+	for (ulong i = count; i > 0; i--)
+	{
+		Dispose(children[i - 1]);
+	}
+
+	Dispose(first);
+	Dispose(second);
+
+	UpdateAll();
+
+	Memory.Free(children, Memory.GenericMemoryBlock);
+	Memory.Free(order, Memory.GenericMemoryBlock);
+
+	return true;
+}
+
+TEST_SUITE(
+	RunBenchmarks,
+	APPEND_TEST(Benchmark)
+	APPEND_TEST(ReparentBenchmark)
+);
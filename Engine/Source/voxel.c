@@ -128,7 +128,8 @@ DEFINE_TYPE_ID(VoxelTree);
 
 static voxelTree Create(Mesh mesh)
 {
-	const ulong voxelCount = mesh->VertexCount / 3;
+	// indexed meshes store their triangles as indices, otherwise every three vertices are a triangle
+	const ulong voxelCount = (mesh->Indices isnt null ? mesh->IndexCount : mesh->VertexCount) / 3;
 
 	// we'll need a voxel for each triangle so just allocate the amount of triangles we need right off the bat
 	REGISTER_TYPE(voxel);
@@ -155,7 +156,20 @@ static voxelTree Create(Mesh mesh)
 		// assign the triangles
 		Voxel destinationVoxel = &voxels[i + 1];
 
-		const triangle triangle = struct_cast(struct triangle)mesh->Vertices[i * 3];
+		triangle triangle;
+
+		if (mesh->Indices isnt null)
+		{
+			triangle = (struct triangle){
+				mesh->Vertices[mesh->Indices[i * 3]],
+				mesh->Vertices[mesh->Indices[i * 3 + 1]],
+				mesh->Vertices[mesh->Indices[i * 3 + 2]]
+			};
+		}
+		else
+		{
+			triangle = struct_cast(struct triangle)mesh->Vertices[i * 3];
+		}
 
 		destinationVoxel->Triangle = triangle;
 
@@ -212,8 +226,8 @@ private bool Intersects(const Voxel left, const Transform leftTransform, const V
 	*out_voxel = null;
 
 	// check to see if the two cuboids intersect first
-	const cuboid leftBounding = Cuboids.AddOffset(left->BoundingBox, leftTransform->Position);
-	const cuboid rightBounding = Cuboids.AddOffset(right->BoundingBox, rightTransform->Position);
+	const cuboid leftBounding = Cuboids.AddOffset(left->BoundingBox, Transforms.GetPosition(leftTransform));
+	const cuboid rightBounding = Cuboids.AddOffset(right->BoundingBox, Transforms.GetPosition(rightTransform));
 
 	const bool cuboidsIntersect = Cuboids.Intersects(leftBounding, rightBounding);
 
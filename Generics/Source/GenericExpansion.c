@@ -346,7 +346,7 @@ private array(tuple(string, int)) SortGenericTypeInfo(GenericTypeInfo info)
 		}
 	}
 
-	arrays(tuple(string, int)).InsertionSort(result, BigToSmallComparator);
+	arrays(tuple(string, int)).StableSort(result, BigToSmallComparator);
 
 	info.SortedTypeLocations = result;
 